@@ -0,0 +1,38 @@
+# - Find MySQL
+# Find the MySQL (or MariaDB Connector/C) includes and client library
+# This module defines
+#  MYSQL_INCLUDE_DIR, where to find mysql.h
+#  MYSQL_LIBRARIES, the libraries needed to use the MySQL client.
+#  MYSQL_FOUND, If false, do not try to use the MySQL client library.
+#
+# Redistribution and use is allowed according to the terms of the BSD license.
+# For details see the accompanying COPYING-CMAKE-SCRIPTS file.
+
+
+if (MYSQL_INCLUDE_DIR AND MYSQL_LIBRARIES)
+  # Already in cache, be silent
+  set(MySQL_FIND_QUIETLY TRUE)
+endif (MYSQL_INCLUDE_DIR AND MYSQL_LIBRARIES)
+
+
+find_path(MYSQL_INCLUDE_DIR mysql.h
+   ${MYSQL_PATH_INCLUDES}/
+   /usr/include/mysql/
+   /usr/local/include/mysql/
+   /usr/include/mariadb/
+   /usr/local/include/mariadb/
+)
+
+find_library(MYSQL_LIBRARIES NAMES mysqlclient mariadb libmysql libmariadb
+    PATHS
+        ${MYSQL_PATH_LIB}
+        /usr/lib/
+        /usr/lib/mysql/
+        /usr/lib/mariadb/
+)
+
+include(ToraFindPackageHandleStandardArgs)
+find_package_handle_standard_args(MySQL DEFAULT_MSG
+                                  MYSQL_INCLUDE_DIR MYSQL_LIBRARIES )
+
+mark_as_advanced(MYSQL_INCLUDE_DIR MYSQL_LIBRARIES)
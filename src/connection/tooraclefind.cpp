@@ -74,6 +74,10 @@ class toOracleInstantFinder : public  toConnectionProviderFinder
             return QString::fromLatin1(ORACLE_INSTANTCLIENT);
         };
 
+        /** Read the configured Oracle home and resolve the relative search paths
+         */
+        virtual void prepare();
+
         /** Return list of possible client locations
          */
         virtual QList<ConnectionProvirerParams> find();
@@ -93,6 +97,10 @@ class toOracleInstantFinder : public  toConnectionProviderFinder
         void setEnv(ConnectionProvirerParams const&);
         void loadLib(ConnectionProvirerParams const&);
 
+        // Set by prepare()
+        QString m_configuredHome;
+        QSet<QString> m_searchPaths;
+
     private:
         static QSet<QString> m_paths;
 };
@@ -172,20 +180,31 @@ EXIT:
     return retval;
 };
 
-QList<toConnectionProviderFinder::ConnectionProvirerParams>  toOracleInstantFinder::find()
+void toOracleInstantFinder::prepare()
 {
-    using namespace ToConfiguration;
+    m_configuredHome = toConfigurationNewSingle::Instance().option(ToConfiguration::Global::OracleHomeDirectory).toString();
+    QString applicationDir = QCoreApplication::applicationDirPath();
+
+    // Relative paths are relative to the application, find() can not chdir
+    // there as the other finders run at the same time
+    QDir appDir(applicationDir);
+    m_searchPaths.clear();
+    foreach(QString p, m_paths)
+        m_searchPaths.insert(QDir::isRelativePath(p) ? appDir.absoluteFilePath(p) : p);
+#if defined(Q_OS_WIN32)
+    m_searchPaths.insert(QFileInfo(applicationDir + QDir::separator() + "instantclient*").absoluteFilePath());
+#endif
+}
 
+QList<toConnectionProviderFinder::ConnectionProvirerParams>  toOracleInstantFinder::find()
+{
     QList<ConnectionProvirerParams> retval;
     QSet<QString> possibleOracleHomes;
     ConnectionProvirerParams ohome;
 
-    QDir cwdDir(QDir::currentPath());
-    QDir::setCurrent(QCoreApplication::applicationDirPath());
-
     do
     {
-        QString cHome = toConfigurationNewSingle::Instance().option(Global::OracleHomeDirectory).toString();
+        QString cHome = m_configuredHome;
         if ( cHome.isEmpty())
             continue;
         QDir dHome(cHome);
@@ -245,16 +264,8 @@ QList<toConnectionProviderFinder::ConnectionProvirerParams>  toOracleInstantFind
         }
     }
 
-#if defined(Q_OS_WIN32)
-    //
-    {
-        QFileInfo ToraDir(QCoreApplication::applicationDirPath() + QDir::separator() + "instantclient*");
-        m_paths.insert(ToraDir.absoluteFilePath());
-    }
-#endif
-
     // populate the list of the possible oracle homes
-    foreach( QString p, m_paths)
+    foreach( QString p, m_searchPaths)
     {
         /** special case, path contains a wildcard
          */
@@ -318,7 +329,6 @@ QList<toConnectionProviderFinder::ConnectionProvirerParams>  toOracleInstantFind
         }
     }
 
-    QDir::setCurrent(cwdDir.absolutePath());
     return retval;
 }
 
@@ -524,15 +534,13 @@ class toOracleFinder : public  toOracleInstantFinder
 
 QList<toConnectionProviderFinder::ConnectionProvirerParams> toOracleFinder::find()
 {
-    using namespace ToConfiguration;
-
     QList<ConnectionProvirerParams> retval;
     QSet<QString> possibleOracleHomes;
     ConnectionProvirerParams ohome;
 
     do
     {
-        QString cHome = toConfigurationNewSingle::Instance().option(Global::OracleHomeDirectory).toString();
+        QString cHome = m_configuredHome;
         if ( cHome.isEmpty())
             continue;
         QDir dHome(cHome);
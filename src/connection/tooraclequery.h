@@ -100,6 +100,18 @@ class oracleQuery : public queryImpl
             return retval;
         }
 
+        /** Estimated, after the execute trotl fetches g_OCIPL_BULK_ROWS rows per round trip
+         * and the last fetch returns less rows.
+         */
+        virtual unsigned long roundTrips(void)
+        {
+            if (!Query)
+                return 0;
+            if ( Query->get_stmt_type() != ::trotl::SqlStatement::STMT_SELECT )
+                return 1;
+            return 2 + Query->get_last_row() / ::trotl::g_OCIPL_BULK_ROWS;
+        }
+
         virtual unsigned columns(void)
         {
             //int descriptionLen;
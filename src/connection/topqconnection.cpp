@@ -0,0 +1,350 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "connection/topqconnection.h"
+#include "connection/topqquery.h"
+#include "core/tologger.h"
+#include "parsing/tsqllexer.h"
+
+#include <libpq-fe.h>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QRegExp>
+
+#include <memory>
+
+toPQConnectionSub::toPQConnectionSub(toConnection const& parent, PGconn *conn)
+    : toConnectionSub()
+    , Connection(conn)
+    , Cancel(PQgetCancel(conn))
+    , StatementCounter(0)
+    , ServerVersion(PQserverVersion(conn))
+    , BackendPID(PQbackendPID(conn))
+{
+    PQsetClientEncoding(Connection, "UTF8");
+    Q_UNUSED(parent);
+}
+
+toPQConnectionSub::~toPQConnectionSub()
+{
+    close();
+}
+
+void toPQConnectionSub::cancel(void)
+{
+    // Must not lock Lock, the query being cancelled holds it
+    QMutexLocker lock(&CancelLock);
+    if (!Cancel)
+        return;
+    char errbuf[256];
+    if (!PQcancel(Cancel, errbuf, sizeof(errbuf)))
+        TLOG(5, toDecorator, __HERE__) << "PQcancel failed: " << errbuf << std::endl;
+}
+
+void toPQConnectionSub::close(void)
+{
+    QMutexLocker lock(&Lock);
+    {
+        QMutexLocker cancelLock(&CancelLock);
+        if (Cancel)
+            PQfreeCancel(Cancel);
+        Cancel = NULL;
+    }
+    if (Connection)
+        PQfinish(Connection);
+    Connection = NULL;
+    Statements.clear();
+    StatementOrder.clear();
+}
+
+void toPQConnectionSub::exec(QString const& sql)
+{
+    PGresult *res = PQexec(Connection, sql.toUtf8().constData());
+    ExecStatusType status = PQresultStatus(res);
+    if (status != PGRES_COMMAND_OK && status != PGRES_TUPLES_OK)
+    {
+        QString err = errorString(Connection, res);
+        PQclear(res);
+        throw toConnection::exception(err);
+    }
+    PQclear(res);
+}
+
+void toPQConnectionSub::commit(void)
+{
+    QMutexLocker lock(&Lock);
+    if (PQtransactionStatus(Connection) != PQTRANS_IDLE)
+        exec("COMMIT");
+}
+
+void toPQConnectionSub::rollback(void)
+{
+    QMutexLocker lock(&Lock);
+    if (PQtransactionStatus(Connection) != PQTRANS_IDLE)
+        exec("ROLLBACK");
+}
+
+bool toPQConnectionSub::hasTransaction(void)
+{
+    QMutexLocker lock(&Lock);
+    PGTransactionStatusType status = PQtransactionStatus(Connection);
+    return status == PQTRANS_INTRANS || status == PQTRANS_INERROR;
+}
+
+QString toPQConnectionSub::version(void)
+{
+    // 90624 -> 0906, 120003 -> 1200 (since 10 the second number is the patch level)
+    int major = ServerVersion / 10000;
+    int minor = ServerVersion >= 100000 ? 0 : (ServerVersion / 100) % 100;
+    QString retval = QString("%1%2").arg(major, 2, 10, QChar('0')).arg(minor, 2, 10, QChar('0'));
+    TLOG(5, toDecorator, __HERE__) << "libpq Connection version: " << retval << std::endl;
+    return retval;
+}
+
+toQueryParams toPQConnectionSub::sessionId(void)
+{
+    return toQueryParams() << QString::number(BackendPID);
+}
+
+queryImpl* toPQConnectionSub::createQuery(toQueryAbstr *query)
+{
+    return new pqQuery(query, this);
+}
+
+QString toPQConnectionSub::errorString(PGconn *conn, PGresult *result)
+{
+    QString ret;
+    if (result)
+        ret = QString::fromUtf8(PQresultErrorMessage(result));
+    if (ret.isEmpty() && conn)
+        ret = QString::fromUtf8(PQerrorMessage(conn));
+    return ret.trimmed();
+}
+
+QString toPQConnectionSub::convertBinds(QString const& sql, int &params)
+{
+    params = 0;
+    QString retval;
+    // The MySQL lexer knows the :name bind syntax, PostgreSQL has no lexer of its own
+    std::unique_ptr <SQLLexer::Lexer> lexer = LexerFactTwoParmSing::Instance().create("MySQLGuiLexer", "", "toCustomLexer");
+    lexer->setStatement(sql);
+
+    SQLLexer::Lexer::token_const_iterator start = lexer->begin();
+    while (start->getTokenType() != SQLLexer::Token::X_EOF)
+    {
+        switch (start->getTokenType())
+        {
+            case SQLLexer::Token::L_BIND_VAR:
+            case SQLLexer::Token::L_BIND_VAR_WITH_PARAMS:
+                retval += QString("$%1").arg(++params);
+                break;
+            default:
+                retval += start->getText();
+        }
+        start++;
+    }
+    return retval;
+}
+
+bool toPQConnectionSub::isPreparable(QString const& sql)
+{
+    static QRegExp preparable("^\\s*(SELECT|WITH|INSERT|UPDATE|DELETE|VALUES|TABLE|MERGE)\\b", Qt::CaseInsensitive);
+    return preparable.indexIn(sql) == 0;
+}
+
+toPQConnectionSub::Statement const& toPQConnectionSub::prepare(QString const& sql, int params)
+{
+    QHash<QString, Statement>::iterator i = Statements.find(sql);
+    if (i != Statements.end())
+    {
+        StatementOrder.removeOne(sql);
+        StatementOrder.append(sql);
+        return i.value();
+    }
+
+    if (StatementOrder.size() >= MaxStatements)
+    {
+        QString oldest = StatementOrder.takeFirst();
+        QString name = Statements.take(oldest).Name;
+        PQclear(PQexec(Connection, QString("DEALLOCATE %1").arg(name).toLatin1().constData()));
+    }
+
+    Statement st;
+    st.Name = QString("tora_%1").arg(++StatementCounter);
+    QByteArray name = st.Name.toLatin1();
+
+    PGresult *res = PQprepare(Connection, name.constData(), sql.toUtf8().constData(), params, NULL);
+    if (PQresultStatus(res) != PGRES_COMMAND_OK)
+    {
+        QString err = errorString(Connection, res);
+        PQclear(res);
+        throw toConnection::exception(err);
+    }
+    PQclear(res);
+
+    res = PQdescribePrepared(Connection, name.constData());
+    if (PQresultStatus(res) != PGRES_COMMAND_OK)
+    {
+        QString err = errorString(Connection, res);
+        PQclear(res);
+        throw toConnection::exception(err);
+    }
+    // Date/time values are only decoded as 64bit integers
+    const char *intdt = PQparameterStatus(Connection, "integer_datetimes");
+    bool integerDatetimes = intdt && qstrcmp(intdt, "on") == 0;
+    st.Format = 1;
+    for (int c = 0; c < PQnfields(res); c++)
+    {
+        unsigned oid = PQftype(res, c);
+        st.Types << oid;
+        if (!pqQuery::hasBinaryFormat(oid))
+            st.Format = 0;
+        if (!integerDatetimes && (oid == pqQuery::TIMEOID || oid == pqQuery::TIMESTAMPOID || oid == pqQuery::TIMESTAMPTZOID))
+            st.Format = 0;
+    }
+    PQclear(res);
+
+    StatementOrder.append(sql);
+    return Statements.insert(sql, st).value();
+}
+
+void toPQConnectionSub::forget(QString const& sql)
+{
+    if (!Statements.contains(sql))
+        return;
+    StatementOrder.removeOne(sql);
+    QString name = Statements.take(sql).Name;
+    PQclear(PQexec(Connection, QString("DEALLOCATE %1").arg(name).toLatin1().constData()));
+}
+
+void toPQConnectionSub::forgetAll(void)
+{
+    if (Statements.isEmpty())
+        return;
+    Statements.clear();
+    StatementOrder.clear();
+    PQclear(PQexec(Connection, "DEALLOCATE ALL"));
+}
+
+unsigned long toPQConnectionSub::pipeline(QList<QString> const& sql, QList<toQueryParams> const& params)
+{
+    QMutexLocker lock(&Lock);
+    unsigned long processed = 0;
+
+    // Bind values stay alive until all the statements are sent
+    QList<QList<QByteArray> > values;
+    QList<QByteArray> statements;
+    for (int i = 0; i < sql.size(); i++)
+    {
+        int count;
+        statements << convertBinds(sql.at(i), count).toUtf8();
+        QList<QByteArray> v;
+        toQueryParams p = i < params.size() ? params.at(i) : toQueryParams();
+        for (int j = 0; j < count && j < p.size(); j++)
+            v << (p.at(j).isNull() ? QByteArray() : p.at(j).displayData().toUtf8());
+        values << v;
+    }
+
+#ifdef LIBPQ_HAS_PIPELINING
+    if (!PQenterPipelineMode(Connection))
+        throw toConnection::exception(errorString(Connection));
+
+    QString error;
+    for (int i = 0; i < statements.size(); i++)
+    {
+        QVector<const char *> v;
+        Q_FOREACH(QByteArray const& b, values.at(i))
+            v << (b.isNull() ? NULL : b.constData());
+        if (!PQsendQueryParams(Connection, statements.at(i).constData(), v.size(), NULL, v.constData(), NULL, NULL, 0))
+        {
+            // Statements already queued still have results pending, the
+            // pipeline can only be left once they are read up to the sync
+            error = errorString(Connection);
+            break;
+        }
+    }
+    if (!PQpipelineSync(Connection))
+    {
+        // Nothing can be read up to a sync that was never sent, the connection is lost
+        QString err = errorString(Connection);
+        PQexitPipelineMode(Connection);
+        throw toConnection::exception(err);
+    }
+
+    // One result set per statement, each closed by NULL, then the sync
+    PGresult *res;
+    for (;;)
+    {
+        res = PQgetResult(Connection);
+        if (!res)
+        {
+            if (PQstatus(Connection) == CONNECTION_BAD)
+                break;
+            continue;
+        }
+        ExecStatusType status = PQresultStatus(res);
+        if (status == PGRES_PIPELINE_SYNC)
+        {
+            PQclear(res);
+            break;
+        }
+        if (status == PGRES_COMMAND_OK || status == PGRES_TUPLES_OK)
+            processed += QByteArray(PQcmdTuples(res)).toULong();
+        else if (error.isEmpty() && status != PGRES_PIPELINE_ABORTED)
+            error = errorString(Connection, res);
+        PQclear(res);
+    }
+    PQexitPipelineMode(Connection);
+    if (!error.isEmpty())
+        throw toConnection::exception(error);
+#else
+    for (int i = 0; i < statements.size(); i++)
+    {
+        QVector<const char *> v;
+        Q_FOREACH(QByteArray const& b, values.at(i))
+            v << (b.isNull() ? NULL : b.constData());
+        PGresult *res = PQexecParams(Connection, statements.at(i).constData(), v.size(), NULL, v.constData(), NULL, NULL, 0);
+        ExecStatusType status = PQresultStatus(res);
+        if (status != PGRES_COMMAND_OK && status != PGRES_TUPLES_OK)
+        {
+            QString err = errorString(Connection, res);
+            PQclear(res);
+            throw toConnection::exception(err);
+        }
+        processed += QByteArray(PQcmdTuples(res)).toULong();
+        PQclear(res);
+    }
+#endif
+    return processed;
+}
@@ -0,0 +1,145 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include "core/toconnection.h"
+#include "core/toconnectionsub.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+// Declared in libpq-fe.h, only pointers are used here
+typedef struct pg_conn PGconn;
+typedef struct pg_result PGresult;
+typedef struct pg_cancel PGcancel;
+
+/**
+ * PostgreSQL session talking to the server through libpq directly,
+ * used by the QPSQL provider when the "Native libpq" option is set.
+ *
+ * Statements that can be prepared are prepared once per session and
+ * reused, results are transferred in binary format whenever all the
+ * column types can be decoded by @ref pqQuery. Any other statement (DDL,
+ * SET, ...) may change what they return, so the prepared statements are
+ * dropped before it runs.
+ */
+class toPQConnectionSub : public toConnectionSub
+{
+    public:
+        /** Prepared statement of this session */
+        struct Statement
+        {
+            QString Name;
+            /** Type oids of the result columns */
+            QVector<unsigned> Types;
+            /** 1 for binary transfer, 0 for text */
+            int Format;
+        };
+
+        /** Prepared statements kept per session, least recently used are deallocated */
+        enum { MaxStatements = 100 };
+
+        toPQConnectionSub(toConnection const& parent, PGconn *conn);
+        ~toPQConnectionSub();
+
+        void cancel(void) override;
+        void close(void) override;
+        void commit(void) override;
+        void rollback(void) override;
+        bool hasTransaction(void) override;
+
+        QString version(void) override;
+        toQueryParams sessionId(void) override;
+
+        queryImpl* createQuery(toQueryAbstr *query) override;
+
+        toQAdditionalDescriptions* decribe(toCache::ObjectRef const&) override
+        {
+            throw QString("Not implemented yet: toPQConnectionSub::describe");
+        }
+
+        /** Get the prepared statement for sql, preparing it on first use.
+         * Must be called with @ref Lock held.
+         * @exception toConnection::exception if the server refuses the statement.
+         */
+        Statement const& prepare(QString const& sql, int params);
+
+        /** Deallocate the prepared statement for sql (if any), it is prepared
+         * again on next use. Must be called with @ref Lock held.
+         */
+        void forget(QString const& sql);
+
+        /** Deallocate all the prepared statements, called before statements
+         * which are not prepared. Must be called with @ref Lock held.
+         */
+        void forgetAll(void);
+
+        /** Run several statements in one round trip (pipeline mode of libpq 14+,
+         * one statement after another with older client libraries).
+         * @return Sum of the rows processed by all statements.
+         * @exception toConnection::exception on the first failing statement.
+         */
+        unsigned long pipeline(QList<QString> const& sql, QList<toQueryParams> const& params);
+
+        /** Replace TOra bind variables (:name<type>) by $1, $2, ... in order of appearance
+         * @param params Set to the number of bind variables found.
+         */
+        static QString convertBinds(QString const& sql, int &params);
+
+        /** True for statements the server can prepare (SELECT, DML, ...) */
+        static bool isPreparable(QString const& sql);
+
+        static QString errorString(PGconn *conn, PGresult *result = NULL);
+
+        QMutex Lock;
+        PGconn *Connection;
+
+    private:
+        void exec(QString const& sql);
+
+        /** Created once, @ref cancel must not touch the connection the query being cancelled uses */
+        PGcancel *Cancel;
+        /** Guards Cancel only, @ref Lock is held by the query being cancelled */
+        QMutex CancelLock;
+
+        QHash<QString, Statement> Statements;
+        QList<QString> StatementOrder;
+        int StatementCounter;
+        int ServerVersion;
+        int BackendPID;
+};
@@ -0,0 +1,588 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "connection/topqquery.h"
+#include "connection/topqconnection.h"
+#include "core/tologger.h"
+
+#include <libpq-fe.h>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QtEndian>
+
+#include <cstring>
+#include <limits>
+
+// Binary date/time values count from 2000-01-01
+static const QDate PostgresEpoch(2000, 1, 1);
+
+template <typename T> static inline T readBE(const char *data)
+{
+    return qFromBigEndian<T>(reinterpret_cast<const uchar *>(data));
+}
+
+static const qint64 UsecsPerDay = Q_INT64_C(86400000000);
+
+// Time of day from microseconds, as the server writes it in the text format:
+// fraction only when non zero, without trailing zeros. QTime only has milliseconds.
+static QString formatTime(qint64 usec)
+{
+    qint64 secs = usec / 1000000;
+    QString ret = QString::asprintf("%02d:%02d:%02d", int(secs / 3600), int(secs / 60 % 60), int(secs % 60));
+    int fraction = int(usec % 1000000);
+    if (fraction)
+    {
+        QString digits = QString::asprintf("%06d", fraction);
+        while (digits.endsWith('0'))
+            digits.chop(1);
+        ret += '.' + digits;
+    }
+    return ret;
+}
+
+// Binary timestamps are microseconds since the epoch, the int64 bounds stand for +-infinity
+static QString formatTimestamp(qint64 usec, bool withZone)
+{
+    if (usec == std::numeric_limits<qint64>::max())
+        return QString::fromLatin1("infinity");
+    if (usec == std::numeric_limits<qint64>::min())
+        return QString::fromLatin1("-infinity");
+
+    qint64 offset = 0;
+    if (withZone)
+    {
+        // Shown in the local time zone like the text format shows the session one
+        QDateTime utc(PostgresEpoch, QTime(0, 0), Qt::UTC);
+        utc = utc.addSecs(usec / 1000000);
+        offset = utc.toLocalTime().offsetFromUtc();
+        usec += offset * 1000000;
+    }
+
+    qint64 days = usec / UsecsPerDay;
+    qint64 time = usec % UsecsPerDay;
+    if (time < 0)
+    {
+        days--;
+        time += UsecsPerDay;
+    }
+    QString ret = PostgresEpoch.addDays(days).toString(QString::fromLatin1("yyyy-MM-dd")) + ' ' + formatTime(time);
+    if (withZone)
+    {
+        qint64 minutes = qAbs(offset) / 60;
+        ret += QString::asprintf("%c%02d", offset < 0 ? '-' : '+', int(minutes / 60));
+        if (minutes % 60)
+            ret += QString::asprintf(":%02d", int(minutes % 60));
+    }
+    return ret;
+}
+
+// Binary numeric: ndigits, weight, sign, dscale followed by base 10000 digits
+static QString decodeNumeric(const char *data, int len)
+{
+    if (len < 8)
+        return QString();
+    int ndigits = readBE<qint16>(data);
+    int weight = readBE<qint16>(data + 2);
+    quint16 sign = readBE<quint16>(data + 4);
+    int dscale = readBE<qint16>(data + 6);
+    switch (sign)
+    {
+        case 0xC000:
+            return QString::fromLatin1("NaN");
+        case 0xD000:
+            return QString::fromLatin1("Infinity");
+        case 0xF000:
+            return QString::fromLatin1("-Infinity");
+    }
+    if (len < 8 + ndigits * 2)
+        return QString();
+
+    QVector<int> digits(ndigits);
+    for (int i = 0; i < ndigits; i++)
+        digits[i] = readBE<qint16>(data + 8 + i * 2);
+
+    QString ret;
+    if (sign == 0x4000)
+        ret += QChar('-');
+    if (weight < 0)
+        ret += QChar('0');
+    for (int i = 0; i <= weight; i++)
+    {
+        int d = i < ndigits ? digits[i] : 0;
+        if (i == 0)
+            ret += QString::number(d);
+        else
+            ret += QString("%1").arg(d, 4, 10, QChar('0'));
+    }
+    if (dscale > 0)
+    {
+        QString frac;
+        for (int i = weight + 1; frac.length() < dscale; i++)
+        {
+            int d = (i >= 0 && i < ndigits) ? digits[i] : 0;
+            frac += QString("%1").arg(d, 4, 10, QChar('0'));
+        }
+        ret += QChar('.');
+        ret += frac.left(dscale);
+    }
+    return ret;
+}
+
+pqQuery::pqQuery(toQueryAbstr *query, toPQConnectionSub *conn)
+    : queryImpl(query)
+    , Connection(conn)
+    , Result(NULL)
+    , Format(0)
+    , Row(0)
+    , Rows(0)
+    , Column(0)
+    , Processed(0)
+    , Running(false)
+    , EOQ(true)
+{
+}
+
+pqQuery::~pqQuery()
+{
+    if (Running)
+    {
+        Connection->cancel();
+        QMutexLocker lock(&Connection->Lock);
+        drain();
+    }
+    if (Result)
+        PQclear(Result);
+}
+
+void pqQuery::execute(void)
+{
+    send(query()->sql());
+}
+
+void pqQuery::execute(QString const& sql)
+{
+    send(sql);
+}
+
+void pqQuery::send(QString const& sql)
+{
+    QMutexLocker lock(&Connection->Lock);
+    PGconn *conn = Connection->Connection;
+    if (!conn)
+        throw toConnection::exception(QString::fromLatin1("Connection closed"));
+
+    int count = 0;
+    QByteArray stmt;
+    QList<QByteArray> values;
+    if (!query()->params().empty())
+    {
+        stmt = toPQConnectionSub::convertBinds(sql, count).toUtf8();
+        toQueryParams const& params = query()->params();
+        for (int i = 0; i < count; i++)
+        {
+            if (i < params.size() && !params.at(i).isNull())
+                values << params.at(i).displayData().toUtf8();
+            else
+                values << QByteArray();
+        }
+    }
+    else
+    {
+        stmt = sql.toUtf8();
+    }
+    QVector<const char *> v;
+    Q_FOREACH(QByteArray const& b, values)
+        v << (b.isNull() ? NULL : b.constData());
+
+    if (toPQConnectionSub::isPreparable(sql))
+    {
+        QString prepared = QString::fromUtf8(stmt);
+        for (int attempt = 0; ; attempt++)
+        {
+            toPQConnectionSub::Statement const& st = Connection->prepare(prepared, count);
+            Format = st.Format;
+            Types = st.Types;
+            ErrorState.clear();
+            start(PQsendQueryPrepared(conn, st.Name.toLatin1().constData(), v.size(), v.constData(), NULL, NULL, Format));
+            try
+            {
+                nextResult();
+                return;
+            }
+            catch (toConnection::exception const&)
+            {
+                // "cached plan must not change result type": the table changed
+                // (e.g. in another session) since the statement was prepared
+                if (ErrorState != "0A000")
+                    throw;
+                Connection->forget(prepared);
+                // An aborted transaction refuses everything up to the rollback
+                if (attempt > 0 || PQtransactionStatus(conn) != PQTRANS_IDLE)
+                    throw;
+            }
+        }
+    }
+
+    // DDL and the like may change what the prepared statements return
+    Connection->forgetAll();
+    Format = 0;
+    if (count)
+        start(PQsendQueryParams(conn, stmt.constData(), v.size(), NULL, v.constData(), NULL, NULL, 0));
+    else
+        start(PQsendQuery(conn, stmt.constData()));
+    nextResult();
+}
+
+void pqQuery::start(int sent)
+{
+    PGconn *conn = Connection->Connection;
+    if (!sent)
+        throw toConnection::exception(toPQConnectionSub::errorString(conn));
+    Running = true;
+
+#ifdef LIBPQ_HAS_CHUNK_MODE
+    PQsetChunkedRowsMode(conn, 1000);
+#else
+    PQsetSingleRowMode(conn);
+#endif
+}
+
+void pqQuery::nextResult(void)
+{
+    PGconn *conn = Connection->Connection;
+    if (Result)
+        PQclear(Result);
+    Result = NULL;
+    Row = Rows = 0;
+
+    while (Running)
+    {
+        PGresult *res = PQgetResult(conn);
+        if (!res)
+        {
+            Running = false;
+            break;
+        }
+        switch (PQresultStatus(res))
+        {
+            case PGRES_SINGLE_TUPLE:
+#ifdef LIBPQ_HAS_CHUNK_MODE
+            case PGRES_TUPLES_CHUNK:
+#endif
+            case PGRES_TUPLES_OK:
+                if (ColumnDescriptions.empty())
+                {
+                    Types.resize(PQnfields(res));
+                    for (int c = 0; c < PQnfields(res); c++)
+                    {
+                        toCache::ColumnDescription desc;
+                        desc.Name = QString::fromUtf8(PQfname(res, c));
+                        desc.Datatype = typeName(PQftype(res, c));
+                        desc.AlignRight = false;
+                        desc.Null = true;
+                        ColumnDescriptions.append(desc);
+                        Types[c] = PQftype(res, c);
+                    }
+                }
+                if (PQntuples(res) > 0)
+                {
+                    Result = res;
+                    Rows = PQntuples(res);
+                    EOQ = false;
+                    return;
+                }
+                // End of single row/chunked result set, no rows
+                PQclear(res);
+                break;
+            case PGRES_COMMAND_OK:
+                Processed += QByteArray(PQcmdTuples(res)).toULong();
+                PQclear(res);
+                break;
+            case PGRES_EMPTY_QUERY:
+                PQclear(res);
+                break;
+            default:
+            {
+                QString err = toPQConnectionSub::errorString(conn, res);
+                ErrorState = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+                PQclear(res);
+                drain();
+                EOQ = true;
+                throw toConnection::exception(err);
+            }
+        }
+    }
+    EOQ = true;
+}
+
+void pqQuery::drain(void)
+{
+    PGresult *res;
+    while (Running && (res = PQgetResult(Connection->Connection)) != NULL)
+        PQclear(res);
+    Running = false;
+}
+
+void pqQuery::cancel(void)
+{
+    // Do not lock, the fetching thread holds the lock while waiting
+    if (Running)
+        Connection->cancel();
+}
+
+toQValue pqQuery::readValue(void)
+{
+    if (EOQ || !Result)
+        throw toConnection::exception(QString::fromLatin1("Tried to read past end of query"));
+
+    QMutexLocker lock(&Connection->Lock);
+    toQValue retval;
+    if (!PQgetisnull(Result, Row, Column))
+    {
+        const char *data = PQgetvalue(Result, Row, Column);
+        int len = PQgetlength(Result, Row, Column);
+        unsigned oid = Types.value(Column);
+        if (PQfformat(Result, Column) == 1)
+            retval = decodeBinary(oid, data, len);
+        else
+            retval = decodeText(oid, data, len);
+    }
+
+    if (++Column == (unsigned) Types.size())
+    {
+        Column = 0;
+        if (++Row == Rows)
+            nextResult();
+    }
+    return retval;
+}
+
+bool pqQuery::eof(void)
+{
+    return EOQ;
+}
+
+unsigned long pqQuery::rowsProcessed(void)
+{
+    return Processed;
+}
+
+unsigned pqQuery::columns(void)
+{
+    return Types.size();
+}
+
+toQColumnDescriptionList pqQuery::describe(void)
+{
+    return ColumnDescriptions;
+}
+
+bool pqQuery::hasBinaryFormat(unsigned oid)
+{
+    switch (oid)
+    {
+        case BOOLOID:
+        case BYTEAOID:
+        case CHAROID:
+        case NAMEOID:
+        case INT8OID:
+        case INT2OID:
+        case INT4OID:
+        case REGPROCOID:
+        case TEXTOID:
+        case OIDOID:
+        case XIDOID:
+        case CIDOID:
+        case JSONOID:
+        case FLOAT4OID:
+        case FLOAT8OID:
+        case UNKNOWNOID:
+        case BPCHAROID:
+        case VARCHAROID:
+        case DATEOID:
+        case TIMEOID:
+        case TIMESTAMPOID:
+        case TIMESTAMPTZOID:
+        case NUMERICOID:
+        case JSONBOID:
+            return true;
+        default:
+            return false;
+    }
+}
+
+QString pqQuery::typeName(unsigned oid)
+{
+    switch (oid)
+    {
+        case BOOLOID:
+            return QString::fromLatin1("BOOLEAN");
+        case BYTEAOID:
+            return QString::fromLatin1("BYTEA");
+        case CHAROID:
+            return QString::fromLatin1("CHAR");
+        case NAMEOID:
+            return QString::fromLatin1("NAME");
+        case INT8OID:
+            return QString::fromLatin1("BIGINT");
+        case INT2OID:
+            return QString::fromLatin1("SMALLINT");
+        case INT4OID:
+            return QString::fromLatin1("INTEGER");
+        case REGPROCOID:
+            return QString::fromLatin1("REGPROC");
+        case TEXTOID:
+            return QString::fromLatin1("TEXT");
+        case OIDOID:
+            return QString::fromLatin1("OID");
+        case XIDOID:
+            return QString::fromLatin1("XID");
+        case CIDOID:
+            return QString::fromLatin1("CID");
+        case JSONOID:
+            return QString::fromLatin1("JSON");
+        case FLOAT4OID:
+            return QString::fromLatin1("REAL");
+        case FLOAT8OID:
+            return QString::fromLatin1("DOUBLE PRECISION");
+        case UNKNOWNOID:
+            return QString::fromLatin1("UNKNOWN");
+        case BPCHAROID:
+            return QString::fromLatin1("CHARACTER");
+        case VARCHAROID:
+            return QString::fromLatin1("CHARACTER VARYING");
+        case DATEOID:
+            return QString::fromLatin1("DATE");
+        case TIMEOID:
+            return QString::fromLatin1("TIME");
+        case TIMESTAMPOID:
+            return QString::fromLatin1("TIMESTAMP");
+        case TIMESTAMPTZOID:
+            return QString::fromLatin1("TIMESTAMP WITH TIME ZONE");
+        case INTERVALOID:
+            return QString::fromLatin1("INTERVAL");
+        case NUMERICOID:
+            return QString::fromLatin1("NUMERIC");
+        case JSONBOID:
+            return QString::fromLatin1("JSONB");
+        default:
+            return QString::fromLatin1("UNKNOWN(%1)").arg(oid);
+    }
+}
+
+toQValue pqQuery::decodeBinary(unsigned oid, const char *data, int len) const
+{
+    switch (oid)
+    {
+        case BOOLOID:
+            return toQValue::fromVariant(QVariant(len > 0 && data[0] != 0));
+        case INT2OID:
+            return toQValue((int) readBE<qint16>(data));
+        case INT4OID:
+            return toQValue((int) readBE<qint32>(data));
+        case INT8OID:
+            return toQValue((qlonglong) readBE<qint64>(data));
+        case OIDOID:
+        case XIDOID:
+        case CIDOID:
+        case REGPROCOID:
+            return toQValue((unsigned) readBE<quint32>(data));
+        case FLOAT4OID:
+        {
+            quint32 bits = readBE<quint32>(data);
+            float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            return toQValue((double) f);
+        }
+        case FLOAT8OID:
+        {
+            quint64 bits = readBE<quint64>(data);
+            double d;
+            std::memcpy(&d, &bits, sizeof(d));
+            return toQValue(d);
+        }
+        case NUMERICOID:
+            return toQValue(decodeNumeric(data, len));
+        case BYTEAOID:
+            return toQValue::createBinary(QByteArray(data, len));
+        case JSONBOID:
+            // First byte is the jsonb format version
+            return toQValue(QString::fromUtf8(data + 1, len > 0 ? len - 1 : 0));
+        case DATEOID:
+        {
+            qint32 days = readBE<qint32>(data);
+            if (days == std::numeric_limits<qint32>::max())
+                return toQValue(QString::fromLatin1("infinity"));
+            if (days == std::numeric_limits<qint32>::min())
+                return toQValue(QString::fromLatin1("-infinity"));
+            return toQValue::fromVariant(PostgresEpoch.addDays(days));
+        }
+        case TIMEOID:
+            return toQValue(formatTime(readBE<qint64>(data)));
+        case TIMESTAMPOID:
+        case TIMESTAMPTZOID:
+            // Text, QDateTime would drop the microseconds
+            return toQValue(formatTimestamp(readBE<qint64>(data), oid == TIMESTAMPTZOID));
+        default:
+            // text, varchar, bpchar, name, char, json, unknown
+            return toQValue(QString::fromUtf8(data, len));
+    }
+}
+
+toQValue pqQuery::decodeText(unsigned oid, const char *data, int len) const
+{
+    switch (oid)
+    {
+        case BOOLOID:
+            return toQValue::fromVariant(QVariant(len > 0 && data[0] == 't'));
+        case INT2OID:
+        case INT4OID:
+            return toQValue(QByteArray(data, len).toInt());
+        case INT8OID:
+            return toQValue(QByteArray(data, len).toLongLong());
+        case OIDOID:
+        case XIDOID:
+        case CIDOID:
+            return toQValue(QByteArray(data, len).toUInt());
+        case FLOAT4OID:
+        case FLOAT8OID:
+            return toQValue(QByteArray(data, len).toDouble());
+        case BYTEAOID:
+            if (len >= 2 && data[0] == '\\' && data[1] == 'x')
+                return toQValue::createBinary(QByteArray::fromHex(QByteArray(data + 2, len - 2)));
+            return toQValue::createBinary(QByteArray(data, len));
+        default:
+            return toQValue(QString::fromUtf8(data, len));
+    }
+}
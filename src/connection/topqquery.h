@@ -0,0 +1,127 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include "core/toquery.h"
+#include "core/toqueryimpl.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVector>
+
+class toPQConnectionSub;
+typedef struct pg_result PGresult;
+
+/**
+ * Query running on a @ref toPQConnectionSub.
+ *
+ * Rows are streamed from the server in chunks (single rows with libpq
+ * older than 17) so the first rows are available before the whole result
+ * is transferred. Values come in binary format for prepared statements
+ * whose columns all have a known binary representation.
+ */
+class pqQuery : public queryImpl
+{
+    public:
+        // PostgreSQL datatypes (From pg_type.h)
+        enum DataTypeEnum
+        {
+            BOOLOID 	= 16,
+            BYTEAOID 	= 17,
+            CHAROID 	= 18,
+            NAMEOID 	= 19,
+            INT8OID 	= 20,
+            INT2OID 	= 21,
+            INT4OID 	= 23,
+            REGPROCOID 	= 24,
+            TEXTOID 	= 25,
+            OIDOID 	= 26,
+            XIDOID 	= 28,
+            CIDOID 	= 29,
+            JSONOID 	= 114,
+            FLOAT4OID 	= 700,
+            FLOAT8OID 	= 701,
+            UNKNOWNOID 	= 705,
+            BPCHAROID 	= 1042,
+            VARCHAROID 	= 1043,
+            DATEOID 	= 1082,
+            TIMEOID 	= 1083,
+            TIMESTAMPOID 	= 1114,
+            TIMESTAMPTZOID = 1184,
+            INTERVALOID 	= 1186,
+            NUMERICOID 	= 1700,
+            JSONBOID 	= 3802
+        };
+
+        pqQuery(toQueryAbstr *query, toPQConnectionSub *conn);
+        virtual ~pqQuery();
+        virtual void execute(void);
+        virtual void execute(QString const&);
+        virtual void cancel(void);
+        virtual toQValue readValue(void);
+        virtual bool eof(void);
+        virtual unsigned long rowsProcessed(void);
+        virtual unsigned columns(void);
+        virtual toQColumnDescriptionList describe(void);
+
+        /** True if values of type oid can be decoded from the binary transfer format */
+        static bool hasBinaryFormat(unsigned oid);
+
+        /** Name of the PostgreSQL datatype oid as shown in the column description */
+        static QString typeName(unsigned oid);
+    private:
+        void send(QString const& sql);
+        /** Check the statement was sent and switch to streaming rows, with the connection locked */
+        void start(int sent);
+        /** Fetch the next chunk of rows, must be called with the connection locked */
+        void nextResult(void);
+        /** Throw away the results still pending on the connection */
+        void drain(void);
+        toQValue decodeBinary(unsigned oid, const char *data, int len) const;
+        toQValue decodeText(unsigned oid, const char *data, int len) const;
+
+        toPQConnectionSub *Connection;
+        PGresult *Result;
+        QVector<unsigned> Types;
+        toQColumnDescriptionList ColumnDescriptions;
+        /** SQLSTATE of the last error */
+        QByteArray ErrorState;
+        int Format;
+        int Row;
+        int Rows;
+        unsigned Column;
+        unsigned long Processed;
+        bool Running;
+        bool EOQ;
+};
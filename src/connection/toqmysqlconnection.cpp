@@ -35,6 +35,9 @@
 #include "connection/toqmysqlconnection.h"
 #include "connection/toqsqlconnection.h"
 #include "connection/toqmysqlquery.h"
+#ifdef HAVE_MYSQL_H
+#include "connection/toqmysqlstream.h"
+#endif
 #include "core/tosql.h"
 
 #include <QtSql/QSqlError>
@@ -130,3 +133,55 @@ queryImpl* toQMySqlConnectionSub::createQuery(toQueryAbstr *query)
 {
     return new mysqlQuery(query, this);
 }
+
+void toQMySqlConnectionSub::commit()
+{
+    {
+        LockingPtr<QSqlDatabase> ptr(Connection, Lock);
+        releaseStream();
+    }
+    toQSqlConnectionSub::commit();
+}
+
+void toQMySqlConnectionSub::rollback()
+{
+    {
+        LockingPtr<QSqlDatabase> ptr(Connection, Lock);
+        releaseStream();
+    }
+    toQSqlConnectionSub::rollback();
+}
+
+QString toQMySqlConnectionSub::version()
+{
+    {
+        LockingPtr<QSqlDatabase> ptr(Connection, Lock);
+        releaseStream();
+    }
+    return toQSqlConnectionSub::version();
+}
+
+toQueryParams toQMySqlConnectionSub::sessionId()
+{
+    {
+        LockingPtr<QSqlDatabase> ptr(Connection, Lock);
+        releaseStream();
+    }
+    return toQSqlConnectionSub::sessionId();
+}
+
+void toQMySqlConnectionSub::releaseStream(void)
+{
+#ifdef HAVE_MYSQL_H
+    if (!Stream)
+        return;
+    toQMySqlStream *stream = Stream;
+    bool abandoned = StreamAbandoned;
+    Stream = NULL;
+    StreamAbandoned = false;
+    if (abandoned)
+        delete stream; // Discards the rest of the rows
+    else
+        stream->store();
+#endif
+}
@@ -41,6 +41,8 @@
 #include <QtCore/QString>
 #include <QtSql/QSqlDatabase>
 
+class toQMySqlStream;
+
 // MySQL datatypes (From mysql_com.h)
 enum enum_field_types { FIELD_TYPE_DECIMAL, FIELD_TYPE_TINY,
                         FIELD_TYPE_SHORT, FIELD_TYPE_LONG,
@@ -80,28 +82,34 @@ class toQMySqlConnectionSub : public toQSqlConnectionSub
     public:
         toQMySqlConnectionSub(toConnection const& parent, QSqlDatabase const& db, QString const& dbname)
             : toQSqlConnectionSub(parent, db, dbname)
+            , Stream(NULL)
+            , StreamAbandoned(false)
         {
+            // Needed by KILL QUERY in mysqlQuery::cancel
+            ConnectionID = sessionId().first();
         }
 
         virtual ~toQMySqlConnectionSub()
         {
             LockingPtr<QSqlDatabase> ptr(Connection, Lock);
+            releaseStream();
             ptr->close();
         }
 
         /** Implemented abstract method inherited from toConnectionSub */
 
-        void cancel(void) override
-        {
-            throw QString("Not implemented yet: toQMySqlConnectionSub::close");
-        };
-
         /** Close connection. */
         void close(void) override
         {
             throw QString("Not implemented yet: toQMySqlConnectionSub::close");
         }
 
+        /** Any result still open is read before these are run on the handle */
+        void commit() override;
+        void rollback() override;
+        QString version() override;
+        toQueryParams sessionId() override;
+
         queryImpl* createQuery(toQueryAbstr *query) override;
 
         toQAdditionalDescriptions* decribe(toCache::ObjectRef const&) override
@@ -109,5 +117,16 @@ class toQMySqlConnectionSub : public toQSqlConnectionSub
             throw QString("Not implemented yet: toQMySqlConnectionSub::describe");
         }
 
+        /** Read the rest of the unbuffered result open on this connection
+         *  (if any) into memory so that the handle accepts the next
+         *  statement. A result left by a deleted query is thrown away.
+         *  Must be called with Lock held.
+         */
+        void releaseStream(void);
+
+        /** Unbuffered result currently open on this connection (if any) */
+        toQMySqlStream *Stream;
+        /** Stream was handed over by a deleted query and is owned by the connection */
+        bool StreamAbandoned;
     private:
 };
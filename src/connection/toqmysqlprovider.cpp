@@ -72,6 +72,10 @@ QList<QString> toQMySqlProvider::options() const
                          << "-"
                          << "Ignore Space"
                          << "No Schema";
+#ifdef HAVE_MYSQL_H
+    // Fetch rows unbuffered, see toQMySqlStream
+    ret << "*Stream results";
+#endif
 
     return ret;
 }
@@ -36,6 +36,10 @@
 #include "connection/toqmysqlprovider.h"
 #include "connection/toqmysqltraits.h"
 #include "connection/toqmysqlsetting.h"
+#include "connection/toqmysqlconnection.h"
+#ifdef HAVE_MYSQL_H
+#include "connection/toqmysqlstream.h"
+#endif
 #include "core/toconfiguration.h"
 #include "core/tosql.h"
 #include "core/tocache.h"
@@ -47,13 +51,13 @@
 #include <QtSql/QSqlError>
 
 static toSQL SQLCancel("toQSqlConnection:Cancel",
-                       "KILL :f1",
+                       "KILL :f1<noquote>",
                        "Cancel a connection given it's connection ID",
                        "0323",
                        "QMYSQL");
 
 static toSQL SQLCancelM5("toQSqlConnection:Cancel",
-                         "KILL QUERY :f1",
+                         "KILL QUERY :f1<noquote>",
                          "",
                          "0500",
                          "QMYSQL");
@@ -82,6 +86,7 @@ QSqlQuery* mysqlQuery::createQuery(const QString &sql)
 mysqlQuery::mysqlQuery(toQueryAbstr *query, toQMySqlConnectionSub *conn)
     : qsqlQuery(query, conn)
     , Query(NULL)
+    , Stream(NULL)
     , Connection(conn)
     , CurrentColumn(0)
     , EOQ(true)
@@ -92,6 +97,43 @@ mysqlQuery::~mysqlQuery()
 {
     LockingPtr<QSqlDatabase> ptr(Connection->Connection, Connection->Lock);
     delete Query;
+#ifdef HAVE_MYSQL_H
+    // Do not wait here for the rest of an abandoned result to be transferred,
+    // the connection throws it away before it runs the next statement
+    if (Stream && Connection->Stream == Stream && !Stream->finished())
+        Connection->StreamAbandoned = true;
+    else
+    {
+        if (Connection->Stream == Stream)
+            Connection->Stream = NULL;
+        delete Stream;
+    }
+#endif
+}
+
+bool mysqlQuery::startStream(const QString &sql)
+{
+#ifdef HAVE_MYSQL_H
+    // The connection can not run anything while a previous result is not read completely
+    if (Connection->Stream != Stream)
+        Connection->releaseStream();
+
+    if (!query()->params().empty() || !query()->connection().options().contains("Stream results"))
+        return false;
+    if (!Stream)
+    {
+        MYSQL *handle = toQMySqlStream::handle(Connection->Connection);
+        if (!handle)
+            return false;
+        Stream = new toQMySqlStream(handle, toConfigurationNewSingle::Instance().option(Database::InitialFetchInt).toInt());
+    }
+    Connection->Stream = Stream;
+    Stream->execute(sql);
+    EOQ = Stream->eof();
+    return true;
+#else
+    return false;
+#endif
 }
 
 void mysqlQuery::execute(void)
@@ -99,6 +141,8 @@ void mysqlQuery::execute(void)
 	LockingPtr<QSqlDatabase> ptr(Connection->Connection, Connection->Lock);
 	ExtraQuery = queryParam(query()->sql(), query()->params());
 	QString sql = ExtraQuery.takeFirst();
+	if (startStream(sql))
+	    return;
 	Query = createQuery(sql);
     checkQuery();
 }
@@ -106,12 +150,14 @@ void mysqlQuery::execute(void)
 void mysqlQuery::execute(QString const& sql)
 {
     LockingPtr<QSqlDatabase> ptr(Connection->Connection, Connection->Lock);
+    if (startStream(sql))
+        return;
     Query = createQuery(sql);
     checkQuery();
 }
 void mysqlQuery::cancel(void)
 {
-    LockingPtr<QSqlDatabase> ptr(Connection->Connection, Connection->Lock);
+    // don't lock here, a streamed fetch holds the lock while waiting for the server
     if (!Connection->ConnectionID.isEmpty())
     {
         try
@@ -142,6 +188,20 @@ toQValue mysqlQuery::readValue(void)
 {
     LockingPtr<QSqlDatabase> ptr(Connection->Connection, Connection->Lock);
 
+#ifdef HAVE_MYSQL_H
+    if (Stream)
+    {
+        toQValue retval = Stream->readValue();
+        EOQ = Stream->eof();
+        if (EOQ && !ExtraQuery.isEmpty())
+        {
+            Stream->execute(ExtraQuery.takeFirst());
+            EOQ = Stream->eof();
+        }
+        return retval;
+    }
+#endif
+
     if (!Query)
         throw toConnection::exception(QString::fromLatin1("Fetching from not executed query"));
     if (EOQ)
@@ -187,6 +247,10 @@ unsigned long mysqlQuery::rowsProcessed(void)
     {
         LockingPtr<QSqlDatabase> ptr(Connection->Connection, Connection->Lock, true);
 
+#ifdef HAVE_MYSQL_H
+        if (Stream)
+            return Stream->rowsProcessed();
+#endif
         if (!Query)
             return 0L;
         return Query->numRowsAffected();
@@ -200,6 +264,10 @@ unsigned long mysqlQuery::rowsProcessed(void)
 unsigned mysqlQuery::columns(void)
 {
     LockingPtr<QSqlDatabase> ptr(Connection->Connection, Connection->Lock);
+#ifdef HAVE_MYSQL_H
+    if (Stream)
+        return Stream->columns();
+#endif
     return Record.count();
 }
 
@@ -207,6 +275,10 @@ toQColumnDescriptionList mysqlQuery::describe(void)
 {
     LockingPtr<QSqlDatabase> ptr(Connection->Connection, Connection->Lock);
     toQColumnDescriptionList ret;
+#ifdef HAVE_MYSQL_H
+    if (Stream)
+        return Stream->describe();
+#endif
     if (Query && Query->isSelect())
     {
         ret = describe(Query->record());
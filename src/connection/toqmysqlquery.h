@@ -43,6 +43,7 @@
 
 class QSqlQuery;
 class toQMySqlConnectionSub;
+class toQMySqlStream;
 
 class mysqlQuery : public qsqlQuery
 {
@@ -71,8 +72,11 @@ class mysqlQuery : public qsqlQuery
         QString stripBinds(const QString &in);
         void bindParam(QSqlQuery *q, toQueryParams const &params);
         QStringList queryParam(const QString &in, toQueryParams &params);
+        /** Run sql unbuffered if possible, see @ref toQMySqlStream */
+        bool startStream(const QString &sql);
 
         QSqlQuery *Query;
+        toQMySqlStream *Stream;
         QSqlRecord Record;
         QStringList BindParams;
         QStringList ExtraQuery;                            // see toAnalyze
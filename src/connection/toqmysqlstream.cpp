@@ -0,0 +1,294 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "connection/toqmysqlstream.h"
+#include "core/tologger.h"
+
+#include <mysql.h>
+
+#include <QtCore/QDateTime>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlDriver>
+
+// charsetnr of binary strings and blobs
+#define BINARY_CHARSET 63
+
+static QString typeName(MYSQL_FIELD const& field)
+{
+    switch (field.type)
+    {
+        case MYSQL_TYPE_DECIMAL:
+        case MYSQL_TYPE_NEWDECIMAL:
+            return QString::fromLatin1("DECIMAL(%1,%2)").arg(field.length).arg(field.decimals);
+        case MYSQL_TYPE_TINY:
+            return QString::fromLatin1("TINYINT");
+        case MYSQL_TYPE_SHORT:
+            return QString::fromLatin1("SMALLINT");
+        case MYSQL_TYPE_INT24:
+            return QString::fromLatin1("MEDIUMINT");
+        case MYSQL_TYPE_LONG:
+            return QString::fromLatin1("INT");
+        case MYSQL_TYPE_LONGLONG:
+            return QString::fromLatin1("BIGINT");
+        case MYSQL_TYPE_FLOAT:
+            return QString::fromLatin1("FLOAT");
+        case MYSQL_TYPE_DOUBLE:
+            return QString::fromLatin1("DOUBLE");
+        case MYSQL_TYPE_NULL:
+            return QString::fromLatin1("NULL");
+        case MYSQL_TYPE_TIMESTAMP:
+            return QString::fromLatin1("TIMESTAMP");
+        case MYSQL_TYPE_DATE:
+        case MYSQL_TYPE_NEWDATE:
+            return QString::fromLatin1("DATE");
+        case MYSQL_TYPE_TIME:
+            return QString::fromLatin1("TIME");
+        case MYSQL_TYPE_DATETIME:
+            return QString::fromLatin1("DATETIME");
+        case MYSQL_TYPE_YEAR:
+            return QString::fromLatin1("YEAR");
+        case MYSQL_TYPE_BIT:
+            return QString::fromLatin1("BIT(%1)").arg(field.length);
+        case MYSQL_TYPE_ENUM:
+            return QString::fromLatin1("ENUM");
+        case MYSQL_TYPE_SET:
+            return QString::fromLatin1("SET");
+        case MYSQL_TYPE_TINY_BLOB:
+        case MYSQL_TYPE_MEDIUM_BLOB:
+        case MYSQL_TYPE_LONG_BLOB:
+        case MYSQL_TYPE_BLOB:
+            return QString::fromLatin1(field.charsetnr == BINARY_CHARSET ? "BLOB" : "TEXT");
+        case MYSQL_TYPE_VARCHAR:
+        case MYSQL_TYPE_VAR_STRING:
+            return QString::fromLatin1(field.charsetnr == BINARY_CHARSET ? "VARBINARY(%1)" : "VARCHAR(%1)").arg(field.length);
+        case MYSQL_TYPE_STRING:
+            return QString::fromLatin1(field.charsetnr == BINARY_CHARSET ? "BINARY(%1)" : "CHAR(%1)").arg(field.length);
+        case MYSQL_TYPE_GEOMETRY:
+            return QString::fromLatin1("GEOMETRY");
+        default:
+            return QString::fromLatin1("UNKNOWN(%1)").arg(field.type);
+    }
+}
+
+toQMySqlStream::toQMySqlStream(MYSQL *conn, int batch)
+    : Connection(conn)
+    , Result(NULL)
+    , Batch(batch > 0 ? batch : 100)
+    , Processed(0)
+{
+}
+
+toQMySqlStream::~toQMySqlStream()
+{
+    // Reads (and throws away) the rest of the rows
+    if (Result)
+        mysql_free_result(Result);
+    try
+    {
+        skipResults();
+    }
+    catch (...)
+    {
+        TLOG(1, toDecorator, __HERE__) << "	Ignored exception." << std::endl;
+    }
+}
+
+MYSQL* toQMySqlStream::handle(QSqlDatabase const& db)
+{
+    QVariant v = db.driver()->handle();
+    if (v.isValid() && qstrcmp(v.typeName(), "MYSQL*") == 0)
+        return *static_cast<MYSQL **>(v.data());
+    return NULL;
+}
+
+void toQMySqlStream::execute(QString const& sql)
+{
+    if (Result)
+    {
+        mysql_free_result(Result);
+        Result = NULL;
+        skipResults();
+    }
+    Buffer.clear();
+    Types.clear();
+    Unsigned.clear();
+    Binary.clear();
+    ColumnDescriptions.clear();
+    Processed = 0;
+
+    QByteArray stmt = sql.toUtf8();
+    if (mysql_real_query(Connection, stmt.constData(), stmt.length()))
+        throw toConnection::exception(QString::fromUtf8(mysql_error(Connection)));
+
+    Result = mysql_use_result(Connection);
+    if (!Result)
+    {
+        if (mysql_field_count(Connection) != 0)
+            throw toConnection::exception(QString::fromUtf8(mysql_error(Connection)));
+        // INSERT, UPDATE, ...
+        Processed = mysql_affected_rows(Connection);
+        skipResults();
+        return;
+    }
+
+    unsigned count = mysql_num_fields(Result);
+    MYSQL_FIELD *fields = mysql_fetch_fields(Result);
+    for (unsigned i = 0; i < count; i++)
+    {
+        Types << fields[i].type;
+        Unsigned << ((fields[i].flags & UNSIGNED_FLAG) != 0);
+        Binary << (fields[i].charsetnr == BINARY_CHARSET);
+
+        toCache::ColumnDescription desc;
+        desc.Name = QString::fromUtf8(fields[i].name);
+        desc.Datatype = typeName(fields[i]);
+        desc.Null = (fields[i].flags & NOT_NULL_FLAG) == 0;
+        desc.AlignRight = IS_NUM(fields[i].type);
+        ColumnDescriptions << desc;
+    }
+    fetch(Batch);
+}
+
+void toQMySqlStream::fetch(int rows)
+{
+    if (!Result)
+        return;
+    unsigned count = Types.size();
+    for (int r = 0; rows == 0 || r < rows; r++)
+    {
+        MYSQL_ROW row = mysql_fetch_row(Result);
+        if (!row)
+        {
+            unsigned err = mysql_errno(Connection);
+            QString msg = QString::fromUtf8(mysql_error(Connection));
+            mysql_free_result(Result);
+            Result = NULL;
+            // Interrupted by KILL QUERY or lost connection
+            if (err)
+                throw toConnection::exception(msg);
+            skipResults();
+            return;
+        }
+        unsigned long *lengths = mysql_fetch_lengths(Result);
+        for (unsigned c = 0; c < count; c++)
+            Buffer << (row[c] ? convert(c, row[c], lengths[c]) : toQValue());
+        Processed++;
+    }
+}
+
+void toQMySqlStream::skipResults(void)
+{
+    // 0 - next result available, -1 - no more results, > 0 - error
+    for (;;)
+    {
+        int status = mysql_next_result(Connection);
+        if (status < 0)
+            return;
+        if (status > 0)
+            throw toConnection::exception(QString::fromUtf8(mysql_error(Connection)));
+        MYSQL_RES *res = mysql_use_result(Connection);
+        if (res)
+        {
+            TLOG(6, toDecorator, __HERE__) << "Skipping additional result set" << std::endl;
+            mysql_free_result(res);
+        }
+    }
+}
+
+void toQMySqlStream::store(void)
+{
+    if (Result)
+    {
+        TLOG(6, toDecorator, __HERE__) << "Storing unbuffered result before next statement" << std::endl;
+        fetch(0);
+    }
+}
+
+toQValue toQMySqlStream::readValue(void)
+{
+    if (Buffer.isEmpty())
+        throw toConnection::exception(QString::fromLatin1("Tried to read past end of query"));
+    toQValue ret = Buffer.takeFirst();
+    if (Buffer.isEmpty())
+        fetch(Batch);
+    return ret;
+}
+
+toQValue toQMySqlStream::convert(int column, const char *data, unsigned long length) const
+{
+    switch (Types.at(column))
+    {
+        case MYSQL_TYPE_TINY:
+        case MYSQL_TYPE_SHORT:
+        case MYSQL_TYPE_INT24:
+        case MYSQL_TYPE_LONG:
+        case MYSQL_TYPE_LONGLONG:
+        case MYSQL_TYPE_YEAR:
+            if (Unsigned.at(column))
+                return toQValue(QByteArray(data, length).toULongLong());
+            return toQValue(QByteArray(data, length).toLongLong());
+        case MYSQL_TYPE_FLOAT:
+        case MYSQL_TYPE_DOUBLE:
+            return toQValue(QByteArray(data, length).toDouble());
+        case MYSQL_TYPE_DATE:
+        case MYSQL_TYPE_NEWDATE:
+        {
+            QDate d = QDate::fromString(QString::fromLatin1(data, length), Qt::ISODate);
+            // Zero dates (0000-00-00) are shown as returned
+            return d.isValid() ? toQValue::fromVariant(d) : toQValue(QString::fromLatin1(data, length));
+        }
+        case MYSQL_TYPE_DATETIME:
+        case MYSQL_TYPE_TIMESTAMP:
+        {
+            QDateTime d = QDateTime::fromString(QString::fromLatin1(data, length), Qt::ISODate);
+            return d.isValid() ? toQValue::fromVariant(d) : toQValue(QString::fromLatin1(data, length));
+        }
+        case MYSQL_TYPE_BIT:
+        case MYSQL_TYPE_GEOMETRY:
+            return toQValue::createBinary(QByteArray(data, length));
+        case MYSQL_TYPE_TINY_BLOB:
+        case MYSQL_TYPE_MEDIUM_BLOB:
+        case MYSQL_TYPE_LONG_BLOB:
+        case MYSQL_TYPE_BLOB:
+        case MYSQL_TYPE_VARCHAR:
+        case MYSQL_TYPE_VAR_STRING:
+        case MYSQL_TYPE_STRING:
+            if (Binary.at(column))
+                return toQValue::createBinary(QByteArray(data, length));
+            return toQValue(QString::fromUtf8(data, length));
+        default:
+            // DECIMAL is kept as text to preserve precision
+            return toQValue(QString::fromUtf8(data, length));
+    }
+}
@@ -0,0 +1,128 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include "core/toquery.h"
+#include "core/toqueryimpl.h"
+
+#include <QtCore/QList>
+#include <QtCore/QVector>
+
+class QSqlDatabase;
+
+// Declared in mysql.h, which can not be included together with toqmysqlconnection.h
+typedef struct st_mysql MYSQL;
+typedef struct st_mysql_res MYSQL_RES;
+
+/**
+ * Unbuffered result of a MySQL statement.
+ *
+ * QMYSQL always reads the whole result set into client memory
+ * (mysql_store_result) before the first row is returned. This class runs
+ * the statement on the driver's MYSQL handle with mysql_use_result and
+ * converts the rows in batches, so memory use is bound by the batch size
+ * and the first rows are shown as soon as the server sends them.
+ *
+ * While the result is open no other statement can be run on the same
+ * handle, call @ref store before doing so.
+ *
+ * Only the first result set is shown. The ones following it (CALL of a
+ * procedure, several statements separated by ;) are read and thrown
+ * away, the server does not accept the next statement before that.
+ */
+class toQMySqlStream
+{
+    public:
+        /**
+         * @param conn Handle of an open connection
+         * @param batch Number of rows converted at once
+         */
+        toQMySqlStream(MYSQL *conn, int batch);
+        ~toQMySqlStream();
+
+        /** Native handle of an open QMYSQL connection, NULL if not available */
+        static MYSQL* handle(QSqlDatabase const& db);
+
+        /** Run the statement
+         * @exception toConnection::exception on error
+         */
+        void execute(QString const& sql);
+
+        toQValue readValue(void);
+
+        bool eof(void) const
+        {
+            return Buffer.isEmpty();
+        }
+
+        /** True once the last row has been received from the server */
+        bool finished(void) const
+        {
+            return Result == NULL;
+        }
+
+        unsigned columns(void) const
+        {
+            return Types.size();
+        }
+
+        toQColumnDescriptionList describe(void) const
+        {
+            return ColumnDescriptions;
+        }
+
+        unsigned long rowsProcessed(void) const
+        {
+            return Processed;
+        }
+
+        /** Read the remaining rows into memory and release the connection */
+        void store(void);
+    private:
+        /** Convert up to rows rows, 0 for all of them */
+        void fetch(int rows);
+        /** Discard the results following the current one */
+        void skipResults(void);
+        toQValue convert(int column, const char *data, unsigned long length) const;
+
+        MYSQL *Connection;
+        MYSQL_RES *Result;
+        int Batch;
+        QList<toQValue> Buffer;
+        QVector<int> Types;
+        QVector<bool> Unsigned, Binary;
+        toQColumnDescriptionList ColumnDescriptions;
+        unsigned long Processed;
+};
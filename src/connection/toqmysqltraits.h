@@ -67,9 +67,10 @@ class toQMySqlTraits: public toConnectionTraits
             return false;
         }
 
+        /** KILL QUERY from a second session, see toQSqlConnectionSub::cancel */
         bool hasAsyncBreak() const override
         {
-            return false;
+            return true;
         }
 
         QString quoteVarchar(const QString &name) const override
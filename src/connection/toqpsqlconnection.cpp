@@ -34,6 +34,7 @@
 
 #include "connection/toqpsqlconnection.h"
 #include "connection/toqpsqlquery.h"
+#include "connection/topqconnection.h"
 #include "core/tosql.h"
 
 #include <QtSql/QSqlError>
@@ -115,6 +116,11 @@ toQPSqlConnectionImpl::toQPSqlConnectionImpl(toConnection &conn)
 
 toConnectionSub *toQPSqlConnectionImpl::createConnection(void)
 {
+#ifdef HAVE_POSTGRESQL_LIBPQ_FE_H
+    if (parentConnection().options().contains("Native libpq"))
+        return createNativeConnection();
+#endif
+
     // TODO shouldn't be this method reenteant?
     static QAtomicInt ID_COUNTER(0);
     int ID = ID_COUNTER.fetchAndAddAcquire(1);
@@ -159,11 +165,69 @@ toConnectionSub *toQPSqlConnectionImpl::createConnection(void)
     return ret;
 }
 
+#ifdef HAVE_POSTGRESQL_LIBPQ_FE_H
+toConnectionSub *toQPSqlConnectionImpl::createNativeConnection(void)
+{
+    QString host = parentConnection().host();
+    QString port;
+    int pos = host.indexOf(QString(":"));
+    if (pos >= 0)
+    {
+        port = host.mid(pos + 1);
+        host = host.mid(0, pos);
+    }
+
+    QList<QByteArray> keys, values;
+    keys << "host" << "port" << "dbname" << "user" << "password" << "application_name";
+    values << host.toUtf8()
+           << port.toUtf8()
+           << parentConnection().database().toUtf8()
+           << parentConnection().user().toUtf8()
+           << parentConnection().password().toUtf8()
+           << "TOra";
+    if (parentConnection().options().contains("SSL"))
+    {
+        keys << "sslmode";
+        values << "require";
+    }
+
+    QVector<const char *> k, v;
+    for (int i = 0; i < keys.size(); i++)
+    {
+        if (values.at(i).isEmpty())
+            continue;
+        k << keys.at(i).constData();
+        v << values.at(i).constData();
+    }
+    k << (const char *) NULL;
+    v << (const char *) NULL;
+
+    PGconn *conn = PQconnectdbParams(k.constData(), v.constData(), 0);
+    if (PQstatus(conn) != CONNECTION_OK)
+    {
+        QString t = toPQConnectionSub::errorString(conn);
+        PQfinish(conn);
+        throw t;
+    }
+    return new toPQConnectionSub(parentConnection(), conn);
+}
+#endif
+
 void toQPSqlConnectionImpl::closeConnection(toConnectionSub *)
 {
 
 }
 
+void toQPSqlConnectionSub::cancel()
+{
+#ifdef LIBPQ_DECL_CANCEL
+    // don't lock, the running query holds the lock
+    nativeCancel();
+#else
+    super::cancel();
+#endif
+}
+
 QString toQPSqlConnectionSub::version()
 {
     int ver = nativeVersion();
@@ -54,6 +54,10 @@ class toQPSqlConnectionImpl: public toQSqlConnectionImpl
         /** Close a connection to the database. */
         virtual void closeConnection(toConnectionSub *);
     private:
+#ifdef HAVE_POSTGRESQL_LIBPQ_FE_H
+        /** Connect through libpq directly, see @ref toPQConnectionSub */
+        toConnectionSub *createNativeConnection(void);
+#endif
 };
 
 class toQPSqlConnectionSub : public toQSqlConnectionSub
@@ -75,10 +79,7 @@ class toQPSqlConnectionSub : public toQSqlConnectionSub
 
         /** Implemented abstract method inherited from toConnectionSub */
 
-        void cancel(void) override
-        {
-            // NOT SUPPORTED YET
-        };
+        void cancel(void) override;
 
         /** Close connection. */
         void close(void) override
@@ -57,6 +57,18 @@ QMap<QString,QString> toQPSqlProvider::defaultConnection() const
 	//return QMap<QString,QString>{{"HOST", "localhost"}, {"PORT", "5432"}, {"DB", "postgres"}, {"USER", "postgres"}}; Qt >= 5.2 only
 }
 
+QList<QString> toQPSqlProvider::options() const
+{
+    QList<QString> ret = QList<QString>()
+                         << "SSL";
+#ifdef HAVE_POSTGRESQL_LIBPQ_FE_H
+    // Bypass QSqlDriver, see toPQConnectionSub
+    ret << "-"
+        << "Native libpq";
+#endif
+    return ret;
+}
+
 QWidget* toQPSqlProvider::configurationTab(QWidget *parent)
 {
 #ifdef Q_OS_WIN
@@ -61,13 +61,13 @@ class toQPSqlProvider : public toQSqlProvider
         /** see: @ref toConnectionProvider::defaultConnection() */
         QMap<QString,QString> defaultConnection() const override;
 
+        /** see: @ref toConnectionProvider::options() */
+        QList<QString> options() const override;
+
 // TODO DEFINE THESE
         #if 0
         /** see: @ref toConnectionProvider::databases() */
         virtual QList<QString> databases(const QString &host, const QString &user, const QString &pwd);
-
-        /** see: @ref toConnectionProvider::options() */
-        virtual QList<QString> options();
 #endif
         /** see: @ref toConnectionProvider::configurationTab() */
         QWidget *configurationTab(QWidget *parent) override;
@@ -45,6 +45,12 @@ class toQPSqlTraits: public toQSqlTraits
          * @return SQL statement
          */
         virtual QString schemaSwitchSQL(QString const&) const;
+
+        /** Running statements are cancelled by toQPSqlConnectionSub::cancel */
+        virtual bool hasAsyncBreak() const
+        {
+            return true;
+        }
 };
 
 #endif
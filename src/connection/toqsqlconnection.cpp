@@ -41,6 +41,7 @@
 #include <QtSql/QSqlField>
 #include <QtSql/QSqlQuery>
 #include "core/tosql.h"
+#include "core/toconnectionsubloan.h"
 
 toQSqlConnectionSub::toQSqlConnectionSub(toConnection const& parent, QSqlDatabase const& db, QString const& dbname)
     : Connection(db)
@@ -57,7 +58,23 @@ toQSqlConnectionSub::~toQSqlConnectionSub()
 
 void toQSqlConnectionSub::cancel()
 {
-
+    // Can not use this connection, it is busy running the statement to be cancelled.
+    // Ask the server to cancel it from a second session (KILL QUERY, pg_cancel_backend)
+    if (ConnectionID.isEmpty())
+        return;
+    try
+    {
+        toConnection &conn = const_cast<toConnection&>(ParentConnection);
+        QString sql = toSQL::string("toQSqlConnection:Cancel", conn);
+        if (sql.isEmpty())
+            return;
+        toConnectionSubLoan c(conn);
+        toQuery(c, sql, toQueryParams() << ConnectionID);
+    }
+    catch (...)
+    {
+        TLOG(1, toDecorator, __HERE__) << "	Ignored exception." << std::endl;
+    }
 }
 
 void toQSqlConnectionSub::close()
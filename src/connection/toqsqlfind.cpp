@@ -54,6 +54,10 @@ class toQSqlFinder : public  toConnectionProviderFinder
             return QString::fromLatin1(QSQL_FINDER);
         };
 
+        /** Set up the library paths and list the Qt SQL drivers
+         */
+        virtual void prepare();
+
         /** Return list of possible client locations
          */
         virtual QList<ConnectionProvirerParams> find();
@@ -63,11 +67,12 @@ class toQSqlFinder : public  toConnectionProviderFinder
         */
         virtual void load(ConnectionProvirerParams const&);
 
+    private:
+        QStringList m_drivers;
 };
 
-QList<toConnectionProviderFinder::ConnectionProvirerParams>  toQSqlFinder::find()
+void toQSqlFinder::prepare()
 {
-    QList<ConnectionProvirerParams> retval;
 #ifdef Q_OS_WIN
     QString mysqlHome(toConfigurationNewSingle::Instance().option(ToConfiguration::Global::MysqlHomeDirectory).toString());
     QDir mysqlHomeDir(mysqlHome);
@@ -83,7 +88,13 @@ QList<toConnectionProviderFinder::ConnectionProvirerParams>  toQSqlFinder::find(
     }
 #endif
 
-    QStringList drivers = QSqlDatabase::drivers();
+    m_drivers = QSqlDatabase::drivers();
+}
+
+QList<toConnectionProviderFinder::ConnectionProvirerParams>  toQSqlFinder::find()
+{
+    QList<ConnectionProvirerParams> retval;
+    QStringList const& drivers = m_drivers;
 
     Q_FOREACH(QString driver, drivers)
     {
@@ -97,6 +108,7 @@ QList<toConnectionProviderFinder::ConnectionProvirerParams>  toQSqlFinder::find(
         //mysql.insert("VERSION", version);
         mysql.insert("KEY", name());
         mysql.insert("PROVIDER", QT_MYSQL_DRIVER);
+        mysql.insert("DISPLAY", MYSQL_PROVIDER);
         retval.append(mysql);
     }
     if (drivers.contains(QT_PGSQL_DRIVER))
@@ -106,6 +118,7 @@ QList<toConnectionProviderFinder::ConnectionProvirerParams>  toQSqlFinder::find(
         //psql.insert("VERSION", version);
         psql.insert("KEY", name());
         psql.insert("PROVIDER", QT_PGSQL_DRIVER);
+        psql.insert("DISPLAY", PGSQL_PROVIDER);
         retval.append(psql);
     }
     if (drivers.contains(QT_ODBC_DRIVER))
@@ -115,6 +128,7 @@ QList<toConnectionProviderFinder::ConnectionProvirerParams>  toQSqlFinder::find(
         //odbc.insert("VERSION", version);
         odbc.insert("KEY", name());
         odbc.insert("PROVIDER", QT_ODBC_DRIVER);
+        odbc.insert("DISPLAY", ODBC_PROVIDER);
         retval.append(odbc);
     }
     return retval;
@@ -255,11 +255,12 @@ QList<toCache::CacheEntry const*> toCache::getEntriesInSchema(QString const& sch
     QString schemaU = schema.toUpper();
     QList<toCache::CacheEntry const*> retval;
 
-    QList<ObjectRef> objs = entryMap.keys(); // TODO there must be a better way of searching QMap (do not copy keys)
-    Q_FOREACH(ObjectRef const & o, objs)
+    // ObjectRef is ordered by owner first, the entries of a schema are one range of the map
+    QMap<ObjectRef, CacheEntry const*>::const_iterator i = entryMap.lowerBound(ObjectRef(schemaU, QString(), QString()));
+    for (; i != entryMap.constEnd() && i.key().first == schemaU; i++)
     {
-        if ((entryMap.value(o)->type == type || type == toCache::ANY) && o.first == schemaU)
-            retval.append(entryMap.value(o));
+        if (i.value()->type == type || type == toCache::ANY)
+            retval.append(i.value());
     }
     return retval;
 }
@@ -418,11 +419,13 @@ void toCache::upsertSchemaEntries(QString const& schema, QString const& objType,
         throw QString("toCache: Unsupported object type ANY");
 
     // Clear whole schema
-    QList<ObjectRef> objs = entryMap.keys(); // TODO there must be a better way of deleting from QMap
-    Q_FOREACH(ObjectRef const & o, objs)
+    QMap<ObjectRef, CacheEntry const*>::iterator i = entryMap.lowerBound(ObjectRef(schema, QString(), QString()));
+    while (i != entryMap.end() && i.key().first == schema)
     {
-        if (o.first == schema && entryMap.value(o)->type == type)
-            entryMap.remove(o);
+        if (i.value()->type == type)
+            i = entryMap.erase(i);
+        else
+            i++;
     }
 
     // Add new entries in the schema
@@ -446,12 +449,9 @@ void toCache::upsertSchemaEntries(QString const& schema, QString const& objType,
 
     if (type == SYNONYM)
     {
-        QList<ObjectRef> objs = synonymMap.keys(); // TODO there must be a better way of deleting from QMap
-        Q_FOREACH(ObjectRef const & o, objs)
-        {
-            if (o.first == schema)
-                synonymMap.remove(o);
-        }
+        QMap<ObjectRef, CacheEntry const*>::iterator s = synonymMap.lowerBound(ObjectRef(schema, QString(), QString()));
+        while (s != synonymMap.end() && s.key().first == schema)
+            s = synonymMap.erase(s);
 
         Q_FOREACH(CacheEntry * e, rows)
         {
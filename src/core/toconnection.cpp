@@ -44,6 +44,8 @@
 #include "core/toconnectionprovider.h"
 #include "widgets/toworkspace.h"
 #include "core/todatabaseconfig.h"
+#include "core/tosql.h"
+#include "core/toquerycache.h"
 
 #include <QMenu>
 
@@ -66,6 +68,8 @@ toConnection::toConnection(const QString &provider,
     , pTrait(NULL)
     , ConnectionOptions(provider, host, database, user, password, schema, color , 0, options)
     , pCache(NULL)
+    , pResolvedSQL(NULL)
+    , pQueryCache(new toQueryCache)
     , LoanCnt(0)
 {
     pConnectionImpl = toConnectionProviderRegistrySing::Instance().get(provider).createConnectionImpl(*this);
@@ -74,6 +78,7 @@ toConnection::toConnection(const QString &provider,
     toConnectionSub* connSub = addConnection();
     Version = connSub->version();
     Connections.insert(connSub);
+    pResolvedSQL = new toSQLResolved(Provider, Version);
 
     setDefaultSchema(schema);
 
@@ -102,6 +107,8 @@ toConnection::toConnection(const toConnectionOptions &opts)
     , pTrait(NULL)
     , ConnectionOptions(opts)
     , pCache(NULL)
+    , pResolvedSQL(NULL)
+    , pQueryCache(new toQueryCache)
     , LoanCnt(0)
 {
     pConnectionImpl = toConnectionProviderRegistrySing::Instance().get(Provider).createConnectionImpl(*this);
@@ -110,6 +117,7 @@ toConnection::toConnection(const toConnectionOptions &opts)
     toConnectionSub* connSub = addConnection();
     Version = connSub->version();
     Connections.insert(connSub);
+    pResolvedSQL = new toSQLResolved(Provider, Version);
 
     setDefaultSchema(opts.schema);
 
@@ -194,6 +202,8 @@ toConnection::~toConnection()
         QMutexLocker lock(&ConnectionLock);
     }
     delete pConnectionImpl;
+    delete pResolvedSQL;
+    delete pQueryCache;
 }
 
 void toConnection::commit(toConnectionSub *sub)
@@ -64,6 +64,8 @@ class toQuery;           // defined in toquery.h
 class queryImpl;         // defined in toqueryimpl.h
 class toConnectionSubLoan;
 class toSQL;
+class toSQLResolved;
+class toQueryCache;
 
 /** Represent a database connection in TOra. Observe that this can mean several actual
  * connections to the database as queries that are expected to run a long time are sometimes
@@ -83,6 +85,7 @@ class toConnection : public QObject
         friend class toCache;
         friend class toCacheWorker;
         friend class toResultModel;
+        friend class toSQL;
     public:
         /** Create a new connection.
          * @param provider Which database provider to use for this connection.
@@ -206,6 +209,12 @@ class toConnection : public QObject
             return *pTrait;
         }
 
+        /** Results of dictionary queries, see @ref toSQL::Dictionary */
+        inline toQueryCache& queryCache() const
+        {
+            return *pQueryCache;
+        }
+
         // SETTERS
 
         /** Change password of connection. */
@@ -381,6 +390,8 @@ class toConnection : public QObject
         toConnectionTraits *pTrait;
         toConnectionOptions ConnectionOptions;
         toCache *pCache;
+        toSQLResolved *pResolvedSQL;
+        toQueryCache *pQueryCache;
         QAtomicInt LoanCnt;
         QSet<QAction*> ConnectionActions;
 }; // toConnection
@@ -35,6 +35,9 @@
 #include "core/toconnectionprovider.h"
 #include "core/tooracleconst.h"
 #include "connection/absfact.h"
+#include "core/tologger.h"
+
+#include <QtCore/QElapsedTimer>
 
 void toConnectionProviderRegistry::load(toConnectionProviderFinder::ConnectionProvirerParams const& providerParams)
 {
@@ -62,10 +65,57 @@ void toConnectionProviderRegistry::load(toConnectionProviderFinder::ConnectionPr
     {
         m_registry.insert(providerName, pProvider.release());
     }
+    m_deferred.remove(providerName);
 };
 
+void toConnectionProviderRegistry::defer(toConnectionProviderFinder::ConnectionProvirerParams const& providerParams)
+{
+    QString const& providerName = providerParams.value("PROVIDER").toString();
+    if (m_registry.contains(providerName) || m_deferred.value(providerName).contains(providerParams))
+        return;
+    m_deferred[providerName].append(providerParams);
+}
+
+bool toConnectionProviderRegistry::isLoaded(QString const& providerName) const
+{
+    return m_registry.contains(providerName);
+}
+
+QString toConnectionProviderRegistry::displayName(QString const& providerName) const
+{
+    if (m_registry.contains(providerName))
+        return m_registry.value(providerName)->displayName();
+    QString display = m_deferred.value(providerName).value(0).value("DISPLAY").toString();
+    return display.isEmpty() ? providerName : display;
+}
+
 toConnectionProvider& toConnectionProviderRegistry::get(QString const& providerName)
 {
+    if ( !m_registry.contains(providerName) && m_deferred.contains(providerName))
+    {
+        // Try the candidates (e.g. Oracle clients) in order until one loads
+        QList<toConnectionProviderFinder::ConnectionProvirerParams> candidates = m_deferred.take(providerName);
+        QString error;
+        while (!candidates.isEmpty() && !m_registry.contains(providerName))
+        {
+            toConnectionProviderFinder::ConnectionProvirerParams params = candidates.takeFirst();
+            QElapsedTimer timer;
+            timer.start();
+            try
+            {
+                load(params);
+                TLOG(5, toDecoratorNC, __HERE__) << "Loaded deferred provider " << providerName << " from " << params.value("PATH").toString()
+                                                 << " in " << timer.elapsed() << " ms" << std::endl;
+            }
+            catch (QString const& e)
+            {
+                TLOG(5, toDecoratorNC, __HERE__) << "Failed to load " << params.value("PATH").toString() << ": " << e << std::endl;
+                error = e;
+            }
+        }
+        if ( !m_registry.contains(providerName) && !error.isEmpty())
+            throw error;
+    }
     if ( !m_registry.contains(providerName))
     {
         throw QString("Connection provider not loaded: %1").arg(providerName);
@@ -85,5 +135,9 @@ toConnectionProvider const& toConnectionProviderRegistry::get(QString const& pro
 
 QList<QString> toConnectionProviderRegistry::providers() const
 {
-    return m_registry.keys();
+    QList<QString> retval = m_registry.keys();
+    Q_FOREACH(QString const& name, m_deferred.keys())
+        if (!m_registry.contains(name))
+            retval << name;
+    return retval;
 }
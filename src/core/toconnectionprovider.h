@@ -85,11 +85,19 @@ class toConnectionProviderFinder
     public:
         /** Each location of database client location is described by a set of parameters
             like name, path, ORACLE_HOME, ORACLE_HOME_NAME, TNS_ADMIN, INFORMIXDIR, or whatever.
+            Optional DISPLAY holds the provider's display name, so it can be listed before it is loaded.
         */
         typedef QMap<QString, QVariant> ConnectionProvirerParams;
 
         virtual QString name() const = 0;
 
+        /** Called on the main thread before find(). find() runs on a worker
+            thread at the same time as the other finders, so whatever needs the
+            configuration or Qt global state (library paths, SQL drivers, cwd)
+            is read here.
+         */
+        virtual void prepare() {};
+
         /** Return list of possible client locations
          */
         virtual QList<ConnectionProvirerParams> find() = 0;
@@ -123,8 +131,21 @@ class toConnectionProviderRegistry
 
         void load(toConnectionProviderFinder::ConnectionProvirerParams const& provider);
 
+        /** Register a provider found at startup without loading its libraries.
+         *  The provider is loaded by the first call to @ref get for its name.
+         *  Calling it again for the same provider name adds a fallback, @ref get
+         *  tries the candidates in the order they were deferred until one loads.
+         */
+        void defer(toConnectionProviderFinder::ConnectionProvirerParams const& provider);
+
+        /** Names of all the providers, loaded or deferred */
         QList<QString> providers() const;
 
+        bool isLoaded(QString const &provider) const;
+
+        /** Name shown in the new connection dialog, does not load a deferred provider */
+        QString displayName(QString const &provider) const;
+
     protected:
         /** only singleton @ref toConnectionProviderRegistrySing can create a instance of this class */
         friend class toConnectionProviderRegistrySing;
@@ -133,6 +154,7 @@ class toConnectionProviderRegistry
         toConnectionProviderRegistry() {};
     private:
         QMap<QString, toConnectionProvider*> m_registry;
+        QMap<QString, QList<toConnectionProviderFinder::ConnectionProvirerParams> > m_deferred;
 };
 
 class toConnectionProviderRegistrySing: public Loki::SingletonHolder<toConnectionProviderRegistry> {};
@@ -38,18 +38,32 @@
 #include "core/toquery.h"
 #include "core/tosql.h"
 
+#include <QtCore/QElapsedTimer>
+
 toConnectionSubLoan::toConnectionSubLoan(toConnection &con)
     : ParentConnection(con)
+    , BorrowWait(0)
     , SchemaInitialized(false)
-    , ConnectionSub(con.borrowSub())
-{}
+    , ConnectionSub(NULL)
+{
+    QElapsedTimer timer;
+    timer.start();
+    ConnectionSub = con.borrowSub();
+    BorrowWait = timer.nsecsElapsed() / 1000;
+}
 
 toConnectionSubLoan::toConnectionSubLoan(toConnection &con, QString const & schema)
     : ParentConnection(con)
+    , BorrowWait(0)
     , SchemaInitialized(false)
     , Schema(schema)
-    , ConnectionSub(con.borrowSub())
+    , ConnectionSub(NULL)
 {
+    QElapsedTimer timer;
+    timer.start();
+    ConnectionSub = con.borrowSub();
+    BorrowWait = timer.nsecsElapsed() / 1000;
+
     Q_ASSERT_X(!schema.isEmpty(), qPrintable(__QHERE__), "schema is empty");
     SchemaInitialized = ConnectionSub->schema() == schema;
 }
@@ -57,6 +71,7 @@ toConnectionSubLoan::toConnectionSubLoan(toConnection &con, QString const & sche
 /** This special kind of constructor is used by @ref toQuery while testing the connections*/
 toConnectionSubLoan::toConnectionSubLoan(toConnection &con, int*)
     : ParentConnection(con)
+    , BorrowWait(0)
     , SchemaInitialized(false)
     , ConnectionSub(NULL)
 {}
@@ -66,6 +66,10 @@ class toConnectionSubLoan
         QList<QString> initStrings() const;
 
         toConnection const& ParentConnection;
+        /** How long the constructor waited for a free connection (microseconds).
+         * Taken over by the first query run on this loan, see @ref toQueryProbe.
+         */
+        qint64 BorrowWait;
         //InitModeEnum InitMode;
         bool SchemaInitialized;
         QString Schema;
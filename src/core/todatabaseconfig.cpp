@@ -77,6 +77,8 @@ QVariant ToConfiguration::Database::defaultValue(int option) const
             return QVariant((bool)true);
         case IncludeParallelBool:
             return QVariant((bool)true);
+        case QueryCacheTTLInt:
+            return QVariant((int)300);
         default:
             Q_ASSERT_X( false, qPrintable(__QHERE__), qPrintable(QString("Context Database un-registered enum value: %1").arg(option)));
             return QVariant();
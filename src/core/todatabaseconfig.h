@@ -64,6 +64,7 @@ namespace ToConfiguration
                 , IncludeHeaderBool        // #define CONF_EXT_INC_HEADER
                 , IncludePromptBool        // #define CONF_EXT_INC_PROMPT
                 , IncludeParallelBool      // #define CONF_EXT_INC_PARALLEL
+                , QueryCacheTTLInt         // seconds dictionary query results are cached, 0 = off
             };
             virtual QVariant defaultValue(int) const;
     };
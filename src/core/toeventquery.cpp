@@ -42,6 +42,8 @@
 #include "core/toconnectionsubloan.h"
 #include "core/toconnectiontraits.h"
 
+#include <QtCore/QElapsedTimer>
+
 toEventQuery::toEventQuery(QObject *parent
                            , toConnection &conn
                            , QString const& sql
@@ -250,20 +252,34 @@ void toEventQuery::stop(void)
     {
         Utils::toBusy busy;
         TLOG(7, toDecorator, __HERE__) << "toEventQuery stop Thread is running" << std::endl;
+        QElapsedTimer timer;
+        timer.start();
+        bool cancelled = false;
         CancelCondition->Mutex.lock();
         emit stopRequested();
-        bool succeeded = CancelCondition->WaitCondition.wait(&CancelCondition->Mutex, 1000); // possible wait for 1 sec
-        CancelCondition->Mutex.unlock();
-        if (!succeeded)
+        // An idle worker answers at once, a busy one only when the database call returns
+        bool succeeded = CancelCondition->Closed
+                         || CancelCondition->WaitCondition.wait(&CancelCondition->Mutex, StopGraceMs);
+        if (!succeeded && Connection->ParentConnection.getTraits().hasAsyncBreak())
         {
-            TLOG(7, toDecorator, __HERE__) << "toEventQuery stop bg did not respond" << std::endl;
-            if (Connection->ParentConnection.getTraits().hasAsyncBreak())
-                try
-                {
-                    (*Connection)->cancel();
-                }
+            // Interrupt the running call from this thread (OCIBreak, PQcancel, KILL QUERY)
+            // so the worker finishes and the session is returned to the pool
+            TLOG(7, toDecorator, __HERE__) << "toEventQuery stop bg busy, cancelling on server" << std::endl;
+            try
+            {
+                (*Connection)->cancel();
+                cancelled = true;
+            }
             TOCATCH;
+            succeeded = CancelCondition->WaitCondition.wait(&CancelCondition->Mutex, StopCancelMs);
         }
+        CancelCondition->Mutex.unlock();
+        if (succeeded)
+            TLOG(5, toDecorator, __HERE__) << "toEventQuery stopped in " << timer.elapsed() << "ms"
+                                           << (cancelled ? " (server side cancel)" : "") << std::endl;
+        else
+            TLOG(5, toDecorator, __HERE__) << "toEventQuery stop: bg did not respond in " << timer.elapsed() << "ms"
+                                           << (cancelled ? " after server side cancel" : "") << std::endl;
         //Thread->wait();
     }
     WorkDone = true;
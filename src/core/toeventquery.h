@@ -98,8 +98,11 @@ class toEventQuery : public QObject
         class WaitConditionWithMutex
         {
             public:
+                WaitConditionWithMutex() : Closed(false) {}
                 QMutex Mutex;
                 QWaitCondition WaitCondition;
+                // set (under Mutex) by the worker once it is done with the connection
+                bool Closed;
         };
 
         /**
@@ -256,6 +259,10 @@ class toEventQuery : public QObject
         /** Undefined copy contructor.Don't clone me. */
         toEventQuery(toEventQuery const& other);
 
+        // stop(): time given to the worker before the server is asked to cancel,
+        // and then for the interrupted database call to return (milliseconds)
+        enum { StopGraceMs = 100, StopCancelMs = 2000 };
+
         ValuesList Values;
 
         // SQL to execute.
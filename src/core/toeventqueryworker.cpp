@@ -124,12 +124,15 @@ void toEventQueryWorker::toQueryPriv::init()
             delete m_Query;
         }
 #endif
-        m_Query = m_ConnectionSubLoan->createQuery(this);
+        m_Probe.setupDone();
+        m_Query = createQuery();
         m_ConnectionSubLoan->setQuery(this);
         m_Query->execute();
+        m_Probe.executed(m_Cached);
     }
     catch (...)
     {
+        m_Probe.failed();
         if (m_Query)
             delete m_Query;
         m_ConnectionSubLoan->setQuery(NULL);
@@ -192,7 +195,6 @@ void toEventQueryWorker::slotStop()
 {
     TLOG(7, toDecorator, __HERE__) << "toEventQueryWorker syncStop" << std::endl;
     Stopped = true;
-    CancelCondition->WaitCondition.wakeAll();
     close();
 }
 
@@ -209,6 +211,11 @@ void toEventQueryWorker::close()
     emit workDone();
 
     Closed = true;
+    // toEventQuery::stop holds the mutex until it waits, so the wake can not get lost
+    CancelCondition->Mutex.lock();
+    CancelCondition->Closed = true;
+    CancelCondition->WaitCondition.wakeAll();
+    CancelCondition->Mutex.unlock();
     emit finished();
     TLOG(7, toDecorator, __HERE__) << "toEventQueryWorker close b" << std::endl;
 }
@@ -242,40 +242,11 @@ std::list<QString> toExtract::describe(const toExtract::ObjectList &objects)
             }
             num++;
 
-            QString type = i.first;
-            QString owner = Connection.getTraits().unQuote(i.second.owner());
-            QString name  = Connection.getTraits().unQuote(i.second.name());
-            ObjectType typeEnum = objectTypeFromString(type.toUpper());
-            QString schema = intSchema(owner, true);
-
             std::list<QString> cur;
 
             try
             {
-                try
-                {
-                    if (ext)
-                    {
-                        if(!Initialized)
-                        {
-                            ext->initialize();
-                            Initialized = true;
-                        }
-                        ext->describe(cur,
-                                      typeEnum,
-                                      schema,
-                                      owner,
-                                      name);
-                    }
-                    else
-                    {
-                        throw qApp->translate("toExtract", "Invalid type %1 to describe").arg(type);
-                    }
-                }
-                catch (const QString &exc)
-                {
-                    rethrow(qApp->translate("toExtract", "Describe"), i.second.toString(), exc);
-                }
+                describeObject(i, cur);
                 cur.sort();
                 ret.merge(cur);
             }
@@ -294,6 +265,153 @@ std::list<QString> toExtract::describe(const toExtract::ObjectList &objects)
     return ret;
 }
 
+void toExtract::describeObject(const QPair<QString, toCache::ObjectRef> &object, std::list<QString> &ret)
+{
+    QString type = object.first;
+    QString owner = Connection.getTraits().unQuote(object.second.owner());
+    QString name  = Connection.getTraits().unQuote(object.second.name());
+    ObjectType typeEnum = objectTypeFromString(type.toUpper());
+    QString schema = intSchema(owner, true);
+
+    try
+    {
+        if (ext)
+        {
+            if(!Initialized)
+            {
+                ext->initialize();
+                Initialized = true;
+            }
+            ext->describe(ret,
+                          typeEnum,
+                          schema,
+                          owner,
+                          name);
+        }
+        else
+        {
+            throw qApp->translate("toExtract", "Invalid type %1 to describe").arg(type);
+        }
+    }
+    catch (const QString &exc)
+    {
+        rethrow(qApp->translate("toExtract", "Describe"), object.second.toString(), exc);
+    }
+}
+
+toExtract::FingerprintMap toExtract::fingerprint(const toExtract::ObjectList &objects)
+{
+    FingerprintMap ret;
+    QProgressDialog *progress = NULL;
+
+    if (Parent)
+    {
+        progress = new QProgressDialog(
+            qApp->translate("toExtract", "Creating fingerprints"),
+            qApp->translate("toExtract", "Cancel"),
+            0,
+            objects.size(),
+            Parent);
+        progress->setWindowTitle(qApp->translate("toExtract", "Creating fingerprints"));
+    }
+
+    try
+    {
+        Utils::toBusy busy;
+        int num = 1;
+        foreach(auto i, objects)
+        {
+            if (progress)
+            {
+                progress->setValue(num);
+                progress->setLabelText(i.second.toString());
+                qApp->processEvents();
+                if (progress->wasCanceled())
+                    throw qApp->translate("toExtract", "Describe was canceled");
+            }
+            num++;
+
+            std::list<QString> cur;
+            try
+            {
+                describeObject(i, cur);
+            }
+            catch (const QString &exc)
+            {
+                Utils::toStatusMessage(exc);
+                continue;
+            }
+            cur.sort();
+
+            // 64 bit FNV-1a over the sorted lines, the lines themselves are dropped
+            quint64 hash = Q_UINT64_C(14695981039346656037);
+            for (std::list<QString>::const_iterator j = cur.begin(); j != cur.end(); j++)
+            {
+                const QChar *c = j->constData();
+                for (int k = 0; k < j->size(); k++)
+                {
+                    hash ^= c[k].unicode();
+                    hash *= Q_UINT64_C(1099511628211);
+                }
+                hash ^= '\n';
+                hash *= Q_UINT64_C(1099511628211);
+            }
+
+            QString owner = Connection.getTraits().unQuote(i.second.owner());
+            QString name  = Connection.getTraits().unQuote(i.second.name());
+            Fingerprint print;
+            print.Object = i;
+            print.Hash = hash;
+            ret.insert(i.first.toUpper() + "\01" + intSchema(owner, true) + "\01" + name, print);
+        }
+    }
+    catch (...)
+    {
+        delete progress;
+        throw;
+    }
+    delete progress;
+    return ret;
+}
+
+void toExtract::changedObjects(const FingerprintMap &source, const FingerprintMap &destination,
+                               ObjectList &sourceChanged, ObjectList &destinationChanged)
+{
+    sourceChanged.clear();
+    destinationChanged.clear();
+
+    // Both maps are ordered by key, walk them side by side
+    FingerprintMap::const_iterator i = source.constBegin();
+    FingerprintMap::const_iterator j = destination.constBegin();
+    while (i != source.constEnd() && j != destination.constEnd())
+    {
+        if (i.key() < j.key())
+        {
+            sourceChanged.append(i->Object);
+            i++;
+        }
+        else if (j.key() < i.key())
+        {
+            destinationChanged.append(j->Object);
+            j++;
+        }
+        else
+        {
+            if (i->Hash != j->Hash)
+            {
+                sourceChanged.append(i->Object);
+                destinationChanged.append(j->Object);
+            }
+            i++;
+            j++;
+        }
+    }
+    for (; i != source.constEnd(); i++)
+        sourceChanged.append(i->Object);
+    for (; j != destination.constEnd(); j++)
+        destinationChanged.append(j->Object);
+}
+
 QString toExtract::generateHeading(const QString &action, const QList<QPair<QString,toCache::ObjectRef> > &objects)
 {
     if (!Heading)
@@ -45,6 +45,7 @@
 #include <loki/Factory_alt.h>
 
 #include <QtCore/QFile>
+#include <QtCore/QMap>
 #include <QtCore/QTextStream>
 #include <QtCore/QVariant>
 #include <QtCore/QString>
@@ -276,6 +277,7 @@ public:
         // General internal functions
 
         void rethrow(const QString &what, const QString &object, const QString &exc);
+        void describeObject(const QPair<QString, toCache::ObjectRef> &object, std::list<QString> &ret);
         QString generateHeading(const QString &action, const ObjectList &objects);
 
     public:
@@ -334,6 +336,23 @@ public:
          */
         std::list<QString> describe(const ObjectList &objects);
 
+        /** Compact digest of the description of one object, see @ref fingerprint */
+        struct Fingerprint
+        {
+            QPair<QString, toCache::ObjectRef> Object;
+            quint64 Hash;
+        };
+        /** Fingerprints keyed by type, described schema and name of the object */
+        typedef QMap<QString, Fingerprint> FingerprintMap;
+
+        /** Describe objects one at a time keeping only a hash of each description.
+         * Used to compare large schemas without holding every description line
+         * in memory, only objects whose hashes differ need to be described again.
+         * @param objects Same as for @ref describe.
+         * @return Map of object fingerprints.
+         */
+        FingerprintMap fingerprint(const ObjectList &objects);
+
         /** Set a context for this extractor.
          * @param name Name of this context
          * @param val Value of this context
@@ -578,6 +597,16 @@ public:
         static void srcDst2DropCreate(std::list<QString> &source, std::list<QString> &destination,
                                       std::list<QString> &drop, std::list<QString> &creat);
 
+        /** Compare two fingerprint maps and return the objects whose description
+         * differs, that is objects missing on one side or having another hash.
+         * @param source Fingerprints of the source objects.
+         * @param destination Fingerprints of the destination objects.
+         * @param sourceChanged Source objects to describe in detail (Will be overwritten).
+         * @param destinationChanged Destination objects to describe in detail (Will be overwritten).
+         */
+        static void changedObjects(const FingerprintMap &source, const FingerprintMap &destination,
+                                   ObjectList &sourceChanged, ObjectList &destinationChanged);
+
         /** Add a list to description.
          * @param ret The return list to add a line to.
          * @param ctx The current description context.
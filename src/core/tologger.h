@@ -13,6 +13,7 @@
 #include "ts_log/critical_section.h"
 #include "ts_log/message_handler_log.h"
 #include "ts_log/thread_safe_log.h"
+#include "ts_log/ring_buffer_log.h"
 #include "ts_log/ts_log_utils.h"
 #include "ts_log/decorator.h"
 #include "ts_log/toostream.h"
@@ -46,9 +47,30 @@ using namespace boost::iostreams;
 // TLOG(1, toDecorator, __HERE__) << "The value for a is:" << a << std::endl;
 // TLOG(5, toNoDecorator, __HERE__) << "The value for a is:" << a << std::endl;
 ////////////////////////////////////////////////////////////////////////////////
-#define TLOG(lognumber, decorator, where) get_log(lognumber).ts<decorator>(where)
+// Disabled channels do not evaluate "where" nor format the message at all.
+// The if/else form keeps TLOG usable as the body of an unbraced if.
+#define TLOG(lognumber, decorator, where)                                      \
+    if (!is_log_enabled(lognumber)) {} else get_log(lognumber).ts<decorator>(where)
+
+// Channels write through the per-thread lock-free rings (ring_buffer_log.h)
+#ifdef TS_LOG_HAS_RING
+typedef internal_thread_safe_log_ring internal_thread_safe_log_default;
+#else
+typedef internal_thread_safe_log_ownthread internal_thread_safe_log_default;
+#endif
+
+template< int idxLog>
+struct log_enabled
+{
+    enum { value = 1 };
+};
 
 #define DISABLE_LOG(lognumber)                                                 \
+    template<>                                                                 \
+    struct log_enabled<lognumber>                                              \
+    {                                                                          \
+        enum { value = 0 };                                                    \
+    };                                                                         \
     template<>                                                                 \
     inline thread_safe_log templ_get_log_ownthread(int_to_type<lognumber>*)    \
     {                                                                          \
@@ -72,7 +94,7 @@ struct s_null_sink : public boost::iostreams::stream_buffer<boost::iostreams::nu
     inline thread_safe_log templ_get_log_ownthread(int_to_type<lognumber>*)   \
     {                                                                         \
         static toOStream out;                                                 \
-        static internal_thread_safe_log_ownthread log(out);                   \
+        static internal_thread_safe_log_default log(out);                     \
         return thread_safe_log(log);                                          \
     };
 
@@ -140,7 +162,7 @@ TSLOG_TYPELIST_2(timeTotalDecorator<DEFAULT_THREAD_MANAGER>,
 template< int idxLog>
 inline thread_safe_log templ_get_log_ownthread( int_to_type< idxLog> *i = NULL )
 {
-    static internal_thread_safe_log_ownthread log( std::cout );
+    static internal_thread_safe_log_default log( std::cout );
     /* TODO it can crash here
        The main thread(1) already exited the funcion main. Runs __run_exit_handlers and calls ~thread_safe_log_writer_ownthread.
        It is waiting till the writter thread stops, m_bShouldBeDestructed == true.
@@ -183,6 +205,37 @@ DISABLE_LOG(10)  // QScintilla
 //
 ////////////////////////////////////////////////////////////////////////////////
 
+inline bool is_log_enabled(int idxLog)
+{
+    switch (idxLog)
+    {
+        case 0:
+            return log_enabled<0>::value;
+        case 1:
+            return log_enabled<1>::value;
+        case 2:
+            return log_enabled<2>::value;
+        case 3:
+            return log_enabled<3>::value;
+        case 4:
+            return log_enabled<4>::value;
+        case 5:
+            return log_enabled<5>::value;
+        case 6:
+            return log_enabled<6>::value;
+        case 7:
+            return log_enabled<7>::value;
+        case 8:
+            return log_enabled<8>::value;
+        case 9:
+            return log_enabled<9>::value;
+        case 10:
+            return log_enabled<10>::value;
+        default:
+            return true;
+    }
+}
+
 inline thread_safe_log get_log(int idxLog)
 {
     switch (idxLog)
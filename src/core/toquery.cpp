@@ -39,6 +39,7 @@
 #include "core/toconnectionsub.h"
 #include "core/toconnectiontraits.h"
 #include "core/tosql.h"
+#include "core/toquerycache.h"
 
 #include <QApplication>
 
@@ -49,10 +50,12 @@ toQueryAbstr::toQueryAbstr(toConnectionSubLoan &conn, const toSQL &sql, toQueryP
     , m_SQLName(sql.name())
     , m_eof(false)
     , m_rowsProcessed(0)
+    , m_Cached(false)
     , m_Query(NULL)
 {
 	conn->setLastSql(sql.name());
 	m_SQLName.remove('\'');
+	m_Probe.start(conn, sql.name(), conn.ParentConnection.description(false));
 }
 
 toQueryAbstr::toQueryAbstr(toConnectionSubLoan &conn, QString const& sql, toQueryParams const& params)
@@ -62,14 +65,22 @@ toQueryAbstr::toQueryAbstr(toConnectionSubLoan &conn, QString const& sql, toQuer
     , m_SQLName(sql.left(20))
     , m_eof(false)
     , m_rowsProcessed(0)
+    , m_Cached(false)
     , m_Query(NULL)
 {
 	conn->setLastSql(sql.left(20));
     m_SQLName.remove('\'');
+
+    QString name = toSQL::nameOf(sql, conn.ParentConnection);
+    if (name.isNull())
+        name = sql.simplified().left(60);
+    m_Probe.start(conn, name, conn.ParentConnection.description(false));
 }
 
 toQueryAbstr::~toQueryAbstr()
 {
+    // Statements not read until the end (DML, failures, stopped queries) are recorded here
+    m_Probe.finish(rowsProcessed(), m_Query ? m_Query->roundTrips() : 0);
     if (m_Query)
         delete m_Query;
 
@@ -94,29 +105,36 @@ toQueryAbstr::~toQueryAbstr()
 
 bool toQueryAbstr::eof(void)
 {
+    qint64 started = m_Probe.fetching();
     bool retval = m_Query ? m_Query->eof() : true;
+    m_Probe.waited(started);
 
     // eof value was flip over (do not call this each time)
     if (retval && !m_eof) //
     {
         m_eof = retval;
-        try
+        // a cached result sent nothing to the database, the current schema did not change
+        if (!m_Cached)
         {
-            QString sql = toSQL::string("Global:CurrentSchema", connection());
-            if (!sql.isEmpty())
+            try
+            {
+                QString sql = toSQL::string("Global:CurrentSchema", connection());
+                if (!sql.isEmpty())
+                {
+                    queryImpl* Query = m_ConnectionSubLoan->createQuery(this);
+                    //m_ConnectionSubLoan->setQuery(this);
+                    Query->execute(sql);
+                    QString schema = (QString)Query->readValue();
+                    m_ConnectionSubLoan->setSchema(schema);
+                    delete Query;
+                }
+            }
+            catch (...)
             {
-                queryImpl* Query = m_ConnectionSubLoan->createQuery(this);
-                //m_ConnectionSubLoan->setQuery(this);
-                Query->execute(sql);
-                QString schema = (QString)Query->readValue();
-                m_ConnectionSubLoan->setSchema(schema);
-                delete Query;
             }
-        }
-        catch (...)
-        {
         }
         m_rowsProcessed = m_Query->rowsProcessed();
+        m_Probe.finish(m_rowsProcessed, m_Query->roundTrips());
         if (m_Query)
             delete m_Query;
         m_Query = NULL;
@@ -125,11 +143,19 @@ bool toQueryAbstr::eof(void)
     return retval;
 }
 
+queryImpl* toQueryAbstr::createQuery()
+{
+    return connection().queryCache().createQuery(this, sub(), m_Cached);
+}
+
 toQValue toQueryAbstr::readValue(void)
 {
     if (connection().Abort)
         throw qApp->translate("toQuery", "Query aborted");
-    return m_Query->readValue();
+    qint64 started = m_Probe.fetching();
+    toQValue value = m_Query->readValue();
+    m_Probe.fetched(started, value.size());
+    return value;
 }
 
 toQColumnDescriptionList toQueryAbstr::describe(void)
@@ -171,12 +197,15 @@ void toQuery::init()
             m_ConnectionSubLoan->setInitialized(true);
         }
 
-        m_Query = m_ConnectionSubLoan->createQuery(this);
+        m_Probe.setupDone();
+        m_Query = createQuery();
         m_ConnectionSubLoan->setQuery(this);
         m_Query->execute();
+        m_Probe.executed(m_Cached);
     }
     catch (...)
     {
+        m_Probe.failed();
         if (m_Query)
             delete m_Query;
         m_ConnectionSubLoan->setQuery(NULL);
@@ -40,6 +40,7 @@
 #include "core/toqueryimpl.h"
 #include "core/toconnection.h"
 #include "core/toconnectionsubloan.h"
+#include "core/toquerytelemetry.h"
 
 class toConnection;
 class toConnectionSub;
@@ -173,12 +174,19 @@ class toQueryAbstr : public QObject
 
         virtual void init() = 0;
 
+        /** Create the implementation of the query itself, it might be served
+         * by the connection's @ref toQueryCache
+         */
+        queryImpl* createQuery();
+
         toConnectionSubLoan& m_ConnectionSubLoan;
         toQueryParams m_Params;
         QString m_SQL;
         QString m_SQLName;
         bool m_eof;
         unsigned long m_rowsProcessed;
+        bool m_Cached;
+        toQueryProbe m_Probe;
 
         queryImpl *m_Query;
         toQueryAbstr(const toQuery &);
@@ -0,0 +1,318 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "core/toquerycache.h"
+#include "core/toquery.h"
+#include "core/toqueryimpl.h"
+#include "core/toconnection.h"
+#include "core/toconnectionsub.h"
+#include "core/toconfiguration.h"
+#include "core/todatabaseconfig.h"
+#include "core/tologger.h"
+#include "core/tosql.h"
+
+#include <QtCore/QMutexLocker>
+#include <QtCore/QSet>
+
+namespace
+{
+    /** Returns a result stored in the cache, nothing is sent to the database */
+    class cachedQuery : public queryImpl
+    {
+        public:
+            cachedQuery(toQueryAbstr *query, toQueryCache::EntryPtr entry)
+                : queryImpl(query)
+                , Entry(entry)
+                , Position(0)
+            {}
+            void execute(void) override {}
+            void execute(QString const&) override {}
+            toQValue readValue(void) override
+            {
+                if (Position >= Entry->Values.size())
+                    throw toConnection::exception(QString::fromLatin1("Tried to read past end of query"));
+                return Entry->Values.at(Position++);
+            }
+            bool eof(void) override
+            {
+                return Position >= Entry->Values.size();
+            }
+            unsigned long rowsProcessed(void) override
+            {
+                return Entry->Processed;
+            }
+            toQColumnDescriptionList describe(void) override
+            {
+                return Entry->Description;
+            }
+            unsigned columns(void) override
+            {
+                return Entry->Columns;
+            }
+            void cancel(void) override {}
+        private:
+            toQueryCache::EntryPtr Entry;
+            int Position;
+    };
+
+    /** Runs the query on the database and keeps a copy of what was read.
+     * The copy is stored in the cache once the whole result was read.
+     */
+    class recordingQuery : public queryImpl
+    {
+        public:
+            recordingQuery(toQueryAbstr *query, queryImpl *impl, toQueryCache &cache)
+                : queryImpl(query)
+                , Impl(impl)
+                , Cache(cache)
+                , Result(new toQueryCache::Entry)
+                , Generation(cache.generation())
+            {}
+            ~recordingQuery()
+            {
+                delete Impl;
+                delete Result;
+            }
+            void execute(void) override
+            {
+                Impl->execute();
+                // Description is not available from all providers after the last row
+                Result->Description = Impl->describe();
+                Result->Columns = Impl->columns();
+            }
+            void execute(QString const& sql) override
+            {
+                Impl->execute(sql);
+            }
+            toQValue readValue(void) override
+            {
+                toQValue ret = Impl->readValue();
+                if (Result)
+                {
+                    if (Result->Values.size() < toQueryCache::MaxValues)
+                        Result->Values << ret;
+                    else
+                    {
+                        delete Result;
+                        Result = NULL;
+                    }
+                }
+                return ret;
+            }
+            bool eof(void) override
+            {
+                bool ret = Impl->eof();
+                if (ret && Result)
+                {
+                    Result->Processed = Impl->rowsProcessed();
+                    Cache.store(query()->sql(), query()->params(), Result, Generation);
+                    Result = NULL;
+                }
+                return ret;
+            }
+            unsigned long rowsProcessed(void) override
+            {
+                return Impl->rowsProcessed();
+            }
+            toQColumnDescriptionList describe(void) override
+            {
+                return Impl->describe();
+            }
+            unsigned columns(void) override
+            {
+                return Impl->columns();
+            }
+            void cancel(void) override
+            {
+                // A cancelled result is incomplete
+                delete Result;
+                Result = NULL;
+                Impl->cancel();
+            }
+        private:
+            queryImpl *Impl;
+            toQueryCache &Cache;
+            toQueryCache::Entry *Result;
+            unsigned Generation;
+    };
+
+    /** True for statements which (may) change the data dictionary:
+     * CREATE, ALTER, DROP, ... The first word after leading whitespace
+     * and comments is checked.
+     */
+    bool isDDL(QString const& sql)
+    {
+        int pos = 0, len = sql.length();
+        while (pos < len)
+        {
+            if (sql.at(pos).isSpace())
+                pos++;
+            else if (sql.midRef(pos, 2) == QLatin1String("--"))
+            {
+                pos = sql.indexOf('\n', pos);
+                if (pos < 0)
+                    return false;
+            }
+            else if (sql.midRef(pos, 2) == QLatin1String("/*"))
+            {
+                pos = sql.indexOf(QLatin1String("*/"), pos + 2);
+                if (pos < 0)
+                    return false;
+                pos += 2;
+            }
+            else
+                break;
+        }
+        int end = pos;
+        while (end < len && sql.at(end).isLetter())
+            end++;
+        static const QSet<QString> words = QSet<QString>()
+                                           << "CREATE" << "ALTER" << "DROP" << "RENAME" << "TRUNCATE"
+                                           << "COMMENT" << "GRANT" << "REVOKE" << "PURGE" << "FLASHBACK";
+        return words.contains(sql.mid(pos, end - pos).toUpper());
+    }
+}
+
+toQueryCache::toQueryCache()
+    : Generation(0)
+{
+    Counters.Hits = Counters.Misses = Counters.Expired = Counters.Stored = 0;
+    Counters.Entries = 0;
+}
+
+queryImpl* toQueryCache::createQuery(toQueryAbstr *query, toConnectionSub *sub, bool &cached)
+{
+    cached = false;
+    if (toConfigurationNewSingle::Instance().option(ToConfiguration::Database::QueryCacheTTLInt).toInt() <= 0)
+        return sub->createQuery(query);
+    if (!toSQL::isDictionary(query->sql(), query->connection()))
+    {
+        // DDL run on this connection makes the cached results out of date
+        if (isDDL(query->sql()))
+            clear();
+        return sub->createQuery(query);
+    }
+
+    EntryPtr entry = find(query->sql(), query->params());
+    if (entry)
+    {
+        cached = true;
+        return new cachedQuery(query, entry);
+    }
+    return new recordingQuery(query, sub->createQuery(query), *this);
+}
+
+QString toQueryCache::key(QString const& sql, toQueryParams const& params)
+{
+    QString ret = sql;
+    Q_FOREACH(toQValue const& p, params)
+    {
+        // Separator which does not appear in SQL text, null differs from empty
+        ret += QChar(0x1f);
+        if (!p.isNull())
+            ret += QChar('=') + p.displayData();
+    }
+    return ret;
+}
+
+toQueryCache::EntryPtr toQueryCache::find(QString const& sql, toQueryParams const& params)
+{
+    qint64 ttl = toConfigurationNewSingle::Instance().option(ToConfiguration::Database::QueryCacheTTLInt).toInt() * 1000LL;
+    QString k = key(sql, params);
+
+    QMutexLocker lock(&Lock);
+    QHash<QString, EntryPtr>::iterator i = Entries.find(k);
+    if (i == Entries.end())
+    {
+        Counters.Misses++;
+        return EntryPtr();
+    }
+    if (i.value()->Age.elapsed() > ttl)
+    {
+        Counters.Expired++;
+        Counters.Misses++;
+        Entries.erase(i);
+        Order.removeOne(k);
+        return EntryPtr();
+    }
+    Counters.Hits++;
+    return i.value();
+}
+
+void toQueryCache::store(QString const& sql, toQueryParams const& params, Entry *entry, unsigned generation)
+{
+    QString k = key(sql, params);
+    entry->Age.start();
+
+    QMutexLocker lock(&Lock);
+    // Started before the cache was cleared, may be out of date
+    if (generation != Generation)
+    {
+        delete entry;
+        return;
+    }
+    if (Entries.contains(k))
+        Order.removeOne(k);
+    Entries.insert(k, EntryPtr(entry));
+    Order.append(k);
+    while (Order.size() > MaxEntries)
+        Entries.remove(Order.takeFirst());
+    Counters.Stored++;
+}
+
+void toQueryCache::clear(void)
+{
+    QMutexLocker lock(&Lock);
+    TLOG(5, toDecorator, __HERE__) << "Query cache cleared, entries: " << Entries.size()
+                                   << " hits: " << Counters.Hits
+                                   << " misses: " << Counters.Misses
+                                   << " expired: " << Counters.Expired << std::endl;
+    Entries.clear();
+    Order.clear();
+    Generation++;
+}
+
+unsigned toQueryCache::generation(void) const
+{
+    QMutexLocker lock(&Lock);
+    return Generation;
+}
+
+toQueryCache::Stats toQueryCache::stats(void) const
+{
+    QMutexLocker lock(&Lock);
+    Stats ret = Counters;
+    ret.Entries = Entries.size();
+    return ret;
+}
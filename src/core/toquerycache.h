@@ -0,0 +1,118 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include "core/toqvalue.h"
+#include "core/tocache.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QString>
+
+class queryImpl;
+class toQueryAbstr;
+class toConnectionSub;
+
+/**
+ * Client side cache of the results of dictionary queries, one per @ref toConnection.
+ *
+ * Only statements defined with the @ref toSQL::Dictionary flag are cached,
+ * keyed by their text and bind values. Results are kept for
+ * Database::QueryCacheTTLInt seconds (0 disables the cache) or until
+ * @ref clear is called, e.g. by the refresh button of a tool. DDL
+ * statements (CREATE, ALTER, DROP, ...) run on the connection clear it
+ * too, changes made by other sessions are seen once the TTL expires.
+ * Only results read completely are stored.
+ */
+class toQueryCache
+{
+    public:
+        struct Entry
+        {
+            toQColumnDescriptionList Description;
+            unsigned Columns;
+            QList<toQValue> Values;
+            unsigned long Processed;
+            QElapsedTimer Age;
+        };
+        typedef QSharedPointer<const Entry> EntryPtr;
+
+        struct Stats
+        {
+            unsigned long Hits, Misses, Expired, Stored;
+            int Entries;
+        };
+
+        /** Limits, results with more values are not cached */
+        enum { MaxEntries = 500, MaxValues = 100000 };
+
+        toQueryCache();
+
+        /** Create the implementation for a query: served from the cache,
+         * recording into the cache or just the connection's one for
+         * statements which are not cached.
+         * @param cached Set to true if no statement will be sent to the database.
+         */
+        queryImpl* createQuery(toQueryAbstr *query, toConnectionSub *sub, bool &cached);
+
+        /** Cached result, NULL if there is none (or it is too old) */
+        EntryPtr find(QString const& sql, toQueryParams const& params);
+
+        /** Store a result, takes ownership of entry
+         * @param generation Value of @ref generation when the query was started,
+         * the result is dropped if the cache was cleared since.
+         */
+        void store(QString const& sql, toQueryParams const& params, Entry *entry, unsigned generation);
+
+        /** Forget all the results */
+        void clear(void);
+
+        /** Incremented by every @ref clear */
+        unsigned generation(void) const;
+
+        Stats stats(void) const;
+
+    private:
+        static QString key(QString const& sql, toQueryParams const& params);
+
+        mutable QMutex Lock;
+        QHash<QString, EntryPtr> Entries;
+        QList<QString> Order;
+        Stats Counters;
+        unsigned Generation;
+};
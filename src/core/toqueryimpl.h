@@ -91,6 +91,13 @@ class TORA_EXPORT queryImpl : public QObject
         /** Get the number of rows processed in the last executed query.
          */
         virtual unsigned long rowsProcessed(void) = 0;
+        /** Get the number of round trips to the server made by the last executed query.
+         * Returns 0 if the provider can not tell.
+         */
+        virtual unsigned long roundTrips(void)
+        {
+            return 0;
+        }
         /** Describe the currently running query.
          * @return A list of column descriptions of the query.
          */
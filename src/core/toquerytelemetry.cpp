@@ -0,0 +1,166 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "core/toquerytelemetry.h"
+#include "core/toconnectionsubloan.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QMutexLocker>
+
+#include <algorithm>
+
+toQueryTelemetry::toQueryTelemetry()
+    : Next(0)
+    , Recorded(0)
+{
+}
+
+void toQueryTelemetry::record(const toQueryExecution &execution)
+{
+    QMutexLocker lock(&Lock);
+    if (Ring.size() < Capacity)
+        Ring.append(execution);
+    else
+        Ring[Next] = execution;
+    Next = (Next + 1) % Capacity;
+    Recorded++;
+}
+
+QList<toQueryExecution> toQueryTelemetry::executions() const
+{
+    QMutexLocker lock(&Lock);
+    QList<toQueryExecution> ret;
+    ret.reserve(Ring.size());
+    // Once the ring is full Next points to the oldest execution
+    int first = Ring.size() < Capacity ? 0 : Next;
+    for (int i = 0; i < Ring.size(); i++)
+        ret << Ring.at((first + i) % Ring.size());
+    return ret;
+}
+
+QList<toQueryTelemetry::Summary> toQueryTelemetry::summary() const
+{
+    QHash<QString, Summary> sums;
+    {
+        QMutexLocker lock(&Lock);
+        for (const toQueryExecution &e : Ring)
+        {
+            Summary &s = sums[e.Name];
+            s.Name = e.Name;
+            s.Executions++;
+            if (e.Failed)
+                s.Failed++;
+            if (e.Cached)
+                s.Cached++;
+            s.Elapsed += e.elapsed();
+            s.MaxElapsed = std::max(s.MaxElapsed, e.elapsed());
+            s.Borrow += e.Borrow;
+            s.Setup += e.Setup;
+            s.Execute += e.Execute;
+            s.FirstRow += std::max(e.FirstRow, qint64(0));
+            s.Fetch += e.Fetch;
+            s.Rows += e.Rows;
+            s.RoundTrips += e.RoundTrips;
+            s.Bytes += e.Bytes;
+        }
+    }
+
+    QList<Summary> ret = sums.values();
+    std::sort(ret.begin(), ret.end(), [](const Summary & a, const Summary & b)
+    {
+        return a.Elapsed > b.Elapsed;
+    });
+    return ret;
+}
+
+void toQueryTelemetry::clear()
+{
+    QMutexLocker lock(&Lock);
+    Ring.clear();
+    Next = 0;
+}
+
+quint64 toQueryTelemetry::recorded() const
+{
+    QMutexLocker lock(&Lock);
+    return Recorded;
+}
+
+toQueryProbe::toQueryProbe()
+    : ExecuteStart(0)
+    , FetchNs(0)
+    , Started(false)
+    , Recorded(false)
+{
+}
+
+void toQueryProbe::start(toConnectionSubLoan &conn, const QString &name, const QString &connection)
+{
+    Timer.start();
+    Started = true;
+    Execution.Started = QDateTime::currentDateTime();
+    Execution.Name = name;
+    Execution.Connection = connection;
+    // A loan can serve several queries, only the first one waited for it
+    Execution.Borrow = conn.BorrowWait;
+    conn.BorrowWait = 0;
+}
+
+void toQueryProbe::setupDone()
+{
+    ExecuteStart = Timer.nsecsElapsed();
+    Execution.Setup = ExecuteStart / 1000;
+}
+
+void toQueryProbe::executed(bool cached)
+{
+    Execution.Execute = (Timer.nsecsElapsed() - ExecuteStart) / 1000;
+    Execution.Cached = cached;
+}
+
+void toQueryProbe::failed()
+{
+    Execution.Failed = true;
+}
+
+void toQueryProbe::finish(unsigned long rows, unsigned long roundTrips)
+{
+    if (Recorded || !Started)
+        return;
+    Recorded = true;
+    Execution.Fetch = FetchNs / 1000;
+    Execution.Rows = rows;
+    Execution.RoundTrips = Execution.Cached ? 0 : roundTrips;
+    toQueryTelemetrySing::Instance().record(Execution);
+}
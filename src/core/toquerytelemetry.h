@@ -0,0 +1,196 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include "loki/Singleton.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+class toConnectionSubLoan;
+
+/** Client side timings of one statement execution, times are in microseconds */
+struct toQueryExecution
+{
+    QDateTime Started;
+    /** toSQL name of the statement, or its beginning for ad hoc statements */
+    QString Name;
+    QString Connection;
+    /** Waiting for a free connection */
+    qint64 Borrow;
+    /** Switching the schema and running the session init statements */
+    qint64 Setup;
+    /** Parse, bind and execute, the providers do not report them separately */
+    qint64 Execute;
+    /** From the start of execute until the first value was read */
+    qint64 FirstRow;
+    /** Spent reading values and waiting for the next batch of rows */
+    qint64 Fetch;
+    quint64 Rows;
+    /** 0 if the provider can not tell */
+    quint64 RoundTrips;
+    quint64 Bytes;
+    /** Served by the connection's query cache */
+    bool Cached;
+    bool Failed;
+
+    toQueryExecution()
+        : Borrow(0), Setup(0), Execute(0), FirstRow(-1), Fetch(0)
+        , Rows(0), RoundTrips(0), Bytes(0), Cached(false), Failed(false)
+    {}
+
+    qint64 elapsed() const
+    {
+        return Borrow + Setup + Execute + Fetch;
+    }
+};
+
+/**
+ * Bounded in-memory ring of the last statement executions.
+ *
+ * Every @ref toQuery and @ref toEventQuery records its timings here once it
+ * is done, the logging docklet shows them one by one and summed up per toSQL
+ * name. Recording is thread safe, toEventQuery records from its worker thread.
+ */
+class toQueryTelemetry
+{
+    public:
+        /** Executions of one statement summed up */
+        struct Summary
+        {
+            QString Name;
+            int Executions;
+            int Failed;
+            int Cached;
+            qint64 Elapsed;
+            qint64 MaxElapsed;
+            qint64 Borrow;
+            qint64 Setup;
+            qint64 Execute;
+            qint64 FirstRow;
+            qint64 Fetch;
+            quint64 Rows;
+            quint64 RoundTrips;
+            quint64 Bytes;
+
+            Summary()
+                : Executions(0), Failed(0), Cached(0), Elapsed(0), MaxElapsed(0)
+                , Borrow(0), Setup(0), Execute(0), FirstRow(0), Fetch(0)
+                , Rows(0), RoundTrips(0), Bytes(0)
+            {}
+        };
+
+        /** Number of executions kept */
+        enum { Capacity = 5000 };
+
+        toQueryTelemetry();
+
+        void record(const toQueryExecution &execution);
+
+        /** Recorded executions, oldest first */
+        QList<toQueryExecution> executions() const;
+
+        /** Recorded executions summed up per statement name, most expensive first */
+        QList<Summary> summary() const;
+
+        void clear();
+
+        /** Number of executions recorded since start, including those which already left the ring */
+        quint64 recorded() const;
+
+    private:
+        mutable QMutex Lock;
+        QVector<toQueryExecution> Ring;
+        int Next;
+        quint64 Recorded;
+};
+
+typedef Loki::SingletonHolder<toQueryTelemetry> toQueryTelemetrySing;
+
+/**
+ * Collects the timings of one execution for @ref toQueryTelemetry.
+ *
+ * Owned by @ref toQueryAbstr, the calls follow the life of the query:
+ * setup, execute, values read, end of data (or destruction).
+ */
+class toQueryProbe
+{
+    public:
+        toQueryProbe();
+
+        /** Query was created, takes over the borrow wait of the loan */
+        void start(toConnectionSubLoan &conn, const QString &name, const QString &connection);
+        /** Schema switch and init statements are done, execute follows */
+        void setupDone();
+        void executed(bool cached);
+        void failed();
+
+        /** Start of a read, see @ref fetched */
+        inline qint64 fetching()
+        {
+            return Timer.nsecsElapsed();
+        }
+
+        /** One read finished */
+        inline void fetched(qint64 started, int bytes)
+        {
+            qint64 now = Timer.nsecsElapsed();
+            if (Execution.FirstRow < 0)
+                Execution.FirstRow = (now - ExecuteStart) / 1000;
+            FetchNs += now - started;
+            Execution.Bytes += bytes;
+        }
+
+        /** Waited in an end of data check, the next batch of rows may have been fetched */
+        inline void waited(qint64 started)
+        {
+            FetchNs += Timer.nsecsElapsed() - started;
+        }
+
+        /** Add the execution to @ref toQueryTelemetry, only the first call records */
+        void finish(unsigned long rows, unsigned long roundTrips);
+
+    private:
+        toQueryExecution Execution;
+        QElapsedTimer Timer;
+        qint64 ExecuteStart;
+        qint64 FetchNs;
+        bool Started;
+        bool Recorded;
+};
@@ -241,6 +241,24 @@ bool toQValue::isNull() const
     return Value.isNull();
 }
 
+int toQValue::size() const
+{
+    switch (Value.type())
+    {
+        case QVariant::Invalid:
+            return 0;
+        case QVariant::String:
+            return Value.toString().size() * sizeof(QChar);
+        case QVariant::ByteArray:
+            return Value.toByteArray().size();
+        case QVariant::Int:
+        case QVariant::UInt:
+            return sizeof(int);
+        default:
+            return sizeof(qlonglong);
+    }
+}
+
 const QByteArray toQValue::toByteArray() const
 {
     return Value.toByteArray();
@@ -170,6 +170,11 @@ class TORA_EXPORT toQValue
          */
         bool isComplexType(void) const;
 
+        /** Approximate number of bytes the value took when received from the
+         * database. Complex types count as their locator only.
+         */
+        int size(void) const;
+
         /** Get integer representation of this value.
          */
         int toInt(void) const;
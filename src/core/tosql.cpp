@@ -50,6 +50,9 @@ const char * const toSQL::TOSQL_CREATEPLAN = "Global:CreatePlan";
 
 QString toSQL::defaultVersion("0000");
 
+int toSQL::Handles = 0;
+QAtomicInt toSQL::Generation(0);
+
 toSQL::version::version(char const *provider, char const *ver, char const *sql, bool modified)
     : Provider(provider), Version(ver), SQL(sql), Modified(modified)
 {
@@ -63,15 +66,33 @@ toSQL::toSQL(char const *name,
              char const *sql,
              char const *description,
              char const *ver,
-             char const *provider)
+             char const *provider,
+             int flags)
     : Name(name)
+    , Handle(-1)
 {
     updateSQL(name, sql, description, ver, provider, false);
+    sqlMap::iterator i = Definitions->find(Name);
+    if (i != Definitions->end())
+    {
+        Handle = (*i).second.Handle;
+        if (flags & Dictionary)
+        {
+            (*i).second.Dictionary = true;
+            Generation.ref();
+        }
+    }
 }
 
 toSQL::toSQL(const QString &name)
     : Name(name)
-{}
+    , Handle(-1)
+{
+    allocCheck();
+    sqlMap::iterator i = Definitions->find(Name);
+    if (i != Definitions->end())
+        Handle = (*i).second.Handle;
+}
 
 void toSQL::allocCheck(void)
 {
@@ -90,6 +111,7 @@ bool toSQL::updateSQL(char const *_name,
 	version def(_provider, _ver, _sql, modified);
 
     allocCheck();
+    generationBump bump;
     sqlMap::iterator i = Definitions->find(_name);
     if (i == Definitions->end())
     {
@@ -99,6 +121,8 @@ bool toSQL::updateSQL(char const *_name,
             return false;
         }
         definition newDef;
+        newDef.Handle = Handles++;
+        newDef.Dictionary = false;
         newDef.Modified = modified;
         newDef.Description = _description;
         if (!def.SQL.isNull())
@@ -150,6 +174,7 @@ bool toSQL::deleteSQL(QString const& name,
                       QString const& provider)
 {
     allocCheck();
+    generationBump bump;
     sqlMap::iterator i = Definitions->find(name);
     if (i == Definitions->end())
     {
@@ -186,18 +211,11 @@ toSQL toSQL::sql(const QString &name)
     throw qApp->translate("toSQL", "01: Tried to get unknown SQL (%1)").arg(QString(name));
 }
 
-QString toSQL::string(const QString &name, const toConnection &conn)
+QString toSQL::resolve(const definition &def, const QString &provider, const QString &version)
 {
-    allocCheck();
-    QString SessionVersion = conn.version();
-    QString SessionProvider = conn.provider();
-
+    QString SessionProvider = provider;
     bool quit = false;
 
-    sqlMap::iterator i = Definitions->find(name);
-    if (i == Definitions->end())
-        goto fail;
-
     // Loop over our connections' provider queries, if nothing is found also loop over "ANY" providers' queries
     do
     {
@@ -205,15 +223,14 @@ QString toSQL::string(const QString &name, const toConnection &conn)
     		quit = true;
     	QString retval;
     	QString SqlVersion = defaultVersion;
-    	std::list<version> &cl = (*i).second.Versions;
-    	for (std::list<version>::iterator j = cl.begin(); j != cl.end(); j++)
+    	std::list<version> const &cl = def.Versions;
+    	for (std::list<version>::const_iterator j = cl.begin(); j != cl.end(); j++)
     	{
     		if (j->Provider != SessionProvider)
     			continue;
 
     		QString const& QueryVersion = j->Version;
-    		QString const& QueryProvider = j->Provider;
-    		if (SqlVersion <= QueryVersion && QueryVersion <= SessionVersion)
+    		if (SqlVersion <= QueryVersion && QueryVersion <= version)
     		{
     			retval = j->SQL;
     			SqlVersion = QueryVersion;
@@ -226,10 +243,115 @@ QString toSQL::string(const QString &name, const toConnection &conn)
     }
     while (!quit);
 
-fail:
+    return QString();
+}
+
+QString toSQL::string(const QString &name, const toConnection &conn)
+{
+    allocCheck();
+
+    sqlMap::iterator i = Definitions->find(name);
+    if (i != Definitions->end())
+    {
+        QString retval = resolve((*i).second, conn.provider(), conn.version());
+        if (!retval.isNull())
+            return retval;
+    }
+
     throw qApp->translate("toSQL", "02: Tried to get unknown SQL (%1)").arg(QString(name));
 }
 
+QString toSQL::string(const toSQL &sqldef, const toConnection &conn)
+{
+    if (sqldef.Handle >= 0 && conn.pResolvedSQL)
+    {
+        QString retval = conn.pResolvedSQL->statement(sqldef.Handle);
+        if (!retval.isNull())
+            return retval;
+    }
+    // Not resolved for this connection, let the lookup by name report it
+    return string(sqldef.Name, conn);
+}
+
+toSQLResolved::toSQLResolved(const QString &provider, const QString &version)
+    : Provider(provider)
+    , Version(version)
+    , Generation(-1)
+{
+    resolve();
+}
+
+void toSQLResolved::resolve(void)
+{
+    toSQL::allocCheck();
+    Generation = toSQL::Generation.loadAcquire();
+    Statements.fill(QString(), toSQL::Handles);
+    Dictionary.clear();
+    Names.clear();
+    for (toSQL::sqlMap::const_iterator i = toSQL::Definitions->begin(); i != toSQL::Definitions->end(); i++)
+    {
+        QString sql = toSQL::resolve((*i).second, Provider, Version);
+        Statements[(*i).second.Handle] = sql;
+        if (!sql.isNull())
+            Names.insert(sql, (*i).first);
+        if ((*i).second.Dictionary && !sql.isNull())
+            Dictionary.insert(sql);
+    }
+}
+
+void toSQLResolved::check(void)
+{
+    QWriteLocker lock(&Lock);
+    if (Generation != toSQL::Generation.loadAcquire())
+        resolve();
+}
+
+QString toSQLResolved::statement(int handle)
+{
+    {
+        QReadLocker lock(&Lock);
+        if (Generation == toSQL::Generation.loadAcquire())
+            return handle < Statements.size() ? Statements.at(handle) : QString();
+    }
+    check();
+    QReadLocker lock(&Lock);
+    return handle < Statements.size() ? Statements.at(handle) : QString();
+}
+
+bool toSQLResolved::isDictionary(const QString &sql)
+{
+    {
+        QReadLocker lock(&Lock);
+        if (Generation == toSQL::Generation.loadAcquire())
+            return Dictionary.contains(sql);
+    }
+    check();
+    QReadLocker lock(&Lock);
+    return Dictionary.contains(sql);
+}
+
+QString toSQLResolved::name(const QString &sql)
+{
+    {
+        QReadLocker lock(&Lock);
+        if (Generation == toSQL::Generation.loadAcquire())
+            return Names.value(sql);
+    }
+    check();
+    QReadLocker lock(&Lock);
+    return Names.value(sql);
+}
+
+bool toSQL::isDictionary(const QString &sql, const toConnection &conn)
+{
+    return conn.pResolvedSQL && conn.pResolvedSQL->isDictionary(sql);
+}
+
+QString toSQL::nameOf(const QString &sql, const toConnection &conn)
+{
+    return conn.pResolvedSQL ? conn.pResolvedSQL->name(sql) : QString();
+}
+
 bool toSQL::saveSQL(const QString &filename, bool all)
 {
     allocCheck();
@@ -39,6 +39,11 @@
 
 #include <QtCore/QString>
 #include <QtCore/QList>
+#include <QtCore/QVector>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QSet>
+#include <QtCore/QHash>
 
 class toConnection;
 
@@ -116,6 +121,21 @@ class toSQL
             /** List of the different versions of the statement.
              */
             std::list<version> Versions;
+            /** Index of this definition in the tables of @ref toSQLResolved,
+             * never reused for another name.
+             */
+            int Handle;
+            /** Results of this statement may be served from @ref toQueryCache
+             */
+            bool Dictionary;
+        };
+
+        /** Flags of a statement, see the constructor */
+        enum Flags
+        {
+            NoFlags = 0,
+            /** Read-only dictionary query whose result can be cached (for all versions of the statement) */
+            Dictionary = 1
         };
 
         /** Type of map of statement names to statement definitions.
@@ -130,6 +150,38 @@ class toSQL
          */
         QString Name;
 
+        /** Handle of the definition of this statement, -1 if not known
+         */
+        int Handle;
+
+        /** Next definition handle to hand out
+         */
+        static int Handles;
+
+        /** Incremented on every change of @ref Definitions, see @ref toSQLResolved
+         */
+        static QAtomicInt Generation;
+
+        /** Increments @ref Generation when it goes out of scope. Changes of
+         * @ref Definitions must be complete before the generation moves,
+         * otherwise a concurrent @ref toSQLResolved::check could cache the old
+         * text under the new generation.
+         */
+        struct generationBump
+        {
+            ~generationBump()
+            {
+                Generation.ref();
+            }
+        };
+
+        /** Pick the statement for a provider and version from a definition.
+         * @return Null string if there is none.
+         */
+        static QString resolve(const definition &def, const QString &provider, const QString &version);
+
+        friend class toSQLResolved;
+
         /** Internal constructor used by some of the internal functions. Creates an
          * SQL statement with a name but without an entry in the @ref Definitions map.
          */
@@ -188,10 +240,7 @@ class toSQL
          * @return String containing the statement.
          * @exception QString with description of problem fetching string.
          */
-        static QString string(const toSQL &sqldef, const toConnection &conn)
-        {
-            return string(sqldef.Name, conn);
-        }
+        static QString string(const toSQL &sqldef, const toConnection &conn);
 
         /** Get description of an SQL.
          * @param name Name of SQL to get name from..
@@ -227,7 +276,7 @@ class toSQL
          */
         static QString sql(const toSQL &sqldef, const toConnection &conn)
         {
-            return sql(sqldef.Name, conn);
+            return string(sqldef, conn).toUtf8();
         }
 
         /** Get an SQL from a specified name.
@@ -270,9 +319,20 @@ class toSQL
          */
         const QString operator () (const toConnection &conn) const
         {
-            return string(Name, conn);
+            return string(*this, conn);
         }
 
+        /** Check if a statement text is a @ref Dictionary statement for a connection.
+         * @param sql Statement as returned by @ref string.
+         */
+        static bool isDictionary(const QString &sql, const toConnection &conn);
+
+        /** Find the name of the definition a statement text was resolved from.
+         * @param sql Statement as returned by @ref string.
+         * @return Null string if the statement is not a toSQL definition.
+         */
+        static QString nameOf(const QString &sql, const toConnection &conn);
+
         /** Get name of this SQL.
          * @return Name.
          */
@@ -289,12 +349,50 @@ class toSQL
          * @param description Description of statement.
          * @param ver Version this statement applies to.
          * @param provider Provider this string is for.
+         * @param flags Combination of @ref Flags.
          */
         toSQL(char const *name,
               char const * sql,
               char const *description = "",
               char const *ver = "0801",
-              char const *provider = "Oracle");
+              char const *provider = "Oracle",
+              int flags = NoFlags);
+};
+
+/**
+ * All the statements of the toSQL dictionary resolved for one provider and
+ * version. Every @ref toConnection owns one, so looking up a statement by
+ * its @ref toSQL object is an array access. The table is rebuilt on the
+ * first lookup after any statement was changed (e.g. edited in the SQL
+ * dictionary editor or loaded from a file).
+ */
+class toSQLResolved
+{
+    public:
+        toSQLResolved(const QString &provider, const QString &version);
+
+        /** Get the statement for a definition handle.
+         * @return Null string if there is no statement for this provider.
+         */
+        QString statement(int handle);
+
+        /** Check if the statement text belongs to a toSQL::Dictionary definition */
+        bool isDictionary(const QString &sql);
+
+        /** Name of the definition resolved to the statement text */
+        QString name(const QString &sql);
+
+    private:
+        void resolve(void);
+        void check(void);
+
+        QString Provider;
+        QString Version;
+        int Generation;
+        QVector<QString> Statements;
+        QSet<QString> Dictionary;
+        QHash<QString, QString> Names;
+        QReadWriteLock Lock;
 };
 
 #endif
@@ -454,6 +454,73 @@ void toTableModelPriv::appendRows(toQueryAbstr::RowList const& r)
         emit firstResultReceived();
 }
 
+void toTableModelPriv::updateRows(const QList<int> &keys,
+                                  const QMap<QString, toQueryAbstr::Row> &changed,
+                                  const QSet<QString> &removed,
+                                  const toQueryAbstr::RowList &added)
+{
+    QList<QString> rowKeys;
+    rowKeys.reserve(Rows.size());
+    for (int r = 0; r < Rows.size(); r++)
+        rowKeys << rowKey(Rows.at(r), keys);
+
+    if (!changed.isEmpty())
+    {
+        for (int r = 0; r < Rows.size(); r++)
+        {
+            QMap<QString, toQueryAbstr::Row>::const_iterator c = changed.constFind(rowKeys.at(r));
+            if (c == changed.constEnd())
+                continue;
+
+            toQueryAbstr::Row &row = Rows[r];
+            int first = -1, last = -1;
+            for (int col = 0; col < row.size() && col < c->size(); col++)
+            {
+                if (row.at(col) == c->at(col))
+                    continue;
+                if (first < 0)
+                    first = col;
+                last = col;
+            }
+            if (first < 0)
+                continue;
+            row = *c;
+            emit dataChanged(index(r, first), index(r, last));
+        }
+    }
+
+    if (!removed.isEmpty())
+    {
+        // from the bottom so that the indexes of the remaining rows stay valid
+        for (int r = Rows.size() - 1; r >= 0; r--)
+        {
+            if (!removed.contains(rowKeys.at(r)))
+                continue;
+            int last = r;
+            while (r > 0 && removed.contains(rowKeys.at(r - 1)))
+                r--;
+            super::beginRemoveRows(QModelIndex(), r, last);
+            Rows.erase(Rows.begin() + r, Rows.begin() + last + 1);
+            super::endRemoveRows();
+        }
+    }
+
+    if (!added.isEmpty())
+        appendRows(added);
+}
+
+QString toTableModelPriv::rowKey(const toQueryAbstr::Row &row, const QList<int> &keys)
+{
+    QString key;
+    foreach(int k, keys)
+    {
+        if (k >= 0 && k < row.size())
+            key += (QString) row.at(k);
+        key += QChar(0);
+    }
+    return key;
+}
+
 void toTableModelPriv::setHeaders(toQueryAbstr::HeaderList const& h)
 {
     if (!Headers.empty())
@@ -40,6 +40,8 @@
 
 #include <QtCore/QAbstractTableModel>
 #include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QSet>
 
 /** This is base class for all table based models.
  *  QT does not allow signals to be emitted by templates.
@@ -206,6 +208,25 @@ class toTableModelPriv : public QAbstractTableModel
         toQueryAbstr::HeaderList & headers(void) { return Headers; }
         toQueryAbstr::HeaderList const& headers(void) const { return Headers; }
 
+        /**
+         * Apply a keyed delta to the rows in place.
+         *
+         * Rows are matched using @ref rowKey, changed rows emit dataChanged()
+         * only for the range of columns that differ, removed rows are taken
+         * out in contiguous blocks and added rows are appended. Unlike a
+         * reload this keeps selection, current index and scroll position.
+         */
+        void updateRows(const QList<int> &keys,
+                        const QMap<QString, toQueryAbstr::Row> &changed,
+                        const QSet<QString> &removed,
+                        const toQueryAbstr::RowList &added);
+
+        /** Identity of a row made from the values of its key columns */
+        static QString rowKey(const toQueryAbstr::Row &row, const QList<int> &keys);
+
+        /** Rows currently held by the model (implicitly shared) */
+        toQueryAbstr::RowList const& rows(void) const { return Rows; }
+
     protected:
         void clearAll();
 
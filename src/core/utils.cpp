@@ -685,7 +685,7 @@ namespace Utils
             return false;
 
 #ifdef Q_OS_LINUX
-        static char Elf_ident[16];
+        char Elf_ident[16];
 
         if ( lib.read(Elf_ident, sizeof(Elf_ident)) != sizeof(Elf_ident))
             return false;
@@ -706,9 +706,9 @@ namespace Utils
 #endif
 
 #ifdef Q_OS_WIN32
-        static char COFF_header[68];
+        char COFF_header[68];
         quint32 offset;
-        static char PE_header[6];
+        char PE_header[6];
         quint16 machine;
 
         if ( lib.read(COFF_header, sizeof(COFF_header)) != sizeof(COFF_header))
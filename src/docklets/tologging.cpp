@@ -37,6 +37,14 @@
 #include "core/tologger.h"
 #include "core/utils.h"
 #include <QPlainTextEdit>
+#include <QComboBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QSortFilterProxyModel>
+#include <QTabWidget>
+#include <QTableView>
+#include <QtCore/QTimer>
 #include "widgets/tosearchreplace.h"
 
 REGISTER_VIEW("Logging", toLoggingDocklet);
@@ -54,15 +62,52 @@ toLoggingDocklet::toLoggingDocklet(QWidget *parent, toWFlags flags)
 
     setFocusProxy(&log);
 
+    // Client side timings of the statements TOra executed
+    QWidget *s = new QWidget(this);
+    QVBoxLayout *sl = new QVBoxLayout();
+    sl->setSpacing(0);
+    sl->setContentsMargins(0, 0, 0, 0);
+    QHBoxLayout *bar = new QHBoxLayout();
+    mode = new QComboBox(s);
+    mode->addItem(tr("By statement"));
+    mode->addItem(tr("Executions"));
+    bar->addWidget(mode);
+    bar->addStretch();
+    QPushButton *clear = new QPushButton(tr("Clear"), s);
+    bar->addWidget(clear);
+    sl->addLayout(bar);
+
+    telemetry = new toQueryTelemetryModel(this);
+    QSortFilterProxyModel *proxy = new QSortFilterProxyModel(this);
+    proxy->setSourceModel(telemetry);
+    statements = new QTableView(s);
+    statements->setModel(proxy);
+    statements->setSortingEnabled(true);
+    statements->setSelectionBehavior(QAbstractItemView::SelectRows);
+    statements->verticalHeader()->hide();
+    sl->addWidget(statements);
+    s->setLayout(sl);
+
+    connect(mode, SIGNAL(currentIndexChanged(int)), this, SLOT(slotModeChanged(int)));
+    connect(clear, SIGNAL(clicked()), this, SLOT(slotClear()));
+
+    tabs = new QTabWidget(this);
+    tabs->addTab(&log, tr("Log"));
+    tabs->addTab(s, tr("Statements"));
+
     QWidget *w = new QWidget(this);
     QVBoxLayout *l = new QVBoxLayout();
     l->setSpacing(0);
     l->setContentsMargins(0, 0, 0, 0);
-    l->addWidget(&log);
+    l->addWidget(tabs);
     w->setLayout(l);
 
     setWidget(w);
 
+    timer = new QTimer(this);
+    connect(timer, SIGNAL(timeout()), this, SLOT(slotRefresh()));
+    timer->start(2000);
+
 //    FlagSet.Save = true;
     FlagSet.Copy = true;
     FlagSet.Search = true;
@@ -112,3 +157,182 @@ bool toLoggingDocklet::handleSearching(QString const& search, QString const& rep
 
     return log.find(search, f);
 }
+
+void toLoggingDocklet::slotModeChanged(int index)
+{
+    telemetry->setMode((toQueryTelemetryModel::Mode) index);
+    statements->resizeColumnsToContents();
+}
+
+void toLoggingDocklet::slotClear()
+{
+    toQueryTelemetrySing::Instance().clear();
+    telemetry->refresh(true);
+}
+
+void toLoggingDocklet::slotRefresh()
+{
+    // Nothing to do while nobody is looking
+    if (!isVisible() || tabs->currentIndex() != 1)
+        return;
+    telemetry->refresh();
+}
+
+namespace
+{
+    // Microseconds as milliseconds
+    inline QVariant ms(qint64 us)
+    {
+        return qRound64(us / 100.0) / 10.0;
+    }
+}
+
+toQueryTelemetryModel::toQueryTelemetryModel(QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_mode(SummaryMode)
+    , m_recorded(0)
+{
+}
+
+void toQueryTelemetryModel::setMode(Mode mode)
+{
+    beginResetModel();
+    m_mode = mode;
+    endResetModel();
+    refresh(true);
+}
+
+void toQueryTelemetryModel::refresh(bool force)
+{
+    toQueryTelemetry &t = toQueryTelemetrySing::Instance();
+    quint64 recorded = t.recorded();
+    if (!force && recorded == m_recorded)
+        return;
+    m_recorded = recorded;
+
+    beginResetModel();
+    m_summary.clear();
+    m_executions.clear();
+    if (m_mode == SummaryMode)
+        m_summary = t.summary();
+    else
+        m_executions = t.executions();
+    endResetModel();
+}
+
+int toQueryTelemetryModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_mode == SummaryMode ? m_summary.size() : m_executions.size();
+}
+
+int toQueryTelemetryModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_mode == SummaryMode ? 15 : 13;
+}
+
+QVariant toQueryTelemetryModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+
+    if (m_mode == SummaryMode)
+    {
+        switch (section)
+        {
+            case 0: return tr("Statement");
+            case 1: return tr("Executions");
+            case 2: return tr("Failed");
+            case 3: return tr("Cached");
+            case 4: return tr("Total ms");
+            case 5: return tr("Avg ms");
+            case 6: return tr("Max ms");
+            case 7: return tr("Borrow ms");
+            case 8: return tr("Setup ms");
+            case 9: return tr("Execute ms");
+            case 10: return tr("Avg first row ms");
+            case 11: return tr("Fetch ms");
+            case 12: return tr("Rows");
+            case 13: return tr("Round trips");
+            case 14: return tr("Bytes");
+        }
+    }
+    else
+    {
+        switch (section)
+        {
+            case 0: return tr("Started");
+            case 1: return tr("Statement");
+            case 2: return tr("Connection");
+            case 3: return tr("Elapsed ms");
+            case 4: return tr("Borrow ms");
+            case 5: return tr("Setup ms");
+            case 6: return tr("Execute ms");
+            case 7: return tr("First row ms");
+            case 8: return tr("Fetch ms");
+            case 9: return tr("Rows");
+            case 10: return tr("Round trips");
+            case 11: return tr("Bytes");
+            case 12: return tr("State");
+        }
+    }
+    return QVariant();
+}
+
+QVariant toQueryTelemetryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole)
+        return QVariant();
+
+    if (m_mode == SummaryMode)
+    {
+        const toQueryTelemetry::Summary &s = m_summary.at(index.row());
+        switch (index.column())
+        {
+            case 0: return s.Name;
+            case 1: return s.Executions;
+            case 2: return s.Failed;
+            case 3: return s.Cached;
+            case 4: return ms(s.Elapsed);
+            case 5: return ms(s.Elapsed / qMax(s.Executions, 1));
+            case 6: return ms(s.MaxElapsed);
+            case 7: return ms(s.Borrow);
+            case 8: return ms(s.Setup);
+            case 9: return ms(s.Execute);
+            case 10: return ms(s.FirstRow / qMax(s.Executions, 1));
+            case 11: return ms(s.Fetch);
+            case 12: return s.Rows;
+            case 13: return s.RoundTrips;
+            case 14: return s.Bytes;
+        }
+    }
+    else
+    {
+        const toQueryExecution &e = m_executions.at(index.row());
+        switch (index.column())
+        {
+            case 0: return e.Started.toString("hh:mm:ss.zzz");
+            case 1: return e.Name;
+            case 2: return e.Connection;
+            case 3: return ms(e.elapsed());
+            case 4: return ms(e.Borrow);
+            case 5: return ms(e.Setup);
+            case 6: return ms(e.Execute);
+            case 7: return e.FirstRow < 0 ? QVariant() : ms(e.FirstRow);
+            case 8: return ms(e.Fetch);
+            case 9: return e.Rows;
+            case 10: return e.RoundTrips;
+            case 11: return e.Bytes;
+            case 12:
+                if (e.Failed)
+                    return tr("Failed");
+                if (e.Cached)
+                    return tr("Cached");
+                return QVariant();
+        }
+    }
+    return QVariant();
+}
@@ -36,6 +36,7 @@
 
 #include "core/todocklet.h"
 #include "core/toeditwidget.h"
+#include "core/toquerytelemetry.h"
 #include "editor/toeditglobals.h"
 
 #include "loki/Singleton.h"
@@ -43,9 +44,48 @@
 #include <QListView>
 #include <QDirModel>
 #include <QPlainTextEdit>
+#include <QtCore/QAbstractTableModel>
 
+class QComboBox;
+class QTabWidget;
+class QTableView;
+class QTimer;
 class toToolWidget;
 
+/**
+ * Statement executions recorded by @ref toQueryTelemetry, either one
+ * by one or summed up per statement. Times are shown in milliseconds.
+ */
+class toQueryTelemetryModel : public QAbstractTableModel
+{
+    Q_OBJECT;
+public:
+    enum Mode
+    {
+        SummaryMode = 0,
+        ExecutionsMode
+    };
+
+    toQueryTelemetryModel(QObject *parent = 0);
+
+    void setMode(Mode mode);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+public slots:
+    /** Reload from @ref toQueryTelemetry if anything was recorded since the last refresh */
+    void refresh(bool force = false);
+
+private:
+    Mode m_mode;
+    QList<toQueryTelemetry::Summary> m_summary;
+    QList<toQueryExecution> m_executions;
+    quint64 m_recorded;
+};
+
 class toLoggingDocklet : public toDocklet , public toEditWidget
 {
     Q_OBJECT;
@@ -83,7 +123,17 @@ protected:
     /** Re-implented from toEditWidget */
     void focusOutEvent (QFocusEvent *e) override;
 
+private slots:
+    void slotModeChanged(int);
+    void slotClear();
+    void slotRefresh();
+
 private:
     QPlainTextEdit &log;
+    QTabWidget *tabs;
+    QComboBox *mode;
+    QTableView *statements;
+    toQueryTelemetryModel *telemetry;
+    QTimer *timer;
 };
 
@@ -36,8 +36,6 @@
 #include "core/toconfiguration.h"
 #include "core/toeditorconfiguration.h"
 
-#include <dtl/dtl.hpp>
-
 #include <QListWidget>
 #include <QVBoxLayout>
 #include <QApplication>
@@ -45,28 +43,6 @@
 #include <Qsci/qscilexerdiff.h>
 #include <Qsci/qscilexercustom.h>
 
-class Line
-{
-public:
-    Line(QString _txt, unsigned _number) : number(_number), txt(_txt) {};
-    Line(const Line& other) : number(other.number) , txt(other.txt) {};
-
-    Line& operator=(const Line& other)
-    {
-        number = other.number;
-        txt = other.txt;
-        return *this;
-    }
-
-    unsigned number;
-    QString txt;
-};
-inline bool operator==(const Line& lhs, const Line& rhs)
-{
-    return lhs.txt == rhs.txt;
-}
-inline bool operator!=(const Line& lhs, const Line& rhs){ return !(lhs == rhs); }
-
 #define declareStyle(style,color, paper, font) styleNames[style] = tr(#style); \
     setColor(color, style); \
     setPaper(paper, style); \
@@ -133,6 +109,7 @@ public:
 
 toDiffText::toDiffText(QWidget *parent, const char *name)
     : toScintilla(parent)
+    , Algorithm(toLineDiff::Automatic)
 {
     using namespace ToConfiguration;
     if (name)
@@ -149,61 +126,42 @@ toDiffText::toDiffText(QWidget *parent, const char *name)
 
 void toDiffText::setText (const QString& oldTxt, const QString& newTxt)
 {
-    using dtl::Diff;
-    typedef Line elem;
-    typedef std::vector<Line> sequence;
-
     toScintilla::clear();
 
     QRegExp newline("\n|\r\n|\r");
     QStringList oldLines = oldTxt.split(newline);
     QStringList newLines = newTxt.split(newline);
 
-    sequence Old, New;
-    unsigned i = 0;
-    foreach(QString line, oldLines)
-    {
-        Old.push_back(Line(line, i++));
-    }
-    i = 0;
-    foreach(QString line, newLines)
+    std::vector<toLineDiff::Edit> edits = toLineDiff::diff(oldLines, newLines, Algorithm);
+
+    // Fill the editor in one go, then style runs of lines sharing the same edit type
+    QString text;
+    foreach(const toLineDiff::Edit &e, edits)
     {
-        New.push_back(Line(line, i++));
+        text += e.Type == toLineDiff::Add ? newLines.at(e.NewLine) : oldLines.at(e.OldLine);
+        text += "\n";
     }
+    toScintilla::setText(text);
 
-    Diff< elem, sequence > d(Old, New);
-    d.compose();
-
-    auto seq = d.getSes().getSequence();
-    int lineNumber = 0;
-    foreach(auto &e, seq)
+    int lines = edits.size();
+    for (int first = 0; first < lines;)
     {
-        Line line = e.first;
-        auto info  = e.second;
-        long long beforeIdx = info.beforeIdx;
-        long long afterIdx  = info.afterIdx;
-        dtl::edit_t type    = info.type;
-
-        long pos = toScintilla::positionFromLineIndex(lineNumber, 0);
-        toScintilla::append(line.txt);
-        toScintilla::append("\n");
-
-        toScintilla::SendScintilla(QsciScintillaBase::SCI_STARTSTYLING, pos, 0x1f);
-        switch(type)
-        {
-            case dtl::SES_DELETE:
-                toScintilla::SendScintilla(QsciScintillaBase::SCI_SETSTYLING, line.txt.length()+1, QsciLexerDiff::LineRemoved);
-                break;
-            case dtl::SES_COMMON:
-                toScintilla::SendScintilla(QsciScintillaBase::SCI_SETSTYLING, line.txt.length(), QsciLexerDiff::Default);
-                break;
-            case dtl::SES_ADD:
-                toScintilla::SendScintilla(QsciScintillaBase::SCI_SETSTYLING, line.txt.length()+1, QsciLexerDiff::LineAdded);
-                break;
-            default:
-                toScintilla::SendScintilla(QsciScintillaBase::SCI_SETSTYLING, line.txt.length(), QsciLexerDiff::Default);
-        }
-        lineNumber++;
+        toLineDiff::EditType type = edits[first].Type;
+        int last = first;
+        while (last + 1 < lines && edits[last + 1].Type == type)
+            last++;
+
+        long start = toScintilla::positionFromLineIndex(first, 0);
+        long end = toScintilla::positionFromLineIndex(last + 1, 0);
+        int style = QsciLexerDiff::Default;
+        if (type == toLineDiff::Delete)
+            style = QsciLexerDiff::LineRemoved;
+        else if (type == toLineDiff::Add)
+            style = QsciLexerDiff::LineAdded;
+        toScintilla::SendScintilla(QsciScintillaBase::SCI_STARTSTYLING, start, 0x1f);
+        toScintilla::SendScintilla(QsciScintillaBase::SCI_SETSTYLING, end - start, style);
+
+        first = last + 1;
     }
 }
 
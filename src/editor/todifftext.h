@@ -35,6 +35,7 @@
 #pragma once
 
 #include "widgets/toscintilla.h"
+#include "editor/tolinediff.h"
 
 #include <QtCore/QString>
 
@@ -57,5 +58,16 @@ public:
 
     void setText(const QString &oldTxt, const QString &newTxt);
 
+    /** Select the diff algorithm used by subsequent @ref setText calls.
+     * The default picks dtl for small texts and the linear space one otherwise.
+     */
+    void setAlgorithm(toLineDiff::Algorithm algorithm)
+    {
+        Algorithm = algorithm;
+    }
+
+private:
+    toLineDiff::Algorithm Algorithm;
+
     private slots:
 };
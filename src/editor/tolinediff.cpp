@@ -0,0 +1,283 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "editor/tolinediff.h"
+
+#include <dtl/dtl.hpp>
+
+#include <QtCore/QHash>
+
+std::vector<toLineDiff::Edit> toLineDiff::diff(const QStringList &oldLines,
+        const QStringList &newLines,
+        Algorithm algorithm)
+{
+    // Give every distinct line an id, equal lines get equal ids
+    QHash<QString, int> ids;
+    ids.reserve(oldLines.size() + newLines.size());
+    std::vector<int> a, b;
+    a.reserve(oldLines.size());
+    b.reserve(newLines.size());
+    foreach(const QString &line, oldLines)
+    {
+        QHash<QString, int>::const_iterator i = ids.constFind(line);
+        if (i == ids.constEnd())
+            i = ids.insert(line, ids.size());
+        a.push_back(i.value());
+    }
+    foreach(const QString &line, newLines)
+    {
+        QHash<QString, int>::const_iterator i = ids.constFind(line);
+        if (i == ids.constEnd())
+            i = ids.insert(line, ids.size());
+        b.push_back(i.value());
+    }
+
+    toLineDiff d(a, b);
+    int xoff = 0, xlim = a.size();
+    int yoff = 0, ylim = b.size();
+    while (xoff < xlim && yoff < ylim && a[xoff] == b[yoff])
+    {
+        xoff++;
+        yoff++;
+    }
+    while (xlim > xoff && ylim > yoff && a[xlim - 1] == b[ylim - 1])
+    {
+        xlim--;
+        ylim--;
+    }
+
+    if (algorithm == Classic ||
+            (algorithm == Automatic && (xlim - xoff) + (ylim - yoff) <= ClassicLimit))
+        d.classic(xoff, xlim, yoff, ylim);
+    else
+        d.compare(xoff, xlim, yoff, ylim);
+
+    std::vector<Edit> ret;
+    ret.reserve((std::max)(a.size(), b.size()));
+    int i = 0, j = 0;
+    int n = a.size(), m = b.size();
+    while (i < n || j < m)
+    {
+        Edit e;
+        if (i < n && d.ChangedA[i])
+        {
+            e.Type = Delete;
+            e.OldLine = i++;
+            e.NewLine = -1;
+        }
+        else if (j < m && d.ChangedB[j])
+        {
+            e.Type = Add;
+            e.OldLine = -1;
+            e.NewLine = j++;
+        }
+        else
+        {
+            e.Type = Common;
+            e.OldLine = i++;
+            e.NewLine = j++;
+        }
+        ret.push_back(e);
+    }
+    return ret;
+}
+
+toLineDiff::toLineDiff(const std::vector<int> &a, const std::vector<int> &b)
+    : A(a)
+    , B(b)
+    , ChangedA(a.size(), false)
+    , ChangedB(b.size(), false)
+{
+}
+
+void toLineDiff::compare(int xoff, int xlim, int yoff, int ylim)
+{
+    while (xoff < xlim && yoff < ylim && A[xoff] == B[yoff])
+    {
+        xoff++;
+        yoff++;
+    }
+    while (xlim > xoff && ylim > yoff && A[xlim - 1] == B[ylim - 1])
+    {
+        xlim--;
+        ylim--;
+    }
+
+    if (xoff == xlim)
+    {
+        for (int j = yoff; j < ylim; j++)
+            ChangedB[j] = true;
+    }
+    else if (yoff == ylim)
+    {
+        for (int i = xoff; i < xlim; i++)
+            ChangedA[i] = true;
+    }
+    else
+        bisect(xoff, xlim, yoff, ylim);
+}
+
+void toLineDiff::classic(int xoff, int xlim, int yoff, int ylim)
+{
+    std::vector<int> a(A.begin() + xoff, A.begin() + xlim);
+    std::vector<int> b(B.begin() + yoff, B.begin() + ylim);
+
+    dtl::Diff<int, std::vector<int> > d(a, b);
+    d.compose();
+
+    int i = xoff, j = yoff;
+    auto seq = d.getSes().getSequence();
+    for (auto &e : seq)
+    {
+        switch (e.second.type)
+        {
+            case dtl::SES_DELETE:
+                ChangedA[i++] = true;
+                break;
+            case dtl::SES_ADD:
+                ChangedB[j++] = true;
+                break;
+            default:
+                i++;
+                j++;
+        }
+    }
+}
+
+/**
+ * Find the middle snake of the edit graph by running the search from both
+ * ends at once, then recurse on both halves. Only the furthest reaching
+ * x for each diagonal is kept, so memory is linear in the input size.
+ */
+void toLineDiff::bisect(int xoff, int xlim, int yoff, int ylim)
+{
+    const int n = xlim - xoff;
+    const int m = ylim - yoff;
+    const int maxD = (n + m + 1) / 2;
+    const int offset = maxD;
+    const int length = 2 * maxD + 2;
+    std::vector<int> v1(length, -1);
+    std::vector<int> v2(length, -1);
+    v1[offset + 1] = 0;
+    v2[offset + 1] = 0;
+
+    const int delta = n - m;
+    // If the total number of lines is odd the forward path collides with the reverse one
+    const bool front = (delta % 2 != 0);
+    int k1start = 0, k1end = 0, k2start = 0, k2end = 0;
+
+    for (int d = 0; d < maxD; d++)
+    {
+        // forward path
+        for (int k1 = -d + k1start; k1 <= d - k1end; k1 += 2)
+        {
+            int k1off = offset + k1;
+            int x1;
+            if (k1 == -d || (k1 != d && v1[k1off - 1] < v1[k1off + 1]))
+                x1 = v1[k1off + 1];
+            else
+                x1 = v1[k1off - 1] + 1;
+            int y1 = x1 - k1;
+            while (x1 < n && y1 < m && A[xoff + x1] == B[yoff + y1])
+            {
+                x1++;
+                y1++;
+            }
+            v1[k1off] = x1;
+            if (x1 > n)
+                k1end += 2;         // ran off the right of the graph
+            else if (y1 > m)
+                k1start += 2;       // ran off the bottom of the graph
+            else if (front)
+            {
+                int k2off = offset + delta - k1;
+                if (k2off >= 0 && k2off < length && v2[k2off] != -1)
+                {
+                    // mirror x2 onto the top-left coordinate system
+                    int x2 = n - v2[k2off];
+                    if (x1 >= x2)
+                    {
+                        compare(xoff, xoff + x1, yoff, yoff + y1);
+                        compare(xoff + x1, xlim, yoff + y1, ylim);
+                        return;
+                    }
+                }
+            }
+        }
+
+        // reverse path
+        for (int k2 = -d + k2start; k2 <= d - k2end; k2 += 2)
+        {
+            int k2off = offset + k2;
+            int x2;
+            if (k2 == -d || (k2 != d && v2[k2off - 1] < v2[k2off + 1]))
+                x2 = v2[k2off + 1];
+            else
+                x2 = v2[k2off - 1] + 1;
+            int y2 = x2 - k2;
+            while (x2 < n && y2 < m && A[xlim - x2 - 1] == B[ylim - y2 - 1])
+            {
+                x2++;
+                y2++;
+            }
+            v2[k2off] = x2;
+            if (x2 > n)
+                k2end += 2;
+            else if (y2 > m)
+                k2start += 2;
+            else if (!front)
+            {
+                int k1off = offset + delta - k2;
+                if (k1off >= 0 && k1off < length && v1[k1off] != -1)
+                {
+                    int x1 = v1[k1off];
+                    int y1 = offset + x1 - k1off;
+                    x2 = n - x2;
+                    if (x1 >= x2)
+                    {
+                        compare(xoff, xoff + x1, yoff, yoff + y1);
+                        compare(xoff + x1, xlim, yoff + y1, ylim);
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+    // No common line at all
+    for (int i = xoff; i < xlim; i++)
+        ChangedA[i] = true;
+    for (int j = yoff; j < ylim; j++)
+        ChangedB[j] = true;
+}
@@ -0,0 +1,99 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include <QtCore/QStringList>
+
+#include <vector>
+
+/**
+ * Line based difference of two texts.
+ *
+ * Lines are first mapped to integer ids so that all further comparisons
+ * are integer compares, then the unchanged prefix and suffix are trimmed.
+ * Small remainders are handed to dtl, larger ones are compared with the
+ * linear space divide and conquer variant of Myers' O(ND) algorithm which
+ * only needs two vectors of size O(N + M) at each recursion level instead
+ * of the whole edit graph.
+ */
+class toLineDiff
+{
+    public:
+        enum Algorithm
+        {
+            Automatic,   // dtl for small inputs, linear space otherwise
+            Classic,     // always dtl
+            LinearSpace  // always linear space
+        };
+
+        enum EditType
+        {
+            Common,
+            Delete,
+            Add
+        };
+
+        /** One line of the edit script, lines are 0 based, -1 when not applicable */
+        struct Edit
+        {
+            EditType Type;
+            int OldLine;
+            int NewLine;
+        };
+
+        /** Number of lines (after trimming) up to which @ref Automatic uses dtl */
+        static const int ClassicLimit = 2000;
+
+        /**
+         * Compute the edit script turning @p oldLines into @p newLines.
+         * Deleted lines of a hunk come before added ones.
+         */
+        static std::vector<Edit> diff(const QStringList &oldLines,
+                                      const QStringList &newLines,
+                                      Algorithm algorithm = Automatic);
+
+    private:
+        toLineDiff(const std::vector<int> &a, const std::vector<int> &b);
+
+        void compare(int xoff, int xlim, int yoff, int ylim);
+        void classic(int xoff, int xlim, int yoff, int ylim);
+        void bisect(int xoff, int xlim, int yoff, int ylim);
+
+        const std::vector<int> &A;
+        const std::vector<int> &B;
+        // Lines not part of the common subsequence
+        std::vector<bool> ChangedA;
+        std::vector<bool> ChangedB;
+};
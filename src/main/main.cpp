@@ -58,8 +58,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <chrono>
+#include <future>
 #include <memory>
 #include <typeinfo>
+#include <vector>
 
 #include <QtCore/QTextCodec>
 #include <QtCore/QString>
@@ -69,12 +72,82 @@
 #include <QtCore/QDebug>
 #include <QtCore/QDateTime>
 #include <QtCore/QSettings>
+#include <QtCore/QElapsedTimer>
 #include <QProgressBar>
 #include <QStyleFactory>
 #include <QApplication>
 #include <QMessageBox>
 #include <QtNetwork/QNetworkProxyFactory>
 
+namespace
+{
+    /** Result of one connection provider finder, run on its own thread */
+    struct toFinderResult
+    {
+        QString Name;
+        QList<toConnectionProviderFinder::ConnectionProvirerParams> Found;
+        QString Error;
+        qint64 Elapsed;
+    };
+
+    /** Runs on a worker thread, the finder was prepared on the main thread */
+    toFinderResult runFinder(toConnectionProviderFinder *finder)
+    {
+        toFinderResult retval;
+        retval.Name = finder->name();
+        QElapsedTimer timer;
+        timer.start();
+        try
+        {
+            retval.Found = finder->find();
+        }
+        catch (QString const& e)
+        {
+            retval.Error = e;
+        }
+        catch (std::exception const& e)
+        {
+            retval.Error = QString::fromLocal8Bit(e.what());
+        }
+        catch (...)
+        {
+            retval.Error = QString::fromLatin1("Unknown exception");
+        }
+        retval.Elapsed = timer.elapsed();
+        return retval;
+    }
+
+    /** Per phase startup timing, written to the log once the main window is up */
+    class toStartupTimer
+    {
+        public:
+            toStartupTimer()
+            {
+                Total.start();
+                Phase.start();
+            }
+            void phase(QString const& name)
+            {
+                Phases << qMakePair(name, Phase.restart());
+            }
+            void detail(QString const& name, qint64 elapsed)
+            {
+                Phases << qMakePair(QString::fromLatin1("  ") + name, elapsed);
+            }
+            void log() const
+            {
+                TLOG(5, toDecoratorNC, __HERE__) << "Startup timing:" << std::endl;
+                for (int i = 0; i < Phases.size(); i++)
+                    TLOG(5, toNoDecorator, __HERE__) << "  " << Phases[i].first << ": " << Phases[i].second << " ms" << std::endl;
+                TLOG(5, toNoDecorator, __HERE__) << "  total: " << Total.elapsed() << " ms" << std::endl;
+            }
+        private:
+            QElapsedTimer Total;
+            QElapsedTimer Phase;
+            QList<QPair<QString, qint64> > Phases;
+    };
+}
+
 int main(int argc, char **argv)
 {
     /* This is probably needed for toWorksheet parser threads
@@ -92,6 +165,7 @@ int main(int argc, char **argv)
         break it (e.g. qscintilla lexers etc.).
      */
     QApplication app(argc, argv);
+    toStartupTimer startup;
 
     /*! Try to transfer some config options from Tora 2.x */
     {
@@ -149,6 +223,8 @@ int main(int argc, char **argv)
             qApp->installTranslator(&toadbindings);
         }
 
+        startup.phase("application setup");
+
         {
             toSplash splash(NULL);
             splash.show();
@@ -210,6 +286,7 @@ int main(int argc, char **argv)
             QLabel *label = splash.label();
             progress->setRange(1, plugins.size() + finders.size()*2);
             qApp->processEvents();
+            startup.phase("splash");
             Q_FOREACH(QString path, plugins)
             {
                 label->setText(qApp->translate("main", "Loading plugin %1").arg(path));
@@ -236,90 +313,104 @@ int main(int argc, char **argv)
                 qApp->processEvents();
             }
 
-            // Loop over all finders and call their "find" method, each of them can return several locations
+            startup.phase("plugins");
+
+            // Run all finders in parallel, each of them can return several locations.
+            // Results are collected in the factory order so the provider selection below
+            // does not depend on which finder returns first.
+            label->setText(qApp->translate("main", "Looking for database clients..."));
+            qApp->processEvents();
+            // Only the file system probing runs in parallel, the finders read
+            // the configuration and Qt global state in prepare() on this thread.
+            std::vector<std::unique_ptr<toConnectionProviderFinder> > instances;
+            std::vector<std::future<toFinderResult> > pending;
+            QList<toFinderResult> found;
             for (std::vector<std::string>::const_iterator i = finders.begin(); i != finders.end(); ++i)
             {
-                QString finderName(i->c_str());
-                label->setText(qApp->translate("main", "Looking for %1").arg(finderName));
-                qApp->processEvents();
                 TLOG(5, toDecoratorNC, __HERE__) << "Looking for client: " << *i << std::endl;
+                std::unique_ptr<toConnectionProviderFinder> finder;
                 try
                 {
-                    std::unique_ptr<toConnectionProviderFinder> finder = ConnectionProviderFinderFactory::Instance().create(*i, 0);
-                    QList<toConnectionProviderFinder::ConnectionProvirerParams> l = finder->find();
-                    allProviders.append(l);
-                    finderName = finder->name();
+                    finder = ConnectionProviderFinderFactory::Instance().create(*i, 0);
+                    finder->prepare();
                 }
-                TOCATCH;
+                catch (QString const& e)
+                {
+                    Utils::toStatusMessage(e);
+                    finder.reset();
+                }
+                catch (std::exception const& e)
+                {
+                    Utils::toStatusMessage(QString::fromLocal8Bit(e.what()));
+                    finder.reset();
+                }
+                if (!finder)
+                {
+                    progress->setValue(progress->value()+1);
+                    continue;
+                }
+                pending.push_back(std::async(std::launch::async, runFinder, finder.get()));
+                instances.push_back(std::move(finder));
+            }
+            for (std::vector<std::future<toFinderResult> >::iterator i = pending.begin(); i != pending.end(); ++i)
+            {
+                while (i->wait_for(std::chrono::milliseconds(20)) != std::future_status::ready)
+                    qApp->processEvents();
+                toFinderResult result = i->get();
+                if (!result.Error.isEmpty())
+                    Utils::toStatusMessage(result.Error);
+                allProviders.append(result.Found);
+                found << result;
                 progress->setValue(progress->value()+1);
                 qApp->processEvents();
             }
+            startup.phase("provider discovery");
+            Q_FOREACH(toFinderResult const& result, found)
+                startup.detail(result.Name, result.Elapsed);
 
             label->setText(qApp->translate("main", "Examinating Oracle clients..."));
             qApp->processEvents();
 
-            // Loop over all providers found and try to load desired Oracle client
-            // 1st try to load requested Oracle client (if set) then load thick (TNS) Oracle client
+            // Providers are only registered here, their libraries are loaded
+            // when the first connection of that type is requested.
+            toConnectionProviderRegistry &registry = toConnectionProviderRegistrySing::Instance();
+
+            // Order the Oracle clients to try:
+            // 1st the requested Oracle client (if set) then the thick (TNS) Oracle client,
+            // the remaining clients follow. The first one which loads is used.
             QDir oHome = toConfigurationNewSingle::Instance().option(ToConfiguration::Global::OracleHomeDirectory).toString();
             Q_FOREACH(toConnectionProviderFinder::ConnectionProvirerParams const& params, allProviders)
             {
-                QString providerName = params.value("PROVIDER").toString();
-                if ( params.value("PROVIDER").toString() != ORACLE_PROVIDER)
+                if (params.value("PROVIDER").toString() != ORACLE_PROVIDER)
                     continue;
                 QDir pHome(params.value("ORACLE_HOME").toString());
                 if (oHome != pHome)
                     continue;
-                try
-                {
-                    label->setText(qApp->translate("main", "Loading provider %1").arg(providerName));
-                    qApp->processEvents();
-                    TLOG(5, toDecoratorNC, __HERE__) << "Loading: " << params.value("PATH").toString() << std::endl;
-                    toConnectionProviderRegistrySing::Instance().load(params);
-                    progress->setValue(progress->value()+1);
-                    qApp->processEvents();
-                    break;
-                }
-                TOCATCH;
+                TLOG(5, toDecoratorNC, __HERE__) << "Registering: " << params.value("PATH").toString() << std::endl;
+                registry.defer(params);
             }
             Q_FOREACH(toConnectionProviderFinder::ConnectionProvirerParams const& params, allProviders)
             {
-                QString providerName = params.value("PROVIDER").toString();
                 if (params.value("PROVIDER").toString() != ORACLE_PROVIDER)
                     continue;
                 if (params.value("IS INSTANT").toBool() == true)
                     continue;
-                if (toConnectionProviderRegistrySing::Instance().providers().contains(providerName))
-                    continue;
-                try
-                {
-                    label->setText(qApp->translate("main", "Loading provider %1").arg(providerName));
-                    qApp->processEvents();
-                    TLOG(5, toDecoratorNC, __HERE__) << "Loading: " << params.value("PATH").toString() << std::endl;
-                    //! \todo This is unused variable and can be safely deleted from code:
-                    //QString providerName = params.value("PROVIDER").toString();
-                    toConnectionProviderRegistrySing::Instance().load(params);
-                    progress->setValue(progress->value()+1);
-                    qApp->processEvents();
-                    break;
-                }
-                TOCATCH;
+                TLOG(5, toDecoratorNC, __HERE__) << "Registering: " << params.value("PATH").toString() << std::endl;
+                registry.defer(params);
             }
-            // Load all remaining providers
+            // Register all remaining providers, for providers already registered they are fallbacks
             Q_FOREACH(toConnectionProviderFinder::ConnectionProvirerParams provider, allProviders)
             {
                 QString providerName = provider.value("PROVIDER").toString();
-                if (toConnectionProviderRegistrySing::Instance().providers().contains(providerName))
+                bool known = registry.providers().contains(providerName);
+                registry.defer(provider);
+                if (known)
                     continue;
-                try
-                {
-                    label->setText(qApp->translate("main", "Loading provider %1").arg(providerName));
-                    qApp->processEvents();
-                    toConnectionProviderRegistrySing::Instance().load(provider);
-                    progress->setValue(progress->value()+1);
-                    qApp->processEvents();
-                }
-                TOCATCH;
+                label->setText(qApp->translate("main", "Registering provider %1").arg(providerName));
+                progress->setValue(progress->value()+1);
             }
+            qApp->processEvents();
+            startup.phase("provider registration");
 
         } // end splash
 
@@ -337,6 +428,7 @@ int main(int argc, char **argv)
         {
             TLOG(1, toDecorator, __HERE__) << "	Ignored exception." << std::endl;
         }
+        startup.phase("custom SQL");
 
         if (toConfigurationNewSingle::Instance().option(ToConfiguration::Main::LastVersion).toString() != TORAVERSION)
         {
@@ -360,7 +452,11 @@ int main(int argc, char **argv)
         qRegisterMetaType<toConnection::exception>("toConnection::exception");
         qRegisterMetaType<toDictionary>("toDictionary");
 
+        startup.phase("settings");
+
         new toMain;
+        startup.phase("main window");
+        startup.log();
 
         int ret = qApp->exec();
         return ret;
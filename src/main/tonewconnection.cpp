@@ -93,8 +93,8 @@ toNewConnection::toNewConnection(QWidget* parent, toWFlags fl)
             }
             else
             {
-                toConnectionProvider &provider = toConnectionProviderRegistrySing::Instance().get(p);
-                Provider->addItem(provider.displayName(), QVariant(provider.name()));
+                // Do not load deferred providers just to list them
+                Provider->addItem(toConnectionProviderRegistrySing::Instance().displayName(p), QVariant(p));
             }
         }
         TOCATCH
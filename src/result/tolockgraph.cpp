@@ -0,0 +1,487 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "result/tolockgraph.h"
+#include "core/tosql.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+
+#include <algorithm>
+
+static toSQL SQLLockSnapshot("toLockGraph:Snapshot",
+                             "select l.inst_id                                                   as \"Instance\",   \n"
+                             "       l.sid                                                       as \"Session\",    \n"
+                             "       s.serial#                                                   as \"Serial#\",    \n"
+                             "       s.schemaname                                                as Schema,         \n"
+                             "       s.osuser                                                    as Osuser,         \n"
+                             "       s.program                                                   as Program,        \n"
+                             "       l.type                                                      as Type,           \n"
+                             "       l.id1                                                       as Id1,            \n"
+                             "       l.id2                                                       as Id2,            \n"
+                             "       l.lmode                                                     as \"Mode\",       \n"
+                             "       l.request                                                   as Request,        \n"
+                             "       l.ctime                                                     as Seconds,        \n"
+                             "       s.event                                                     as Event,          \n"
+                             "       decode(o.object_id, null, null, o.owner||'.'||o.object_name) as Object,        \n"
+                             "       decode(l.inst_id, sys_context('USERENV', 'INSTANCE'), 1, 0) as \"Local\"       \n"
+                             "  from gv$lock l, gv$session s, sys.all_objects o                                     \n"
+                             " where s.inst_id = l.inst_id                                                          \n"
+                             "   and s.sid = l.sid                                                                  \n"
+                             "   and (l.request > 0 or l.block != 0)                                                \n"
+                             "   and o.object_id (+) = decode(l.type, 'TM', l.id1,                                  \n"
+                             "                                decode(l.request, 0, null, s.row_wait_obj#))          \n"
+                             " order by l.inst_id, l.sid",
+                             "Snapshot of enqueues somebody waits for or which block somebody, "
+                             "used to build the blocking graph on the client. "
+                             "Must return the columns in the same order");
+
+namespace
+{
+    QString lockMode(const toQValue &mode)
+    {
+        switch (mode.toInt())
+        {
+            case 0:
+                return QString::fromLatin1("None");
+            case 1:
+                return QString::fromLatin1("Null");
+            case 2:
+                return QString::fromLatin1("Row-S");
+            case 3:
+                return QString::fromLatin1("Row-X");
+            case 4:
+                return QString::fromLatin1("Share");
+            case 5:
+                return QString::fromLatin1("S/Row-X");
+            case 6:
+                return QString::fromLatin1("Exclusive");
+        }
+        return QString::number(mode.toInt());
+    }
+
+    QHash<QString, QString> lockTypeNames()
+    {
+        QHash<QString, QString> names;
+        names.insert("MR", "Media Recovery");
+        names.insert("RT", "Redo Thread");
+        names.insert("UN", "User Name");
+        names.insert("TX", "Transaction");
+        names.insert("TM", "DML");
+        names.insert("UL", "PL/SQL User Lock");
+        names.insert("DX", "Distributed Xaction");
+        names.insert("CF", "Control File");
+        names.insert("IS", "Instance State");
+        names.insert("FS", "File Set");
+        names.insert("IR", "Instance Recovery");
+        names.insert("ST", "Disk Space Transaction");
+        names.insert("TS", "Temp Segment");
+        names.insert("IV", "Library Cache Invalidation");
+        names.insert("LS", "Log Start or Switch");
+        names.insert("RW", "Row Wait");
+        names.insert("SQ", "Sequence Number");
+        names.insert("TE", "Extend Table");
+        names.insert("TT", "Temp Table");
+        return names;
+    }
+
+    QString lockType(const QString &type)
+    {
+        // Initialized once, the graph may be built by several workers at a time
+        static const QHash<QString, QString> names = lockTypeNames();
+        return names.value(type, QString::fromLatin1("Internal (%1)").arg(type));
+    }
+}
+
+toLockGraph toLockGraph::build(const toQueryAbstr::RowList &snapshot)
+{
+    toLockGraph graph;
+    graph.Snapshot = snapshot;
+
+    QHash<QString, int> sessions;
+    QHash<QString, QList<int> > holders;
+    QHash<QString, QList<int> > waiters;
+    QVector<int> owner(snapshot.size(), -1);
+
+    for (int i = 0; i < snapshot.size(); i++)
+    {
+        const toQueryAbstr::Row &row = snapshot.at(i);
+        if (row.size() < SnapshotColumns)
+            continue;
+
+        QString sid = row.at(SidColumn);
+        QString key = QString::fromLatin1("%1:%2").arg(QString(row.at(InstColumn))).arg(sid);
+        int session = sessions.value(key, -1);
+        if (session == -1)
+        {
+            Session s;
+            s.Key = key;
+            s.Sid = sid;
+            s.Local = row.at(LocalColumn).toInt() == 1;
+            s.Row = i;
+            session = graph.Sessions.size();
+            graph.Sessions.append(s);
+            sessions.insert(key, session);
+        }
+        owner[i] = session;
+
+        // The same resource is shared by all RAC instances
+        QString resource = QString::fromLatin1("%1:%2:%3")
+                           .arg(QString(row.at(TypeColumn)))
+                           .arg(QString(row.at(Id1Column)))
+                           .arg(QString(row.at(Id2Column)));
+        if (row.at(RequestColumn).toInt() > 0)
+        {
+            if (graph.Sessions[session].Wait == -1)
+                graph.Sessions[session].Wait = i;
+            waiters[resource] << i;
+        }
+        if (row.at(ModeColumn).toInt() > 0)
+            holders[resource] << i;
+    }
+
+    for (QHash<QString, QList<int> >::const_iterator r = waiters.constBegin(); r != waiters.constEnd(); r++)
+    {
+        QList<int> held = holders.value(r.key());
+        for (int w : r.value())
+        {
+            int waiter = owner.at(w);
+            int requested = snapshot.at(w).at(RequestColumn).toInt();
+            for (int h : held)
+            {
+                int blocker = owner.at(h);
+                if (blocker == waiter || compatible(snapshot.at(h).at(ModeColumn).toInt(), requested))
+                    continue;
+                if (graph.Sessions[waiter].Blockers.contains(blocker))
+                    continue;
+                graph.Sessions[waiter].Blockers << blocker;
+                graph.Sessions[blocker].Waiters << waiter;
+                if (graph.Sessions[blocker].Hold == -1)
+                    graph.Sessions[blocker].Hold = h;
+            }
+        }
+    }
+
+    graph.findCycles();
+    graph.rank();
+    return graph;
+}
+
+bool toLockGraph::compatible(int held, int requested)
+{
+    // Null, Row-S, Row-X, Share, S/Row-X, Exclusive
+    static const bool matrix[6][6] =
+    {
+        { true, true,  true,  true,  true,  true  },
+        { true, true,  true,  true,  true,  false },
+        { true, true,  true,  false, false, false },
+        { true, true,  false, true,  false, false },
+        { true, true,  false, false, false, false },
+        { true, false, false, false, false, false },
+    };
+    if (held < 1 || held > 6 || requested < 1 || requested > 6)
+        return true;
+    return matrix[held - 1][requested - 1];
+}
+
+void toLockGraph::findCycles()
+{
+    // Tarjan's strongly connected components over the waiter -> blocker
+    // edges, iterative as chains can be long. Any component with more than
+    // one session is a deadlock.
+    int count = Sessions.size();
+    QVector<int> index(count, -1);
+    QVector<int> low(count, 0);
+    QVector<bool> onStack(count, false);
+    QVector<int> stack;
+    QVector<QPair<int, int> > calls;
+    int counter = 0;
+
+    for (int start = 0; start < count; start++)
+    {
+        if (index.at(start) != -1 || Sessions.at(start).Blockers.isEmpty())
+            continue;
+
+        index[start] = low[start] = counter++;
+        stack.append(start);
+        onStack[start] = true;
+        calls.append(qMakePair(start, 0));
+
+        while (!calls.isEmpty())
+        {
+            int v = calls.last().first;
+            const QList<int> &edges = Sessions.at(v).Blockers;
+            if (calls.last().second < edges.size())
+            {
+                int w = edges.at(calls.last().second++);
+                if (index.at(w) == -1)
+                {
+                    index[w] = low[w] = counter++;
+                    stack.append(w);
+                    onStack[w] = true;
+                    calls.append(qMakePair(w, 0));
+                }
+                else if (onStack.at(w))
+                {
+                    low[v] = qMin(low.at(v), index.at(w));
+                }
+                continue;
+            }
+
+            calls.removeLast();
+            if (!calls.isEmpty())
+            {
+                int u = calls.last().first;
+                low[u] = qMin(low.at(u), low.at(v));
+            }
+
+            if (low.at(v) == index.at(v))
+            {
+                QList<int> component;
+                int w;
+                do
+                {
+                    w = stack.takeLast();
+                    onStack[w] = false;
+                    component << w;
+                }
+                while (w != v);
+
+                if (component.size() > 1)
+                {
+                    for (int s : component)
+                        Sessions[s].Deadlocked = true;
+                    Cycles << component;
+                }
+            }
+        }
+    }
+}
+
+void toLockGraph::rank()
+{
+    for (int i = 0; i < Sessions.size(); i++)
+    {
+        if (Sessions.at(i).Waiters.isEmpty())
+            continue;
+
+        QSet<int> seen;
+        QList<int> queue = Sessions.at(i).Waiters;
+        while (!queue.isEmpty())
+        {
+            int s = queue.takeFirst();
+            if (s == i || seen.contains(s))
+                continue;
+            seen.insert(s);
+            queue << Sessions.at(s).Waiters;
+        }
+        Sessions[i].Blocked = seen.size();
+    }
+
+    // Sessions not waiting for anybody else, waiters whose blocker is
+    // unknown included, and one session of each deadlock
+    for (int i = 0; i < Sessions.size(); i++)
+    {
+        const Session &s = Sessions.at(i);
+        if (s.Blockers.isEmpty() && (!s.Waiters.isEmpty() || s.Wait != -1))
+            Roots << i;
+    }
+    for (const QList<int> &cycle : Cycles)
+    {
+        int best = cycle.first();
+        for (int s : cycle)
+            if (Sessions.at(s).Blocked > Sessions.at(best).Blocked)
+                best = s;
+        Roots << best;
+    }
+
+    std::stable_sort(Roots.begin(), Roots.end(), [this](int a, int b)
+    {
+        const Session &l = Sessions.at(a);
+        const Session &r = Sessions.at(b);
+        if (l.Blocked != r.Blocked)
+            return l.Blocked > r.Blocked;
+        int lrow = l.Hold != -1 ? l.Hold : l.Row;
+        int rrow = r.Hold != -1 ? r.Hold : r.Row;
+        return Snapshot.at(lrow).at(TimeColumn).toLong() > Snapshot.at(rrow).at(TimeColumn).toLong();
+    });
+}
+
+toQueryAbstr::HeaderList toLockGraph::headers()
+{
+    static const char *names[] =
+    {
+        "Session", "Serial#", "Schema", "Osuser", "Program", "Type", "Mode", "Request",
+        "Object", "Event", "Seconds", "Waiters", "State", NULL
+    };
+
+    toQueryAbstr::HeaderList headers;
+    for (int i = 0; names[i]; i++)
+    {
+        toQueryAbstr::HeaderDesc d;
+        d.name = d.name_orig = QString::fromLatin1(names[i]);
+        d.datatype = QString::fromLatin1("VARCHAR2");
+        d.hidden = false;
+        headers << d;
+    }
+    return headers;
+}
+
+toQueryAbstr::RowList toLockGraph::rows(const QString &sid) const
+{
+    QSet<int> focus;
+    if (!sid.isEmpty())
+    {
+        for (int i = 0; i < Sessions.size(); i++)
+            if (Sessions.at(i).Local && Sessions.at(i).Sid == sid)
+                focus.insert(i);
+    }
+
+    toQueryAbstr::RowList out;
+    QList<int> path;
+    for (int root : Roots)
+    {
+        if (!sid.isEmpty())
+        {
+            bool found = false;
+            QSet<int> seen;
+            QList<int> queue;
+            queue << root;
+            while (!queue.isEmpty() && !found)
+            {
+                int s = queue.takeFirst();
+                if (seen.contains(s))
+                    continue;
+                seen.insert(s);
+                found = focus.contains(s);
+                queue << Sessions.at(s).Waiters;
+            }
+            if (!found)
+                continue;
+        }
+        flatten(root, 0, path, out);
+    }
+    return out;
+}
+
+void toLockGraph::flatten(int session, int level, QList<int> &path, toQueryAbstr::RowList &out) const
+{
+    const Session &s = Sessions.at(session);
+    bool repeated = path.contains(session);
+
+    int lock = s.Wait != -1 ? s.Wait : (s.Hold != -1 ? s.Hold : s.Row);
+    const toQueryAbstr::Row &info = Snapshot.at(lock);
+    const toQueryAbstr::Row &held = Snapshot.at(s.Hold != -1 ? s.Hold : lock);
+
+    QString state;
+    if (repeated)
+        state = QString::fromLatin1("Deadlock (repeated)");
+    else if (s.Deadlocked)
+        state = QString::fromLatin1("Deadlock");
+    else if (s.Blockers.isEmpty() && !s.Waiters.isEmpty())
+        state = QString::fromLatin1("Root blocker");
+    else if (!s.Waiters.isEmpty())
+        state = QString::fromLatin1("Blocking");
+    else
+        state = QString::fromLatin1("Waiting");
+
+    toQueryAbstr::Row row;
+    if (level == 0)
+        row << toQValue(s.Key);
+    else
+        row << toQValue(QString::fromLatin1("+").leftJustified(level, '-') + QLatin1Char(' ') + s.Key);
+    row << info.at(SerialColumn)
+        << info.at(SchemaColumn)
+        << info.at(OsuserColumn)
+        << info.at(ProgramColumn)
+        << toQValue(lockType(info.at(TypeColumn)))
+        << toQValue(lockMode(held.at(ModeColumn)))
+        << toQValue(lockMode(s.Wait != -1 ? info.at(RequestColumn) : toQValue(0)))
+        << info.at(ObjectColumn)
+        << info.at(EventColumn)
+        << info.at(TimeColumn)
+        << toQValue(s.Blocked)
+        << toQValue(state);
+    out << row;
+
+    if (repeated)
+        return;
+
+    path << session;
+    for (int waiter : s.Waiters)
+        flatten(waiter, level + 1, path, out);
+    path.removeLast();
+}
+
+toLockGraphBuilder::toLockGraphBuilder(QObject *parent)
+    : QObject(parent)
+    , Thread(new QThread(this))
+    , Worker(new QObject)
+    , Generation(0)
+{
+    Thread->setObjectName("toLockGraphBuilder Thread");
+    Worker->moveToThread(Thread);
+    Thread->start();
+}
+
+toLockGraphBuilder::~toLockGraphBuilder()
+{
+    reset();
+    Thread->quit();
+    Thread->wait();
+    delete Worker;
+}
+
+void toLockGraphBuilder::build(const toQueryAbstr::RowList &snapshot, const QString &sid)
+{
+    unsigned generation = ++Generation;
+
+    QTimer::singleShot(0, Worker, [this, generation, snapshot, sid]
+    {
+        toQueryAbstr::RowList rows = toLockGraph::build(snapshot).rows(sid);
+        QTimer::singleShot(0, this, [this, generation, rows]
+        {
+            if (generation != Generation)
+                return;
+            emit built(toLockGraph::headers(), rows);
+        });
+    });
+}
+
+void toLockGraphBuilder::reset(void)
+{
+    Generation++;
+}
@@ -0,0 +1,183 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include "core/toquery.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+
+class QThread;
+
+/**
+ * Blocker/waiter graph of database sessions.
+ *
+ * The graph is built from one snapshot of gv$lock joined with gv$session
+ * (see toLockGraph:Snapshot). The snapshot holds every enqueue somebody is
+ * waiting for and every enqueue blocking somebody, waiters are matched with
+ * the holders of the same resource here on the client. As the resource is
+ * identified by (type, id1, id2) only, chains spanning RAC instances are
+ * found as well.
+ */
+class toLockGraph
+{
+    public:
+        /** Columns of the snapshot query */
+        enum SnapshotColumn
+        {
+            InstColumn = 0,
+            SidColumn,
+            SerialColumn,
+            SchemaColumn,
+            OsuserColumn,
+            ProgramColumn,
+            TypeColumn,
+            Id1Column,
+            Id2Column,
+            ModeColumn,
+            RequestColumn,
+            TimeColumn,
+            EventColumn,
+            ObjectColumn,
+            LocalColumn,
+            SnapshotColumns
+        };
+
+        struct Session
+        {
+            /** "instance:sid" */
+            QString Key;
+            QString Sid;
+            /** Session is connected to the instance the snapshot was taken on */
+            bool Local;
+            /** First snapshot row of this session */
+            int Row;
+            /** Snapshot row of the enqueue requested by this session, -1 if not waiting */
+            int Wait;
+            /** Snapshot row of the first enqueue held by this session blocking somebody, -1 if none */
+            int Hold;
+            /** Sessions this one is waiting for */
+            QList<int> Blockers;
+            /** Sessions waiting for this one */
+            QList<int> Waiters;
+            /** Number of sessions waiting for this one directly or indirectly */
+            int Blocked;
+            /** Session is part of a deadlock */
+            bool Deadlocked;
+
+            Session() : Local(false), Row(-1), Wait(-1), Hold(-1), Blocked(0), Deadlocked(false) {}
+        };
+
+        /** Build the graph from rows of the snapshot query */
+        static toLockGraph build(const toQueryAbstr::RowList &snapshot);
+
+        /** Column descriptions of @ref rows */
+        static toQueryAbstr::HeaderList headers();
+
+        /**
+         * Flatten the graph into a tree, one root blocker after another
+         * starting with the one holding up the most sessions.
+         *
+         * @param sid When not empty only the trees containing this session
+         *            of the local instance are returned.
+         */
+        toQueryAbstr::RowList rows(const QString &sid = QString()) const;
+
+        const QVector<Session>& sessions() const
+        {
+            return Sessions;
+        }
+
+        /** Sessions at the root of the trees, best ranked first */
+        const QList<int>& roots() const
+        {
+            return Roots;
+        }
+
+        /** Deadlocked groups of sessions */
+        const QList<QList<int> >& cycles() const
+        {
+            return Cycles;
+        }
+
+    private:
+        /** True if an enqueue held in @p held mode does not block a request in @p requested mode */
+        static bool compatible(int held, int requested);
+
+        void findCycles();
+        void rank();
+        void flatten(int session, int level, QList<int> &path, toQueryAbstr::RowList &out) const;
+
+        toQueryAbstr::RowList Snapshot;
+        QVector<Session> Sessions;
+        QList<int> Roots;
+        QList<QList<int> > Cycles;
+};
+
+/**
+ * Builds @ref toLockGraph in a worker thread.
+ *
+ * Matching thousands of enqueues and ranking the blockers is kept off the
+ * GUI thread, only the resulting rows are handed back to the view.
+ */
+class toLockGraphBuilder : public QObject
+{
+        Q_OBJECT;
+
+    public:
+        toLockGraphBuilder(QObject *parent);
+        virtual ~toLockGraphBuilder();
+
+        /**
+         * Start building the graph.
+         *
+         * A build still running is superseded, its result will not be reported.
+         * @param snapshot Rows of the snapshot query (implicitly shared, not copied).
+         * @param sid Passed to @ref toLockGraph::rows.
+         */
+        void build(const toQueryAbstr::RowList &snapshot, const QString &sid = QString());
+
+        /** Forget any build in progress */
+        void reset(void);
+
+    signals:
+        /** Emitted in the thread of the builder once the graph is ready */
+        void built(const toQueryAbstr::HeaderList &headers, const toQueryAbstr::RowList &rows);
+
+    private:
+        QThread *Thread;
+        QObject *Worker;
+        unsigned Generation;
+};
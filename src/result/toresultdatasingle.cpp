@@ -133,6 +133,8 @@ void toResultDataSingle::changeSource(toResultModelEdit *model, int _row)
             SIGNAL(dataChanged(const QModelIndex &, const QModelIndex &)),
             this,
             SLOT(dataChanged(const QModelIndex &, const QModelIndex &)));
+    // sorted
+    connect(Model, &QAbstractItemModel::layoutChanged, this, [this] { changeRow(Row); });
 }
 
 
@@ -33,6 +33,7 @@
  * END_COMMON_COPYRIGHT_HEADER */
 
 #include "result/toresultlock.h"
+#include "result/tolockgraph.h"
 
 #include "core/toconnection.h"
 #include "core/toeventquery.h"
@@ -65,63 +66,74 @@ toResultLock::toResultLock(QWidget *parent, const char *name)
 //    setAllColumnsShowFocus(true);
 //    setSorting( -1);
 //    setRootIsDecorated(true);
-    setSQLName(QString::fromLatin1("toResultLock:Locks"));
+    setSQLName(QString::fromLatin1("toLockGraph:Snapshot"));
+
+    Builder = new toLockGraphBuilder(this);
+    connect(Builder, &toLockGraphBuilder::built, this, &toResultLock::slotBuilt);
 }
 
 toResultLock::~toResultLock()
 {
 }
 
-static toSQL SQLLock("toResultLock:Locks",
-                     "select b.sid                                                                                 as \"Session\", \n"
-                     "       b.schemaname                                                                          as Schema,  \n"
-                     "       b.osuser                                                                              as Osuser,  \n"
-                     "       b.program                                                                             as Program, \n"
-                     "       decode(a.type,\n"
-                     "              'MR', 'Media Recovery',\n"
-                     "              'RT', 'Redo Thread',\n"
-                     "              'UN', 'User Name',\n"
-                     "              'TX', 'Transaction',\n"
-                     "              'TM', 'DML',\n"
-                     "              'UL', 'PL/SQL User Lock',\n"
-                     "              'DX', 'Distributed Xaction',\n"
-                     "              'CF', 'Control File',\n"
-                     "              'IS', 'Instance State',\n"
-                     "              'FS', 'File Set',\n"
-                     "              'IR', 'Instance Recovery',\n"
-                     "              'ST', 'Disk Space Transaction',\n"
-                     "              'TS', 'Temp Segment',\n"
-                     "              'IV', 'Library Cache Invalidation',\n"
-                     "              'LS', 'Log Start or Switch',\n"
-                     "              'RW', 'Row Wait',\n"
-                     "              'SQ', 'Sequence Number',\n"
-                     "              'TE', 'Extend Table',\n"
-                     "              'TT', 'Temp Table',\n"
-                     "              'Internal ('||a.type||')')                                                     as Type, \n"
-                     "       DECODE(a.lmode,0,'None',1,'Null',2,'Row-S',3,'Row-X',4,'Share',5,'S/Row-X',6,'Exclusive',TO_CHAR(a.lmode)) as \"Mode\", \n"
-                     "       DECODE(e.request,0,'None',1,'Null',2,'Row-S',3,'Row-X',4,'Share',5,'S/Row-X',6,'Exclusive',TO_CHAR(e.request)) as Request,\n"
-                     "       d.object_name                                                                         as Object,   \n"
-                     "       TO_CHAR(SYSDATE-a.CTIME/3600/24)                                                      as Grabbed,  \n"
-                     "       TO_CHAR(SYSDATE-e.CTIME/3600/24)                                                      as Requested \n"
-                     "  from v$lock a, v$session b,v$locked_object c,sys.all_objects d,v$lock e\n"
-                     " where a.sid = b.sid\n"
-                     "   and a.lmode != 0\n"
-                     "   and c.session_id = a.sid\n"
-                     "   and c.object_id = d.object_id\n"
-                     "   and exists (select 'X'\n"
-                     "                 from v$locked_object bb,\n"
-                     "                      v$lock cc\n"
-                     "                where bb.session_id = cc.sid\n"
-                     "                  and cc.sid != a.sid\n"
-                     "                  and cc.id1 = a.id1\n"
-                     "                  and cc.id2 = a.id2\n"
-                     "                  and bb.object_id = c.object_id)\n"
-                     "   and a.id1 = e.id1\n"
-                     "   and a.id2 = e.id2\n"
-                     "   and e.sid = :f1<char[101]>\n"
-                     "   and e.lmode != e.request\n"
-                     "   and e.request != 0",
-                     "List locks in a session");
+void toResultLock::refreshWithParams(toQueryParams const& params)
+{
+    QString focus = params.isEmpty() ? QString() : QString(params.first());
+
+    // Clicking through the sessions only filters the last snapshot
+    if (focus != Focus && SnapshotAge.isValid() && SnapshotAge.elapsed() < SnapshotReuse)
+    {
+        Focus = focus;
+        Model::clearAll();
+        Builder->build(Snapshot, Focus);
+        return;
+    }
+
+    Focus = focus;
+    Snapshot.clear();
+    SnapshotAge.invalidate();
+    Builder->reset();
+    ResutLock::MVC::refreshWithParams(toQueryParams());
+}
+
+void toResultLock::observeHeaders(const toQueryAbstr::HeaderList&)
+{
+    // Columns are set once the graph is built
+}
+
+void toResultLock::observeData(QObject *q)
+{
+    toEventQuery *query = dynamic_cast<toEventQuery*>(q);
+    if (!query)
+        return;
+
+    try
+    {
+        int columns = query->columnCount();
+        while (query->hasMore())
+        {
+            toQueryAbstr::Row row;
+            for (int i = 0; i < columns; i++)
+                row << query->readValue();
+            Snapshot << row;
+        }
+    }
+    TOCATCH
+}
+
+void toResultLock::observeDone()
+{
+    SnapshotAge.start();
+    Builder->build(Snapshot, Focus);
+}
+
+void toResultLock::slotBuilt(const toQueryAbstr::HeaderList &headers, const toQueryAbstr::RowList &rows)
+{
+    Model::clearAll();
+    Model::setHeaders(headers);
+    if (!rows.isEmpty())
+        Model::appendRows(rows);
+}
 
 //SELECT decode( a.blocker_sid , NULL , '<chain id#' ||a.chain_id||'>' ) chain_id,
 //       RPAD( '+' , LEVEL , '-' ) ||a.sid sid,
@@ -37,7 +37,10 @@
 #include "result/tomvc.h"
 #include "widgets/totreeview.h"
 
+#include <QtCore/QElapsedTimer>
+
 class toEventQuery;
+class toLockGraphBuilder;
 
 namespace Views
 {
@@ -51,6 +54,7 @@ namespace ResutLock
         static const bool AlternatingRowColorsEnabled = true;
         static const int  ShowRowNumber = NoRowNumber;
         static const int  ColumnResize = RowColumResize;
+        static const bool SortingEnabled = false;
 
         typedef Views::toTreeView View;
     };
@@ -77,7 +81,11 @@ namespace ResutLock
 }
 
 /**
- * A result table displaying information about locks
+ * A result table displaying sessions blocking each other.
+ *
+ * One snapshot of gv$lock and gv$session is fetched per refresh, the
+ * blocker/waiter trees, deadlocks and the ranking of the root blockers
+ * are computed from it in a worker thread (see @ref toLockGraph).
  */
 class toResultLock
         : public ResutLock::MVC
@@ -88,9 +96,30 @@ class toResultLock
         toResultLock(QWidget *parent, const char *name = "toResultLock");
         ~toResultLock();
 
+        /** Show the blocking trees.
+         * @param params Optional SID of a session on the current instance,
+         *               only the trees containing that session are shown then.
+         *               When only the session changes a recent snapshot is reused.
+         */
+        void refreshWithParams(toQueryParams const& params) override;
+
+        void observeHeaders(const toQueryAbstr::HeaderList&) override;
+        void observeData(QObject*) override;
+        void observeDone() override;
+
         /** Support Oracle
          */
         //bool canHandle(const toConnection &conn) /* TODO does not called - override */;
 
+    private slots:
+        void slotBuilt(const toQueryAbstr::HeaderList &headers, const toQueryAbstr::RowList &rows);
+
     private:
+        /** For how long a snapshot is reused when switching sessions (ms) */
+        enum { SnapshotReuse = 10000 };
+
+        toLockGraphBuilder *Builder;
+        toQueryAbstr::RowList Snapshot;
+        QElapsedTimer SnapshotAge;
+        QString Focus;
 };
@@ -46,6 +46,7 @@
 #include <QVBoxLayout>
 #include <QMessageBox>
 #include <QtGui/QCloseEvent>
+#include <QtCore/QElapsedTimer>
 
 #include "result/toresultdatasingle.h"
 #include "tools/toresulttableviewedit.h"
@@ -403,34 +404,38 @@ bool toResultTableData::commitChanges()
         return false;
     }
 
+    toConnectionSubLoan conn(connection());
+    int total = Changes.size();
+    QList<ChangeBatch> batches = toResultModelEdit::batchChanges(Changes,
+                                 insertSyntax(conn.ParentConnection) == SingleRowInsert ? 1 : BatchRows,
+                                 BatchRows);
+
     ProgressBar->setVisible(true);
-    ProgressBar->setMaximum(Changes.size());
+    ProgressBar->setMaximum(total);
+    ProgressBar->setValue(0);
+    ProgressBar->resetFormat();
     Logging->setVisible(true);
 
     bool error = false;
     unsigned updated = 0, added = 0, deleted = 0;
+    int done = 0;
+    QElapsedTimer timer;
+    timer.start();
 
-
-    toConnectionSubLoan conn(connection());
-    // No primary keys
-    for (int changeIndex = 0; changeIndex < Changes.size(); changeIndex++)
+    Q_FOREACH(ChangeBatch const& batch, batches)
     {
-        ProgressBar->setValue(changeIndex);
-
         try
         {
-            struct toResultModelEdit::ChangeSet &change = Changes[changeIndex];
-
-            switch (change.kind)
+            switch (batch.first()->kind)
             {
                 case toResultModelEdit::Delete:
-                    deleted += commitDelete(conn, change);
+                    deleted += commitDelete(conn, batch);
                     break;
                 case toResultModelEdit::Add:
-                    added += commitAdd(conn, change);
+                    added += commitAdd(conn, batch);
                     break;
                 case toResultModelEdit::Update:
-                    updated += commitUpdate(conn, change);
+                    updated += commitUpdate(conn, batch);
                     break;
                 default:
                     Utils::toStatusMessage(tr("Internal error."));
@@ -439,26 +444,37 @@ bool toResultTableData::commitChanges()
         }
         catch (const QString &str)
         {
+            Logging->appendPlainText("Rollback;");
             conn->rollback();
+            if (batch.size() > 1 && batch.first()->kind != toResultModelEdit::Update)
+                reportFailedRow(conn, batch);
             Utils::toStatusMessage(str);
             error = true;
             break;
         }
+
+        done += batch.size();
+        ProgressBar->setValue(done);
+        if (timer.elapsed() > 0)
+            ProgressBar->setFormat(tr("%v/%m changes, %1 rows/s").arg(done * 1000 / timer.elapsed()));
+        // no event processing here, the batches point into the model's change list
+        ProgressBar->repaint();
     }
 
     if (!error)
     {
         conn->commit();
-        ProgressBar->setValue(Changes.size());
+        ProgressBar->setValue(total);
         Changes.clear();
         Model->clearStatus();
     }
 
-    Utils::toStatusMessage(tr("Saved %1 changes(updated %2, added %3, deleted %4)")
-                           .arg(Changes.size(), 0, 10)
+    Utils::toStatusMessage(tr("Saved %1 changes(updated %2, added %3, deleted %4) in %5 s")
+                           .arg(error ? 0 : total, 0, 10)
                            .arg(updated, 0, 10)
                            .arg(added, 0, 10)
                            .arg(deleted, 0, 10)
+                           .arg(timer.elapsed() / 1000.0, 0, 'f', 1)
                            , false, false);
 
     return !error;
@@ -535,10 +551,57 @@ void toResultTableData::refreshWarn()
     refresh();
 }
 
-unsigned toResultTableData::commitUpdate(toConnectionSubLoan &conn, toResultModelEdit::ChangeSet &change)
+toResultTableData::InsertSyntax toResultTableData::insertSyntax(toConnection const& conn)
+{
+    if (conn.providerIs("Oracle"))
+        return InsertAllInsert;
+    if (conn.providerIs("QMYSQL") || conn.providerIs("QPSQL"))
+        return MultiValuesInsert;
+    return SingleRowInsert;
+}
+
+void toResultTableData::reportFailedRow(toConnectionSubLoan &conn, ChangeBatch const& batch)
+{
+    // The whole batch was refused, replay its rows one by one to tell which one failed
+    Q_FOREACH(toResultModelEdit::ChangeSet const* change, batch)
+    {
+        try
+        {
+            if (change->kind == toResultModelEdit::Add)
+                commitAdd(conn, ChangeBatch() << change);
+            else
+                commitDelete(conn, ChangeBatch() << change);
+        }
+        catch (const QString &str)
+        {
+            Logging->appendPlainText(tr("-- Failed row: %1").arg(str));
+            break;
+        }
+    }
+    Logging->appendPlainText("Rollback;");
+    conn->rollback();
+}
+
+QString toResultTableData::keyCondition(toConnectionTraits const& connTraits, toQueryAbstr::Row const& row)
+{
+    static const QString CONJUNCTION = QString::fromLatin1(" AND %1 = %2");
+
+    QString retval;
+    for (int i = 1; i < Model->getPriKeys().size() + 1; i++)
+    {
+        retval += CONJUNCTION
+                  .arg(connTraits.quote(Model->headerData(
+                                            i,
+                                            Qt::Horizontal,
+                                            Qt::DisplayRole).toString()))
+                  .arg(connTraits.quoteVarchar(row[i].editData()));
+    }
+    return retval;
+}
+
+unsigned toResultTableData::commitUpdate(toConnectionSubLoan &conn, ChangeBatch const& batch)
 {
     static const QString UPDATE = QString("UPDATE %1.%2 SET %3 WHERE 1=1 %4");
-    static const QString CONJUNCTION = QString(" AND %1 = %2");
     static const QString ASSIGNMENT = QString("%1 = %2");
 
     if (Model->getPriKeys().empty())
@@ -548,63 +611,51 @@ unsigned toResultTableData::commitUpdate(toConnectionSubLoan &conn, toResultMode
     }
 
     toConnectionTraits const& connTraits = conn.ParentConnection.getTraits();
-    QString sqlValuePlaceHolders, sqlCondPlaceHolders;
 
-    // set new value in update statement
-    if (change.newValue.isNull())
-        sqlValuePlaceHolders = ASSIGNMENT.arg(connTraits.quote(change.columnName)).arg("NULL");
-    else
-        sqlValuePlaceHolders = ASSIGNMENT.arg(connTraits.quote(change.columnName)).arg((QString)change.newValue);
+    // All the edits of a row go in one statement, the last value of a column wins
+    QMap<int, toResultModelEdit::ChangeSet const*> columns;
+    Q_FOREACH(toResultModelEdit::ChangeSet const* change, batch)
+        columns[change->column] = change;
 
-    for (int i = 1; i < Model->getPriKeys().size() + 1; i++)
+    QString sqlValuePlaceHolders;
+    Q_FOREACH(toResultModelEdit::ChangeSet const* change, columns)
     {
-        sqlCondPlaceHolders += CONJUNCTION
-                               .arg(connTraits.quote(Model->headerData(
-                                           i,
-                                           Qt::Horizontal,
-                                           Qt::DisplayRole).toString()))
-                               .arg(connTraits.quoteVarchar(change.row[i].editData()));
+        if (!sqlValuePlaceHolders.isEmpty())
+            sqlValuePlaceHolders += ", ";
+        // set new value in update statement
+        if (change->newValue.isNull())
+            sqlValuePlaceHolders += ASSIGNMENT.arg(connTraits.quote(change->columnName)).arg("NULL");
+        else
+            sqlValuePlaceHolders += ASSIGNMENT.arg(connTraits.quote(change->columnName)).arg((QString)change->newValue);
     }
 
+    // the row as it was before its first edit holds the original primary key
+    QString sqlCondPlaceHolders = keyCondition(connTraits, batch.first()->row);
+
     QString sql = UPDATE.arg(connTraits.quote(Owner)).arg(connTraits.quote(Table)).arg(sqlValuePlaceHolders).arg(sqlCondPlaceHolders);
     Logging->appendPlainText(sql);
     {
         toQuery q(conn, sql, toQueryParams());
         q.eof();
         if (q.rowsProcessed() > 1)
-        {
-            Logging->appendPlainText("Rollback;");
-            conn->rollback();
-            return 0;
-        }
+            throw tr("Update of one row would change %1 rows").arg(q.rowsProcessed());
         return q.rowsProcessed();
     }
 }
 
-unsigned toResultTableData::commitAdd(toConnectionSubLoan &conn, toResultModelEdit::ChangeSet &change)
+bool toResultTableData::addValues(toConnectionTraits const& connTraits, toResultModelEdit::ChangeSet const& change, QString &values)
 {
-    static const QString INSERT = QString("INSERT INTO %1.%2 ( %3 ) VALUES( %4 ) ");
-
-    toConnectionTraits const& connTraits = conn.ParentConnection.getTraits();
     const toResultModel::HeaderList & Headers = Model->headers();
 
-    QString sqlColumns, sqlValuePlaceHolders;
-
+    QString sqlValuePlaceHolders;
     for (int i = 1 + Model->PriKeys.size(), col = 0; i < change.row.size(); i++, col++)
     {
-        if (col > 0)
-            sqlColumns += ", ";
-        sqlColumns += connTraits.quote(Model->headerData(
-                                           i,
-                                           Qt::Horizontal,
-                                           Qt::DisplayRole).toString());
-
         toQValue const &val = change.row[i].editData();
         if (val.isComplexType()) // If it's a complex type then it's not NULL
         {
             Utils::toStatusMessage(tr("This table contains complex/user defined columns "
                                       "and can not be edited"));
-            return 0;
+            return false;
         }
 
         if (col > 0)
@@ -619,12 +670,12 @@ unsigned toResultTableData::commitAdd(toConnectionSubLoan &conn, toResultModelEd
             }
 
             Utils::toStatusMessage(QString("Unsupported datatype(%1)").arg(Headers[i].datatype));
-            return 0;
+            return false;
         }
 
         // Everything else --> varchar
         {
-            if (Headers[col].datatype.toUpper().contains("LOB"))
+            if (Headers[i].datatype.toUpper().contains("LOB"))
             {
                 sqlValuePlaceHolders += ("empty_clob()");
                 continue;
@@ -634,7 +685,56 @@ unsigned toResultTableData::commitAdd(toConnectionSubLoan &conn, toResultModelEd
         }
     }
 
-    QString sql = INSERT.arg(connTraits.quote(Owner)).arg(connTraits.quote(Table)).arg(sqlColumns).arg(sqlValuePlaceHolders);
+    values = QString::fromLatin1("( %1 )").arg(sqlValuePlaceHolders);
+    return true;
+}
+
+unsigned toResultTableData::commitAdd(toConnectionSubLoan &conn, ChangeBatch const& batch)
+{
+    static const QString INSERT = QString("INSERT INTO %1.%2 ( %3 ) VALUES %4 ");
+    static const QString INSERT_ALL = QString("INSERT ALL\n%1SELECT * FROM dual");
+    static const QString INTO = QString("  INTO %1.%2 ( %3 ) VALUES %4\n");
+
+    toConnectionTraits const& connTraits = conn.ParentConnection.getTraits();
+
+    QString sqlColumns;
+    for (int i = 1 + Model->PriKeys.size(), col = 0; i < batch.first()->row.size(); i++, col++)
+    {
+        if (col > 0)
+            sqlColumns += ", ";
+        sqlColumns += connTraits.quote(Model->headerData(
+                                           i,
+                                           Qt::Horizontal,
+                                           Qt::DisplayRole).toString());
+    }
+
+    QStringList rows;
+    Q_FOREACH(toResultModelEdit::ChangeSet const* change, batch)
+    {
+        QString values;
+        if (addValues(connTraits, *change, values))
+            rows << values;
+    }
+    if (rows.isEmpty())
+        return 0;
+
+    QString owner = connTraits.quote(Owner), table = connTraits.quote(Table);
+    QString sql;
+    if (rows.size() == 1)
+    {
+        sql = INSERT.arg(owner).arg(table).arg(sqlColumns).arg(rows.first());
+    }
+    else if (insertSyntax(conn.ParentConnection) == InsertAllInsert)
+    {
+        QString into;
+        Q_FOREACH(QString const& values, rows)
+            into += INTO.arg(owner).arg(table).arg(sqlColumns).arg(values);
+        sql = INSERT_ALL.arg(into);
+    }
+    else
+    {
+        sql = INSERT.arg(owner).arg(table).arg(sqlColumns).arg(rows.join(",\n       "));
+    }
     Logging->appendPlainText(sql);
 
     {
@@ -645,10 +745,10 @@ unsigned toResultTableData::commitAdd(toConnectionSubLoan &conn, toResultModelEd
     }
 }
 
-unsigned toResultTableData::commitDelete(toConnectionSubLoan &conn, toResultModelEdit::ChangeSet &change)
+unsigned toResultTableData::commitDelete(toConnectionSubLoan &conn, ChangeBatch const& batch)
 {
-    static const QString DELETESTAT = QString::fromLatin1("DELETE FROM %1.%2 WHERE 1=1 %3");
-    static const QString CONJUNCTION = QString::fromLatin1(" AND %1 = %2");
+    static const QString DELETESTAT = QString::fromLatin1("DELETE FROM %1.%2 WHERE %3");
+    static const QString ROW = QString::fromLatin1("(1=1 %1)");
     if (Model->getPriKeys().empty())
     {
         Utils::toStatusMessage(tr("This table has no known primary keys"));
@@ -656,29 +756,18 @@ unsigned toResultTableData::commitDelete(toConnectionSubLoan &conn, toResultMode
     }
 
     toConnectionTraits const& connTraits = conn.ParentConnection.getTraits();
-    QString sqlValuePlaceHolders;
-    for (int i = 1; i < Model->getPriKeys().size() + 1; i++)
-    {
-        sqlValuePlaceHolders += CONJUNCTION
-                                .arg(connTraits.quote(Model->headerData(
-                                            i,
-                                            Qt::Horizontal,
-                                            Qt::DisplayRole).toString()))
-                                .arg(connTraits.quoteVarchar(change.row[i].editData()));
-    }
+    QStringList rows;
+    Q_FOREACH(toResultModelEdit::ChangeSet const* change, batch)
+        rows << ROW.arg(keyCondition(connTraits, change->row));
 
-    QString sql = DELETESTAT.arg(connTraits.quote(Owner)).arg(connTraits.quote(Table)).arg(sqlValuePlaceHolders);
+    QString sql = DELETESTAT.arg(connTraits.quote(Owner)).arg(connTraits.quote(Table)).arg(rows.join("\n   OR "));
     Logging->appendPlainText(sql);
 
     {
         toQuery q(conn, sql, toQueryParams());
         q.eof();
-        if (q.rowsProcessed() > 1)
-        {
-            Logging->appendPlainText("Rollback;");
-            conn->rollback();
-            return 0;
-        }
+        if (q.rowsProcessed() > (unsigned long)batch.size())
+            throw tr("Delete of %1 rows would remove %2 rows").arg(batch.size()).arg(q.rowsProcessed());
         return q.rowsProcessed();
     }
 }
@@ -46,6 +46,7 @@ class QAction;
 class QCloseEvent;
 class toResultDataSingle;
 class toResultTableViewEdit;
+class toConnectionTraits;
 //class toResultModel;
 //class toResultModelEdit;
 
@@ -109,9 +110,29 @@ class toResultTableData
 
         void commitUpdate(toConnectionSubLoan &conn, const toQueryAbstr::Row &row, unsigned int &updated);
 
-        unsigned commitUpdate(toConnectionSubLoan &conn, toResultModelEdit::ChangeSet &change);
-        unsigned commitAdd(toConnectionSubLoan &conn, toResultModelEdit::ChangeSet &change);
-        unsigned commitDelete(toConnectionSubLoan &conn, toResultModelEdit::ChangeSet &change);
+        typedef toResultModelEdit::ChangeBatch ChangeBatch;
+
+        /** Maximum number of rows in one INSERT or DELETE statement */
+        enum { BatchRows = 200 };
+
+        enum InsertSyntax
+        {
+            SingleRowInsert,
+            InsertAllInsert,   // Oracle's INSERT ALL INTO ... SELECT * FROM dual
+            MultiValuesInsert  // INSERT INTO ... VALUES (...), (...)
+        };
+
+        static InsertSyntax insertSyntax(toConnection const& conn);
+
+        /** Run a failed batch again row by row to log the row refused, rolls back */
+        void reportFailedRow(toConnectionSubLoan &conn, ChangeBatch const& batch);
+
+        QString keyCondition(toConnectionTraits const& connTraits, toQueryAbstr::Row const& row);
+        bool addValues(toConnectionTraits const& connTraits, toResultModelEdit::ChangeSet const& change, QString &values);
+
+        unsigned commitUpdate(toConnectionSubLoan &conn, ChangeBatch const& batch);
+        unsigned commitAdd(toConnectionSubLoan &conn, ChangeBatch const& batch);
+        unsigned commitDelete(toConnectionSubLoan &conn, ChangeBatch const& batch);
 
         toResultModelEdit* Model;
 
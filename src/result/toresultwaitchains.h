@@ -34,48 +34,16 @@
 
 #pragma once
 
-#include "result/tomvc.h"
-#include "widgets/totreeview.h"
-
-class toEventQuery;
-
-namespace ResutWaitSchains
-{
-    struct Traits : public MVCTraits
-    {
-        static const bool AlternatingRowColorsEnabled = true;
-        static const int  ShowRowNumber = NoRowNumber;
-        static const int  ColumnResize = RowColumResize;
-
-        typedef Views::toTreeView View;
-    };
-
-    class MVC
-            : public TOMVC
-              <
-              ::ResutWaitSchains::Traits,
-              Views::DefaultTreeViewPolicy,
-              ::DefaultDataProviderPolicy
-              >
-    {
-        Q_OBJECT;
-    public:
-        typedef TOMVC<
-                ::ResutWaitSchains::Traits,
-                 Views::DefaultTreeViewPolicy,
-                ::DefaultDataProviderPolicy
-                  > _s;
-        MVC(QWidget *parent) : _s(parent)
-        {};
-        virtual ~MVC() {};
-    };
-}
+#include "result/toresultlock.h"
 
 /**
- * A result table displaying information about locks in a hierarchy
+ * A result table displaying information about locks in a hierarchy.
+ *
+ * Shows the blocking trees of all sessions of all instances, built on the
+ * client from one snapshot instead of a CONNECT BY over v$wait_chains.
  */
 class toResultWaitChains
-        : public ResutWaitSchains::MVC
+        : public toResultLock
 {
     Q_OBJECT;
 
@@ -0,0 +1,196 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "tools/tolinechart.h"
+#include "tools/tobarchart.h"
+#include "tools/totimeseries.h"
+#include "core/toconfiguration.h"
+
+#include <QApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+/* Offscreen chart rendering benchmark
+ *
+ * First checks the decimation pyramid of toTimeSeries: random ranges and
+ * buckets of a ring that wrapped several times are compared with a brute
+ * force min/max/avg over the same samples. Exits with 1 on a mismatch.
+ *
+ * Then fills charts with an increasing number of samples and measures the time
+ * needed to render them into an image. With the decimation pyramid the
+ * render time should stay flat while the number of samples grows.
+ *
+ * Usage: test19 [samples] [width]
+ */
+
+static void fill(toLineChart *chart, int samples)
+{
+    std::list<QString> labels;
+    labels.push_back("sin");
+    labels.push_back("cos");
+    labels.push_back("noise");
+    chart->setLabels(labels);
+    chart->setSamples(samples);
+
+    for (int i = 0; i < samples; i++)
+    {
+        std::list<double> vals;
+        vals.push_back(100 + 100 * sin(i / 1000.0));
+        vals.push_back(100 + 100 * cos(i / 3000.0));
+        vals.push_back(qrand() % 50);
+        chart->addValues(vals, QString::number(i));
+    }
+}
+
+static bool same(double a, double b)
+{
+    return std::fabs(a - b) <= 1e-9 * (std::max)(1.0, std::fabs(a));
+}
+
+static bool checkRange(const toTimeSeries &series, int s, int from, int to, const toTimeSeries::MinMax &got)
+{
+    toTimeSeries::MinMax exp;
+    exp.Min = exp.Max = exp.Sum = 0;
+    exp.Values = 0;
+    exp.Valid = false;
+    for (int i = from; i < to; i++)
+    {
+        if (!series.hasValue(s, i))
+            continue;
+        double val = series.value(s, i);
+        if (!exp.Valid || val < exp.Min)
+            exp.Min = val;
+        if (!exp.Valid || val > exp.Max)
+            exp.Max = val;
+        exp.Sum += val;
+        exp.Values++;
+        exp.Valid = true;
+    }
+
+    bool ok = got.Valid == exp.Valid;
+    if (ok && exp.Valid)
+        ok = got.Min == exp.Min && got.Max == exp.Max && got.Values == exp.Values && same(got.average(), exp.average());
+    if (!ok)
+        std::cout << "mismatch series " << s << " [" << from << ", " << to << "): got "
+                  << got.Min << '/' << got.Max << '/' << got.average() << " expected "
+                  << exp.Min << '/' << exp.Max << '/' << exp.average() << std::endl;
+    return ok;
+}
+
+static bool check(void)
+{
+    qsrand(19);
+    toTimeSeries series(5000);
+
+    // the third series starts late and has gaps, its slots hold NaN
+    for (int i = 0; i < 23456; i++)
+    {
+        std::list<double> vals;
+        vals.push_back(qrand() % 1000 - 500);
+        vals.push_back(sin(i / 100.0));
+        if (i > 3000 && i % 7 != 0)
+            vals.push_back(qrand() % 100);
+        series.append(vals, QString::number(i));
+    }
+
+    std::vector<toTimeSeries::MinMax> buckets;
+    for (int n = 0; n < 200; n++)
+    {
+        int s = n % series.series();
+        int from = qrand() % series.size();
+        int to = from + 1 + qrand() % (series.size() - from);
+        if (!checkRange(series, s, from, to, series.range(s, from, to)))
+            return false;
+
+        int count = 1 + qrand() % 300;
+        series.decimate(s, from, to, count, buckets);
+        for (int i = 0; i < count; i++)
+        {
+            int first = from + int(qint64(to - from) * i / count);
+            int last = from + int(qint64(to - from) * (i + 1) / count);
+            if (last == first)
+                last = (std::min)(first + 1, to);
+            if (!checkRange(series, s, first, last, buckets[i]))
+                return false;
+        }
+    }
+    std::cout << "pyramid check passed" << std::endl;
+    return true;
+}
+
+static qint64 render(toLineChart *chart, int width, int repeat)
+{
+    chart->resize(width, 400);
+    QImage image(width, 400, QImage::Format_ARGB32_Premultiplied);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < repeat; i++)
+    {
+        QPainter p(&image);
+        chart->render(&p);
+    }
+    return timer.nsecsElapsed() / repeat / 1000;
+}
+
+int main(int argc, char **argv)
+{
+    toConfiguration::setQSettingsEnv();
+    QApplication app(argc, argv);
+
+    int maxSamples = argc > 1 ? QString(argv[1]).toInt() : 1000000;
+    int width = argc > 2 ? QString(argv[2]).toInt() : 1600;
+
+    if (!check())
+        return 1;
+
+    std::cout << "samples\tline(us)\tbar(us)" << std::endl;
+    for (int samples = 1000; samples <= maxSamples; samples *= 10)
+    {
+        toLineChart line;
+        toBarChart bar;
+        fill(&line, samples);
+        fill(&bar, samples);
+
+        std::cout << samples << '\t'
+                  << render(&line, width, 10) << '\t'
+                  << render(&bar, width, 10) << std::endl;
+    }
+    return 0;
+}
@@ -147,6 +147,7 @@ int main(int argc, char **argv)
         {
             TLOG(5, toDecorator, __HERE__) << "Looking for client: " << *i << std::endl;
             std::unique_ptr<toConnectionProviderFinder> finder = ConnectionProviderFinderFactory::Instance().create(*i, 0);
+            finder->prepare();
             QList<toConnectionProviderFinder::ConnectionProvirerParams> l = finder->find();
             allProviders.append(l);
         }
@@ -0,0 +1,178 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "editor/tolinediff.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QStringList>
+
+#include <cstdlib>
+#include <iostream>
+
+/* Line diff benchmark
+ *
+ * Generates a large PL/SQL package body, derives a second version with
+ * scattered edits, inserted and deleted blocks and compares the two with
+ * both diff algorithms. dtl is only run up to its line limit since its
+ * edit graph grows with the product of both inputs.
+ *
+ * Every edit script is applied to the old text and must give the new one,
+ * both algorithms must find the same number of changed lines. Exits with
+ * 1 on a mismatch.
+ *
+ * Usage: test20 [lines] [edits] [dtl-limit]
+ */
+
+static QStringList package(int lines)
+{
+    QStringList ret;
+    ret << "CREATE OR REPLACE PACKAGE BODY bench_pkg AS";
+    int proc = 0;
+    while (ret.size() < lines)
+    {
+        ret << QString("  PROCEDURE proc_%1(p_id IN NUMBER, p_name IN VARCHAR2) IS").arg(proc);
+        ret << "    l_count NUMBER := 0;";
+        ret << "  BEGIN";
+        for (int i = 0; i < 20; i++)
+            ret << QString("    UPDATE tab_%1 SET col_%2 = p_name WHERE id = p_id + %3;").arg(proc % 17).arg(i).arg(i);
+        ret << "    l_count := l_count + SQL%ROWCOUNT;";
+        ret << "    COMMIT;";
+        ret << QString("  END proc_%1;").arg(proc);
+        ret << "";
+        proc++;
+    }
+    ret << "END bench_pkg;";
+    return ret;
+}
+
+static QStringList modify(QStringList lines, int edits)
+{
+    srand(1);
+    for (int i = 0; i < edits; i++)
+    {
+        int at = rand() % lines.size();
+        switch (i % 3)
+        {
+            case 0:
+                lines[at] = lines[at] + " -- changed";
+                break;
+            case 1:
+                for (int j = 0; j < 5; j++)
+                    lines.insert(at, QString("    NULL; -- inserted %1").arg(i));
+                break;
+            case 2:
+                for (int j = 0; j < 5 && at < lines.size(); j++)
+                    lines.removeAt(at);
+                break;
+        }
+    }
+    return lines;
+}
+
+/** Apply the edit script to a, false if it is not a valid script turning a into b */
+static bool valid(const QStringList &a, const QStringList &b, const std::vector<toLineDiff::Edit> &edits)
+{
+    QStringList result;
+    int oldLine = 0, newLine = 0;
+    for (std::vector<toLineDiff::Edit>::const_iterator i = edits.begin(); i != edits.end(); i++)
+    {
+        switch (i->Type)
+        {
+            case toLineDiff::Common:
+                if (i->OldLine != oldLine++ || i->NewLine != newLine++ || a.at(i->OldLine) != b.at(i->NewLine))
+                    return false;
+                result << a.at(i->OldLine);
+                break;
+            case toLineDiff::Delete:
+                if (i->OldLine != oldLine++)
+                    return false;
+                break;
+            case toLineDiff::Add:
+                if (i->NewLine != newLine++)
+                    return false;
+                result << b.at(i->NewLine);
+                break;
+        }
+    }
+    return oldLine == a.size() && result == b;
+}
+
+/** @return Number of changed lines, -1 if the edit script is not valid */
+static int run(const char *name, const QStringList &a, const QStringList &b, toLineDiff::Algorithm algorithm)
+{
+    QElapsedTimer timer;
+    timer.start();
+    std::vector<toLineDiff::Edit> edits = toLineDiff::diff(a, b, algorithm);
+    qint64 elapsed = timer.elapsed();
+
+    int changed = 0;
+    for (std::vector<toLineDiff::Edit>::const_iterator i = edits.begin(); i != edits.end(); i++)
+        if (i->Type != toLineDiff::Common)
+            changed++;
+    bool ok = valid(a, b, edits);
+    std::cout << name << ": " << a.size() << " -> " << b.size() << " lines, "
+              << changed << " changed, " << elapsed << " ms"
+              << (ok ? "" : ", INVALID edit script") << std::endl;
+    return ok ? changed : -1;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    int lines = argc > 1 ? atoi(argv[1]) : 100000;
+    int edits = argc > 2 ? atoi(argv[2]) : 500;
+    int limit = argc > 3 ? atoi(argv[3]) : 20000;
+
+    bool ok = true;
+    for (int n = 1000; n <= lines; n *= 10)
+    {
+        QStringList a = package(n);
+        QStringList b = modify(a, qMax(1, edits * n / lines));
+        int linear = run("linear", a, b, toLineDiff::LinearSpace);
+        ok = ok && linear >= 0;
+        if (n <= limit)
+        {
+            int classic = run("dtl   ", a, b, toLineDiff::Classic);
+            ok = ok && classic >= 0;
+            if (linear != classic)
+            {
+                std::cout << "FAILED, linear and dtl change counts differ" << std::endl;
+                ok = false;
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "core/toconfiguration.h"
+#include "core/toconnection.h"
+#include "core/toconnectionprovider.h"
+#include "core/toconnectionsubloan.h"
+#include "core/tologger.h"
+#include "core/toquery.h"
+#include "core/toqvalue.h"
+#include "connection/topqconnection.h"
+
+#include <QApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QPointer>
+#include <QtCore/QString>
+
+#include <iostream>
+#include <memory>
+
+/* PostgreSQL fetch benchmark
+ *
+ * Reads the whole result of a query through the QSqlDriver based
+ * connection and through the native libpq one and prints the fetch
+ * rate of both. Also times a batch of inserts into a temporary table
+ * sent one by one and in a single pipeline.
+ *
+ * Usage: test21 user/password@host[:port]/database [sql] [repeats]
+ */
+
+static void usage()
+{
+    printf("Usage:\n\n  test21 user/password@host[:port]/database [sql] [repeats]\n\n");
+    exit(2);
+}
+
+static void fetch(toConnection &conn, const char *name, QString const& sql, int repeats)
+{
+    toConnectionSubLoan sub(conn);
+    qint64 values = 0, rows = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int r = 0; r < repeats; r++)
+    {
+        toQuery query(sub, sql, toQueryParams());
+        unsigned cols = query.columns();
+        while (!query.eof())
+        {
+            query.readValue();
+            values++;
+        }
+        rows += cols ? values / cols : 0;
+        values = 0;
+    }
+    qint64 elapsed = timer.elapsed();
+    std::cout << name << ": " << rows << " rows in " << elapsed << " ms";
+    if (elapsed)
+        std::cout << ", " << rows * 1000 / elapsed << " rows/s";
+    std::cout << std::endl;
+}
+
+static void batch(toConnection &conn, int count)
+{
+    toConnectionSubLoan sub(conn);
+    toPQConnectionSub *pq = dynamic_cast<toPQConnectionSub*>((toConnectionSub*)sub);
+    if (!pq)
+        return;
+
+    toQuery(sub, "CREATE TEMPORARY TABLE test21 (id integer, name text)", toQueryParams());
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < count; i++)
+        toQuery(sub, "INSERT INTO test21 VALUES (:id<int>, :name<char[101]>)", toQueryParams() << i << QString::number(i));
+    std::cout << "single inserts: " << count << " in " << timer.elapsed() << " ms" << std::endl;
+
+    QList<QString> sql;
+    QList<toQueryParams> params;
+    for (int i = 0; i < count; i++)
+    {
+        sql << "INSERT INTO test21 VALUES (:id<int>, :name<char[101]>)";
+        params << (toQueryParams() << i << QString::number(i));
+    }
+    timer.restart();
+    unsigned long rows = pq->pipeline(sql, params);
+    std::cout << "pipelined inserts: " << rows << " in " << timer.elapsed() << " ms" << std::endl;
+
+    toQuery(sub, "DROP TABLE test21", toQueryParams());
+}
+
+int main(int argc, char **argv)
+{
+    toConfiguration::setQSettingsEnv();
+
+    QApplication app(argc, argv);
+
+    try
+    {
+        qRegisterMetaType<toQColumnDescriptionList>("toQColumnDescriptionList&");
+        qRegisterMetaType<ValuesList>("ValuesList&");
+        qRegisterMetaType<toConnection::exception>("toConnection::exception");
+
+        if (argc < 2)
+            usage();
+
+        QString connect = QString::fromLatin1(argv[1]);
+        int at = connect.lastIndexOf('@');
+        int slash = connect.indexOf('/');
+        int dbslash = connect.lastIndexOf('/');
+        if (at < 0 || slash < 0 || slash > at || dbslash < at)
+            usage();
+        QString user = connect.left(slash);
+        QString password = connect.mid(slash + 1, at - slash - 1);
+        QString host = connect.mid(at + 1, dbslash - at - 1);
+        QString database = connect.mid(dbslash + 1);
+
+        QString sql = argc > 2
+                      ? QString::fromLatin1(argv[2])
+                      : QString::fromLatin1("SELECT i, i * 1.5, 'row ' || i, now() FROM generate_series(1, 200000) i");
+        int repeats = argc > 3 ? atoi(argv[3]) : 3;
+
+        std::vector<std::string> finders = ConnectionProviderFinderFactory::Instance().keys();
+        for (std::vector<std::string>::const_iterator i = finders.begin(); i != finders.end(); ++i)
+        {
+            std::unique_ptr<toConnectionProviderFinder> finder = ConnectionProviderFinderFactory::Instance().create(*i, 0);
+            finder->prepare();
+            foreach(toConnectionProviderFinder::ConnectionProvirerParams const& params, finder->find())
+            {
+                if (params.value("PROVIDER").toString() == "QPSQL")
+                    toConnectionProviderRegistrySing::Instance().load(params);
+            }
+        }
+
+        QSet<QString> qsqlOptions;
+        QPointer<toConnection> qsql = new toConnection(QString("QPSQL"), user, password, host, database, "", "", qsqlOptions);
+        TLOG(0, toDecorator, __HERE__) << "Version: " << qsql->version() << std::endl;
+
+        QSet<QString> nativeOptions;
+        nativeOptions << "Native libpq";
+        QPointer<toConnection> native = new toConnection(QString("QPSQL"), user, password, host, database, "", "", nativeOptions);
+
+        fetch(*qsql, "QSqlDriver", sql, repeats);
+        fetch(*native, "libpq", sql, repeats);
+        batch(*native, 10000);
+
+        delete qsql;
+        delete native;
+        return 0;
+    }
+    catch (const QString &str)
+    {
+        std::cerr << "Unhandled exception:" << std::endl << std::endl << qPrintable(str) << std::endl;
+    }
+    return 1;
+}
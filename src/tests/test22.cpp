@@ -0,0 +1,159 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "core/tologger.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThread>
+#include <QtCore/QAtomicInt>
+
+#include <iostream>
+#include <vector>
+
+/* ts_log benchmark
+ *
+ * Several threads write messages at the same time through the lock-free
+ * ring backend and through the mutex protected queue backend (one writer
+ * thread per log). Both write into a stream which only counts the lines.
+ * Prints the rate at which the threads could log and the rate at which
+ * the messages were written out. Also times TLOG on a disabled channel.
+ *
+ * Usage: test22 [threads] [messages per thread]
+ */
+
+class lineCounter : public std::streambuf
+{
+    public:
+        int lines() const
+        {
+            return Lines.loadAcquire();
+        }
+    protected:
+        int_type overflow(int_type c) override
+        {
+            if (c == '\n')
+                Lines.ref();
+            return c;
+        }
+        std::streamsize xsputn(const char *s, std::streamsize n) override
+        {
+            for (std::streamsize i = 0; i < n; i++)
+                if (s[i] == '\n')
+                    Lines.ref();
+            return n;
+        }
+    private:
+        QAtomicInt Lines;
+};
+
+template<class internal_log>
+class producer : public QThread
+{
+    public:
+        producer(internal_log &log, int id, int messages)
+            : Log(log)
+            , Id(id)
+            , Messages(messages)
+        {}
+    protected:
+        void run() override
+        {
+            for (int i = 0; i < Messages; i++)
+                thread_safe_log(Log).ts() << "message " << i << " from producer " << Id << std::endl;
+        }
+    private:
+        internal_log &Log;
+        int Id, Messages;
+};
+
+template<class internal_log>
+static void bench(const char *name, int threads, int messages)
+{
+    lineCounter counter;
+    std::ostream out(&counter);
+    qint64 produced, written;
+    QElapsedTimer timer;
+    timer.start();
+    {
+        internal_log log(out);
+        std::vector<producer<internal_log>*> producers;
+        for (int t = 0; t < threads; t++)
+            producers.push_back(new producer<internal_log>(log, t, messages));
+        for (int t = 0; t < threads; t++)
+            producers[t]->start();
+        for (int t = 0; t < threads; t++)
+        {
+            producers[t]->wait();
+            delete producers[t];
+        }
+        produced = timer.elapsed();
+        while (counter.lines() < threads * messages)
+            QThread::msleep(1);
+        written = timer.elapsed();
+    }
+    qint64 total = (qint64)threads * messages;
+    std::cout << name << ": " << total << " messages, logged in " << produced << " ms";
+    if (produced)
+        std::cout << " (" << total * 1000 / produced << " msg/s)";
+    std::cout << ", written in " << written << " ms";
+    if (written)
+        std::cout << " (" << total * 1000 / written << " msg/s)";
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    int threads = argc > 1 ? atoi(argv[1]) : 8;
+    int messages = argc > 2 ? atoi(argv[2]) : 100000;
+    if (threads <= 0 || messages <= 0)
+    {
+        printf("Usage:\n\n  test22 [threads] [messages per thread]\n\n");
+        return 2;
+    }
+
+    bench<internal_thread_safe_log_ownthread>("queue", threads, messages);
+#ifdef TS_LOG_HAS_RING
+    bench<internal_thread_safe_log_ring>("ring ", threads, messages);
+#endif
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < messages; i++)
+        TLOG(6, toDecorator, __HERE__) << "message " << i << std::endl;
+    std::cout << "disabled TLOG: " << timer.nsecsElapsed() / messages << " ns per call" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,225 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "core/toconfiguration.h"
+#include "core/toconnection.h"
+#include "core/toconnectionprovider.h"
+#include "core/toconnectionsubloan.h"
+#include "core/tologger.h"
+#include "core/toquery.h"
+#include "core/toqvalue.h"
+
+#include <QApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QPointer>
+#include <QtCore/QString>
+
+#include <iostream>
+#include <memory>
+
+/* MySQL streaming test
+ *
+ * Reads the whole result of a query with the buffered QMYSQL driver and
+ * with "Stream results" and prints the fetch rate of both. Then checks
+ * that a streamed connection stays usable when a result is left partly
+ * read, when a query is deleted before its end and after a CALL which
+ * returns several result sets. Works against MySQL and MariaDB.
+ *
+ * Usage: test23 user/password@host[:port]/database [sql] [repeats]
+ */
+
+static void usage()
+{
+    printf("Usage:\n\n  test23 user/password@host[:port]/database [sql] [repeats]\n\n");
+    exit(2);
+}
+
+static qint64 readAll(toQuery &query)
+{
+    qint64 values = 0;
+    while (!query.eof())
+    {
+        query.readValue();
+        values++;
+    }
+    return values;
+}
+
+static void fetch(toConnection &conn, const char *name, QString const& sql, int repeats)
+{
+    toConnectionSubLoan sub(conn);
+    qint64 rows = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int r = 0; r < repeats; r++)
+    {
+        toQuery query(sub, sql, toQueryParams());
+        unsigned cols = query.columns();
+        qint64 values = readAll(query);
+        rows += cols ? values / cols : 0;
+    }
+    qint64 elapsed = timer.elapsed();
+    std::cout << name << ": " << rows << " rows in " << elapsed << " ms";
+    if (elapsed)
+        std::cout << ", " << rows * 1000 / elapsed << " rows/s";
+    std::cout << std::endl;
+}
+
+static void check(bool ok, const char *what)
+{
+    std::cout << what << ": " << (ok ? "ok" : "FAILED") << std::endl;
+    if (!ok)
+        throw QString::fromLatin1("Check failed: %1").arg(QString::fromLatin1(what));
+}
+
+static bool selectOne(toConnectionSubLoan &sub)
+{
+    toQuery query(sub, "SELECT 1", toQueryParams());
+    return !query.eof() && query.readValue().toInt() == 1;
+}
+
+static void streaming(toConnection &conn, QString const& sql)
+{
+    toConnectionSubLoan sub(conn);
+    qint64 expected;
+    {
+        toQuery query(sub, sql, toQueryParams());
+        expected = readAll(query);
+    }
+
+    // Commit and session id in the middle of a streamed result
+    {
+        toQuery query(sub, sql, toQueryParams());
+        qint64 values = 0;
+        for (; values < 10 && !query.eof(); values++)
+            query.readValue();
+        ((toConnectionSub*)sub)->commit();
+        check(!((toConnectionSub*)sub)->sessionId().isEmpty(), "session id while a result is open");
+        values += readAll(query);
+        check(values == expected, "rest of result after commit");
+    }
+
+    // Query deleted before its last row
+    {
+        toQuery query(sub, sql, toQueryParams());
+        query.readValue();
+    }
+    check(selectOne(sub), "statement after abandoned result");
+    ((toConnectionSub*)sub)->rollback();
+    check(selectOne(sub), "statement after rollback");
+
+    // Several result sets
+    toQuery(sub, "DROP PROCEDURE IF EXISTS test23", toQueryParams());
+    toQuery(sub, "CREATE PROCEDURE test23() BEGIN SELECT 1, 2; SELECT 3; END", toQueryParams());
+    {
+        toQuery query(sub, "CALL test23()", toQueryParams());
+        check(readAll(query) == 2, "first result set of CALL");
+    }
+    check(selectOne(sub), "statement after CALL");
+    {
+        toQuery query(sub, "CALL test23()", toQueryParams());
+        query.readValue();
+    }
+    check(selectOne(sub), "statement after abandoned CALL");
+    toQuery(sub, "DROP PROCEDURE test23", toQueryParams());
+}
+
+int main(int argc, char **argv)
+{
+    toConfiguration::setQSettingsEnv();
+
+    QApplication app(argc, argv);
+
+    try
+    {
+        qRegisterMetaType<toQColumnDescriptionList>("toQColumnDescriptionList&");
+        qRegisterMetaType<ValuesList>("ValuesList&");
+        qRegisterMetaType<toConnection::exception>("toConnection::exception");
+
+        if (argc < 2)
+            usage();
+
+        QString connect = QString::fromLatin1(argv[1]);
+        int at = connect.lastIndexOf('@');
+        int slash = connect.indexOf('/');
+        int dbslash = connect.lastIndexOf('/');
+        if (at < 0 || slash < 0 || slash > at || dbslash < at)
+            usage();
+        QString user = connect.left(slash);
+        QString password = connect.mid(slash + 1, at - slash - 1);
+        QString host = connect.mid(at + 1, dbslash - at - 1);
+        QString database = connect.mid(dbslash + 1);
+
+        QString sql = argc > 2
+                      ? QString::fromLatin1(argv[2])
+                      : QString::fromLatin1("WITH d AS (SELECT 0 i UNION ALL SELECT 1 UNION ALL SELECT 2 UNION ALL SELECT 3 UNION ALL SELECT 4 "
+                                            "UNION ALL SELECT 5 UNION ALL SELECT 6 UNION ALL SELECT 7 UNION ALL SELECT 8 UNION ALL SELECT 9) "
+                                            "SELECT n, n * 1.5, CONCAT('row ', n), NOW() FROM "
+                                            "(SELECT a.i + 10 * b.i + 100 * c.i + 1000 * e.i + 10000 * f.i n FROM d a, d b, d c, d e, d f) s");
+        int repeats = argc > 3 ? atoi(argv[3]) : 3;
+
+        std::vector<std::string> finders = ConnectionProviderFinderFactory::Instance().keys();
+        for (std::vector<std::string>::const_iterator i = finders.begin(); i != finders.end(); ++i)
+        {
+            std::unique_ptr<toConnectionProviderFinder> finder = ConnectionProviderFinderFactory::Instance().create(*i, 0);
+            finder->prepare();
+            foreach(toConnectionProviderFinder::ConnectionProvirerParams const& params, finder->find())
+            {
+                if (params.value("PROVIDER").toString() == "QMYSQL")
+                    toConnectionProviderRegistrySing::Instance().load(params);
+            }
+        }
+
+        QSet<QString> bufferedOptions;
+        QPointer<toConnection> buffered = new toConnection(QString("QMYSQL"), user, password, host, database, "", "", bufferedOptions);
+        TLOG(0, toDecorator, __HERE__) << "Version: " << buffered->version() << std::endl;
+
+        QSet<QString> streamOptions;
+        streamOptions << "Stream results";
+        QPointer<toConnection> stream = new toConnection(QString("QMYSQL"), user, password, host, database, "", "", streamOptions);
+
+        fetch(*buffered, "buffered", sql, repeats);
+        fetch(*stream, "streamed", sql, repeats);
+        streaming(*stream, sql);
+
+        delete buffered;
+        delete stream;
+        return 0;
+    }
+    catch (const QString &str)
+    {
+        std::cerr << "Unhandled exception:" << std::endl << std::endl << qPrintable(str) << std::endl;
+    }
+    return 1;
+}
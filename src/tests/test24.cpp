@@ -0,0 +1,160 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "widgets/toresultmodeledit.h"
+#include "core/toconfiguration.h"
+#include "core/toqvalue.h"
+
+#include <QApplication>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include <iostream>
+
+/* Grid save batching test
+ *
+ * Checks how toResultModelEdit::batchChanges groups the edits of a
+ * table grid into statements: edits of one row following each other are
+ * coalesced, adds and deletes following each other are grouped up to the
+ * batch size, no change is lost or sent twice and no change moves before
+ * an earlier one. Exits with 1 on a mismatch.
+ *
+ * Usage: test24
+ */
+
+typedef toResultModelEdit::ChangeSet ChangeSet;
+
+static ChangeSet change(toResultModelEdit::ChangeKind kind, int key)
+{
+    toRowDesc desc;
+    desc.key = key;
+    desc.status = EXISTED;
+
+    ChangeSet ret;
+    ret.kind = kind;
+    ret.column = 1;
+    ret.row << toQValue(desc) << toQValue(key);
+    return ret;
+}
+
+/** Batches as lists of positions in changes, e.g. "0 1|2|3 4" */
+static QString layout(QList<ChangeSet> const& changes, QList<toResultModelEdit::ChangeBatch> const& batches)
+{
+    QStringList ret;
+    Q_FOREACH(toResultModelEdit::ChangeBatch const& batch, batches)
+    {
+        QStringList positions;
+        Q_FOREACH(ChangeSet const* c, batch)
+        {
+            int pos = -1;
+            for (int i = 0; i < changes.size() && pos < 0; i++)
+                if (&changes.at(i) == c)
+                    pos = i;
+            positions << QString::number(pos);
+        }
+        ret << positions.join(" ");
+    }
+    return ret.join("|");
+}
+
+static bool check(QList<ChangeSet> const& changes, int maxAdd, int maxDelete, QString const& expected)
+{
+    QList<toResultModelEdit::ChangeBatch> batches = toResultModelEdit::batchChanges(changes, maxAdd, maxDelete);
+
+    // every change exactly once, no mixed or oversized batch
+    QList<ChangeSet const*> seen;
+    bool ok = true;
+    Q_FOREACH(toResultModelEdit::ChangeBatch const& batch, batches)
+    {
+        Q_FOREACH(ChangeSet const* c, batch)
+        {
+            ok = ok && c->kind == batch.first()->kind && !seen.contains(c);
+            seen << c;
+        }
+        if (batch.first()->kind == toResultModelEdit::Add)
+            ok = ok && batch.size() <= maxAdd;
+        else if (batch.first()->kind == toResultModelEdit::Delete)
+            ok = ok && batch.size() <= maxDelete;
+    }
+    ok = ok && seen.size() == changes.size();
+
+    QString got = layout(changes, batches);
+    ok = ok && got == expected;
+    std::cout << "maxAdd " << maxAdd << ", maxDelete " << maxDelete << ": " << qPrintable(got)
+              << (ok ? " ok" : qPrintable(QString(" FAILED, expected %1").arg(expected))) << std::endl;
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    toConfiguration::setQSettingsEnv();
+
+    QApplication app(argc, argv);
+
+    QList<ChangeSet> changes;
+    changes << change(toResultModelEdit::Update, 1)   // 0
+            << change(toResultModelEdit::Update, 1)   // 1 coalesced with 0
+            << change(toResultModelEdit::Update, 2)   // 2
+            << change(toResultModelEdit::Add, 10)     // 3
+            << change(toResultModelEdit::Add, 11)     // 4
+            << change(toResultModelEdit::Add, 12)     // 5
+            << change(toResultModelEdit::Delete, 2)   // 6
+            << change(toResultModelEdit::Delete, 3)   // 7
+            << change(toResultModelEdit::Update, 1)   // 8 other changes since 1, new batch
+            << change(toResultModelEdit::Delete, 1)   // 9
+            << change(toResultModelEdit::Update, 1)   // 10 row deleted before, new batch
+            << change(toResultModelEdit::Add, 13);    // 11
+
+    bool ok = true;
+    ok = check(changes, 2, 3, "0 1|2|3 4|5|6 7|8|9|10|11") && ok;
+    ok = check(changes, 1, 3, "0 1|2|3|4|5|6 7|8|9|10|11") && ok;
+    ok = check(changes, 200, 2, "0 1|2|3 4 5|6 7|8|9|10|11") && ok;
+    ok = check(QList<ChangeSet>(), 200, 200, "") && ok;
+
+    // swapping keys: row 1 id 1 -> 99, row 2 id 2 -> 1, row 1 id 99 -> 2
+    QList<ChangeSet> swap;
+    swap << change(toResultModelEdit::Update, 1)
+         << change(toResultModelEdit::Update, 2)
+         << change(toResultModelEdit::Update, 1);
+    ok = check(swap, 200, 200, "0|1|2") && ok;
+
+    // delete id 5, then give another row id 5
+    QList<ChangeSet> reuse;
+    reuse << change(toResultModelEdit::Delete, 5)
+          << change(toResultModelEdit::Update, 6)
+          << change(toResultModelEdit::Update, 6);
+    ok = check(reuse, 200, 200, "0|1 2") && ok;
+
+    return ok ? 0 : 1;
+}
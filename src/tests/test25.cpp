@@ -0,0 +1,136 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "widgets/toresultitemmodel.h"
+#include "core/toconfiguration.h"
+#include "core/toqvalue.h"
+
+#include <QApplication>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include <iostream>
+
+/* Item model options test
+ *
+ * Checks the toResultItemModel options used by the lists ported from
+ * toResultView: first line display and tooltip, MultiLine, Checkable
+ * (flags, check state through setData, checkStateChanged) and sorting
+ * of a two level tree by ids. Exits with 1 on a mismatch.
+ *
+ * Usage: test25
+ */
+
+static bool check(QString const& what, QString const& got, QString const& expected)
+{
+    bool ok = got == expected;
+    std::cout << qPrintable(what) << ": " << qPrintable(got)
+              << (ok ? " ok" : qPrintable(QString(" FAILED, expected %1").arg(expected))) << std::endl;
+    return ok;
+}
+
+static toQueryAbstr::Row row(QString const& name, QString const& value)
+{
+    toQueryAbstr::Row ret;
+    ret << toQValue(name) << toQValue(value);
+    return ret;
+}
+
+/** Texts of column 0 below parent in display order, e.g. "a b c" */
+static QString level(toResultItemModel const& model, QModelIndex const& parent)
+{
+    QStringList ret;
+    for (int i = 0; i < model.rowCount(parent); i++)
+        ret << model.data(model.index(i, 0, parent), Qt::EditRole).toString();
+    return ret.join(" ");
+}
+
+int main(int argc, char **argv)
+{
+    toConfiguration::setQSettingsEnv();
+
+    QApplication app(argc, argv);
+
+    bool ok = true;
+
+    // default: first line only, the whole text as tooltip, no check box
+    toResultItemModel plain;
+    plain.setHeaders(QStringList() << "Name" << "Value");
+    int id = plain.appendRow(row("a", "first\nsecond"));
+    QModelIndex value = plain.indexOf(id, 1);
+    ok = check("display", plain.data(value, Qt::DisplayRole).toString(), "first...") && ok;
+    ok = check("tooltip", plain.data(value, Qt::ToolTipRole).toString(), "first\nsecond") && ok;
+    ok = check("edit", plain.data(value, Qt::EditRole).toString(), "first\nsecond") && ok;
+    ok = check("not checkable", QString::number(bool(plain.flags(plain.indexOf(id)) & Qt::ItemIsUserCheckable)), "0") && ok;
+    ok = check("no check state", QString::number(plain.data(plain.indexOf(id), Qt::CheckStateRole).isValid()), "0") && ok;
+    ok = check("setData refused", QString::number(plain.setData(plain.indexOf(id), Qt::Checked, Qt::CheckStateRole)), "0") && ok;
+
+    // MultiLine and Checkable
+    toResultItemModel model(NULL, toResultItemModel::MultiLine | toResultItemModel::Checkable);
+    model.setHeaders(QStringList() << "Name" << "Value");
+    int b = model.appendRow(row("b", "2"));
+    int a = model.appendRow(row("a", "10"));
+    toQueryAbstr::RowList children;
+    children << row("z", "3") << row("y", "1\nline") << row("x", "20");
+    model.appendRows(children, a);
+
+    QModelIndex multi = model.index(1, 1, model.indexOf(a));
+    ok = check("multiline", model.data(multi, Qt::DisplayRole).toString(), "1\nline") && ok;
+    ok = check("checkable", QString::number(bool(model.flags(model.indexOf(a)) & Qt::ItemIsUserCheckable)), "1") && ok;
+    ok = check("column 1 not checkable", QString::number(bool(model.flags(model.indexOf(a, 1)) & Qt::ItemIsUserCheckable)), "0") && ok;
+
+    QStringList changes;
+    QObject::connect(&model, &toResultItemModel::checkStateChanged, [&changes](int id, Qt::CheckState state)
+    {
+        changes << QString("%1:%2").arg(id).arg(int(state));
+    });
+    ok = check("setData", QString::number(model.setData(model.indexOf(b), Qt::Checked, Qt::CheckStateRole)), "1") && ok;
+    model.setData(model.indexOf(b), Qt::Checked, Qt::CheckStateRole); // no change, no signal
+    model.setCheckState(a, Qt::PartiallyChecked);
+    ok = check("check state", QString("%1 %2").arg(int(model.checkState(b))).arg(int(model.data(model.indexOf(a), Qt::CheckStateRole).toInt())), "2 1") && ok;
+    ok = check("checkStateChanged", changes.join(" "), QString("%1:2 %2:1").arg(b).arg(a)) && ok;
+
+    // sorting keeps ids and check states, numbers held as text sort as numbers
+    QPersistentModelIndex persistent = model.indexOf(b);
+    model.sort(1, Qt::AscendingOrder);
+    ok = check("sorted top", level(model, QModelIndex()), "b a") && ok;
+    ok = check("sorted children", level(model, model.indexOf(a)), "z x y") && ok; // "1\nline" is text
+    ok = check("persistent", QString::number(model.id(persistent)), QString::number(b)) && ok;
+    model.sort(0, Qt::DescendingOrder);
+    ok = check("sorted by name", level(model, QModelIndex()) + "|" + level(model, model.indexOf(a)), "b a|z y x") && ok;
+    ok = check("check state after sort", QString::number(int(model.checkState(b))), "2") && ok;
+    ok = check("first child", model.text(model.firstChild(a), 0), "z") && ok;
+
+    return ok ? 0 : 1;
+}
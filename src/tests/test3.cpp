@@ -119,6 +119,7 @@ int main(int argc, char **argv)
             try
             {
                 std::unique_ptr<toConnectionProviderFinder> finder = ConnectionProviderFinderFactory::Instance().create(*i, 0);
+                finder->prepare();
                 QList<toConnectionProviderFinder::ConnectionProvirerParams> l = finder->find();
                 allProviders.append(l);
                 finderName = finder->name();
@@ -35,10 +35,13 @@
 #include "tools/toanalyze.h"
 #include "core/utils.h"
 #include "core/totool.h"
+#include "core/toconnectionsubloan.h"
+#include "core/toquery.h"
 #include "editor/tomemoeditor.h"
 #include "widgets/toresultschema.h"
 #include "tools/toworksheetstatistic.h"
 //#include "core/toconfiguration.h"
+#include <QCheckBox>
 #include <QComboBox>
 #include <QSpinBox>
 #include <QMenu>
@@ -56,6 +59,8 @@
 #include "toresultplan.h"
 #include "toresulttableview.h"
 
+#include <algorithm>
+
 class toAnalyzeTool : public toTool
 {
         const char **pictureXPM(void) override
@@ -181,6 +186,21 @@ static toSQL SQLListIndexPg(
     "0702",
     "QPSQL");
 
+static toSQL SQLSegmentSize("toAnalyze:SegmentSize",
+                            "SELECT segment_name,\n"
+                            "       partition_name,\n"
+                            "       segment_type,\n"
+                            "       SUM(bytes)\n"
+                            "  FROM sys.dba_segments\n"
+                            " WHERE owner = :own<char[101]>\n"
+                            "   AND segment_type LIKE :typ<char[101]>\n"
+                            " GROUP BY segment_name, partition_name, segment_type",
+                            "Size of the segments of a schema, used to order analyze jobs. "
+                            "Must have same columns and binds");
+
+// Fallback size estimate read from the statistics list, see toAnalyze::estimateCost
+static const double BlockSize = 8192;
+
 static toSQL SQLListPlans("toAnalyze:ListPlans",
                           "SELECT DISTINCT\n"
                           "       statement_id \"Statement\",\n"
@@ -317,6 +337,15 @@ toAnalyze::toAnalyze(QWidget *main, toConnection &connection)
     Parallel->setMaximum(100);
     toolbar->addWidget(Parallel);
 
+    Partitions = NULL;
+    if (connection.providerIs("Oracle"))
+    {
+        Partitions = new QCheckBox(tr("Per partition"), toolbar);
+        Partitions->setToolTip(tr("Run one job per partition of partitioned objects.\n"
+                                  "Global statistics of the object are then not gathered."));
+        toolbar->addWidget(Partitions);
+    }
+
     toolbar->addSeparator();
 
     toolbar->addAction(QIcon(QPixmap(const_cast<const char**>(execute_xpm))),
@@ -413,6 +442,8 @@ toAnalyze::toAnalyze(QWidget *main, toConnection &connection)
         Worksheet   = NULL;
     }
 
+    TotalCost = DoneCost = 0;
+
     slotRefresh();
     setFocusProxy(Tabs);
 }
@@ -440,10 +471,20 @@ void toAnalyze::startQuery(toEventQuery * q)
 QStringList toAnalyze::getSQL(void)
 {
     QStringList ret;
+    Q_FOREACH(Job const& job, getJobs())
+        ret << job.SQL;
+    return ret;
+}
+
+QList<toAnalyze::Job> toAnalyze::getJobs(void)
+{
+    QList<Job> ret;
     for (toResultTableView::iterator it(Statistics); (*it).isValid(); it++)
     {
         if (Statistics->isRowSelected((*it)))
         {
+            Job job;
+            job.Cost = 0;
             if (connection().providerIs("Oracle"))
             {
                 QString sql = QString::fromLatin1("ANALYZE %3 %1.%2 ");
@@ -470,26 +511,27 @@ QStringList toAnalyze::getSQL(void)
                 switch (Operation->currentIndex())
                 {
                     case 0:
-                        sql += QString::fromLatin1("COMPUTE STATISTICS");
-                        sql += forc;
+                        job.Operation = QString::fromLatin1("COMPUTE STATISTICS");
+                        job.Operation += forc;
                         break;
                     case 1:
-                        sql += QString::fromLatin1("ESTIMATE STATISTICS");
-                        sql += forc;
-                        sql += QString::fromLatin1(" SAMPLE %1 PERCENT").arg(Sample->value());
+                        job.Operation = QString::fromLatin1("ESTIMATE STATISTICS");
+                        job.Operation += forc;
+                        job.Operation += QString::fromLatin1(" SAMPLE %1 PERCENT").arg(Sample->value());
                         break;
                     case 2:
-                        sql += QString::fromLatin1("DELETE STATISTICS");
+                        job.Operation = QString::fromLatin1("DELETE STATISTICS");
                         break;
                     case 3:
-                        sql += QString::fromLatin1("VALIDATE REF UPDATE");
+                        job.Operation = QString::fromLatin1("VALIDATE REF UPDATE");
                         break;
                 }
-                ret.append(
-                    sql.arg(Statistics->model()->data((*it).row(), 2).toString())
-                    .arg(Statistics->model()->data((*it).row(), 3).toString())
-                    .arg(Statistics->model()->data((*it).row(), 1).toString()));
-
+                job.Owner = Statistics->model()->data((*it).row(), 2).toString();
+                job.Name = Statistics->model()->data((*it).row(), 3).toString();
+                job.Type = Statistics->model()->data((*it).row(), 1).toString();
+                job.SQL = (sql + job.Operation).arg(job.Owner).arg(job.Name).arg(job.Type);
+                // Blocks for tables, leaf blocks for indexes
+                job.Cost = Statistics->model()->data((*it).row(), job.Type == "TABLE" ? 5 : 6).toDouble() * BlockSize;
             }
             else if (connection().providerIs("QPSQL"))
             {
@@ -510,7 +552,11 @@ QStringList toAnalyze::getSQL(void)
 
                 QString table = Statistics->model()->data((*it).row(), 3).toString();
                 QString schema = Statistics->model()->data((*it).row(), 2).toString();
-                ret.append(sql.arg(schema).arg(table));
+                job.Owner = schema;
+                job.Name = table;
+                job.SQL = sql.arg(schema).arg(table);
+                // 8KB pages of the relation
+                job.Cost = Statistics->model()->data((*it).row(), 5).toDouble() * BlockSize;
             }
             else
             {
@@ -527,14 +573,105 @@ QStringList toAnalyze::getSQL(void)
                 QString owner = Statistics->model()->data((*it).row(), 2).toString();
                 if (owner.isNull())
                     owner = Schema->selected();
-                ret.append(sql.arg(owner).arg(
-                               Statistics->model()->data((*it).row(), 1).toString()));
+                job.Owner = owner;
+                job.Name = Statistics->model()->data((*it).row(), 1).toString();
+                job.SQL = sql.arg(owner).arg(job.Name);
+                // Data_length of show table status
+                job.Cost = Statistics->model()->data((*it).row(), 7).toDouble();
             }
+            ret.append(job);
         }
     }
+
+    if (connection().providerIs("Oracle"))
+        estimateCost(ret);
+
+    // Largest first, so the long running jobs do not end up alone at the tail
+    std::stable_sort(ret.begin(), ret.end(), [](Job const& a, Job const& b)
+    {
+        return a.Cost > b.Cost;
+    });
     return ret;
 }
 
+void toAnalyze::estimateCost(QList<Job> &jobs)
+{
+    bool split = Partitions && Partitions->isChecked() && Operation->currentIndex() != 3;
+    QString type = (!Type || Type->currentIndex() == 0) ? "TABLE%" : "INDEX%";
+
+    QSet<QString> owners;
+    Q_FOREACH(Job const& job, jobs)
+        owners.insert(job.Owner);
+
+    // Segment sizes per object, and per partition of partitioned objects.
+    // Keyed by type too, an index can have the name of a table.
+    QMap<QString, double> sizes;
+    QMap<QString, QList<Job> > parts;
+    try
+    {
+        Utils::toBusy busy;
+        toConnectionSubLoan conn(connection());
+        Q_FOREACH(QString const& owner, owners)
+        {
+            toQuery query(conn, SQLSegmentSize, toQueryParams() << owner << type);
+            while (!query.eof())
+            {
+                QString name = (QString)query.readValue();
+                QString partition = (QString)query.readValue();
+                QString segment = (QString)query.readValue();
+                double bytes = query.readValue().toDouble();
+                QString key = segment.section(' ', 0, 0) + " " + owner + "." + name;
+                sizes[key] += bytes;
+                if (split && !partition.isEmpty())
+                {
+                    Job part;
+                    part.Owner = owner;
+                    part.Name = name;
+                    part.Partition = partition;
+                    part.Type = segment;
+                    part.Cost = bytes;
+                    parts[key] << part;
+                }
+            }
+        }
+    }
+    catch (const QString &str)
+    {
+        // No access to DBA_SEGMENTS, keep the estimate from the statistics list
+        Utils::toStatusMessage(tr("Cannot read segment sizes, ordering by analyzed blocks: %1").arg(str), false, false);
+        return;
+    }
+
+    QList<Job> ret;
+    Q_FOREACH(Job job, jobs)
+    {
+        QString key = job.Type + " " + job.Owner + "." + job.Name;
+        if (sizes.contains(key))
+            job.Cost = sizes[key];
+        if (parts.contains(key))
+        {
+            Q_FOREACH(Job part, parts[key])
+            {
+                // segment_type is TABLE PARTITION, INDEX SUBPARTITION...
+                QString kind = part.Type.contains("SUBPARTITION") ? "SUBPARTITION" : "PARTITION";
+                part.Type = job.Type;
+                part.Operation = job.Operation;
+                part.SQL = QString::fromLatin1("ANALYZE %1 %2.%3 %4 (%5) %6")
+                           .arg(job.Type)
+                           .arg(job.Owner)
+                           .arg(job.Name)
+                           .arg(kind)
+                           .arg(part.Partition)
+                           .arg(job.Operation);
+                ret << part;
+            }
+        }
+        else
+            ret << job;
+    }
+    jobs = ret;
+}
+
 void toAnalyze::slotDisplaySQL(void)
 {
     QStringList sql = getSQL();
@@ -553,28 +690,50 @@ void toAnalyze::slotExecute(void)
 {
     slotStop();
 
-    Pending = getSQL();
+    Pending = getJobs();
 
     if (Pending.isEmpty())
         return;
 
+    TotalCost = DoneCost = 0;
+    Q_FOREACH(Job const& job, Pending)
+        TotalCost += job.Cost;
+    Elapsed.start();
+
     try
     {
         for (int i = 0; i < Parallel->value(); i++)
-        {
-            if (!Pending.isEmpty())
-            {
-                QString sql = Pending.takeFirst();
-                toEventQuery * q = new toEventQuery(this, connection(), sql, toQueryParams(), toEventQuery::READ_ALL);
-                Running.append(q);
-                startQuery(q);
-            }
-        }
+            startNext();
         Stop->setEnabled(true);
+        updateProgress();
     }
     TOCATCH;
 }
 
+void toAnalyze::startNext(void)
+{
+    if (Pending.isEmpty())
+        return;
+    Job job = Pending.takeFirst();
+    toEventQuery * q = new toEventQuery(this, connection(), job.SQL, toQueryParams(), toEventQuery::READ_ALL);
+    Running.insert(q, job);
+    startQuery(q);
+}
+
+void toAnalyze::updateProgress(void)
+{
+    QString text = tr("Running %1 Pending %2").arg(Running.size()).arg(Pending.size());
+    // Remaining size at the throughput reached so far, all sessions together
+    if (DoneCost > 0 && TotalCost > DoneCost && Elapsed.isValid())
+    {
+        qint64 eta = qint64(Elapsed.elapsed() / 1000.0 * (TotalCost - DoneCost) / DoneCost);
+        text += " " + tr("ETA %1:%2")
+                .arg(eta / 60)
+                .arg(eta % 60, 2, 10, QChar('0'));
+    }
+    Current->setText(text);
+}
+
 void toAnalyze::receiveData(toEventQuery* q)
 {
     // This function will probably never be called as table statistics
@@ -585,23 +744,20 @@ void toAnalyze::receiveData(toEventQuery* q)
         for (int j = 0; j < cols; j++)
             q->readValue();  // Eat the output if any.
 
-        Current->setText(tr("Running %1 Pending %2").arg(Running.size()).arg(Pending.size()));
+        updateProgress();
     }
     TOCATCH;
 }
 
 void toAnalyze::queryDone(toEventQuery* q)
 {
-    Running.removeOne(q);
+    DoneCost += Running.take(q).Cost;
     delete q;
 
     if (!Pending.isEmpty())
     {
-        QString sql = Pending.takeFirst();
-        toEventQuery * q = new toEventQuery(this, connection(), sql, toQueryParams(), toEventQuery::READ_ALL);
-        startQuery(q);
-        Running.append(q);
-        Current->setText(tr("Running %1 Pending %2").arg(Running.size()).arg(Pending.size()));
+        startNext();
+        updateProgress();
     }
     else
     {
@@ -615,9 +771,8 @@ void toAnalyze::queryDone(toEventQuery* q)
 
 void toAnalyze::slotStop(void)
 {
-    QList<toEventQuery*>::iterator i;
-    for (i = Running.begin(); i != Running.end(); i++)
-        delete *i;
+    Q_FOREACH(toEventQuery *q, Running.keys())
+        delete q;
     Running.clear();
     Pending.clear();
     Stop->setEnabled(false);
@@ -37,10 +37,12 @@
 #include "core/toeventquery.h"
 #include "widgets/totoolwidget.h"
 
+#include <QtCore/QElapsedTimer>
 #include <QAction>
 #include <QLabel>
 #include <QToolButton>
 
+class QCheckBox;
 class QComboBox;
 class QMenu;
 class QSpinBox;
@@ -64,7 +66,22 @@ class toAnalyze : public toToolWidget
 
         void startQuery(toEventQuery * q);
 
+        /** One statement to run, with the estimated size of the segment it processes */
+        struct Job
+        {
+            QString SQL;
+            QString Type;
+            QString Owner;
+            QString Name;
+            QString Partition;
+            /** Operation part of the statement, reused for partition jobs */
+            QString Operation;
+            double Cost;
+        };
+
         QStringList getSQL(void);
+        /** Statements for the selected objects, largest estimated segment first */
+        QList<Job> getJobs(void);
 
     public slots:
         virtual void slotDisplaySQL(void);
@@ -79,6 +96,10 @@ class toAnalyze : public toToolWidget
         virtual void slotDisplayMenu(QMenu *);
         virtual void slotWindowActivated(toToolWidget*) {};
     private:
+        void estimateCost(QList<Job> &jobs);
+        void startNext(void);
+        void updateProgress(void);
+
         QTabWidget           *Tabs;
         toResultTableView    *Statistics;
         QComboBox            *Analyzed;
@@ -88,11 +109,15 @@ class toAnalyze : public toToolWidget
         QComboBox            *For;
         QSpinBox             *Sample;
         QSpinBox             *Parallel;
+        QCheckBox            *Partitions;
         QLabel               *Current;
         QToolButton          *Stop;
         toResultTableView    *Plans;
         toResultPlanSaved    *CurrentPlan;
         toWorksheetStatistic *Worksheet;
-        QList<toEventQuery *> Running;
-        QStringList           Pending;
+        QMap<toEventQuery *, Job> Running;
+        QList<Job>            Pending;
+        double                TotalCost;
+        double                DoneCost;
+        QElapsedTimer         Elapsed;
 };
@@ -0,0 +1,693 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "tools/toaqbrowser.h"
+#include "core/utils.h"
+#include "core/tochangeconnection.h"
+#include "core/toconnectionsub.h"
+#include "core/toconnectiontraits.h"
+#include "core/toeventquery.h"
+#include "core/toquery.h"
+#include "core/tosql.h"
+#include "core/totool.h"
+#include "widgets/torefreshcombo.h"
+#include "tools/toresulttableview.h"
+
+#include <QAction>
+#include <QHeaderView>
+#include <QInputDialog>
+#include <QLabel>
+#include <QtCore/QRegExp>
+#include <QSplitter>
+#include <QTableView>
+#include <QToolBar>
+
+#include "icons/database.xpm"
+#include "icons/refresh.xpm"
+#include "icons/trash.xpm"
+
+static toSQL SQLQueues("toAQBrowser:Queues",
+                       "SELECT q.owner,\n"
+                       "       q.name,\n"
+                       "       q.queue_table,\n"
+                       "       q.queue_type,\n"
+                       "       NVL ( t.object_type, 'RAW' ),\n"
+                       "       t.recipients,\n"
+                       "       NVL ( a.waiting, 0 ),\n"
+                       "       NVL ( a.ready, 0 ),\n"
+                       "       NVL ( a.expired, 0 ),\n"
+                       "       NVL ( p.enqueued, -1 ),\n"
+                       "       NVL ( p.dequeued, -1 )\n"
+                       "  FROM sys.dba_queues q\n"
+                       "  JOIN sys.dba_queue_tables t ON t.owner = q.owner AND t.queue_table = q.queue_table\n"
+                       "  LEFT JOIN sys.v_$aq a ON a.qid = q.qid\n"
+                       "  LEFT JOIN ( SELECT queue_schema,\n"
+                       "                     queue_name,\n"
+                       "                     SUM ( enqueued_msgs ) enqueued,\n"
+                       "                     SUM ( dequeued_msgs ) dequeued\n"
+                       "                FROM sys.gv_$persistent_queues\n"
+                       "               GROUP BY queue_schema, queue_name ) p\n"
+                       "         ON p.queue_schema = q.owner AND p.queue_name = q.name\n"
+                       " ORDER BY q.owner, q.name",
+                       "List AQ queues with their depth and cumulative enqueue/dequeue counters "
+                       "(-1 when unknown), must have same columns",
+                       "1100");
+
+static toSQL SQLQueues8("toAQBrowser:Queues",
+                        "SELECT q.owner,\n"
+                        "       q.name,\n"
+                        "       q.queue_table,\n"
+                        "       q.queue_type,\n"
+                        "       NVL ( t.object_type, 'RAW' ),\n"
+                        "       t.recipients,\n"
+                        "       NVL ( a.waiting, 0 ),\n"
+                        "       NVL ( a.ready, 0 ),\n"
+                        "       NVL ( a.expired, 0 ),\n"
+                        "       -1,\n"
+                        "       -1\n"
+                        "  FROM sys.dba_queues q,\n"
+                        "       sys.dba_queue_tables t,\n"
+                        "       sys.v_$aq a\n"
+                        " WHERE t.owner = q.owner\n"
+                        "   AND t.queue_table = q.queue_table\n"
+                        "   AND a.qid (+) = q.qid\n"
+                        " ORDER BY q.owner, q.name",
+                        "",
+                        "0800");
+
+static toSQL SQLPayloadAttributes("toAQBrowser:PayloadAttributes",
+                                  "SELECT attr_name\n"
+                                  "  FROM sys.all_type_attrs\n"
+                                  " WHERE owner = :own<char[128]>\n"
+                                  "   AND type_name = :typ<char[128]>\n"
+                                  "   AND attr_type_owner IS NULL\n"
+                                  " ORDER BY attr_no",
+                                  "Scalar attributes of a queue payload type, must have same binds and columns");
+
+static toSQL SQLSubscribers("toAQBrowser:Subscribers",
+                            "SELECT consumer_name\n"
+                            "  FROM sys.dba_queue_subscribers\n"
+                            " WHERE owner = :own<char[128]>\n"
+                            "   AND queue_name = :que<char[128]>\n"
+                            "   AND consumer_name IS NOT NULL\n"
+                            " ORDER BY consumer_name",
+                            "Subscribers of a multi consumer queue, must have same binds and columns",
+                            "1000");
+
+class toAQBrowserTool : public toTool
+{
+    protected:
+        const char **pictureXPM(void) override
+        {
+            return const_cast<const char**>(database_xpm);
+        }
+    public:
+        toAQBrowserTool()
+            : toTool(235, "AQ Browser")
+        { }
+        const char *menuItem() override
+        {
+            return "AQ Browser";
+        }
+        toToolWidget* toolWindow(QWidget *parent, toConnection &connection) override
+        {
+            return new toAQBrowser(parent, connection);
+        }
+        bool canHandle(const toConnection &conn) override
+        {
+            return conn.providerIs("Oracle");
+        }
+        void closeWindow(toConnection &connection) override {};
+};
+
+static toAQBrowserTool AQBrowserTool;
+
+// Oracle names are quoted as they are stored in the dictionary, "OWNER.TYPE" gives "OWNER"."TYPE"
+static QString quoteDotted(const QString &name)
+{
+    QStringList parts = name.split(QChar('.'));
+    for (QStringList::iterator i = parts.begin(); i != parts.end(); i++)
+        *i = QChar('"') + *i + QChar('"');
+    return parts.join(QChar('.'));
+}
+
+toAQQueueModel::toAQQueueModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int toAQQueueModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : Queues.size();
+}
+
+int toAQQueueModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(ColumnCount);
+}
+
+QVariant toAQQueueModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= Queues.size())
+        return QVariant();
+
+    const Queue &queue = Queues[index.row()];
+    if (role == Qt::TextAlignmentRole)
+        return index.column() >= Waiting ? QVariant(Qt::AlignRight | Qt::AlignVCenter) : QVariant();
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
+    switch (index.column())
+    {
+        case Owner:
+            return queue.Owner;
+        case Name:
+            return queue.Name;
+        case Type:
+            return queue.Type;
+        case Payload:
+            return queue.Payload;
+        case Waiting:
+            return queue.Waiting;
+        case Ready:
+            return queue.Ready;
+        case Expired:
+            return queue.Expired;
+        case Enqueued:
+            return queue.Enqueued < 0 ? QVariant() : QVariant(queue.Enqueued);
+        case Dequeued:
+            return queue.Dequeued < 0 ? QVariant() : QVariant(queue.Dequeued);
+        case EnqueueRate:
+            return queue.EnqueueRate < 0 ? QVariant() : QVariant(QString::number(queue.EnqueueRate, 'f', 2));
+        case DequeueRate:
+            return queue.DequeueRate < 0 ? QVariant() : QVariant(QString::number(queue.DequeueRate, 'f', 2));
+    }
+    return QVariant();
+}
+
+QVariant toAQQueueModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QAbstractTableModel::headerData(section, orientation, role);
+
+    switch (section)
+    {
+        case Owner:
+            return tr("Owner");
+        case Name:
+            return tr("Queue");
+        case Type:
+            return tr("Type");
+        case Payload:
+            return tr("Payload");
+        case Waiting:
+            return tr("Waiting");
+        case Ready:
+            return tr("Ready");
+        case Expired:
+            return tr("Expired");
+        case Enqueued:
+            return tr("Enqueued");
+        case Dequeued:
+            return tr("Dequeued");
+        case EnqueueRate:
+            return tr("Enqueued/s");
+        case DequeueRate:
+            return tr("Dequeued/s");
+    }
+    return QVariant();
+}
+
+void toAQQueueModel::setSample(QVector<Queue> &queues)
+{
+    double seconds = Sampled.isValid() ? Sampled.restart() / 1000.0 : 0;
+    if (!Sampled.isValid())
+        Sampled.start();
+
+    QHash<QString, Queue> previous;
+    for (QVector<Queue>::iterator i = queues.begin(); i != queues.end(); i++)
+    {
+        i->EnqueueRate = -1;
+        i->DequeueRate = -1;
+        QHash<QString, Queue>::const_iterator p = Previous.constFind(i->key());
+        if (seconds > 0 && p != Previous.constEnd())
+        {
+            // Counters restart with the instance, a negative difference is not a rate
+            if (i->Enqueued >= p->Enqueued && p->Enqueued >= 0)
+                i->EnqueueRate = (i->Enqueued - p->Enqueued) / seconds;
+            if (i->Dequeued >= p->Dequeued && p->Dequeued >= 0)
+                i->DequeueRate = (i->Dequeued - p->Dequeued) / seconds;
+        }
+        previous.insert(i->key(), *i);
+    }
+
+    beginResetModel();
+    Queues.swap(queues);
+    Previous.swap(previous);
+    endResetModel();
+}
+
+void toAQQueueModel::clear(void)
+{
+    beginResetModel();
+    Queues.clear();
+    Previous.clear();
+    Sampled.invalidate();
+    endResetModel();
+}
+
+toAQBrowser::toAQBrowser(QWidget *main, toConnection &connection)
+    : toToolWidget(AQBrowserTool, "aqbrowser.html", main, connection, "toAQBrowser")
+{
+    QToolBar *toolbar = Utils::toAllocBar(this, tr("AQ browser"));
+    layout()->addWidget(toolbar);
+
+    QAction *refreshAct = new QAction(QPixmap(const_cast<const char**>(refresh_xpm)),
+                                      tr("Update queue list"), this);
+    refreshAct->setShortcut(QKeySequence::Refresh);
+    connect(refreshAct, SIGNAL(triggered()), this, SLOT(refresh(void)));
+    toolbar->addAction(refreshAct);
+
+    toolbar->addSeparator();
+
+    DequeueAct = new QAction(QPixmap(const_cast<const char**>(trash_xpm)),
+                             tr("Dequeue messages from the selected queue"), this);
+    connect(DequeueAct, SIGNAL(triggered()), this, SLOT(dequeue(void)));
+    toolbar->addAction(DequeueAct);
+    DequeueAct->setEnabled(false);
+
+    toolbar->addSeparator();
+
+    toolbar->addWidget(new QLabel(tr("Refresh") + " ", toolbar));
+    Refresh = new toRefreshCombo(toolbar);
+    connect(Refresh, SIGNAL(timeout(void)), this, SLOT(refreshQueues(void)));
+    toolbar->addWidget(Refresh);
+
+    toolbar->addWidget(new Utils::toSpacer());
+
+    new toChangeConnection(toolbar);
+
+    QSplitter *splitter = new QSplitter(Qt::Vertical, this);
+    layout()->addWidget(splitter);
+
+    Model = new toAQQueueModel(this);
+    Queues = new QTableView(splitter);
+    Queues->setModel(Model);
+    Queues->setSelectionBehavior(QAbstractItemView::SelectRows);
+    Queues->setSelectionMode(QAbstractItemView::SingleSelection);
+    Queues->verticalHeader()->hide();
+    connect(Queues->selectionModel(), SIGNAL(currentRowChanged(const QModelIndex &, const QModelIndex &)),
+            this, SLOT(changeQueue(void)));
+
+    Messages = new toResultTableView(true, false, splitter, "Messages");
+
+    Refresh->watch(this);
+
+    setFocusProxy(Queues);
+    refresh();
+}
+
+toAQBrowser::~toAQBrowser()
+{
+    stopQuery();
+}
+
+void toAQBrowser::stopQuery(void)
+{
+    if (Query)
+    {
+        Query->disconnect(this);
+        Query->stop();
+        Query->deleteLater();
+        Query = NULL;
+    }
+    Pending.clear();
+}
+
+void toAQBrowser::refresh(void)
+{
+    Attributes.clear();
+    refreshQueues();
+    if (!CurrentQueue.isEmpty())
+        Messages->refresh();
+}
+
+void toAQBrowser::refreshQueues(void)
+{
+    // A sample still being read is dropped, rates are computed over complete samples only
+    stopQuery();
+    try
+    {
+        toConnection &conn = connection();
+        Query = new toEventQuery(this, conn, toSQL::string(SQLQueues, conn), toQueryParams(), toEventQuery::READ_ALL);
+        connect(Query, &toEventQuery::dataAvailable, this, &toAQBrowser::receiveQueues);
+        connect(Query, &toEventQuery::done, this, &toAQBrowser::queuesDone);
+        connect(Query, &toEventQuery::error, this, &toAQBrowser::queuesError);
+        Query->start();
+    }
+    catch (const QString &str)
+    {
+        Utils::toStatusMessage(str);
+        emit done();
+    }
+}
+
+void toAQBrowser::receiveQueues(toEventQuery *query)
+{
+    if (query != Query)
+        return;
+
+    try
+    {
+        while (query->hasMore())
+        {
+            toAQQueueModel::Queue queue;
+            queue.Owner = (QString)query->readValue();
+            queue.Name = (QString)query->readValue();
+            queue.QueueTable = (QString)query->readValue();
+            queue.Type = (QString)query->readValue();
+            queue.Payload = (QString)query->readValue();
+            queue.MultiConsumer = (QString)query->readValue() == QLatin1String("MULTIPLE");
+            queue.Waiting = query->readValue().toLong();
+            queue.Ready = query->readValue().toLong();
+            queue.Expired = query->readValue().toLong();
+            queue.Enqueued = query->readValue().toLong();
+            queue.Dequeued = query->readValue().toLong();
+            Pending.push_back(queue);
+        }
+    }
+    catch (const QString &str)
+    {
+        queuesError(query, toConnection::exception(str));
+    }
+}
+
+void toAQBrowser::queuesDone(toEventQuery *query, unsigned long)
+{
+    if (query != Query)
+        return;
+    Query->deleteLater();
+    Query = NULL;
+
+    QString current = CurrentQueue;
+    Model->setSample(Pending);
+    Pending.clear();
+
+    // Keep the selected queue without reloading its messages
+    for (int row = 0; row < Model->rowCount(); row++)
+    {
+        if (Model->queue(row).key() == current)
+        {
+            Queues->selectionModel()->blockSignals(true);
+            Queues->selectRow(row);
+            Queues->selectionModel()->blockSignals(false);
+            break;
+        }
+    }
+    DequeueAct->setEnabled(currentRow() >= 0);
+    emit done();
+}
+
+void toAQBrowser::queuesError(toEventQuery *query, const toConnection::exception &str)
+{
+    if (query != Query)
+        return;
+    stopQuery();
+    Utils::toStatusMessage(str);
+    emit done();
+}
+
+int toAQBrowser::currentRow(void) const
+{
+    QModelIndexList rows = Queues->selectionModel()->selectedRows();
+    return rows.isEmpty() ? -1 : rows.first().row();
+}
+
+void toAQBrowser::changeQueue(void)
+{
+    int row = currentRow();
+    DequeueAct->setEnabled(row >= 0);
+    if (row < 0)
+    {
+        CurrentQueue.clear();
+        Messages->clearData();
+        return;
+    }
+
+    const toAQQueueModel::Queue &queue = Model->queue(row);
+    if (queue.key() == CurrentQueue)
+        return;
+    CurrentQueue = queue.key();
+
+    try
+    {
+        Messages->setSQL(messagesSQL(queue));
+        Messages->refreshWithParams(toQueryParams() << queue.Name);
+    }
+    TOCATCH;
+}
+
+QStringList toAQBrowser::payloadAttributes(const QString &payload)
+{
+    QHash<QString, QStringList>::const_iterator i = Attributes.constFind(payload);
+    if (i != Attributes.constEnd())
+        return i.value();
+
+    QStringList attributes;
+    int dot = payload.indexOf(QChar('.'));
+    if (dot > 0)
+    {
+        toConnectionSubLoan conn(connection());
+        toQuery query(conn, SQLPayloadAttributes, toQueryParams() << payload.left(dot) << payload.mid(dot + 1));
+        while (!query.eof())
+            attributes << (QString)query.readValue();
+    }
+    Attributes.insert(payload, attributes);
+    return attributes;
+}
+
+QString toAQBrowser::messagesSQL(const toAQQueueModel::Queue &queue, bool ready)
+{
+    QString sql = QString::fromLatin1("SELECT RAWTOHEX ( m.msg_id ) \"Message ID\",\n"
+                                      "       m.corr_id \"Correlation\",\n"
+                                      "       m.msg_priority \"Priority\",\n"
+                                      "       m.msg_state \"State\",\n"
+                                      "       m.enq_time \"Enqueued\",\n"
+                                      "       m.deq_time \"Dequeued\",\n"
+                                      "       m.retry_count \"Retries\"");
+    if (queue.MultiConsumer)
+        sql += QString::fromLatin1(",\n       m.consumer_name \"Consumer\"");
+
+    // Typed payloads get one column per scalar attribute
+    QStringList attributes = payloadAttributes(queue.Payload);
+    if (queue.Payload == QLatin1String("SYS.ANYDATA"))
+        sql += QString::fromLatin1(",\n       m.user_data.gettypename() \"Payload type\"");
+    else if (attributes.isEmpty())
+        sql += QString::fromLatin1(",\n       m.user_data \"Payload\"");
+    else
+    {
+        Q_FOREACH(QString const &attribute, attributes)
+            sql += QString::fromLatin1(",\n       m.user_data.\"%1\" \"%1\"").arg(attribute);
+    }
+
+    sql += QString::fromLatin1("\n  FROM %1 m\n"
+                               " WHERE m.queue = :que<char[128]>\n")
+           .arg(quoteDotted(queue.Owner + QLatin1String(".AQ$") + queue.QueueTable));
+    if (ready)
+    {
+        sql += QString::fromLatin1("   AND m.msg_state = 'READY'\n");
+        if (queue.MultiConsumer)
+            sql += QString::fromLatin1("   AND m.consumer_name = :con<char[128]>\n");
+    }
+    sql += QString::fromLatin1(" ORDER BY m.enq_time");
+    return sql;
+}
+
+QString toAQBrowser::dequeueSQL(const toAQQueueModel::Queue &queue, const QStringList &ids)
+{
+    QString payload = queue.Payload == QLatin1String("RAW") ? QString::fromLatin1("RAW(32767)") : quoteDotted(queue.Payload);
+
+    QStringList raws;
+    Q_FOREACH(QString const &id, ids)
+        raws << QString::fromLatin1("HEXTORAW('%1')").arg(id);
+
+    // Each message is dequeued by its id in one round trip, :res tells which ones were
+    // still there (ORA-25263 or ORA-25228 when another session took it meanwhile).
+    // Nothing is committed here.
+    return QString::fromLatin1("DECLARE\n"
+                               "  TYPE t_ids IS TABLE OF RAW(16);\n"
+                               "  l_ids     t_ids := t_ids(%3);\n"
+                               "  l_options DBMS_AQ.DEQUEUE_OPTIONS_T;\n"
+                               "  l_props   DBMS_AQ.MESSAGE_PROPERTIES_T;\n"
+                               "  l_payload %1;\n"
+                               "  l_msgid   RAW(16);\n"
+                               "  l_res     VARCHAR2(4000);\n"
+                               "  e_gone    EXCEPTION;\n"
+                               "  e_empty   EXCEPTION;\n"
+                               "  PRAGMA EXCEPTION_INIT(e_gone, -25263);\n"
+                               "  PRAGMA EXCEPTION_INIT(e_empty, -25228);\n"
+                               "BEGIN\n"
+                               "  l_options.wait := DBMS_AQ.NO_WAIT;\n"
+                               "  l_options.consumer_name := :con<char[128],in>;\n"
+                               "  FOR i IN 1 .. l_ids.COUNT LOOP\n"
+                               "    l_options.msgid := l_ids(i);\n"
+                               "    BEGIN\n"
+                               "      DBMS_AQ.DEQUEUE('%2', l_options, l_props, l_payload, l_msgid);\n"
+                               "      l_res := l_res || '1';\n"
+                               "    EXCEPTION\n"
+                               "      WHEN e_gone OR e_empty THEN\n"
+                               "        l_res := l_res || '0';\n"
+                               "    END;\n"
+                               "  END LOOP;\n"
+                               "  :res<char[4001],out> := l_res;\n"
+                               "END;")
+           .arg(payload)
+           .arg(quoteDotted(queue.Owner + QChar('.') + queue.Name))
+           .arg(raws.join(QLatin1String(", ")));
+}
+
+void toAQBrowser::dequeue(void)
+{
+    int row = currentRow();
+    if (row < 0)
+        return;
+    toAQQueueModel::Queue queue = Model->queue(row);
+
+    try
+    {
+        QString consumer;
+        if (queue.MultiConsumer)
+        {
+            QStringList consumers;
+            {
+                toConnectionSubLoan conn(connection());
+                toQuery query(conn, SQLSubscribers, toQueryParams() << queue.Owner << queue.Name);
+                while (!query.eof())
+                    consumers << (QString)query.readValue();
+            }
+            if (consumers.isEmpty())
+                throw tr("Queue %1 has no subscribers").arg(queue.key());
+
+            bool ok;
+            consumer = QInputDialog::getItem(this,
+                                             tr("Dequeue messages"),
+                                             tr("Dequeue as subscriber"),
+                                             consumers, 0, false, &ok);
+            if (!ok)
+                return;
+        }
+
+        bool ok;
+        int count = QInputDialog::getInt(this,
+                                         tr("Dequeue messages"),
+                                         tr("Maximum number of messages to remove from %1").arg(queue.key()),
+                                         100, 1, MaxDequeue, 100, &ok);
+        if (!ok)
+            return;
+
+        if (TOMessageBox::warning(this,
+                                  tr("Dequeue messages"),
+                                  tr("Are you sure you want to remove up to %1 messages from %2?\n"
+                                     "Dequeued messages are committed and can not be restored.").arg(count).arg(queue.key()),
+                                  tr("&Dequeue"),
+                                  tr("Cancel")) != 0)
+            return;
+
+        // The messages are read before they are removed, the dequeued ones are shown
+        // in place of the queue's messages
+        toQColumnDescriptionList columns;
+        toQueryAbstr::RowList dequeued;
+        {
+            toConnectionSubLoan conn(connection());
+            toQueryAbstr::RowList rows;
+            {
+                toQueryParams params;
+                params << queue.Name;
+                if (queue.MultiConsumer)
+                    params << consumer;
+                params << count;
+                toQuery query(conn,
+                              QString::fromLatin1("SELECT *\n  FROM (\n%1\n)\n WHERE ROWNUM <= :cnt<int>").arg(messagesSQL(queue, true)),
+                              params);
+                columns = query.describe();
+                int cols = query.columns();
+                while (!query.eof())
+                {
+                    toQueryAbstr::Row row;
+                    for (int i = 0; i < cols; i++)
+                        row << query.readValue();
+                    rows << row;
+                }
+            }
+
+            static const QRegExp hexId(QString::fromLatin1("[0-9A-F]{32}"));
+            try
+            {
+                for (int start = 0; start < rows.size(); start += DequeueChunk)
+                {
+                    QStringList ids;
+                    for (int i = start; i < rows.size() && i < start + DequeueChunk; i++)
+                    {
+                        QString id = (QString)rows.at(i).at(0);
+                        if (!hexId.exactMatch(id))
+                            throw tr("Unexpected message ID %1").arg(id);
+                        ids << id;
+                    }
+
+                    QString res;
+                    {
+                        toQuery query(conn, dequeueSQL(queue, ids), toQueryParams() << consumer);
+                        if (!query.eof())
+                            res = (QString)query.readValue();
+                    }
+                    for (int i = 0; i < ids.size(); i++)
+                        if (i < res.size() && res.at(i) == QChar('1'))
+                            dequeued << rows.at(start + i);
+                }
+                conn->commit();
+            }
+            catch (...)
+            {
+                conn->rollback();
+                throw;
+            }
+        }
+        Utils::toStatusMessage(tr("%1 messages dequeued from %2").arg(dequeued.size()).arg(queue.key()), false, false);
+
+        // The queue stays selected, refresh shows its remaining messages
+        Messages->showRows(columns, dequeued);
+        refreshQueues();
+    }
+    TOCATCH;
+}
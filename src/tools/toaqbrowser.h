@@ -0,0 +1,183 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include "widgets/totoolwidget.h"
+#include "core/toconnection.h"
+
+#include <QtCore/QAbstractTableModel>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QPointer>
+#include <QtCore/QVector>
+
+class QAction;
+class QTableView;
+class toEventQuery;
+class toRefreshCombo;
+class toResultTableView;
+
+/*! \brief List of AQ queues with their depth and enqueue/dequeue rates.
+ *
+ * The database only exposes cumulative enqueue/dequeue counters, the rates
+ * are computed on the client as the difference between two consecutive
+ * samples divided by the time elapsed between them.
+ */
+class toAQQueueModel : public QAbstractTableModel
+{
+        Q_OBJECT;
+    public:
+        enum Column
+        {
+            Owner = 0,
+            Name,
+            Type,
+            Payload,
+            Waiting,
+            Ready,
+            Expired,
+            Enqueued,
+            Dequeued,
+            EnqueueRate,
+            DequeueRate,
+            ColumnCount
+        };
+
+        struct Queue
+        {
+            QString Owner;
+            QString Name;
+            QString QueueTable;
+            QString Type;
+            QString Payload;      // payload type, "RAW" for raw queues
+            bool MultiConsumer;
+            qlonglong Waiting;
+            qlonglong Ready;
+            qlonglong Expired;
+            qlonglong Enqueued;   // cumulative counters, -1 when not available
+            qlonglong Dequeued;
+            double EnqueueRate;   // messages per second, -1 until two samples exist
+            double DequeueRate;
+
+            QString key(void) const
+            {
+                return Owner + QChar('.') + Name;
+            }
+        };
+
+        toAQQueueModel(QObject *parent);
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+        int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+        QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+        QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+        /** Replace the queue list with a new sample, rates are computed against the previous one.
+         */
+        void setSample(QVector<Queue> &queues);
+
+        /** Forget all samples, next sample will not have any rates.
+         */
+        void clear(void);
+
+        const Queue &queue(int row) const
+        {
+            return Queues[row];
+        }
+    private:
+        QVector<Queue> Queues;
+        QHash<QString, Queue> Previous;
+        QElapsedTimer Sampled;
+};
+
+/*! \brief Browser of Oracle Advanced Queuing queues.
+ *
+ * The upper pane lists the queues, the lower pane shows the messages of the
+ * selected queue read from its AQ$<queue table> view. Object payloads are
+ * expanded into one column per attribute. Messages are fetched incrementally
+ * by the result view so large queues are never read as a whole.
+ *
+ * Dequeue reads the oldest ready messages first, removes them by message id
+ * and shows the ones actually removed (with their payload) in the lower pane.
+ */
+class toAQBrowser : public toToolWidget
+{
+        Q_OBJECT;
+    public:
+        toAQBrowser(QWidget *parent, toConnection &connection);
+        virtual ~toAQBrowser();
+
+    signals:
+        void done(void);
+
+    public slots:
+        void refresh(void);
+        void refreshQueues(void);
+        void dequeue(void);
+
+    private slots:
+        void changeQueue(void);
+        void receiveQueues(toEventQuery*);
+        void queuesDone(toEventQuery*, unsigned long);
+        void queuesError(toEventQuery*, const toConnection::exception &);
+
+    private:
+        void slotWindowActivated(toToolWidget*) override {};
+
+        void stopQuery(void);
+        int currentRow(void) const;
+        QStringList payloadAttributes(const QString &payload);
+        /** Messages of the queue, or (ready) the ones the current user can dequeue */
+        QString messagesSQL(const toAQQueueModel::Queue &queue, bool ready = false);
+        /** Dequeue the messages with the given ids (hex), returns a '1' or '0' per id */
+        QString dequeueSQL(const toAQQueueModel::Queue &queue, const QStringList &ids);
+
+        enum
+        {
+            MaxDequeue = 100000,   // dequeued messages are kept in memory to be shown
+            DequeueChunk = 200     // message ids sent in one PL/SQL block
+        };
+
+        toRefreshCombo *Refresh;
+        QAction *DequeueAct;
+        QTableView *Queues;
+        toAQQueueModel *Model;
+        toResultTableView *Messages;
+
+        QPointer<toEventQuery> Query;
+        QVector<toAQQueueModel::Queue> Pending;
+        QString CurrentQueue;
+        QHash<QString, QStringList> Attributes;   // payload type -> scalar attributes
+};
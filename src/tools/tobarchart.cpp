@@ -54,54 +54,31 @@ void toBarChart::paintChart(QPainter *p, QRect &rect)
 
     if (!Zooming)
     {
-        if (MinAuto)
+        if (MinAuto && Series.series() > 0)
         {
-            bool first = true;
-            std::list<std::list<double> >::reverse_iterator i = Values.rbegin();
-            if (i != Values.rend())
-            {
-                for (std::list<double>::iterator j = (*i).begin(); j != (*i).end(); j++)
-                {
-                    if (first)
-                    {
-                        first = false;
-                        zMinValue = *j;
-                    }
-                    else if (zMinValue > *j)
-                        zMinValue = *j;
-                }
-            }
+            toTimeSeries::MinMax range = Series.range(Series.series() - 1, 0, Series.size());
+            if (range.Valid)
+                zMinValue = range.Min;
         }
         if (MaxAuto)
         {
             bool first = true;
-            std::list<double> total;
+            std::vector<double> total(Series.size(), 0);
             std::list<bool>::iterator e = Enabled.begin();
+            for (int i = 0; i < Series.series(); i++)
             {
-                for (std::list<std::list<double> >::iterator i = Values.begin(); i != Values.end(); i++)
+                if (e == Enabled.end() || *e)
                 {
-                    std::list<double>::iterator k = total.begin();
-                    if (e == Enabled.end() || *e)
+                    for (int j = 0; j < Series.size(); j++)
                     {
-                        for (std::list<double>::iterator j = (*i).begin(); j != (*i).end(); j++)
-                        {
-                            if (k == total.end())
-                            {
-                                total.insert(total.end(), *j);
-                                k = total.end();
-                            }
-                            else
-                            {
-                                *k += *j;
-                                k++;
-                            }
-                        }
+                        if (Series.hasValue(i, j))
+                            total[j] += Series.value(i, j);
                     }
-                    if (e != Enabled.end())
-                        e++;
                 }
+                if (e != Enabled.end())
+                    e++;
             }
-            for (std::list<double>::iterator i = total.begin(); i != total.end(); i++)
+            for (std::vector<double>::iterator i = total.begin(); i != total.end(); i++)
             {
                 if (first)
                 {
@@ -143,31 +120,42 @@ void toBarChart::paintChart(QPainter *p, QRect &rect)
         if (Zooming)
             p->drawText(2, 2, rect.width() - 4, rect.height() - 4,
                         Qt::AlignLeft | Qt::AlignTop, tr("Zoom"));
+        int last = Series.size() - SkipSamples;
+        int width = rect.width() - 4;
+        // With more samples than pixels stack the maximum of every pixel column instead
+        bool decimated = samples > width && width > 1;
+        int points = decimated ? width : samples;
+        std::vector<toTimeSeries::MinMax> buckets;
         std::list<bool>::reverse_iterator e = Enabled.rbegin();
-        for (std::list<std::list<double> >::reverse_iterator i = Values.rbegin(); i != Values.rend(); i++)
+        for (int i = Series.series() - 1; i >= 0; i--)
         {
             if (e == Enabled.rend() || *e)
             {
-                std::list<double> &val = *i;
+                if (decimated)
+                    Series.decimate(i, last - samples, last, width, buckets);
                 int count = 0;
-                int skip = SkipSamples;
-                QPolygon a(samples + 10);
+                QPolygon a(points + 10);
                 int x = rect.width() - 2;
-                for (std::list<double>::reverse_iterator j = val.rbegin(); j != val.rend() && x >=
-                        2;
-                        j++)
+                for (int j = last - 1; count < points && x >= 2; j--)
                 {
-                    if (skip > 0)
-                        skip--;
+                    double v;
+                    if (decimated)
+                    {
+                        const toTimeSeries::MinMax &bucket = buckets[width - 1 - count];
+                        if (!bucket.Valid)
+                            break;
+                        v = bucket.Max;
+                    }
                     else
                     {
-                        int val = int(rect.height() - 2 - ((*j - zMinValue) / (zMaxValue - zMinValue) * (rect.height() - 4)));
-                        x = rect.width() - 2 - count * (rect.width() - 4) / (samples - 1);
-                        a.setPoint(count, x, val);
-                        count++;
-                        if (count >= samples)
+                        if (j < 0 || !Series.hasValue(i, j))
                             break;
+                        v = Series.value(i, j);
                     }
+                    int val = int(rect.height() - 2 - ((v - zMinValue) / (zMaxValue - zMinValue) * (rect.height() - 4)));
+                    x = rect.width() - 2 - count * (rect.width() - 4) / (points - 1);
+                    a.setPoint(count, x, val);
+                    count++;
                 }
                 a.resize(count * 2);
                 Points.insert(Points.end(), a);
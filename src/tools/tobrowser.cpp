@@ -54,6 +54,7 @@
 #include "widgets/toresultschema.h"
 #include "core/toconnectionsub.h"
 #include "core/toconnectiontraits.h"
+#include "core/toquerycache.h"
 #include "core/toglobalevent.h"
 #include "core/toconfiguration.h"
 #include "toresultview.h"
@@ -1471,6 +1472,7 @@ void toBrowser::refresh(void)
 {
     try
     {
+        connection().queryCache().clear();
         mainTab_currentChanged(m_mainTab->currentIndex(), NO_USE_CACHE); // just a test do now requery the DB   // true);
     }
     TOCATCH
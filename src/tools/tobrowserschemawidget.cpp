@@ -33,10 +33,158 @@
  * END_COMMON_COPYRIGHT_HEADER */
 
 #include "tools/tobrowserschemawidget.h"
+#include "core/tocache.h"
 #include "core/tocodemodel.h"
 #include "core/utils.h"
+#include "widgets/toconnectionwidget.h"
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QRegExp>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+
+// Equivalent of UPPER(name) LIKE filter, the browser filters are upper case
+static QRegExp likeExpression(const QString &filter)
+{
+    QString pattern;
+    Q_FOREACH(QChar c, filter)
+    {
+        if (c == QChar('%'))
+            pattern += QString::fromLatin1(".*");
+        else if (c == QChar('_'))
+            pattern += QChar('.');
+        else
+            pattern += QRegExp::escape(QString(c));
+    }
+    return QRegExp(pattern, Qt::CaseInsensitive);
+}
+
+toBrowserSchemaLoader::toBrowserSchemaLoader(QObject *parent)
+    : QObject(parent)
+    , Thread(new QThread(this))
+    , Worker(new QObject)
+    , Generation(0)
+{
+    Thread->setObjectName("toBrowserSchemaLoader Thread");
+    Worker->moveToThread(Thread);
+    Thread->start();
+}
+
+toBrowserSchemaLoader::~toBrowserSchemaLoader()
+{
+    {
+        QMutexLocker lock(&Lock);
+        Generations.clear();
+    }
+    Thread->quit();
+    Thread->wait();
+    delete Worker;
+}
+
+void toBrowserSchemaLoader::list(QObject *requester, toCache &cache, const QString &schema, const QString &type, const QString &filter)
+{
+    int generation;
+    {
+        QMutexLocker lock(&Lock);
+        generation = ++Generation;
+        Generations.insert(requester, generation);
+    }
+    toCache *c = &cache;
+
+    QTimer::singleShot(0, Worker, [this, requester, generation, c, schema, type, filter]
+    {
+        if (!isCurrent(requester, generation))
+            return;
+
+        // Entries of a schema come ordered by name
+        QList<toCache::CacheEntry const*> entries = c->getEntriesInSchema(schema, type);
+        bool all = filter.isEmpty() || filter == QLatin1String("%");
+        QRegExp like = likeExpression(filter);
+        QStringList names;
+        names.reserve(entries.size());
+        int count = 0;
+        Q_FOREACH(toCache::CacheEntry const * e, entries)
+        {
+            if (++count % 1024 == 0 && !isCurrent(requester, generation))
+                return;
+            if (all || like.exactMatch(e->name.second))
+                names.append(e->name.second);
+        }
+
+        QTimer::singleShot(0, this, [this, requester, generation, names]
+        {
+            if (!isCurrent(requester, generation))
+                return;
+            emit listed(requester, names);
+        });
+    });
+}
+
+void toBrowserSchemaLoader::store(toCache &cache, const QString &schema, const QString &type, const QStringList &names)
+{
+    toCache *c = &cache;
+
+    QTimer::singleShot(0, Worker, [this, c, schema, type, names]
+    {
+        try
+        {
+            QList<toCache::CacheEntry*> rows;
+            rows.reserve(names.size());
+            Q_FOREACH(QString const & name, names)
+            {
+                toCache::CacheEntry *obj = toCache::createCacheEntry(schema, name, type, "");
+                if (obj != NULL) // Some objects (like DBLINKs are not held in the toCache => obj == NULL
+                    rows.append(obj);
+            }
+
+            // NOTE: Oracle directories do not belong to any particular schema.
+            //       Therefore they are saved as belonging to SYS schema.
+            QString owner = type == "DIRECTORY" ? QString::fromLatin1("SYS") : schema;
+            c->upsertSchemaEntries(owner, type, rows);
+
+            // Update information when list of this type of objects in this schema was updated
+            // NOTE: Type is placed in the name field in order not to
+            // mix this meta-information with actual list of objects.
+            c->upsertEntry(new toCache::CacheEntry(owner, type, toCache::TORA_SCHEMA_LIST, ""));
+        }
+        catch (const QString &str)
+        {
+            QTimer::singleShot(0, this, [str]
+            {
+                Utils::toStatusMessage(str);
+            });
+        }
+    });
+}
+
+void toBrowserSchemaLoader::cancel(QObject *requester)
+{
+    QMutexLocker lock(&Lock);
+    Generations.remove(requester);
+}
+
+bool toBrowserSchemaLoader::isCurrent(QObject *requester, int generation)
+{
+    QMutexLocker lock(&Lock);
+    return Generations.value(requester) == generation;
+}
+
+toBrowserSchemaLoader *toBrowserSchemaLoader::shared(QObject *view)
+{
+    QObject *owner = view;
+    for (QObject *cur = view; cur; cur = cur->parent())
+    {
+        if (dynamic_cast<toConnectionWidget *>(cur))
+        {
+            owner = cur;
+            break;
+        }
+    }
+    toBrowserSchemaLoader *loader = owner->findChild<toBrowserSchemaLoader *>(QString(), Qt::FindDirectChildrenOnly);
+    if (!loader)
+        loader = new toBrowserSchemaLoader(owner);
+    return loader;
+}
 
 toBrowserSchemaTableView::toBrowserSchemaTableView(QWidget * parent, const QString &type)
     : toResultTableView(true, false, parent),
@@ -48,6 +196,22 @@ toBrowserSchemaTableView::toBrowserSchemaTableView(QWidget * parent, const QStri
         connect(this, SIGNAL(done()), this, SLOT(updateCache()));
 }
 
+toBrowserSchemaTableView::~toBrowserSchemaTableView()
+{
+    if (Loader)
+        Loader->cancel(this);
+}
+
+toBrowserSchemaLoader *toBrowserSchemaTableView::loader(void)
+{
+    if (!Loader)
+    {
+        Loader = toBrowserSchemaLoader::shared(this);
+        connect(Loader, SIGNAL(listed(QObject *, const QStringList &)), this, SLOT(slotListed(QObject *, const QStringList &)));
+    }
+    return Loader;
+}
+
 QString toBrowserSchemaTableView::objectName()
 {
     return selectedIndex(1).data(Qt::EditRole).toString();
@@ -55,10 +219,9 @@ QString toBrowserSchemaTableView::objectName()
 
 void toBrowserSchemaTableView::refreshWithParams(const QString & schema, const QString & filter)
 {
-    // If all objects of a specific type are to be displayed, try displaying them from the cache
-    // This cannot work for filtered objects yet as we do not want to re-impelement the "like" operator.
-    if (filter == "%" &&
-            !ObjectType.isEmpty() &&
+    // If objects of a specific type are cached, list them from the cache. Reading,
+    // filtering and sorting the cached names is done by the loader thread.
+    if (!ObjectType.isEmpty() &&
             !ForceRequery
             /* && toConnection::currentConnection(this).cacheAvailable(false)*/)
     {
@@ -72,46 +235,44 @@ void toBrowserSchemaTableView::refreshWithParams(const QString & schema, const Q
         else
             sch = schema;
 
-        if (toConnection::currentConnection(this).getCache().findEntry(toCache::ObjectRef(sch, ObjectType, ""))) // search for entry of type TORA_SCHEMA_LIST
+        toCache &cache = toConnection::currentConnection(this).getCache();
+        if (cache.findEntry(toCache::ObjectRef(sch, ObjectType, ""))) // search for entry of type TORA_SCHEMA_LIST
         {
-            this->queryFromCache(sch, ObjectType);
+            loader()->list(this, cache, sch, ObjectType, filter);
             return;
         }
     }
 
+    if (Loader)
+        Loader->cancel(this);
     ForceRequery = false;
     Schema = schema;
     toResultTableView::refreshWithParams(toQueryParams() << schema << filter);
 }
 
+void toBrowserSchemaTableView::slotListed(QObject *requester, const QStringList &names)
+{
+    if (requester != this)
+        return;
+    queryFromCache(ObjectType, names);
+}
+
 void toBrowserSchemaTableView::updateCache(void)
 {
     // if toEventQuery creation thrown an exception, Model == NULL
     if (this->Model == NULL)
         return;
 
-    // Update list of objects
-    QList<toCache::CacheEntry*> rows;
-    toCache::CacheEntry *obj;
+    // Only the names are copied here (implicitly shared), cache entries are
+    // created and upserted by the loader thread
     // TODO: Check that result model rows are NOT sorted in descending order as that would break updating of cache!!!
-    toQueryAbstr::RowList modelRows = this->Model->getRawData();
+    QStringList names;
+    toQueryAbstr::RowList &modelRows = this->Model->getRawData();
+    names.reserve(modelRows.size());
     for (QList<toQueryAbstr::Row>::iterator i = modelRows.begin(); i != modelRows.end(); i++)
-    {
-        obj = toCache::createCacheEntry(Schema, (QString)(*i)[1], ObjectType, "");
-        if (obj != NULL) // Some objects (like DBLINKs are not held in the toCache => obj == NULL
-            rows.append(obj);
-    }
-    // NOTE: Oracle directories do not belong to any particular schema.
-    //       Therefore they are saved as belonging to SYS schema.
-    if (ObjectType == "DIRECTORY")
-        Schema = "SYS";
-
-    toConnection::currentConnection(this).getCache().upsertSchemaEntries(Schema, ObjectType, rows);
+        names.append((QString)(*i)[1]);
 
-    // Update information when list of this type of objects in this schema was updated
-    // NOTE: Type is placed in the name field in order not to
-    // mix this meta-information with actual list of objects.
-    toConnection::currentConnection(this).getCache().upsertEntry(new toCache::CacheEntry(Schema, ObjectType, toCache::TORA_SCHEMA_LIST, ""));
+    loader()->store(toConnection::currentConnection(this).getCache(), Schema, ObjectType, names);
 } // updateCache
 
 toBrowserSchemaCodeBrowser::toBrowserSchemaCodeBrowser(QWidget * parent)
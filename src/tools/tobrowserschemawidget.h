@@ -36,10 +36,61 @@
 #define TOBROWSERSCHEMAWIDGET_H
 
 #include <QTreeView>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QPointer>
+#include <QtCore/QStringList>
 
 #include "toresulttableview.h"
 
+class toCache;
 class toCodeModel;
+class QThread;
+
+/*! \brief Serves object lists of toBrowserSchemaTableView from a worker thread.
+
+Lists are read from toCache, filtered and sorted off the GUI thread. Lists
+read from the database are written back to toCache off the GUI thread too.
+One loader (and thread) is shared by all the views of a tool, see @ref shared.
+A new list request of a view cancels the one of that view in progress.
+*/
+class toBrowserSchemaLoader : public QObject
+{
+        Q_OBJECT
+
+    public:
+        toBrowserSchemaLoader(QObject *parent);
+        virtual ~toBrowserSchemaLoader();
+
+        /** Loader of the connection widget (tool) view is in, created on first use */
+        static toBrowserSchemaLoader *shared(QObject *view);
+
+        /**
+         * Start listing cached objects for requester.
+         *
+         * @param filter Upper case LIKE pattern the object names must match.
+         */
+        void list(QObject *requester, toCache &cache, const QString &schema, const QString &type, const QString &filter);
+
+        /** Replace cached objects of type in schema with names, in one bulk upsert */
+        void store(toCache &cache, const QString &schema, const QString &type, const QStringList &names);
+
+        /** Forget the list in progress for requester, listed() will not be emitted for it */
+        void cancel(QObject *requester);
+
+    signals:
+        void listed(QObject *requester, const QStringList &names);
+
+    private:
+        bool isCurrent(QObject *requester, int generation);
+
+        QThread *Thread;
+        QObject *Worker;
+        QMutex Lock;
+        // Generation of the list in progress per requester, guarded by Lock
+        QHash<QObject*, int> Generations;
+        int Generation;
+};
 
 
 /*! \brief A base class for "object schema browsers" used in toBrowser m_objectsMap.
@@ -84,8 +135,13 @@ class toBrowserSchemaTableView : public toResultTableView,
         QString ObjectType; // What type of object is displayed (TABLE, VIEW etc.)
         QString Schema;
 
+        // Shared, only views with an ObjectType use it
+        QPointer<toBrowserSchemaLoader> Loader;
+        toBrowserSchemaLoader *loader(void);
+
     public:
         toBrowserSchemaTableView(QWidget * parent = 0, const QString &type = 0);
+        ~toBrowserSchemaTableView();
 
         QString objectName();
 
@@ -93,6 +149,7 @@ class toBrowserSchemaTableView : public toResultTableView,
 
     private slots:
         void updateCache(void);
+        void slotListed(QObject *requester, const QStringList &names);
 };
 
 
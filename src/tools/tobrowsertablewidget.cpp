@@ -75,7 +75,10 @@ static toSQL SQLTableIndex("toBrowserTableWidget:TableIndex",
                            "   AND IND.index_owner = AL.owner ( + )\n"
                            "ORDER BY ind.index_name, ind.column_position",
                            "List the indexes on a table",
-                           "");
+                           "",
+                           "",
+                           "Oracle",
+                           toSQL::Dictionary);
 static toSQL SQLTableIndexSapDB("toBrowserTableWidget:TableIndex",
                                 "SELECT owner,\n"
                                 "       indexname \"Index_Name\",\n"
@@ -200,7 +203,10 @@ static toSQL SQLTableConstraint(
     "       AND main.r_owner = refs.owner (+)\n"
     "       AND main.position = refs.position (+)\n",
     "List the constraints on a table",
-    "");
+    "",
+    "",
+    "Oracle",
+    toSQL::Dictionary);
 
 static toSQL SQLTableConstraintPG(
     "toBrowser:TableConstraint",
@@ -250,7 +256,10 @@ static toSQL SQLTableReferences(
     " WHERE referenced_owner = :owner<char[101]>\n"
     "   AND referenced_name = :tab<char[101]>",
     "List the references on a table",
-    "");
+    "",
+    "",
+    "Oracle",
+    toSQL::Dictionary);
 
 static toSQL SQLTableTriggerSapDB("toBrowser:TableTrigger",
                                   "SELECT TriggerName,'UPDATE' \"Event\",''\"Column\",'ENABLED' \"Status\",''\"Description\"\n"
@@ -276,7 +285,9 @@ static toSQL SQLTableTrigger("toBrowser:TableTrigger",
                              "  FROM SYS.ALL_TRIGGERS\n"
                              " WHERE Table_Owner = :f1<char[101]> AND Table_Name = :f2<char[101]>",
                              "",
-                             "0801");
+                             "0801",
+                             "Oracle",
+                             toSQL::Dictionary);
 static toSQL SQLTableTrigger8("toBrowser:TableTrigger",
                               "SELECT Trigger_Name,Triggering_Event,Status,Description \n"
                               "  FROM SYS.ALL_TRIGGERS\n"
@@ -320,7 +331,10 @@ static toSQL SQLTableInfo("toBrowser:TableInformation",
                           "SELECT *\n"
                           "  FROM SYS.ALL_TABLES\n"
                           " WHERE OWNER = :f1<char[101]> AND Table_Name = :f2<char[101]>",
-                          "");
+                          "",
+                          "",
+                          "Oracle",
+                          toSQL::Dictionary);
 static toSQL SQLTableInfoPgSQL("toBrowser:TableInformation",
                                "SELECT c.*\n"
                                "  FROM pg_class c LEFT OUTER JOIN pg_namespace n ON c.relnamespace=n.oid\n"
@@ -0,0 +1,503 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "tools/tohprof.h"
+#include "core/utils.h"
+#include "core/toconnection.h"
+#include "core/toconnectionsubloan.h"
+#include "core/toquery.h"
+#include "core/tosql.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QComboBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QSplitter>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include <algorithm>
+
+static toSQL SQLHProfDetect("toHProf:Detect",
+                            "select count(1)\n"
+                            "  from dbmshp_runs a,\n"
+                            "       dbmshp_function_info b,\n"
+                            "       dbmshp_parent_child_info c\n"
+                            " where a.runid = null and b.runid = null and c.runid = null",
+                            "Detect if hierarchical profiler tables seems to exist");
+
+static toSQL SQLHProfRuns("toHProf:ListRuns",
+                          "SELECT runid,\n"
+                          "       TO_CHAR(run_timestamp,'YYYY-MM-DD HH24:MI:SS'),\n"
+                          "       run_comment,\n"
+                          "       total_elapsed_time\n"
+                          "  FROM dbmshp_runs\n"
+                          " ORDER BY runid DESC",
+                          "Get list of analyzed hierarchical profiler runs, same columns");
+
+static toSQL SQLHProfFunctions("toHProf:Functions",
+                               "SELECT symbolid,\n"
+                               "       owner,\n"
+                               "       module,\n"
+                               "       type,\n"
+                               "       function,\n"
+                               "       line#,\n"
+                               "       calls,\n"
+                               "       function_elapsed_time,\n"
+                               "       subtree_elapsed_time\n"
+                               "  FROM dbmshp_function_info\n"
+                               " WHERE runid = :run<char[101]>",
+                               "Get functions of a hierarchical profiler run, same columns and binds");
+
+static toSQL SQLHProfEdges("toHProf:ParentChild",
+                           "SELECT parentsymid,\n"
+                           "       childsymid,\n"
+                           "       calls,\n"
+                           "       function_elapsed_time,\n"
+                           "       subtree_elapsed_time\n"
+                           "  FROM dbmshp_parent_child_info\n"
+                           " WHERE runid = :run<char[101]>",
+                           "Get caller/callee edges of a hierarchical profiler run, same columns and binds");
+
+// Times in DBMSHP tables are microseconds
+static QString FormatMicro(double usec)
+{
+    if (usec >= 1E6)
+        return QString::number(usec / 1E6, 'f', 3) + " s";
+    if (usec >= 1E3)
+        return QString::number(usec / 1E3, 'f', 3) + " ms";
+    return QString::number(usec, 'f', 0) + " us";
+}
+
+namespace
+{
+    enum
+    {
+        SymbolRole = Qt::UserRole,
+        SortRole = Qt::UserRole + 1
+    };
+
+    // Sorts numeric columns on the raw value instead of the formatted text
+    class toHProfItem : public QTreeWidgetItem
+    {
+        public:
+            toHProfItem(QTreeWidget *parent) : QTreeWidgetItem(parent) {}
+            toHProfItem(QTreeWidgetItem *parent) : QTreeWidgetItem(parent) {}
+
+            void setValue(int column, double value, const QString &text)
+            {
+                setText(column, text);
+                setData(column, SortRole, value);
+                setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+            }
+
+            bool operator<(const QTreeWidgetItem &other) const override
+            {
+                int col = treeWidget() ? treeWidget()->sortColumn() : 0;
+                QVariant a = data(col, SortRole);
+                QVariant b = other.data(col, SortRole);
+                if (a.isValid() && b.isValid())
+                    return a.toDouble() < b.toDouble();
+                return QTreeWidgetItem::operator<(other);
+            }
+    };
+}
+
+QString toHProfRun::Function::label(void) const
+{
+    QString ret;
+    if (!Owner.isEmpty())
+        ret = Owner + ".";
+    if (!Module.isEmpty())
+        ret += Module + ".";
+    ret += Name;
+    if (Line > 0)
+        ret += QString::fromLatin1(" (%1)").arg(Line);
+    return ret;
+}
+
+void toHProfRun::clear(void)
+{
+    RunId = 0;
+    Total = 0;
+    Functions.clear();
+    Children.clear();
+}
+
+void toHProfRun::load(toConnection &conn, int runid)
+{
+    clear();
+    toConnectionSubLoan con(conn);
+    toQueryParams params = toQueryParams() << QString::number(runid);
+
+    toQuery funcs(con, SQLHProfFunctions, params);
+    while (!funcs.eof())
+    {
+        Function f;
+        int symbol = funcs.readValue().toInt();
+        f.Owner = (QString)funcs.readValue();
+        f.Module = (QString)funcs.readValue();
+        f.Type = (QString)funcs.readValue();
+        f.Name = (QString)funcs.readValue();
+        f.Line = funcs.readValue().toInt();
+        f.Calls = funcs.readValue().toDouble();
+        f.Self = funcs.readValue().toDouble();
+        f.Subtree = funcs.readValue().toDouble();
+        Total += f.Self;
+        Functions.insert(symbol, f);
+    }
+
+    toQuery edges(con, SQLHProfEdges, params);
+    while (!edges.eof())
+    {
+        Edge e;
+        e.Parent = edges.readValue().toInt();
+        e.Child = edges.readValue().toInt();
+        e.Calls = edges.readValue().toDouble();
+        e.Self = edges.readValue().toDouble();
+        e.Subtree = edges.readValue().toDouble();
+        Children.insert(e.Parent, e);
+    }
+    RunId = runid;
+}
+
+QList<int> toHProfRun::roots(void) const
+{
+    QSet<int> called;
+    for (QMultiMap<int, Edge>::const_iterator i = Children.begin(); i != Children.end(); ++i)
+        if (i.value().Child != i.value().Parent)
+            called.insert(i.value().Child);
+
+    QList<int> ret;
+    for (QMap<int, Function>::const_iterator i = Functions.begin(); i != Functions.end(); ++i)
+        if (!called.contains(i.key()))
+            ret << i.key();
+    return ret;
+}
+
+QList<int> toHProfRun::bySelfTime(void) const
+{
+    QList<QPair<double, int> > sorted;
+    for (QMap<int, Function>::const_iterator i = Functions.begin(); i != Functions.end(); ++i)
+        sorted << qMakePair(-i.value().Self, i.key());
+    std::sort(sorted.begin(), sorted.end());
+
+    QList<int> ret;
+    for (int i = 0; i < sorted.size(); i++)
+        ret << sorted[i].second;
+    return ret;
+}
+
+toHProfResult::toHProfResult(QWidget *parent)
+    : QWidget(parent)
+{
+    QVBoxLayout *vbox = new QVBoxLayout;
+    vbox->setSpacing(0);
+    vbox->setContentsMargins(0, 0, 0, 0);
+    setLayout(vbox);
+
+    QHBoxLayout *hbox = new QHBoxLayout;
+    Run = new QComboBox(this);
+    hbox->addWidget(Run, 1);
+    hbox->addWidget(new QLabel(tr("Compare with") + " ", this));
+    Compare = new QComboBox(this);
+    hbox->addWidget(Compare, 1);
+    vbox->addLayout(hbox);
+
+    Summary = new QLabel(this);
+    vbox->addWidget(Summary);
+
+    QSplitter *split = new QSplitter(Qt::Vertical, this);
+    vbox->addWidget(split);
+
+    Tree = new QTreeWidget(split);
+    Tree->setHeaderLabels(QStringList() << tr("Call tree") << tr("Calls")
+                          << tr("Self") << tr("Subtree") << tr("% of run"));
+    Tree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    Tree->header()->setStretchLastSection(false);
+    connect(Tree, SIGNAL(itemExpanded(QTreeWidgetItem *)), this, SLOT(expandItem(QTreeWidgetItem *)));
+
+    Flat = new QTreeWidget(split);
+    Flat->setRootIsDecorated(false);
+    Flat->setSortingEnabled(true);
+    Flat->header()->setStretchLastSection(false);
+
+    connect(Run, SIGNAL(activated(int)), this, SLOT(changeRun()));
+    connect(Compare, SIGNAL(activated(int)), this, SLOT(changeRun()));
+}
+
+bool toHProfResult::available(toConnection &conn)
+{
+    try
+    {
+        toConnectionSubLoan con(conn);
+        toQuery query(con, SQLHProfDetect, toQueryParams());
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+void toHProfResult::refresh(void)
+{
+    int current = Run->itemData(Run->currentIndex()).toInt();
+    int base = Compare->itemData(Compare->currentIndex()).toInt();
+
+    Run->clear();
+    Compare->clear();
+    Run->addItem(tr("Select run"), 0);
+    Compare->addItem(tr("No comparison"), 0);
+    try
+    {
+        toConnectionSubLoan con(toConnection::currentConnection(this));
+        toQuery query(con, SQLHProfRuns, toQueryParams());
+        while (!query.eof())
+        {
+            int runid = query.readValue().toInt();
+            QString stamp = (QString)query.readValue();
+            QString comment = (QString)query.readValue();
+            double total = query.readValue().toDouble();
+            QString text = QString::fromLatin1("%1 (%2): %3 [%4]")
+                           .arg(runid)
+                           .arg(stamp)
+                           .arg(comment)
+                           .arg(FormatMicro(total));
+            Run->addItem(text, runid);
+            Compare->addItem(text, runid);
+        }
+    }
+    TOCATCH
+
+    int pos = Run->findData(current);
+    Run->setCurrentIndex(pos > 0 ? pos : 0);
+    pos = Compare->findData(base);
+    Compare->setCurrentIndex(pos > 0 ? pos : 0);
+    changeRun();
+}
+
+void toHProfResult::showRun(int runid)
+{
+    refresh();
+    int pos = Run->findData(runid);
+    if (pos > 0)
+    {
+        Run->setCurrentIndex(pos);
+        changeRun();
+    }
+}
+
+void toHProfResult::changeRun(void)
+{
+    int current = Run->itemData(Run->currentIndex()).toInt();
+    int base = Compare->itemData(Compare->currentIndex()).toInt();
+    try
+    {
+        Utils::toBusy busy;
+        toConnection &conn = toConnection::currentConnection(this);
+        if (current != Current.runId())
+        {
+            if (current > 0)
+                Current.load(conn, current);
+            else
+                Current.clear();
+        }
+        if (base != Base.runId())
+        {
+            if (base > 0)
+                Base.load(conn, base);
+            else
+                Base.clear();
+        }
+    }
+    TOCATCH
+
+    if (Current.runId() > 0)
+        Summary->setText(tr("%1 functions, %2 total self time")
+                         .arg(Current.functions().size())
+                         .arg(FormatMicro(Current.total())));
+    else
+        Summary->clear();
+
+    fillTree();
+    fillFlat();
+}
+
+QTreeWidgetItem *toHProfResult::createNode(QTreeWidgetItem *parent, int symbol,
+        qint64 calls, double self, double subtree)
+{
+    toHProfItem *item = parent ? new toHProfItem(parent) : new toHProfItem(Tree);
+    item->setText(0, Current.functions().value(symbol).label());
+    item->setData(0, SymbolRole, symbol);
+    item->setValue(1, calls, QString::number(calls));
+    item->setValue(2, self, FormatMicro(self));
+    item->setValue(3, subtree, FormatMicro(subtree));
+    double total = Current.total();
+    item->setValue(4, subtree, total > 0 ? QString::number(subtree * 100 / total, 'f', 1) + "%" : QString());
+
+    // Recursive calls are shown once, stop expanding at the first repeat
+    bool recursive = false;
+    for (QTreeWidgetItem *up = parent; up; up = up->parent())
+    {
+        if (up->data(0, SymbolRole).toInt() == symbol)
+        {
+            recursive = true;
+            break;
+        }
+    }
+    if (recursive)
+        item->setText(0, item->text(0) + " " + tr("(recursive)"));
+    else if (!Current.children(symbol).isEmpty())
+        item->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+    return item;
+}
+
+void toHProfResult::fillTree(void)
+{
+    Tree->clear();
+    QList<int> roots = Current.roots();
+    for (int i = 0; i < roots.size(); i++)
+    {
+        const toHProfRun::Function &f = Current.functions()[roots[i]];
+        createNode(NULL, roots[i], f.Calls, f.Self, f.Subtree);
+    }
+    Tree->sortItems(3, Qt::DescendingOrder);
+}
+
+void toHProfResult::expandItem(QTreeWidgetItem *item)
+{
+    if (item->childCount() > 0 || item->childIndicatorPolicy() != QTreeWidgetItem::ShowIndicator)
+        return;
+    addChildren(item);
+    item->setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicatorWhenChildless);
+    item->sortChildren(3, Qt::DescendingOrder);
+}
+
+void toHProfResult::addChildren(QTreeWidgetItem *item)
+{
+    QList<toHProfRun::Edge> edges = Current.children(item->data(0, SymbolRole).toInt());
+    for (int i = 0; i < edges.size(); i++)
+        createNode(item, edges[i].Child, edges[i].Calls, edges[i].Self, edges[i].Subtree);
+}
+
+void toHProfResult::fillFlat(void)
+{
+    Flat->clear();
+    bool compare = Base.runId() > 0;
+    QStringList labels;
+    labels << tr("Function") << tr("Type") << tr("Calls") << tr("Self") << tr("Subtree") << tr("% self");
+    if (compare)
+        labels << tr("Self (base)") << tr("Calls (base)") << tr("Self delta");
+    Flat->setColumnCount(labels.size());
+    Flat->setHeaderLabels(labels);
+
+    // Match functions of both runs by key, overloads in the order of their lines
+    QHash<int, int> matched;
+    QList<int> baseOnly;
+    if (compare)
+    {
+        QHash<QString, QList<QPair<int, int> > > baseKeys, currentKeys;
+        for (QMap<int, toHProfRun::Function>::const_iterator i = Base.functions().begin(); i != Base.functions().end(); ++i)
+            baseKeys[i.value().key()] << qMakePair(i.value().Line, i.key());
+        for (QMap<int, toHProfRun::Function>::const_iterator i = Current.functions().begin(); i != Current.functions().end(); ++i)
+            currentKeys[i.value().key()] << qMakePair(i.value().Line, i.key());
+
+        for (QHash<QString, QList<QPair<int, int> > >::iterator b = baseKeys.begin(); b != baseKeys.end(); ++b)
+        {
+            QList<QPair<int, int> > base = b.value();
+            QList<QPair<int, int> > current = currentKeys.value(b.key());
+            std::sort(base.begin(), base.end());
+            std::sort(current.begin(), current.end());
+            for (int i = 0; i < base.size(); i++)
+            {
+                if (i < current.size())
+                    matched.insert(current[i].second, base[i].second);
+                else
+                    baseOnly << base[i].second;
+            }
+        }
+    }
+
+    Flat->setSortingEnabled(false);
+    QList<int> order = Current.bySelfTime();
+    double total = Current.total();
+    for (int i = 0; i < order.size(); i++)
+    {
+        const toHProfRun::Function &f = Current.functions()[order[i]];
+        toHProfItem *item = new toHProfItem(Flat);
+        item->setText(0, f.label());
+        item->setText(1, f.Type);
+        item->setValue(2, f.Calls, QString::number(f.Calls));
+        item->setValue(3, f.Self, FormatMicro(f.Self));
+        item->setValue(4, f.Subtree, FormatMicro(f.Subtree));
+        item->setValue(5, f.Self, total > 0 ? QString::number(f.Self * 100 / total, 'f', 1) + "%" : QString());
+        if (compare)
+        {
+            QHash<int, int>::const_iterator b = matched.constFind(order[i]);
+            double self = 0;
+            qint64 calls = 0;
+            if (b != matched.constEnd())
+            {
+                const toHProfRun::Function &o = Base.functions()[b.value()];
+                self = o.Self;
+                calls = o.Calls;
+            }
+            item->setValue(6, self, FormatMicro(self));
+            item->setValue(7, calls, QString::number(calls));
+            item->setValue(8, f.Self - self, (f.Self >= self ? "+" : "-") + FormatMicro(qAbs(f.Self - self)));
+        }
+    }
+
+    // Functions only called in the base run
+    foreach(int symbol, baseOnly)
+    {
+        const toHProfRun::Function &o = Base.functions()[symbol];
+        toHProfItem *item = new toHProfItem(Flat);
+        item->setText(0, o.label());
+        item->setText(1, o.Type);
+        item->setValue(2, 0, "0");
+        item->setValue(3, 0, FormatMicro(0));
+        item->setValue(4, 0, FormatMicro(0));
+        item->setValue(5, 0, QString());
+        item->setValue(6, o.Self, FormatMicro(o.Self));
+        item->setValue(7, o.Calls, QString::number(o.Calls));
+        item->setValue(8, -o.Self, "-" + FormatMicro(o.Self));
+    }
+
+    Flat->setSortingEnabled(true);
+    Flat->sortItems(3, Qt::DescendingOrder);
+    Flat->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+}
@@ -0,0 +1,161 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QString>
+#include <QWidget>
+
+class QComboBox;
+class QLabel;
+class QTreeWidget;
+class QTreeWidgetItem;
+class toConnection;
+
+/**
+ * One run of the hierarchical profiler (DBMS_HPROF) as analyzed into the
+ * DBMSHP_FUNCTION_INFO and DBMSHP_PARENT_CHILD_INFO tables. Times are in
+ * microseconds.
+ */
+class toHProfRun
+{
+    public:
+        struct Function
+        {
+            QString Owner;
+            QString Module;
+            QString Type;
+            QString Name;
+            int Line;
+            qint64 Calls;
+            double Self;
+            double Subtree;
+
+            /** Identity of the function across runs (symbol ids are per run).
+             * The line is left out so that a function moved by an edit still
+             * matches, overloads share a key and are told apart by their order.
+             */
+            QString key(void) const
+            {
+                return Owner + "." + Module + "." + Name;
+            }
+            QString label(void) const;
+        };
+
+        struct Edge
+        {
+            int Parent;
+            int Child;
+            qint64 Calls;
+            double Self;
+            double Subtree;
+        };
+
+        toHProfRun() : RunId(0), Total(0) {}
+
+        /** Read a run, throws QString on error */
+        void load(toConnection &conn, int runid);
+        void clear(void);
+
+        int runId(void) const
+        {
+            return RunId;
+        }
+        /** Sum of the self time of all functions */
+        double total(void) const
+        {
+            return Total;
+        }
+        const QMap<int, Function> &functions(void) const
+        {
+            return Functions;
+        }
+        /** Edges leaving a function, that is its callees */
+        QList<Edge> children(int symbol) const
+        {
+            return Children.values(symbol);
+        }
+        /** Functions never called by another one, tops of the call tree */
+        QList<int> roots(void) const;
+        /** Symbols ordered by decreasing self time */
+        QList<int> bySelfTime(void) const;
+
+    private:
+        int RunId;
+        double Total;
+        QMap<int, Function> Functions;
+        QMultiMap<int, Edge> Children;
+};
+
+/**
+ * Result view of hierarchical profiler runs, a call tree and a flat list
+ * of functions ordered by self time. When a second run is selected the
+ * flat list shows the difference between both runs per function.
+ */
+class toHProfResult : public QWidget
+{
+        Q_OBJECT;
+
+    public:
+        toHProfResult(QWidget *parent);
+
+        /** True when the DBMSHP tables are accessible */
+        static bool available(toConnection &conn);
+
+    public slots:
+        void refresh(void);
+        void showRun(int runid);
+
+    private slots:
+        void changeRun(void);
+        void expandItem(QTreeWidgetItem *item);
+
+    private:
+        void fillTree(void);
+        void fillFlat(void);
+        void addChildren(QTreeWidgetItem *item);
+        QTreeWidgetItem *createNode(QTreeWidgetItem *parent, int symbol,
+                                    qint64 calls, double self, double subtree);
+
+        QComboBox *Run;
+        QComboBox *Compare;
+        QLabel *Summary;
+        QTreeWidget *Tree;
+        QTreeWidget *Flat;
+
+        toHProfRun Current;
+        toHProfRun Base;
+};
@@ -44,9 +44,12 @@
 #include "core/toconnectionsub.h"
 #include "core/toconnectionsubloan.h"
 #include "core/toglobalevent.h"
+#include "core/toeventquery.h"
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QVector>
 #include <QtCore/QDebug>
 #include <QToolBar>
 #include <QToolButton>
@@ -54,10 +57,13 @@
 #include <QLayout>
 #include <QtGui/QPixmap>
 #include <QProgressDialog>
+#include <QLabel>
+#include <QSpinBox>
 
 #include "icons/refresh.xpm"
 #include "icons/toinvalid.xpm"
 #include "icons/compile.xpm"
+#include "icons/stop.xpm"
 #include "toresultcode.h"
 #include "toresulttableview.h"
 #include "toresultview.h"
@@ -70,6 +76,25 @@ static toSQL SQLListInvalid("toInvalid:ListInvalid",
                             " WHERE status <> 'VALID'",
                             "Get invalid objects, must have same first three columns.");
 
+static toSQL SQLInvalidDependencies("toInvalid:Dependencies",
+                                    "SELECT d.owner, d.name, d.type,\n"
+                                    "       d.referenced_owner, d.referenced_name, d.referenced_type\n"
+                                    "  FROM sys.all_dependencies d, sys.all_objects o\n"
+                                    " WHERE o.status <> 'VALID'\n"
+                                    "   AND o.owner = d.referenced_owner\n"
+                                    "   AND o.object_name = d.referenced_name\n"
+                                    "   AND o.object_type = d.referenced_type\n"
+                                    "   AND d.referenced_link_name IS NULL",
+                                    "Dependencies on invalid objects, first three columns are the dependent "
+                                    "object, last three the referenced one.");
+
+static toSQL SQLObjectStatus("toInvalid:ObjectStatus",
+                             "SELECT owner, object_name, object_type, status\n"
+                             "  FROM sys.all_objects\n"
+                             " WHERE %1",
+                             "Status of a list of objects, %1 is replaced by conditions on owner, object_name "
+                             "and object_type.");
+
 static toSQL SQLListSource("toInvalid:ListSource",
                            "SELECT Text FROM SYS.ALL_SOURCE\n"
                            " WHERE Owner = :f1<char[101]> AND Name = :f2<char[101]> AND type = :f3<char[101]>",
@@ -131,10 +156,27 @@ toInvalid::toInvalid(QWidget *main, toConnection &connection)
             SLOT(refresh()));
     refreshAct->setShortcut(QKeySequence::Refresh);
 
-    toolbar->addAction(QIcon(QPixmap(const_cast<const char**>(compile_xpm))),
-                       tr("Recompile all invalid"),
-                       this,
-                       SLOT(recompileSelected()));
+    RecompileAct = toolbar->addAction(QIcon(QPixmap(const_cast<const char**>(compile_xpm))),
+                                      tr("Recompile all invalid"),
+                                      this,
+                                      SLOT(recompileSelected()));
+
+    StopAct = toolbar->addAction(QIcon(QPixmap(const_cast<const char**>(stop_xpm))),
+                                 tr("Stop recompiling"),
+                                 this,
+                                 SLOT(stopRecompile()));
+    StopAct->setEnabled(false);
+
+    toolbar->addSeparator();
+
+    toolbar->addWidget(new QLabel(tr("Parallel") + " ",
+                                  toolbar));
+    Parallel = new QSpinBox(toolbar);
+    Parallel->setMinimum(1);
+    Parallel->setMaximum(32);
+    Parallel->setValue(4);
+    Parallel->setToolTip(tr("Number of sessions used to recompile"));
+    toolbar->addWidget(Parallel);
 
     toolbar->addWidget(new Utils::toSpacer());
 
@@ -154,101 +196,76 @@ toInvalid::toInvalid(QWidget *main, toConnection &connection)
 
     connect(Source, SIGNAL(executed()), this, SLOT(refresh()));
 
+    Scheduler = new toInvalidScheduler(connection, this);
+    connect(Scheduler, &toInvalidScheduler::objectStatus, this, &toInvalid::objectStatus);
+    connect(Scheduler, &toInvalidScheduler::progress, this, &toInvalid::recompileProgress);
+    connect(Scheduler, &toInvalidScheduler::finished, this, &toInvalid::recompileFinished);
+
     refresh();
     setFocusProxy(Objects);
 }
 
 void toInvalid::recompileSelected(void)
 {
-    QProgressDialog progress(tr("Recompiling all invalid"),
-                             tr("Cancel"),
-                             0,
-                             Objects->model()->rowCount(),
-                             this);
-    progress.setWindowTitle("Recompiling");
-    progress.show();
-
-    toConnectionTraits const& traits(connection().getTraits());
-    toConnectionSubLoan conn(connection());
+    if (Scheduler->isRunning())
+        return;
+
+    QList<toInvalidScheduler::Object> objects;
+    ObjectRows.clear();
     for (toResultTableView::iterator it(Objects); (*it).isValid(); it++)
     {
-        progress.setLabelText("Recompiling " +
-                              Objects->model()->data((*it).row(), 2).toString() +
-                              "." +
-                              Objects->model()->data((*it).row(), 3).toString());
-        progress.setValue(progress.value() + 1);
-
-        qApp->processEvents();
-
-        if (progress.wasCanceled())
-            break;
-
-        QString type  = Objects->model()->data((*it).row(), 3).toString();
-        QString owner = Objects->model()->data((*it).row(), 1).toString();
-        QString name  = Objects->model()->data((*it).row(), 2).toString();
-        QString sql;
-        if (type == "INDEX")
-            sql = QString("ALTER INDEX %1.%2 REBUILD")
-            .arg(traits.quote(owner))
-            .arg(traits.quote(name));
-        else if (type == "PACKAGE BODY")
-            sql = QString("ALTER PACKAGE %1.%2 COMPILE BODY")
-            .arg(traits.quote(owner))
-            .arg(traits.quote(name));
-        else if (type == "TYPE BODY")
-            sql = QString("ALTER TYPE %1.%2 COMPILE BODY")
-            .arg(traits.quote(owner))
-            .arg(traits.quote(name));
-        else if ((type == "SYNONYM") && (Objects->model()->data((*it).row(), 1).toString() == "PUBLIC"))
-        {
-            // only SYS user is allowed to do ALTER PUBLIC SYNONYM ...
-            // other users can only do CREATE OR REPLACE PUBLIC SYNONYM ...
-            QList<QPair<QString,toCache::ObjectRef> > objects;
-            toExtract extract(const_cast<toConnection&>(conn.ParentConnection), NULL);
-            extract.setCode(true);
-            extract.setHeading(false);
-            extract.setPrompt(false);
-            extract.setReplace(true); // get create OR REPLACE statement
-            objects.append(QPair<QString,toCache::ObjectRef>(type, toCache::ObjectRef("PUBLIC", name, "")));
-            sql = extract.create(objects);
-            throw tr("recompileSelected SYNONYM not implement yet");
-        }
-        else
-            sql = QString("ALTER %1 %2.%3 COMPILE")
-            .arg(type)
-            .arg(traits.quote(owner))
-            .arg(traits.quote(name));
+        toInvalidScheduler::Object object;
+        object.Owner = Objects->model()->data((*it).row(), 1).toString();
+        object.Name  = Objects->model()->data((*it).row(), 2).toString();
+        object.Type  = Objects->model()->data((*it).row(), 3).toString();
+        objects << object;
+        ObjectRows.insert(object.Owner + "." + object.Name + " " + object.Type, (*it).row());
+    }
+    if (objects.isEmpty())
+        return;
 
-        try
-        {
-            // remove trailing newlines, spaces, tabs and semicolons from execution
-            // as this could cause "execution" of empty statement (doing nothing)
-            int l = sql.length() - 1;
-            while (l >= 0 && (sql.at(l) == ';' || sql.at(l).isSpace()))
-                l--;
+    RecompileAct->setEnabled(false);
+    StopAct->setEnabled(true);
+    try
+    {
+        Scheduler->start(objects, Parallel->value());
+    }
+    TOCATCH;
+}
 
-            TLOG(2, toDecorator, __HERE__) << "statement=" << sql.mid(0, l + 1) << std::endl;
+void toInvalid::stopRecompile(void)
+{
+    Scheduler->stop();
+    StopAct->setEnabled(false);
+}
 
-            if (l >= 0)
-            {
-                conn.execute(sql.mid(0, l + 1));
-            }
-        }
-        catch (toConnection::exception const& e)
-        {
-            toGlobalEventSingle::Instance().showMessage(e, false, true);
-        }
-        catch (...)
-        {
-            TLOG(1, toDecorator, __HERE__) << "	Ignored exception." << std::endl;
-        }
-    }
+void toInvalid::objectStatus(const QString &owner, const QString &name, const QString &type, const QString &status)
+{
+    toResultModel *model = Objects->model();
+    if (!model)
+        return;
+
+    // The rows may have been sorted meanwhile, verify before updating
+    int row = ObjectRows.value(owner + "." + name + " " + type, -1);
+    if (row < 0 || row >= model->rowCount() ||
+            model->data(row, 2).toString() != name ||
+            model->data(row, 1).toString() != owner ||
+            model->data(row, 3).toString() != type)
+        return;
+    model->setValue(row, 4, toQValue(status));
+}
 
-    if (progress.isVisible())
-        progress.close();
+void toInvalid::recompileProgress(int done, int total, int wave, int waves)
+{
+    Utils::toStatusMessage(tr("Recompiled %1 of %2 objects, wave %3 of %4")
+                           .arg(done).arg(total).arg(wave).arg(waves), false, false);
+}
 
-    qApp->processEvents();
-    this->refresh();
+void toInvalid::recompileFinished(void)
+{
+    RecompileAct->setEnabled(true);
+    StopAct->setEnabled(false);
+    refresh();
 }
 
 void toInvalid::refresh(void)
@@ -321,3 +338,399 @@ void toInvalid::changeSelection(void)
     }
     TOCATCH;
 }
+
+toInvalidScheduler::toInvalidScheduler(toConnection &conn, QObject *parent)
+    : QObject(parent)
+    , Connection(conn)
+    , Wave(0)
+    , Sessions(1)
+    , Done(0)
+    , Stopped(false)
+    , Dependencies(NULL)
+    , Status(NULL)
+    , QueryFailed(false)
+{
+}
+
+QString toInvalidScheduler::key(const QString &owner, const QString &name, const QString &type)
+{
+    return owner + QChar('.') + name + QChar(' ') + type;
+}
+
+QString toInvalidScheduler::compileStatement(const toConnection &conn, const Object &object)
+{
+    toConnectionTraits const& traits(conn.getTraits());
+    QString sql;
+    if (object.Type == "INDEX")
+        sql = QString("ALTER INDEX %1.%2 REBUILD")
+              .arg(traits.quote(object.Owner))
+              .arg(traits.quote(object.Name));
+    else if (object.Type == "PACKAGE BODY")
+        sql = QString("ALTER PACKAGE %1.%2 COMPILE BODY")
+              .arg(traits.quote(object.Owner))
+              .arg(traits.quote(object.Name));
+    else if (object.Type == "TYPE BODY")
+        sql = QString("ALTER TYPE %1.%2 COMPILE BODY")
+              .arg(traits.quote(object.Owner))
+              .arg(traits.quote(object.Name));
+    else if (object.Type == "SYNONYM" && object.Owner == "PUBLIC")
+        // only SYS user is allowed to do ALTER PUBLIC SYNONYM ...
+        // other users would have to use CREATE OR REPLACE PUBLIC SYNONYM ...
+        return QString();
+    else
+        sql = QString("ALTER %1 %2.%3 COMPILE")
+              .arg(object.Type)
+              .arg(traits.quote(object.Owner))
+              .arg(traits.quote(object.Name));
+    return sql;
+}
+
+void toInvalidScheduler::start(const QList<Object> &objects, int sessions)
+{
+    if (isRunning())
+        return;
+
+    Objects = objects;
+    Sessions = (std::max)(sessions, 1);
+    Done = 0;
+    Wave = 0;
+    Stopped = false;
+    Waves.clear();
+    Pending.clear();
+    Compiled.clear();
+
+    Index.clear();
+    for (int i = 0; i < Objects.size(); i++)
+        Index.insert(key(Objects[i].Owner, Objects[i].Name, Objects[i].Type), i);
+    Dependents = QVector<QList<int> >(Objects.size());
+    Blockers = QVector<int>(Objects.size(), 0);
+
+    QueryFailed = false;
+    try
+    {
+        Dependencies = new toEventQuery(this, Connection, toSQL::string(SQLInvalidDependencies, Connection), toQueryParams(), toEventQuery::READ_ALL);
+        connect(Dependencies, &toEventQuery::dataAvailable, this, &toInvalidScheduler::receiveDependencies);
+        connect(Dependencies, &toEventQuery::done, this, &toInvalidScheduler::dependenciesDone);
+        connect(Dependencies, &toEventQuery::error, this, &toInvalidScheduler::queryError);
+        Dependencies->start();
+    }
+    catch (const QString &str)
+    {
+        Utils::toStatusMessage(str);
+        delete Dependencies;
+        Dependencies = NULL;
+        QueryFailed = true;
+        buildWaves();
+        startWave();
+    }
+}
+
+void toInvalidScheduler::stop(void)
+{
+    Stopped = true;
+    Pending.clear();
+    Wave = Waves.size();
+    if (Running.isEmpty() && !Dependencies && !Status)
+        emit finished();
+}
+
+void toInvalidScheduler::queryError(toEventQuery *, const toConnection::exception &e)
+{
+    // done() follows
+    Utils::toStatusMessage(e);
+    QueryFailed = true;
+}
+
+void toInvalidScheduler::receiveDependencies(toEventQuery *query)
+{
+    if (query != Dependencies)
+        return;
+
+    try
+    {
+        while (query->hasMore())
+        {
+            QString owner = query->readValue();
+            QString name  = query->readValue();
+            QString type  = query->readValue();
+            QString refOwner = query->readValue();
+            QString refName  = query->readValue();
+            QString refType  = query->readValue();
+
+            int dependent = Index.value(key(owner, name, type), -1);
+            int referenced = Index.value(key(refOwner, refName, refType), -1);
+            if (dependent < 0 || referenced < 0 || dependent == referenced)
+                continue;
+            Dependents[referenced] << dependent;
+            Blockers[dependent]++;
+        }
+    }
+    catch (const QString &str)
+    {
+        Utils::toStatusMessage(str);
+        QueryFailed = true;
+    }
+}
+
+void toInvalidScheduler::dependenciesDone(toEventQuery *query)
+{
+    if (query != Dependencies)
+        return;
+    Dependencies->deleteLater();
+    Dependencies = NULL;
+
+    if (Stopped)
+    {
+        emit finished();
+        return;
+    }
+    buildWaves();
+    startWave();
+}
+
+void toInvalidScheduler::buildWaves(void)
+{
+    Waves.clear();
+
+    if (QueryFailed)
+    {
+        // Without dependencies fall back to compiling everything in one wave
+        QList<int> all;
+        for (int i = 0; i < Objects.size(); i++)
+            all << i;
+        Waves << all;
+        return;
+    }
+
+    // Dependents[i] are the objects to compile after i, Blockers[i] the number of objects i waits for
+    QVector<int> blockers(Blockers);
+    QList<int> current;
+    for (int i = 0; i < Objects.size(); i++)
+        if (blockers[i] == 0)
+            current << i;
+
+    int placed = 0;
+    while (!current.isEmpty())
+    {
+        Waves << current;
+        placed += current.size();
+        QList<int> next;
+        foreach(int referenced, current)
+        {
+            foreach(int dependent, Dependents[referenced])
+            {
+                if (--blockers[dependent] == 0)
+                    next << dependent;
+            }
+        }
+        current = next;
+    }
+
+    // Whatever is left is part of a dependency cycle, compile it last
+    if (placed < Objects.size())
+    {
+        QList<int> rest;
+        for (int i = 0; i < Objects.size(); i++)
+            if (blockers[i] > 0)
+                rest << i;
+        Waves << rest;
+    }
+}
+
+void toInvalidScheduler::startWave(void)
+{
+    while (Wave < Waves.size())
+    {
+        Pending = Waves[Wave];
+        Compiled.clear();
+        emit progress(Done, Objects.size(), Wave + 1, Waves.size());
+        if (!Pending.isEmpty())
+        {
+            dispatch();
+            return;
+        }
+        Wave++;
+    }
+    emit finished();
+}
+
+void toInvalidScheduler::dispatch(void)
+{
+    while (Running.size() < Sessions && !Pending.isEmpty())
+    {
+        int i = Pending.takeFirst();
+        const Object &object = Objects.at(i);
+        QString sql = compileStatement(Connection, object);
+        if (sql.isEmpty())
+        {
+            Done++;
+            emit objectStatus(object.Owner, object.Name, object.Type, "INVALID");
+            continue;
+        }
+
+        TLOG(2, toDecorator, __HERE__) << "statement=" << sql << std::endl;
+
+        try
+        {
+            toEventQuery *query = new toEventQuery(this, Connection, sql, toQueryParams(), toEventQuery::READ_ALL);
+            connect(query, &toEventQuery::done, this, &toInvalidScheduler::compileDone);
+            connect(query, &toEventQuery::error, this, &toInvalidScheduler::compileError);
+            Running.insert(query, i);
+            emit objectStatus(object.Owner, object.Name, object.Type, "COMPILING");
+            query->start();
+        }
+        catch (const QString &str)
+        {
+            Done++;
+            Utils::toStatusMessage(str);
+        }
+    }
+
+    if (Running.isEmpty())
+        finishWave();
+}
+
+void toInvalidScheduler::compileError(toEventQuery *query, const toConnection::exception &e)
+{
+    // done() follows, the final status is read when the wave is over
+    if (Running.contains(query))
+        toGlobalEventSingle::Instance().showMessage(e, false, true);
+}
+
+void toInvalidScheduler::compileDone(toEventQuery *query)
+{
+    if (!Running.contains(query))
+        return;
+
+    Compiled << Running.take(query);
+    Done++;
+    query->deleteLater();
+
+    if (Pending.isEmpty() && Running.isEmpty())
+        finishWave();
+    else
+        dispatch();
+}
+
+void toInvalidScheduler::finishWave(void)
+{
+    // Read the status of the objects just compiled, this gives the result
+    // of the wave, and of the next wave to skip what was fixed meanwhile
+    QList<int> check = Compiled;
+    if (!Stopped && Wave + 1 < Waves.size())
+        check += Waves[Wave + 1];
+
+    if (check.isEmpty())
+    {
+        Wave++;
+        startWave();
+        return;
+    }
+
+    // Oracle limits expression lists to 1000 entries
+    QStringList conditions;
+    QStringList objects;
+    foreach(int i, check)
+    {
+        const Object &object = Objects.at(i);
+        objects << QString("('%1','%2','%3')").arg(QString(object.Owner).replace('\'', "''"),
+                                                   QString(object.Name).replace('\'', "''"),
+                                                   QString(object.Type).replace('\'', "''"));
+        if (objects.size() == 1000)
+        {
+            conditions << "(owner, object_name, object_type) IN (" + objects.join(",") + ")";
+            objects.clear();
+        }
+    }
+    if (!objects.isEmpty())
+        conditions << "(owner, object_name, object_type) IN (" + objects.join(",") + ")";
+
+    Valid.clear();
+    QueryFailed = false;
+    try
+    {
+        QString sql = toSQL::string(SQLObjectStatus, Connection).arg(conditions.join("\n    OR "));
+        Status = new toEventQuery(this, Connection, sql, toQueryParams(), toEventQuery::READ_ALL);
+        connect(Status, &toEventQuery::dataAvailable, this, &toInvalidScheduler::receiveStatus);
+        connect(Status, &toEventQuery::done, this, &toInvalidScheduler::statusDone);
+        connect(Status, &toEventQuery::error, this, &toInvalidScheduler::queryError);
+        Status->start();
+    }
+    catch (const QString &str)
+    {
+        Utils::toStatusMessage(str);
+        delete Status;
+        Status = NULL;
+        Compiled.clear();
+        Wave++;
+        startWave();
+    }
+}
+
+void toInvalidScheduler::receiveStatus(toEventQuery *query)
+{
+    if (query != Status)
+        return;
+
+    try
+    {
+        while (query->hasMore())
+        {
+            QString owner = query->readValue();
+            QString name  = query->readValue();
+            QString type  = query->readValue();
+            QString status = query->readValue();
+            if (status == "VALID")
+                Valid.insert(key(owner, name, type));
+        }
+    }
+    catch (const QString &str)
+    {
+        Utils::toStatusMessage(str);
+        QueryFailed = true;
+    }
+}
+
+void toInvalidScheduler::statusDone(toEventQuery *query)
+{
+    if (query != Status)
+        return;
+    Status->deleteLater();
+    Status = NULL;
+
+    if (!QueryFailed)
+    {
+        foreach(int i, Compiled)
+        {
+            const Object &object = Objects.at(i);
+            bool valid = Valid.contains(key(object.Owner, object.Name, object.Type));
+            emit objectStatus(object.Owner, object.Name, object.Type, valid ? "VALID" : "INVALID");
+        }
+    }
+    Compiled.clear();
+
+    if (Stopped)
+    {
+        emit finished();
+        return;
+    }
+
+    Wave++;
+    if (!QueryFailed && Wave < Waves.size())
+    {
+        QList<int> wave;
+        foreach(int i, Waves[Wave])
+        {
+            const Object &object = Objects.at(i);
+            if (!Valid.contains(key(object.Owner, object.Name, object.Type)))
+                wave << i;
+            else
+            {
+                Done++;
+                emit objectStatus(object.Owner, object.Name, object.Type, "SKIPPED");
+            }
+        }
+        Waves[Wave] = wave;
+    }
+    startWave();
+}
@@ -36,10 +36,104 @@
 #define TOINVALID_H
 
 #include "widgets/totoolwidget.h"
+#include "core/toconnection.h"
 
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QVector>
+
+class QAction;
+class QSpinBox;
+class toEventQuery;
 class toResultCode;
 class toResultTableView;
 
+/**
+ * Recompiles a set of invalid objects in dependency order.
+ *
+ * The dependencies between the objects are read from ALL_DEPENDENCIES and
+ * the objects are split into waves, each wave only depending on objects of
+ * earlier waves (objects in dependency cycles end up in the last wave).
+ * The objects of a wave are compiled by up to N background queries, each
+ * using its own session. When a wave is over the status of its objects and
+ * of the objects of the next wave is read, those of the next wave which
+ * became valid as a side effect are skipped. All queries run in the
+ * background, the GUI thread never waits for the database.
+ */
+class toInvalidScheduler : public QObject
+{
+        Q_OBJECT;
+
+    public:
+        struct Object
+        {
+            QString Owner;
+            QString Name;
+            QString Type;
+        };
+
+        toInvalidScheduler(toConnection &conn, QObject *parent);
+
+        /** Start recompiling objects using at most sessions parallel sessions */
+        void start(const QList<Object> &objects, int sessions);
+
+        /** Do not start any more compilations, running ones are allowed to finish */
+        void stop(void);
+
+        bool isRunning(void) const
+        {
+            return !Running.isEmpty() || Wave < Waves.size() || Dependencies || Status;
+        }
+
+        /** Statement compiling an object, empty if it can not be recompiled */
+        static QString compileStatement(const toConnection &conn, const Object &object);
+
+    signals:
+        /** Status of an object changed, status is COMPILING, VALID, INVALID or SKIPPED */
+        void objectStatus(const QString &owner, const QString &name, const QString &type, const QString &status);
+        void progress(int done, int total, int wave, int waves);
+        void finished(void);
+
+    private slots:
+        void compileDone(toEventQuery*);
+        void compileError(toEventQuery*, const toConnection::exception &);
+        void receiveDependencies(toEventQuery*);
+        void dependenciesDone(toEventQuery*);
+        void receiveStatus(toEventQuery*);
+        void statusDone(toEventQuery*);
+        void queryError(toEventQuery*, const toConnection::exception &);
+
+    private:
+        static QString key(const QString &owner, const QString &name, const QString &type);
+        void buildWaves(void);
+        void startWave(void);
+        void dispatch(void);
+        void finishWave(void);
+
+        toConnection &Connection;
+        QList<Object> Objects;
+        QList<QList<int> > Waves;
+        int Wave;
+        int Sessions;
+        QList<int> Pending;
+        QHash<toEventQuery*, int> Running;
+        QList<int> Compiled;
+        int Done;
+        bool Stopped;
+
+        // Dependency graph read before the first wave, indexes into Objects
+        toEventQuery *Dependencies;
+        QHash<QString, int> Index;
+        QVector<QList<int> > Dependents;
+        QVector<int> Blockers;
+
+        // Status of the objects of the wave just compiled and of the next one
+        toEventQuery *Status;
+        QSet<QString> Valid;
+        bool QueryFailed;
+};
+
 class toInvalid : public toToolWidget
 {
         Q_OBJECT;
@@ -51,11 +145,21 @@ class toInvalid : public toToolWidget
         virtual void changeSelection(void);
         virtual void refresh(void);
         void recompileSelected(void);
+        void stopRecompile(void);
     private slots:
         virtual void slotWindowActivated(toToolWidget*) {};
+        void objectStatus(const QString &owner, const QString &name, const QString &type, const QString &status);
+        void recompileProgress(int done, int total, int wave, int waves);
+        void recompileFinished(void);
     private:
         toResultTableView *Objects;
         toResultCode *Source;
+        QSpinBox *Parallel;
+        QAction *RecompileAct;
+        QAction *StopAct;
+        toInvalidScheduler *Scheduler;
+        // Grid row of each object being recompiled, keyed by "owner.name type"
+        QHash<QString, int> ObjectRows;
 };
 
 #endif
@@ -43,6 +43,11 @@
 
 #include <QtGui/QPainter>
 #include <QScrollBar>
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+
+#include <cmath>
+#include <limits>
 
 #include "core/toeditorconfiguration.h"
 #include "icons/print.xpm"
@@ -86,16 +91,7 @@ double toLineChart::round(double round, bool up)
 void toLineChart::setSamples(int samples)
 {
     Samples = samples;
-
-    if (Samples > 0)
-    {
-        while (int(XValues.size()) > Samples)
-            XValues.erase(XValues.begin());
-
-        for (std::list<std::list<double> >::iterator i = Values.begin(); i != Values.end(); i++)
-            while (int((*i).size()) > Samples)
-                (*i).erase((*i).begin());
-    }
+    Series.setCapacity(Samples);
     update();
 }
 
@@ -140,28 +136,7 @@ toLineChart::toLineChart(QWidget *parent, const char *name, toWFlags f)
 
 void toLineChart::addValues(std::list<double> &value, const QString &xValue)
 {
-    if (int(XValues.size()) == Samples && Samples > 0)
-        XValues.erase(XValues.begin());
-    XValues.insert(XValues.end(), xValue);
-
-    if (Samples > 0)
-        for (std::list<std::list<double> >::iterator i = Values.begin(); i != Values.end(); i++)
-            if (int((*i).size()) == Samples)
-                (*i).erase((*i).begin());
-
-    std::list<double>::iterator j = value.begin();
-    for (std::list<std::list<double> >::iterator i = Values.begin(); i != Values.end() && j != value.end(); i++)
-    {
-        (*i).insert((*i).end(), *j);
-        j++;
-    }
-    while (j != value.end())
-    {
-        std::list<double> t;
-        t.insert(t.end(), *j);
-        Values.insert(Values.end(), t);
-        j++;
-    }
+    Series.append(value, xValue);
 
     emit valueAdded(value, xValue);
 
@@ -214,13 +189,14 @@ void toLineChart::paintTitle(QPainter *p, QRect &rect)
     if (Last)
     {
         QString str;
-        for (std::list<std::list<double> >::iterator i = Values.begin(); i != Values.end(); i++)
+        for (int i = 0; i < Series.series(); i++)
         {
-            if ((*i).begin() != (*i).end())
+            double last = Series.last(i);
+            if (!std::isnan(last))
             {
                 if (!str.isEmpty())
                     str += QString::fromLatin1("\n");
-                str += toQValue::formatNumber(*(*i).rbegin());
+                str += toQValue::formatNumber(last);
                 str += YPostfix;
             }
         }
@@ -334,18 +310,15 @@ void toLineChart::paintAxis(QPainter *p, QRect &rect)
         QString maxXstr;
         QString minXstr;
         int xoffset = 0;
-        if (XValues.size() > 1)
+        if (Series.size() > 1)
         {
 
-            int count = 0;
-            for (std::list<QString>::reverse_iterator i = XValues.rbegin(); i != XValues.rend(); i++)
-            {
-                if (count == SkipSamples)
-                    maxXstr = *i;
-                else if (count <= SkipSamples + UseSamples - 1 || UseSamples < 0)
-                    minXstr = *i;
-                count++;
-            }
+            int count = Series.size();
+            if (SkipSamples < count)
+                maxXstr = Series.label(count - 1 - SkipSamples);
+            int oldest = UseSamples < 0 ? 0 : (std::max)(0, count - SkipSamples - UseSamples);
+            if (oldest < count - 1 - SkipSamples)
+                minXstr = Series.label(oldest);
 
             QRect bounds = fm.boundingRect(0, 0, 100000, 100000, FONT_ALIGN, minXstr);
             xoffset = bounds.height();
@@ -461,22 +434,24 @@ void toLineChart::paintChart(QPainter *p, QRect &rect)
         {
             bool first = true;
             std::list<bool>::iterator k = Enabled.begin();
-            for (std::list<std::list<double> >::iterator i = Values.begin(); i != Values.end(); i++)
+            for (int i = 0; i < Series.series(); i++)
             {
                 if (k == Enabled.end() || *k)
                 {
-                    for (std::list<double>::iterator j = (*i).begin(); j != (*i).end(); j++)
+                    toTimeSeries::MinMax range = Series.range(i, 0, Series.size());
+                    if (range.Valid)
                     {
                         if (first)
                         {
-                            zMinValue = *j;
-                            zMaxValue = *j;
+                            zMinValue = range.Min;
+                            zMaxValue = range.Max;
                             first = false;
                         }
-                        else if (zMaxValue < *j)
-                            zMaxValue = *j;
-                        else if (zMinValue > *j)
-                            zMinValue = *j;
+                        else
+                        {
+                            zMaxValue = (std::max)(zMaxValue, range.Max);
+                            zMinValue = (std::min)(zMinValue, range.Min);
+                        }
                     }
                 }
                 if (k != Enabled.end())
@@ -514,8 +489,11 @@ void toLineChart::paintChart(QPainter *p, QRect &rect)
         if (Zooming)
             p->drawText(2, 2, rect.width() - 4, rect.height() - 4,
                         Qt::AlignLeft | Qt::AlignTop, tr("Zoom"));
+        int last = Series.size() - SkipSamples;
+        int width = rect.width() - 4;
+        std::vector<toTimeSeries::MinMax> buckets;
         std::list<bool>::iterator k = Enabled.begin();
-        for (std::list<std::list<double> >::iterator i = Values.begin(); i != Values.end(); i++)
+        for (int i = 0; i < Series.series(); i++)
         {
             if (k == Enabled.end() || *k)
             {
@@ -541,25 +519,43 @@ void toLineChart::paintChart(QPainter *p, QRect &rect)
                         break;
                 }
                 p->setPen(QPen(brush.color(), pens));
-                std::list<double> &val = *i;
-                int count = 0;
-                bool first = true;
-                int lval = 0;
-                int lx = rect.width() - 2;
-                int skip = SkipSamples;
-                for (std::list<double>::reverse_iterator j = val.rbegin(); j != val.rend() && lx >=
-                        2;
-                        j++)
+                if (samples > width && width > 0)
+                {
+                    // More samples than pixels, draw the min/max span of every pixel column
+                    Series.decimate(i, last - samples, last, width, buckets);
+                    const toTimeSeries::MinMax *prev = NULL;
+                    for (int j = 0; j < width; j++)
+                    {
+                        const toTimeSeries::MinMax &cur = buckets[j];
+                        if (!cur.Valid)
+                        {
+                            prev = NULL;
+                            continue;
+                        }
+                        // Stretch the span to touch the previous column to keep the line connected
+                        double low = prev ? (std::min)(cur.Min, prev->Max) : cur.Min;
+                        double high = prev ? (std::max)(cur.Max, prev->Min) : cur.Max;
+                        int ylow = int(rect.height() - 2 - ((low - zMinValue) / (zMaxValue - zMinValue) * (rect.height() - 4)));
+                        int yhigh = int(rect.height() - 2 - ((high - zMinValue) / (zMaxValue - zMinValue) * (rect.height() - 4)));
+                        p->drawLine(j + 2, ylow, j + 2, yhigh);
+                        prev = &cur;
+                    }
+                }
+                else
                 {
-                    if (skip > 0)
-                        skip--;
-                    else
+                    int count = 0;
+                    bool first = true;
+                    int lval = 0;
+                    int lx = rect.width() - 2;
+                    for (int j = last - 1; j >= 0 && lx >= 2; j--)
                     {
-                        int val = int(rect.height() - 2 - ((*j - zMinValue) / (zMaxValue - zMinValue) * (rect.height() - 4)));
+                        double v = Series.value(i, j);
+                        if (std::isnan(v))
+                            break;
+                        int val = int(rect.height() - 2 - ((v - zMinValue) / (zMaxValue - zMinValue) * (rect.height() - 4)));
                         if (!first)
                         {
-                            int x = lx;
-                            x = rect.width() - 2 - (count + 1) * (rect.width() - 4) / samples;
+                            int x = rect.width() - 2 - (count + 1) * (rect.width() - 4) / samples;
                             p->drawLine(x, val, lx, lval);
                             lx = x;
                         }
@@ -634,7 +630,7 @@ int toLineChart::countSamples(void)
     if (UseSamples <= 1)
     {
         if (Samples < 0)
-            samples = XValues.size();
+            samples = Series.size();
         else
             samples = Samples;
     }
@@ -667,6 +663,8 @@ void toLineChart::mousePressEvent(QMouseEvent *e)
                 Menu->addSeparator();
 
                 Menu->addAction(tr("Clear Chart"), this, SLOT(clear()));
+                Menu->addAction(tr("&Save samples..."), this, SLOT(saveSamples()));
+                Menu->addAction(tr("&Load samples..."), this, SLOT(loadSamples()));
                 addMenues(Menu);
             }
             Menu->popup(e->globalPos());
@@ -714,7 +712,7 @@ void toLineChart::setup(void)
     if (Samples < 0)
     {
         setup.UnlimitedSamples->setChecked(true);
-        setup.Samples->setValue(XValues.size());
+        setup.Samples->setValue(Series.size());
     }
     else
         setup.Samples->setValue(Samples);
@@ -827,8 +825,7 @@ toLineChart::toLineChart (toLineChart *chart, QWidget *parent, const char *name,
         setObjectName(name);
 
     Menu = NULL;
-    Values = chart->Values;
-    XValues = chart->XValues;
+    Series = chart->Series;
     Labels = chart->Labels;
     Legend = chart->Legend;
     Last = false;
@@ -877,27 +874,21 @@ void toLineChart::exportData(std::map<QString, QString> &ret, const QString &pre
             ret[prefix + ":Labels:" + QString::number(id).toLatin1()] = *i;
         }
     }
-    id = 0;
-    {
-        for (std::list<QString>::iterator i = XValues.begin(); i != XValues.end(); i++)
-        {
-            id++;
-            ret[prefix + ":XValues:" + QString::number(id).toLatin1()] = *i;
-        }
-    }
-    id = 0;
-    for (std::list<std::list<double> >::iterator i = Values.begin(); i != Values.end(); i++)
+    for (int i = 0; i < Series.size(); i++)
+        ret[prefix + ":XValues:" + QString::number(i + 1).toLatin1()] = Series.label(i);
+    for (int i = 0; i < Series.series(); i++)
     {
         QString value;
 
-        for (std::list<double>::iterator j = (*i).begin(); j != (*i).end(); j++)
+        for (int j = 0; j < Series.size(); j++)
         {
-            if (!value.isNull())
+            if (j > 0)
                 value += QString::fromLatin1(",");
-            value += QString::number(*j);
+            // Missing values are exported empty and read back as NaN
+            if (Series.hasValue(i, j))
+                value += QString::number(Series.value(i, j));
         }
-        id++;
-        ret[prefix + ":Values:" + QString::number(id).toLatin1()] = value;
+        ret[prefix + ":Values:" + QString::number(i + 1).toLatin1()] = value;
     }
     ret[prefix + ":Title"] = Title;
 }
@@ -916,34 +907,45 @@ void toLineChart::importData(std::map<QString, QString> &ret, const QString &pre
     }
 
     id = 1;
-    XValues.clear();
+    std::vector<QString> xValues;
     while ((i = ret.find(prefix + ":XValues:" + QString::number(id).toLatin1())) != ret.end())
     {
-        XValues.insert(XValues.end(), (*i).second);
+        xValues.push_back((*i).second);
         id++;
     }
 
     id = 1;
-    Values.clear();
+    std::vector<QStringList> values;
     QRegExp comma(QString::fromLatin1(","));
     while ((i = ret.find(prefix + ":Values:" + QString::number(id).toLatin1())) != ret.end())
     {
-        QStringList lst = (*i).second.split(comma);
-        std::list<double> vals;
-        for (int j = 0; j < lst.count(); j++)
-            vals.insert(vals.end(), lst[j].toDouble());
-
-        Values.insert(Values.end(), vals);
+        values.push_back((*i).second.split(comma));
         id++;
     }
-    Samples = id - 2;
+
+    // Rebuild the samples row by row, older exports aligned shorter lines to the end
+    Samples = int(xValues.size());
+    Series.clear();
+    Series.setCapacity(Samples);
+    for (int j = 0; j < int(xValues.size()); j++)
+    {
+        std::list<double> vals;
+        for (std::vector<QStringList>::iterator k = values.begin(); k != values.end(); k++)
+        {
+            int pos = (*k).count() - int(xValues.size()) + j;
+            bool ok = false;
+            double val = pos >= 0 ? (*k)[pos].toDouble(&ok) : 0;
+            vals.push_back(ok ? val : std::numeric_limits<double>::quiet_NaN());
+        }
+        Series.append(vals, xValues[j]);
+    }
     Title = ret[prefix + ":Title"];
     update();
 }
 
 void toLineChart::horizontalChange(int val)
 {
-    SkipSamples = XValues.size() - UseSamples - val;
+    SkipSamples = Series.size() - UseSamples - val;
     update();
 }
 
@@ -958,3 +960,56 @@ void toLineChart::verticalChange(int val)
 
     update();
 }
+
+void toLineChart::saveSamples(void)
+{
+    QString fn = Utils::toSaveFilename(QString(), QString::fromLatin1("*.chart"), this);
+    if (fn.isEmpty())
+        return;
+
+    QByteArray data;
+    {
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out << Title;
+        out << (qint32) Labels.size();
+        for (std::list<QString>::iterator i = Labels.begin(); i != Labels.end(); i++)
+            out << *i;
+        Series.save(out);
+    }
+    Utils::toWriteFile(fn, data);
+}
+
+void toLineChart::loadSamples(void)
+{
+    QString fn = Utils::toOpenFilename(QString::fromLatin1("*.chart"), this);
+    if (fn.isEmpty())
+        return;
+
+    try
+    {
+        QByteArray data = Utils::toReadFileB(fn);
+        QDataStream in(&data, QIODevice::ReadOnly);
+
+        QString title;
+        qint32 count;
+        in >> title >> count;
+        std::list<QString> labels;
+        for (int i = 0; i < count && in.status() == QDataStream::Ok; i++)
+        {
+            QString label;
+            in >> label;
+            labels.push_back(label);
+        }
+
+        toTimeSeries series(Samples);
+        if (!series.load(in))
+            throw tr("File %1 does not contain chart samples").arg(fn);
+
+        setTitle(title);
+        Labels = labels;
+        Series = series;
+        clearZoom();
+        update();
+    }
+    TOCATCH
+}
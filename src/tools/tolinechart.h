@@ -46,6 +46,7 @@
 #include <algorithm>
 
 #include "core/utils.h"
+#include "tools/totimeseries.h"
 
 class QMenu;
 class QScrollBar;
@@ -65,8 +66,7 @@ class toLineChart : public QWidget
         QScrollBar *Vertical;
 
     protected:
-        std::list<std::list<double> > Values;
-        std::list<QString> XValues;
+        toTimeSeries Series;
         std::list<QString> Labels;
         std::list<bool> Enabled;
         bool Legend;
@@ -294,20 +294,12 @@ class toLineChart : public QWidget
          */
         virtual void addValues(std::list<double> &value, const QString &xValues);
 
-        /** Get list of labels
-         * @return List of labels
+        /** Get the samples of the chart.
+         * @return Time series holding x-values and one column per line.
          */
-        std::list<QString> &xValues(void)
+        const toTimeSeries &series(void) const
         {
-            return XValues;
-        }
-
-        /** Get list of values.
-         * @return Values in piechart.
-         */
-        std::list<std::list<double> > &values(void)
-        {
-            return Values;
+            return Series;
         }
 
         /** Export chart to a map.
@@ -351,11 +343,17 @@ class toLineChart : public QWidget
          */
         void clear(void)
         {
-            Values.clear();
-            XValues.clear();
+            Series.clear();
             update();
         }
 
+        /** Save the samples of the chart to a file.
+         */
+        void saveSamples(void);
+        /** Load samples saved by @ref saveSamples into the chart.
+         */
+        void loadSamples(void);
+
         /** Setup values of charts.
          */
         virtual void setup(void);
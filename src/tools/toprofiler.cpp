@@ -33,6 +33,7 @@
  * END_COMMON_COPYRIGHT_HEADER */
 
 #include "tools/toprofiler.h"
+#include "tools/tohprof.h"
 #include "core/utils.h"
 #include "core/totool.h"
 #include "core/tochangeconnection.h"
@@ -212,6 +213,23 @@ static toSQL SQLStopProfiler("toProfiler:StopProfiler",
                              "END;",
                              "Stop profiler run");
 
+static toSQL SQLStartHProf("toProfiler:StartHProf",
+                           "DECLARE\n"
+                           "  PRAGMA AUTONOMOUS_TRANSACTION;\n"
+                           "  l_dir     VARCHAR2(128) := :dir<char[128],in>;\n"
+                           "  l_comment VARCHAR2(4000) := :comment<char[4000],in>;\n"
+                           "  l_file    VARCHAR2(100) := 'tora_'||TO_CHAR(SYSTIMESTAMP,'YYYYMMDDHH24MISSFF')||'.trc';\n"
+                           "BEGIN\n"
+                           "  DBMS_HPROF.START_PROFILING(l_dir, l_file);\n",
+                           "Start hierarchical profiler run, must have same binds and declare l_dir, l_file and l_comment");
+
+static toSQL SQLStopHProf("toProfiler:StopHProf",
+                          "  DBMS_HPROF.STOP_PROFILING;\n"
+                          "  :runid<char[4000],out> := DBMS_HPROF.ANALYZE(l_dir, l_file, run_comment => l_comment);\n"
+                          "  COMMIT;\n"
+                          "END;",
+                          "Stop hierarchical profiler run and analyze the trace file into the DBMSHP tables, must have same binds");
+
 class toProfilerTool : public toTool
 {
         const char **pictureXPM(void) override
@@ -470,6 +488,22 @@ toProfiler::toProfiler(QWidget *parent, toConnection &connection)
 
     toolbar->addSeparator();
 
+    Mode = new QComboBox(toolbar);
+    Mode->addItem(tr("Line profiler (DBMS_PROFILER)"));
+    Mode->addItem(tr("Hierarchical profiler (DBMS_HPROF)"));
+    toolbar->addWidget(Mode);
+    connect(Mode, SIGNAL(activated(int)), this, SLOT(changeMode()));
+
+    toolbar->addWidget(new QLabel(" " + tr("Directory") + " ", toolbar));
+
+    Directory = new QLineEdit(toolbar);
+    Directory->setText(QString::fromLatin1("PLSHPROF_DIR"));
+    Directory->setToolTip(tr("Oracle directory object the hierarchical profiler writes its trace file to"));
+    Directory->setEnabled(false);
+    toolbar->addWidget(Directory);
+
+    toolbar->addSeparator();
+
     toolbar->addWidget(new QLabel(tr("Repeat run") + " ", toolbar));
 
     Repeat = new QSpinBox(toolbar);
@@ -535,9 +569,18 @@ toProfiler::toProfiler(QWidget *parent, toConnection &connection)
     Lines->setReadAll(true);
     connect(Lines, SIGNAL(done()), this, SLOT(calcTotals()));
 
+    Hierarchical = new toHProfResult(Tabs);
+    Tabs->addTab(Hierarchical, tr("Hierarchical"));
+
     LastUnit = CurrentRun = 0;
 //     show();
 
+    bool hprof = toHProfResult::available(connection);
+    if (hprof)
+        Hierarchical->refresh();
+    else
+        Tabs->setTabEnabled(Tabs->indexOf(Hierarchical), false);
+
     try
     {
         toConnectionSubLoan con(connection);
@@ -545,6 +588,14 @@ toProfiler::toProfiler(QWidget *parent, toConnection &connection)
     }
     catch (const QString &)
     {
+        if (hprof)
+        {
+            // DBMSHP tables are there, no need for the line profiler ones
+            Mode->setCurrentIndex(HierarchicalMode);
+            changeMode();
+            return ;
+        }
+
         int ret = TOMessageBox::warning(this,
                                         tr("Profiler tables doesn't exist"),
                                         tr("Profiler tables doesn't exist. Should TOra\n"
@@ -580,6 +631,9 @@ toProfiler::toProfiler(QWidget *parent, toConnection &connection)
 
 void toProfiler::refresh(void)
 {
+    if (Tabs->isTabEnabled(Tabs->indexOf(Hierarchical)))
+        Hierarchical->refresh();
+
     Run->clear();
     Run->addItem(tr("Select run"));
     try
@@ -608,8 +662,52 @@ void toProfiler::refresh(void)
     TOCATCH
 }
 
+void toProfiler::changeMode(void)
+{
+    Directory->setEnabled(Mode->currentIndex() == HierarchicalMode);
+    if (Mode->currentIndex() == HierarchicalMode)
+        Tabs->setCurrentIndex(Tabs->indexOf(Hierarchical));
+    else if (Tabs->currentWidget() == Hierarchical)
+        Tabs->setCurrentIndex(Tabs->indexOf(Result));
+}
+
+void toProfiler::executeHierarchical(void)
+{
+    try
+    {
+        toConnectionSubLoan con(connection());
+        QString exc = toSQL::string(SQLStartHProf, connection());
+        for (int i = 0; i < Repeat->value(); i++)
+        {
+            exc += Script->text();
+            exc += QString::fromLatin1("\n");
+        }
+        exc += toSQL::string(SQLStopHProf, connection());
+
+        QString comment = Comment->text() + " " + tr("(%1 runs)").arg(Repeat->value());
+        toQuery query(con,
+                      exc,
+                      toQueryParams() << Directory->text().toUpper() << comment);
+        int runid = query.readValue().toInt();
+        if (runid > 0)
+        {
+            Tabs->setTabEnabled(Tabs->indexOf(Hierarchical), true);
+            Tabs->setCurrentIndex(Tabs->indexOf(Hierarchical));
+            Hierarchical->showRun(runid);
+        }
+        else
+            Utils::toStatusMessage(tr("Something went wrong collecting statistics"));
+    }
+    TOCATCH
+}
+
 void toProfiler::execute(void)
 {
+    if (Mode->currentIndex() == HierarchicalMode)
+    {
+        executeHierarchical();
+        return ;
+    }
     try
     {
         QString exc;
@@ -42,6 +42,7 @@ class QSpinBox;
 class QSplitter;
 class QTabWidget;
 class QToolButton;
+class toHProfResult;
 class toProfilerSource;
 class toProfilerUnits;
 class toResultItem;
@@ -52,10 +53,18 @@ class toProfiler : public toToolWidget
 {
         Q_OBJECT;
 
+        enum ProfilerMode
+        {
+            LineMode = 0,
+            HierarchicalMode = 1
+        };
+
         int CurrentRun;
         int LastUnit;
 
         QToolButton *Background;
+        QComboBox *Mode;
+        QLineEdit *Directory;
         QSpinBox *Repeat;
         QLineEdit *Comment;
         QTabWidget *Tabs;
@@ -66,6 +75,9 @@ class toProfiler : public toToolWidget
         toProfilerUnits *Units;
         toProfilerSource *Lines;
         toSqlText *Script;
+        toHProfResult *Hierarchical;
+
+        void executeHierarchical(void);
     public:
         toProfiler(QWidget *parent, toConnection &connection);
     public slots:
@@ -74,6 +86,7 @@ class toProfiler : public toToolWidget
         void execute(void);
         void changeObject(void);
         void calcTotals(void);
+        void changeMode(void);
         void noTables(void)
         {
             setDisabled(true);
@@ -111,7 +111,10 @@ static toSQL SQLTableComment(
     "SELECT Comments FROM sys.All_Tab_Comments\n"
     " WHERE Owner = :f1<char[100]>\n"
     "   AND Table_Name = :f2<char[100]>",
-    "");
+    "",
+    "",
+    "Oracle",
+    toSQL::Dictionary);
 
 // sql must return a row even if there's no comment for the table
 static toSQL SQLTableCommentPG(
@@ -243,7 +246,9 @@ static toSQL SQLTableColumns(
     "   AND table_name = :f2<char[100]>\n"
     " ORDER BY column_id\n",
     "List table columns and defaults.",
-    "1000");
+    "1000",
+    "Oracle",
+    toSQL::Dictionary);
 
 static toSQL SQLTableColumns8(
     "toResultCols:ListCols",
@@ -34,13 +34,15 @@
 
 #include "tools/toresultextent.h"
 
+#include "core/toeventquery.h"
 #include "core/tosql.h"
 #include "core/utils.h"
+#include "tools/toresulttableview.h"
 
-#include <QProgressDialog>
-#include <QtCore/QCoreApplication>
 #include <QtGui/QPainter>
-#include "tools/toresulttableview.h"
+#include <QtGui/QPaintEvent>
+
+#include <algorithm>
 
 static toSQL SQLListExtents("toResultStorage:ListExtents",
                             "SELECT * \n"
@@ -220,35 +222,42 @@ bool toStorageExtent::extentName::operator == (const toStorageExtent::extentName
     return Owner == ext.Owner && Table == ext.Table && (Partition == ext.Partition || ext.Partition.isNull());
 }
 
-toStorageExtent::extent::extent(const QString &owner, const QString &table,
-                                const QString &partition,
-                                int file, int block, int size)
-    : extentName(owner, table, partition, size)
-{
-    File = file;
-    Block = block;
-}
-
-bool toStorageExtent::extent::operator < (const toStorageExtent::extent &ext) const
+void toStorageExtent::dataFile::sort(void)
 {
-    if (File < ext.File)
-        return true;
-    if (File > ext.File)
-        return false;
-    if (Block < ext.Block)
-        return true;
-    return false;
+    if (Sorted == Extents.size())
+        return;
+    // Extents usually arrive ordered, only the tail has to be sorted and merged
+    std::vector<extentSpan>::iterator middle = Extents.begin() + Sorted;
+    std::sort(middle, Extents.end());
+    std::inplace_merge(Extents.begin(), middle, Extents.end());
+    Sorted = Extents.size();
 }
 
-bool toStorageExtent::extent::operator == (const toStorageExtent::extent &ext) const
+std::pair<std::vector<toStorageExtent::extentSpan>::const_iterator, std::vector<toStorageExtent::extentSpan>::const_iterator>
+toStorageExtent::dataFile::range(int from, int to) const
 {
-    return Owner == ext.Owner && Table == ext.Table && Partition == ext.Partition &&
-           File == ext.File && Block == ext.Block && Size == ext.Size;
+    std::vector<extentSpan>::const_iterator begin = std::upper_bound(Extents.begin(), Extents.end(), from,
+            [](int block, const extentSpan & e)
+    {
+        return block < e.Block;
+    });
+    // Extents do not overlap, only the last one starting before from can reach into the range
+    if (begin != Extents.begin() && (begin - 1)->Block + (begin - 1)->Size > from)
+        --begin;
+    std::vector<extentSpan>::const_iterator end = std::lower_bound(begin, Extents.end(), to,
+            [](const extentSpan & e, int block)
+    {
+        return e.Block < block;
+    });
+    return std::make_pair(begin, end);
 }
 
 toStorageExtent::toStorageExtent(QWidget *parent, const char *name)
     : QWidget(parent)
+    , ExtentCount(0)
     , Total(0)
+    , TileScale(0)
+    , TileWidth(0)
 {
     setObjectName(name);
     QPalette pal = palette();
@@ -256,215 +265,357 @@ toStorageExtent::toStorageExtent(QWidget *parent, const char *name)
     setPalette(pal);
 }
 
+toStorageExtent::~toStorageExtent()
+{
+    clearExtents();
+}
+
 void toStorageExtent::highlight(const QString &owner, const QString &table,
                                 const QString &partition)
 {
     Highlight.Owner = owner;
     Highlight.Table = table;
     Highlight.Partition = partition;
+
+    HighlightNames.clear();
+    for (size_t i = 0; i < Names.size(); i++)
+        if (Names[i] == Highlight)
+            HighlightNames.push_back(i);
     update();
 }
 
 void toStorageExtent::setTablespace(const QString &tablespace)
 {
     fileView = false;
+    if (Tablespace == tablespace)
+        return ;
+    Tablespace = tablespace;
+    start(SQLObjectsTablespace, SQLTablespaceBlocks, toQueryParams() << tablespace);
+}
+
+void toStorageExtent::setFile(const QString &tablespace, int file)
+{
+    fileView = true;
+    Tablespace = QString();
+    start(SQLObjectsFile, SQLFileBlocks, toQueryParams() << tablespace << QString::number(file));
+}
+
+void toStorageExtent::start(const toSQL &extents, const toSQL &sizes, toQueryParams const& params)
+{
+    clearExtents();
     try
     {
-        toConnectionSubLoan c(toConnection::currentConnection(this));
-        if (Tablespace == tablespace)
-            return ;
-        Tablespace = tablespace;
-        Utils::toBusy busy;
-        Extents.clear();
-        FileOffset.clear();
-        toQuery query(c, SQLObjectsTablespace, toQueryParams() << tablespace);
-
-        // It's used to keep UI "non-freezed".
-        // OK, there are better query classes for it but it's enough for now.
-        // TODO: rewrite data fetching for this tool
-        int progressMax = 1000;
-        int progressCurr = 1;
-        QProgressDialog progress("Reading Objects...", "Abort", 0, progressMax, this);
-
-        extent cur;
-        while (!query.eof())
+        toConnection &conn = toConnection::currentConnection(this);
         {
-            if (progressCurr > (progressMax - 1))
-                progressCurr = 0;
-            if (progressCurr % 200 == 0)
-            {
-                progress.setValue(progressCurr);
-                QCoreApplication::processEvents();
-            }
-            if (progress.wasCanceled())
+            toConnectionSubLoan c(conn);
+            toQuery blocks(c, sizes, params);
+            int index = 0;
+            while (!blocks.eof())
             {
-                Extents.clear();
-                break;
+                dataFile &file = Files[blocks.readValue().toInt()];
+                file.Offset = Total;
+                file.Blocks = blocks.readValue().toInt();
+                file.Index = index++;
+                Total += file.Blocks;
             }
-            ++progressCurr;
-
-            cur.Owner = (QString)query.readValue();
-            cur.Table = (QString)query.readValue();
-            cur.Partition = (QString)query.readValue();
-            cur.File = query.readValue().toInt();
-            cur.Block = query.readValue().toInt();
-            cur.Size = query.readValue().toInt();
-            Utils::toPush(Extents, cur);
-        }
-        toQuery blocks(c, SQLTablespaceBlocks, toQueryParams() << tablespace);
-        Total = 0;
-        while (!blocks.eof())
-        {
-            int id = blocks.readValue().toInt();
-            FileOffset[id] = Total;
-            Total += blocks.readValue().toInt();
         }
+
+        // Extents are streamed, the map fills as they arrive
+        Query = new toEventQuery(this, conn, toSQL::string(extents, conn), params, toEventQuery::READ_ALL);
+        connect(Query, &toEventQuery::dataAvailable, this, &toStorageExtent::receiveData);
+        connect(Query, &toEventQuery::done, this, &toStorageExtent::queryDone);
+        connect(Query, &toEventQuery::error, this, &toStorageExtent::queryError);
+        Query->start();
     }
     TOCATCH
-    Extents.sort();
     update();
 }
 
-void toStorageExtent::setFile(const QString &tablespace, int file)
+void toStorageExtent::clearExtents(void)
 {
-    fileView = true;
+    if (Query)
+    {
+        Query->disconnect(this);
+        Query->stop();
+        Query->deleteLater();
+        Query = NULL;
+    }
+    Files.clear();
+    Names.clear();
+    NameIndex.clear();
+    Segments.clear();
+    HighlightNames.clear();
+    Tiles.clear();
+    ExtentCount = 0;
+    Total = 0;
+}
+
+int toStorageExtent::nameIndex(const QString &owner, const QString &table, const QString &partition)
+{
+    QString key = owner + QChar('\n') + table + QChar('\n') + partition;
+    QHash<QString, int>::const_iterator i = NameIndex.constFind(key);
+    if (i != NameIndex.constEnd())
+        return i.value();
+
+    int index = Names.size();
+    Names.push_back(extentName(owner, table, partition, 0));
+    Segments.push_back(std::vector<segmentSpan>());
+    NameIndex.insert(key, index);
+    if (Names.back() == Highlight)
+        HighlightNames.push_back(index);
+    return index;
+}
+
+void toStorageExtent::receiveData(toEventQuery *query)
+{
+    if (query != Query)
+        return;
+
+    // Block range received per file
+    std::map<int, std::pair<int, int> > changed;
     try
     {
-        Utils::toBusy busy;
-        Extents.clear();
-        FileOffset.clear();
-        toConnectionSubLoan c(toConnection::currentConnection(this));
-        toQuery query(c, SQLObjectsFile, toQueryParams() << tablespace << QString::number(file));
-        extent cur;
-
-        int progressMax = 1000;
-        int progressCurr = 1;
-        QProgressDialog progress("Reading Objects...", "Abort", 0, progressMax, this);
-
-        while (!query.eof())
+        while (query->hasMore())
         {
-            if (progressCurr > (progressMax - 1))
-                progressCurr = 0;
-            if (progressCurr % 200 == 0)
-            {
-                progress.setValue(progressCurr);
-                QCoreApplication::processEvents();
-            }
-            if (progress.wasCanceled())
-            {
-                Extents.clear();
-                break;
-            }
-            ++progressCurr;
-
-            cur.Owner = (QString)query.readValue();
-            cur.Table = (QString)query.readValue();
-            cur.Partition = (QString)query.readValue();
-            cur.File = query.readValue().toInt();
-            cur.Block = query.readValue().toInt();
-            cur.Size = query.readValue().toInt();
-            Utils::toPush(Extents, cur);
+            QString owner = (QString)query->readValue();
+            QString table = (QString)query->readValue();
+            QString partition = (QString)query->readValue();
+            int id = query->readValue().toInt();
+            int block = query->readValue().toInt();
+            int size = query->readValue().toInt();
+
+            std::map<int, dataFile>::iterator f = Files.find(id);
+            if (f == Files.end())
+                continue;
+            dataFile &file = f->second;
+
+            extentSpan span;
+            span.Block = block;
+            span.Size = size;
+            span.Name = nameIndex(owner, table, partition);
+
+            bool ordered = file.Sorted == file.Extents.size() &&
+                           (file.Extents.empty() || file.Extents.back().Block <= block);
+            file.Extents.push_back(span);
+            if (ordered)
+                file.Sorted = file.Extents.size();
+
+            segmentSpan segment;
+            segment.File = id;
+            segment.Block = block;
+            segment.Size = size;
+            Segments[span.Name].push_back(segment);
+            ExtentCount++;
+
+            std::map<int, std::pair<int, int> >::iterator c = changed.find(id);
+            if (c == changed.end())
+                changed[id] = std::make_pair(block, block + size);
+            else
+                c->second = std::make_pair(std::min(c->second.first, block), std::max(c->second.second, block + size));
         }
-        toQuery blocks(c, SQLFileBlocks, toQueryParams() << tablespace << QString::number(file));
-        Total = 0;
-        while (!blocks.eof())
+    }
+    catch (const QString &str)
+    {
+        queryError(query, toConnection::exception(str));
+        return;
+    }
+
+    for (std::map<int, std::pair<int, int> >::const_iterator c = changed.begin(); c != changed.end(); c++)
+        invalidate(Files[c->first], c->second.first, c->second.second);
+    update();
+}
+
+void toStorageExtent::queryDone(toEventQuery *query, unsigned long)
+{
+    if (query != Query)
+        return;
+    Query->deleteLater();
+    Query = NULL;
+    update();
+    emit extentsLoaded();
+}
+
+void toStorageExtent::queryError(toEventQuery *query, const toConnection::exception &str)
+{
+    if (query != Query)
+        return;
+    Query->deleteLater();
+    Query = NULL;
+    Utils::toStatusMessage(str);
+    update();
+}
+
+double toStorageExtent::lineBlocks(void) const
+{
+    int lines = height() - headerHeight() - int(Files.size()) + 1;
+    return double(Total) / std::max(lines, 1);
+}
+
+int toStorageExtent::headerHeight(void) const
+{
+    return 2 * fontMetrics().lineSpacing();
+}
+
+void toStorageExtent::invalidate(const dataFile &file, int from, int to)
+{
+    if (Tiles.empty() || TileScale <= 0)
+        return;
+    int first = (int((file.Offset + from) / TileScale) + file.Index) / TileLines;
+    int last = (int((file.Offset + to) / TileScale) + file.Index) / TileLines;
+    Tiles.erase(Tiles.lower_bound(first), Tiles.upper_bound(last));
+}
+
+const QPixmap& toStorageExtent::tile(int index)
+{
+    std::map<int, QPixmap>::const_iterator cached = Tiles.find(index);
+    if (cached != Tiles.end())
+        return cached->second;
+
+    QPixmap pixmap(TileWidth, TileLines);
+    pixmap.fill(palette().color(backgroundRole()));
+
+    QPainter paint(&pixmap);
+    paint.translate(0, -index * TileLines);
+    paint.setPen(QColor("#469446")); //= Qt::darkGreen;
+
+    int first = index * TileLines;
+    int last = first + TileLines;
+    for (std::map<int, dataFile>::iterator f = Files.begin(); f != Files.end(); f++)
+    {
+        dataFile &file = f->second;
+        int from = int((first - file.Index) * TileScale) - file.Offset;
+        int to = int((last - file.Index) * TileScale) - file.Offset + 1;
+        if (to <= 0 || from >= file.Blocks)
+            continue;
+
+        file.sort();
+        std::pair<std::vector<extentSpan>::const_iterator, std::vector<extentSpan>::const_iterator> r = file.range(std::max(from, 0), to);
+
+        // Adjacent extents are drawn as one span, bigfile tablespaces
+        // have many more extents than pixels
+        int spanFrom = -1;
+        int spanTo = -1;
+        for (std::vector<extentSpan>::const_iterator i = r.first; i != r.second; i++)
         {
-            int id = blocks.readValue().toInt();
-            FileOffset[id] = Total;
-            Total += blocks.readValue().toInt();
+            if (spanFrom != -1 && i->Block <= spanTo)
+            {
+                spanTo = std::max(spanTo, i->Block + i->Size);
+                continue;
+            }
+            if (spanFrom != -1)
+                drawSpan(paint, file, spanFrom, spanTo);
+            spanFrom = i->Block;
+            spanTo = i->Block + i->Size;
         }
+        if (spanFrom != -1)
+            drawSpan(paint, file, spanFrom, spanTo);
     }
-    TOCATCH
-    Extents.sort();
-    update();
+
+    return Tiles.insert(std::make_pair(index, pixmap)).first->second;
+}
+
+void toStorageExtent::drawSpan(QPainter &paint, const dataFile &file, int from, int to)
+{
+    double start = (file.Offset + from) / TileScale;
+    double end = (file.Offset + to) / TileScale;
+
+    int y1 = int(start);
+    int x1 = int((start - y1) * TileWidth);
+    int y2 = int(end);
+    int x2 = int((end - y2) * TileWidth);
+    y1 += file.Index;
+    y2 += file.Index;
+    if (y1 != y2)
+    {
+        paint.drawLine(x1, y1, TileWidth - 1, y1);
+        paint.drawLine(0, y2, x2 - 1, y2);
+        if (y1 + 1 != y2)
+            paint.fillRect(0, y1 + 1, TileWidth, y2 - y1 - 1, paint.pen().color());
+    }
+    else
+        paint.drawLine(x1, y1, x2, y2);
 }
 
-void toStorageExtent::paintEvent(QPaintEvent *)
+void toStorageExtent::paintEvent(QPaintEvent *e)
 {
     QPainter paint(this);
-    if ( FileOffset.empty() )
+    if (Files.empty())
         return ;
-    QFontMetrics fm = paint.fontMetrics();
 
-    int offset = 2 * fm.lineSpacing();
+    int offset = headerHeight();
     // prevent the crash when user wants it smaller (by splitter)
     setMinimumHeight(offset + 20);
 
-    double lineblocks = Total / (height() - offset - FileOffset.size() + 1);
+    double lineblocks = lineBlocks();
 
     paint.fillRect(0, 0, width(), offset, palette().window());
-    paint.drawText(0, 0, width(), offset, Qt::AlignLeft | Qt::AlignTop, tr("Files: %1").arg(FileOffset.size()));
-    paint.drawText(0, 0, width(), offset, Qt::AlignRight | Qt::AlignTop, tr("Extents: %1").arg(Extents.size()));
+    paint.drawText(0, 0, width(), offset, Qt::AlignLeft | Qt::AlignTop, tr("Files: %1").arg(Files.size()));
+    paint.drawText(0, 0, width(), offset, Qt::AlignRight | Qt::AlignTop, tr("Extents: %1").arg(ExtentCount));
     if (!Tablespace.isNull())
         paint.drawText(0, 0, width(), offset, Qt::AlignCenter | Qt::AlignTop, tr("Tablespace: %1").arg(Tablespace));
     paint.drawText(0, 0, width(), offset, Qt::AlignLeft | Qt::AlignBottom, tr("Blocks: %1").arg(Total));
     paint.drawText(0, 0, width(), offset, Qt::AlignRight | Qt::AlignBottom, tr("Blocks/line: %1").arg(int(lineblocks)));
 
-    for (std::list<extent>::iterator i = Extents.begin(); i != Extents.end(); i++)
+    if (lineblocks <= 0)
+        return;
+
+    // Tiles are rendered for one size of the widget only
+    if (lineblocks != TileScale || width() != TileWidth)
     {
-        QColor col("#469446"); //= Qt::darkGreen;
-        if (extentName(*i) == Highlight)
-            col = Qt::red;
-        int fileo = 0;
-        for (std::map<int, int>::iterator j = FileOffset.begin(); j != FileOffset.end(); j++, fileo++)
-            if ((*j).first == (*i).File)
-                break;
-        int block = FileOffset[(*i).File] + (*i).Block;
-
-        int y1 = int(block / lineblocks);
-        int x1 = int((block / lineblocks - y1) * width());
-        block += (*i).Size;
-        int y2 = int(block / lineblocks);
-        int x2 = int((block / lineblocks - y2) * width());
-        paint.setPen(col);
-        if (y1 != y2)
-        {
-            paint.drawLine(x1, y1 + offset + fileo, width() - 1, y1 + offset + fileo);
-            paint.drawLine(0, y2 + offset + fileo, x2 - 1, y2 + offset + fileo);
-            if (y1 + 1 != y2)
-                paint.fillRect(0, y1 + 1 + offset + fileo, width(), y2 - y1 - 1, col);
-        }
-        else
-            paint.drawLine(x1, y1 + offset + fileo, x2, y2 + offset + fileo);
+        Tiles.clear();
+        TileScale = lineblocks;
+        TileWidth = width();
+    }
+
+    int firstTile = std::max(0, (e->rect().top() - offset) / TileLines);
+    int lastTile = std::max(0, (e->rect().bottom() - offset) / TileLines);
+    for (int t = firstTile; t <= lastTile; t++)
+        paint.drawPixmap(0, offset + t * TileLines, tile(t));
+
+    paint.translate(0, offset);
+
+    paint.setPen(Qt::red);
+    for (std::vector<int>::const_iterator n = HighlightNames.begin(); n != HighlightNames.end(); n++)
+    {
+        const std::vector<segmentSpan> &spans = Segments[*n];
+        for (std::vector<segmentSpan>::const_iterator i = spans.begin(); i != spans.end(); i++)
+            drawSpan(paint, Files[i->File], i->Block, i->Block + i->Size);
     }
-    std::map<int, int>::iterator j = FileOffset.begin();
-    j++;
+
     paint.setPen(Qt::black);
-    int fileo = offset;
-    while (j != FileOffset.end())
+    for (std::map<int, dataFile>::const_iterator f = Files.begin(); f != Files.end(); f++)
     {
-        int block = (*j).second;
-        int y1 = int(block / lineblocks);
-        int x1 = int((block / lineblocks - y1) * width());
-        paint.drawLine(x1, y1 + fileo, width() - 1, y1 + fileo);
+        const dataFile &file = f->second;
+        if (file.Index == 0)
+            continue;
+        double block = file.Offset / lineblocks;
+        int y1 = int(block);
+        int x1 = int((block - y1) * width());
+        int y = y1 + file.Index - 1;
+        paint.drawLine(x1, y, width() - 1, y);
         if (x1 != 0)
-            paint.drawLine(0, y1 + 1 + fileo, x1 - 1, y1 + fileo + 1);
-        j++;
-        fileo++;
+            paint.drawLine(0, y + 1, x1 - 1, y + 1);
     }
 }
 
-
 std::list<toStorageExtent::extentTotal> toStorageExtent::objects(void)
 {
     std::list<extentTotal> ret;
 
-    for (std::list<extent>::iterator i = Extents.begin(); i != Extents.end(); i++)
+    for (size_t n = 0; n < Segments.size(); n++)
     {
-        bool dup = false;
-        for (std::list<extentTotal>::iterator j = ret.begin(); j != ret.end(); j++)
+        const std::vector<segmentSpan> &spans = Segments[n];
+        if (spans.empty())
+            continue;
+
+        extentTotal total(Names[n].Owner, Names[n].Table, Names[n].Partition, spans.front().Block, 0);
+        total.Extents = spans.size();
+        for (std::vector<segmentSpan>::const_iterator i = spans.begin(); i != spans.end(); i++)
         {
-            if ((*j) == (*i))
-            {
-                (*j).Size += (*i).Size;
-                (*j).Extents++;
-                (*j).LastBlock = ( ((*j).LastBlock > (*i).Block) ? (*j).LastBlock : (*i).Block );
-                dup = true;
-                break;
-            }
+            total.Size += i->Size;
+            total.LastBlock = std::max(total.LastBlock, i->Block);
         }
-        if (!dup)
-            Utils::toPush(ret, extentTotal((*i).Owner, (*i).Table, (*i).Partition, (*i).Block, (*i).Size));
+        Utils::toPush(ret, total);
     }
 
     ret.sort();
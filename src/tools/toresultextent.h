@@ -38,7 +38,15 @@
 #include "core/toresult.h"
 
 #include <QSplitter>
+#include <QtCore/QHash>
+#include <QtCore/QPointer>
+#include <QtGui/QPixmap>
 
+#include <map>
+#include <vector>
+
+class QPainter;
+class toEventQuery;
 class toResultTableView;
 class toStorageExtent;
 class toResultTableView;
@@ -99,39 +107,104 @@ class toStorageExtent : public QWidget
             bool operator < (const extentTotal &) const;
         };
 
-        struct extent : public extentName
+        toStorageExtent(QWidget *parent, const char *name = NULL);
+        virtual ~toStorageExtent();
+
+        void highlight(const QString &owner, const QString &table, const QString &partition);
+
+        /** Start reading the extents of a tablespace.
+         * The map fills while the extents arrive, @ref extentsLoaded is emitted at the end.
+         */
+        void setTablespace(const QString &tablespace);
+        void setFile(const QString &tablespace, int file);
+
+        std::list<extentTotal> objects(void);
+
+    signals:
+        /** All extents of the tablespace or file were read */
+        void extentsLoaded(void);
+
+    protected:
+        void paintEvent(QPaintEvent *) override;
+
+    private slots:
+        void receiveData(toEventQuery*);
+        void queryDone(toEventQuery*, unsigned long);
+        void queryError(toEventQuery*, const toConnection::exception &);
+
+    private:
+        /** One extent, the segment is an index to Names */
+        struct extentSpan
         {
-            int File;
             int Block;
-
-            extent(void)
+            int Size;
+            int Name;
+            bool operator < (const extentSpan &other) const
             {
-                File = Block = 0;
+                return Block < other.Block;
             }
-            extent(const QString &owner, const QString &table, const QString &partition,
-                   int file, int block, int size);
-            bool operator < (const extent &) const;
-            bool operator == (const extent &) const;
         };
 
-    private:
-        std::list<extent> Extents;
+        /** Extents of one datafile ordered by block */
+        struct dataFile
+        {
+            /** First block of the file in the map */
+            int Offset;
+            int Blocks;
+            /** Position of the file, each file boundary takes one line of the map */
+            int Index;
+            /** Extents[0, Sorted) are ordered, the rest arrived since the last sort */
+            std::vector<extentSpan> Extents;
+            size_t Sorted;
+
+            dataFile() : Offset(0), Blocks(0), Index(0), Sorted(0) {}
+            void sort(void);
+            /** Extents overlapping blocks [from, to) */
+            std::pair<std::vector<extentSpan>::const_iterator, std::vector<extentSpan>::const_iterator>
+            range(int from, int to) const;
+        };
+
+        /** Extent of a segment, kept to draw the highlighted ones without walking the map */
+        struct segmentSpan
+        {
+            int File;
+            int Block;
+            int Size;
+        };
+
+        /** Lines of the map rendered into one cached tile */
+        enum { TileLines = 64 };
+
+        void start(const toSQL &extents, const toSQL &sizes, toQueryParams const& params);
+        void clearExtents(void);
+        int nameIndex(const QString &owner, const QString &table, const QString &partition);
+
+        /** Blocks drawn on one line of the map */
+        double lineBlocks(void) const;
+        int headerHeight(void) const;
+
+        /** Drop the tiles showing blocks [from, to) of file */
+        void invalidate(const dataFile &file, int from, int to);
+        const QPixmap& tile(int index);
+        void drawSpan(QPainter &paint, const dataFile &file, int from, int to);
+
+        std::map<int, dataFile> Files;
+        std::vector<extentName> Names;
+        QHash<QString, int> NameIndex;
+        std::vector<std::vector<segmentSpan> > Segments;
+        int ExtentCount;
+
         extentName Highlight;
+        std::vector<int> HighlightNames;
         QString Tablespace;
 
-        std::map<int, int> FileOffset;
         int Total;
         static bool fileView;
-    public:
-        toStorageExtent(QWidget *parent, const char *name = NULL);
-        void highlight(const QString &owner, const QString &table, const QString &partition);
 
-        void setTablespace(const QString &tablespace);
-        void setFile(const QString &tablespace, int file);
-
-        std::list<extentTotal> objects(void);
-    protected:
-        virtual void paintEvent(QPaintEvent *);
+        QPointer<toEventQuery> Query;
+        std::map<int, QPixmap> Tiles;
+        double TileScale;
+        int TileWidth;
 }; // toStorageExtent
 
 #endif
@@ -35,11 +35,14 @@
 #include "tools/toresultstorage.h"
 #include "core/utils.h"
 #include "core/toeventquery.h"
+#include "core/tosql.h"
 #include "core/toconfiguration.h"
 #include "core/toglobalconfiguration.h"
 
 #include <QtGui/QPainter>
 #include <QItemDelegate>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
 
 
 // columns count
@@ -61,81 +64,6 @@
 #define COL_FREE_FRAGMENTS 12
 
 
-/*! \brief Item for storage data display and sorting.
-*/
-class toResultStorageItem : public toResultViewItem
-{
-        bool AvailableGraph;
-    public:
-        toResultStorageItem(bool available, toTreeWidget *parent, toTreeWidgetItem *after,
-                            const QString &buf = QString())
-            : toResultViewItem(parent, after, buf), AvailableGraph(available)
-        { }
-        toResultStorageItem(bool available, toTreeWidgetItem *parent, toTreeWidgetItem *after,
-                            const QString &buf = QString())
-            : toResultViewItem(parent, after, buf), AvailableGraph(available)
-        { }
-
-        //! Try to guess real type of the value taken from DB
-        void setSortValue(int col, const QVariant & v)
-        {
-            bool ok;
-            qulonglong i = v.toULongLong(&ok);
-            if (ok)
-            {
-                m_sortValues[col] = i;
-                return;
-            }
-            double d = v.toDouble(&ok);
-            if (ok)
-            {
-                m_sortValues[col] = d;
-                return;
-            }
-            m_sortValues[col] = v;
-        }
-
-        //! See operator<
-        QVariant sortValue(int i) const
-        {
-            return m_sortValues[i];
-        }
-
-        /*! Operator used for sorting. Original operator handles
-          only string-based sorting. Now it supports int and double
-          for numeric columns.
-        */
-        bool operator<(const QTreeWidgetItem &other) const
-        {
-            int column = treeWidget()->sortColumn();
-            QVariant v(m_sortValues[column]);
-
-            const toResultStorageItem * o = dynamic_cast<const toResultStorageItem*>(&other);
-            Q_ASSERT_X(o, "cast", "only toResultStorageItem are supported");
-
-            switch (v.type())
-            {
-                case QVariant::ULongLong:
-                    return v.toULongLong() < o->sortValue(column).toULongLong();
-                case QVariant::Int:
-                    return v.toInt() < o->sortValue(column).toInt();
-                case QVariant::Double:
-                    return v.toDouble() < o->sortValue(column).toDouble();
-                case QVariant::String:
-                    return v.toString() < o->sortValue(column).toString();
-                default:
-                    Q_ASSERT_X(0, "compare", "more comparation is not supported now");
-                    break;
-            };
-            // never reached
-            return false;
-        }
-
-    private:
-        //! Store the value used for sorting for every column
-        QHash<int, QVariant> m_sortValues;
-};
-
 class toResultStorageItemDelegate: public QItemDelegate
 {
     public:
@@ -189,38 +117,43 @@ bool toResultStorage::canHandle(const toConnection &conn)
 }
 
 toResultStorage::toResultStorage(bool available, QWidget *parent, const char *name)
-    : toResultView(false, false, parent, name), AvailableGraph(available)
+    : toResultItemView(toResultItemModel::NoOptions, parent, name)
+    , toResult()
+    , AvailableGraph(available)
 {
     Unit = toConfigurationNewSingle::Instance().option(ToConfiguration::Global::SizeUnit).toString();
-    setAllColumnsShowFocus(true);
     setSortingEnabled(false); // enable it after data fetch
     setRootIsDecorated(true);
-    addColumn(tr("Name"));
-    addColumn(tr("Status"));
-    addColumn(tr("Information"));
-    addColumn(tr("Contents"));
-    addColumn(tr("Logging"));
-    addColumn(tr("Size (%1)").arg(Unit));
-    addColumn(tr("Free (%1)").arg(Unit));
-    addColumn(tr("Free (%)"));
-    addColumn(tr("Autoextend (%1)").arg(Unit));
-    if (available)
-        addColumn(tr("Used/Free/Autoextend"));
-    else
-        addColumn(tr("Available"));
-    addColumn(tr("Coalesced"));
-    addColumn(tr("Max free (%1)").arg(Unit));
-    addColumn(tr("Free fragments"));
+
+    QStringList headers;
+    headers << tr("Name")
+            << tr("Status")
+            << tr("Information")
+            << tr("Contents")
+            << tr("Logging")
+            << tr("Size (%1)").arg(Unit)
+            << tr("Free (%1)").arg(Unit)
+            << tr("Free (%)")
+            << tr("Autoextend (%1)").arg(Unit)
+            << (available ? tr("Used/Free/Autoextend") : tr("Available"))
+            << tr("Coalesced")
+            << tr("Max free (%1)").arg(Unit)
+            << tr("Free fragments")
+            << tr("Tablespace")
+            << tr("File");
+    Model->setHeaders(headers);
     setSQLName(tr("toResultStorage"));
 
-    setColumnAlignment(COL_SIZE, Qt::AlignRight);
-    setColumnAlignment(COL_FREE_UNIT, Qt::AlignRight);
-    setColumnAlignment(COL_FREE_PERCENT, Qt::AlignRight);
-    setColumnAlignment(COL_AUTOEXT, Qt::AlignCenter);
-    setColumnAlignment(COL_USED_FREE_AUTO, Qt::AlignCenter);
-    setColumnAlignment(COL_COALESCED, Qt::AlignRight);
-    setColumnAlignment(COL_MAX_FREE, Qt::AlignRight);
-    setColumnAlignment(COL_FREE_FRAGMENTS, Qt::AlignRight);
+    Model->setColumnAlignment(COL_SIZE, Qt::AlignRight);
+    Model->setColumnAlignment(COL_FREE_UNIT, Qt::AlignRight);
+    Model->setColumnAlignment(COL_FREE_PERCENT, Qt::AlignRight);
+    Model->setColumnAlignment(COL_AUTOEXT, Qt::AlignCenter);
+    Model->setColumnAlignment(COL_USED_FREE_AUTO, Qt::AlignCenter);
+    Model->setColumnAlignment(COL_COALESCED, Qt::AlignRight);
+    Model->setColumnAlignment(COL_MAX_FREE, Qt::AlignRight);
+    Model->setColumnAlignment(COL_FREE_FRAGMENTS, Qt::AlignRight);
+    setColumnHidden(FILE_TABLESPACE, true);
+    setColumnHidden(FILE_ID, true);
 
     ShowCoalesced = false;
     OnlyFiles = false;
@@ -616,17 +549,17 @@ static toSQL SQLDatafile7("toResultStorage:Datafile",
 
 void toResultStorage::saveSelected(void)
 {
-    toTreeWidgetItem *item = selectedItem();
-    if (item)
+    int item = selectedId();
+    if (item >= 0)
     {
-        if (item->parent() || OnlyFiles)
+        if (Model->parentId(item) >= 0 || OnlyFiles)
         {
-            CurrentSpace = item->text(COLUMNS);
-            CurrentFile = item->text(0);
+            CurrentSpace = Model->text(item, FILE_TABLESPACE);
+            CurrentFile = Model->text(item, 0);
         }
         else
         {
-            CurrentSpace = item->text(0);
+            CurrentSpace = Model->text(item, 0);
             CurrentFile = QString();
         }
     }
@@ -643,7 +576,7 @@ void toResultStorage::query(const QString &sql, toQueryParams const& param)
     try
     {
         saveSelected();
-        clear();
+        Model->clear();
 
         toConnection &conn = connection();
 
@@ -658,7 +591,7 @@ void toResultStorage::query(const QString &sql, toQueryParams const& param)
                                        , toSQL::string(ShowCoalesced ? SQLShowCoalesced : SQLNoShowCoalesced, connection())
                                        , args
                                        , toEventQuery::READ_ALL);
-        auto c1 = connect(Files, &toEventQuery::dataAvailable, this, &toResultStorage::receiveTablespaceData);
+        connect(Tablespaces, &toEventQuery::dataAvailable, this, &toResultStorage::receiveTablespaceData);
         connect(Tablespaces, SIGNAL(done(toEventQuery*, unsigned long)), this, SLOT(slotDoneTablespaces()));
         Tablespaces->start();
 
@@ -667,7 +600,7 @@ void toResultStorage::query(const QString &sql, toQueryParams const& param)
                                  , toSQL::string(SQLDatafile, connection())
                                  , args
                                  , toEventQuery::READ_ALL);
-        auto c2 = connect(Files, &toEventQuery::dataAvailable, this, &toResultStorage::receiveFilesData);
+        connect(Files, &toEventQuery::dataAvailable, this, &toResultStorage::receiveFilesData);
         connect(Files, SIGNAL(done(toEventQuery*, unsigned long)), this, SLOT(slotDoneFiles()));
         Files->start();
     }
@@ -677,24 +610,27 @@ void toResultStorage::query(const QString &sql, toQueryParams const& param)
 void toResultStorage::updateList(void)
 {
     setSortingEnabled(false); // enable it after data fetch
-    clear();
+    Model->clear();
+    setRootIsDecorated(!OnlyFiles);
+    setColumnHidden(FILE_TABLESPACE, !OnlyFiles);
+
+    int selected = -1;
+    QHash<QString, int> spaces;
     if (!OnlyFiles)
     {
+        toQueryAbstr::RowList rows;
         for (QStringList::iterator j = TablespaceValues.begin(); j != TablespaceValues.end();)
         {
-            toResultStorageItem *tablespace = new toResultStorageItem(AvailableGraph, this, NULL);
+            toQueryAbstr::Row tablespace;
             for (int i = 0; i < COLUMNS && j != TablespaceValues.end(); i++, j++)
-            {
-                if (i == COL_USED_FREE_AUTO)
-                    continue;
-                tablespace->setText(i, *j);
-                tablespace->setSortValue(i, *j);
-            }
+                tablespace << toQValue(*j);
+            while (tablespace.size() < FILECOLUMNS)
+                tablespace << toQValue(QString());
 
             // To fill Used/Free/Autoextend column
-            double total = tablespace->text(COL_FREE_PERCENT).toDouble();
-            double user = tablespace->text(COL_SIZE).toDouble();
-            double free = tablespace->text(COL_FREE_UNIT).toDouble();
+            double total = QString(tablespace[COL_FREE_PERCENT]).toDouble();
+            double user = QString(tablespace[COL_SIZE]).toDouble();
+            double free = QString(tablespace[COL_FREE_UNIT]).toDouble();
             if (total < user )
                 total = user;
             user /= total;
@@ -703,57 +639,54 @@ void toResultStorage::updateList(void)
 //             t.sprintf("%05.1f / %05.1f / %05.1f%%", (user-free)*100, free*100, (1 - user)*100);
 // spaces seems better than 0-filling...
             t.sprintf("%#5.1f / %#5.1f / %#5.1f%%", (user - free) * 100, free * 100, (1 - user) * 100);
-            tablespace->setText(COL_USED_FREE_AUTO, t);
-            tablespace->setSortValue(COL_USED_FREE_AUTO, (user - free) * 100);
+            tablespace[COL_USED_FREE_AUTO] = toQValue(t);
             // end of Used/Free/Autoextend column
 
-            if (CurrentSpace == tablespace->text(0))
-            {
-                if (CurrentFile.isEmpty())
-                    tablespace->setSelected(true);
-            }
+            rows << tablespace;
+        }
+
+        int first = Model->size();
+        Model->appendRows(rows);
+        for (int id = first; id < Model->size(); id++)
+        {
+            QString name = Model->text(id, 0);
+            spaces.insert(name, id);
+            if (CurrentSpace == name && CurrentFile.isEmpty())
+                selected = id;
         }
     }
 
+    // Files are grouped by tablespace to be appended below it at once
+    QMap<int, toQueryAbstr::RowList> files;
     for (QStringList::iterator k = FileValues.begin(); k != FileValues.end();)
     {
         QString name = *k;
         k++;
 
-        toTreeWidgetItem *file;
-        toTreeWidgetItem *tablespace = NULL;
-        if (OnlyFiles)
-        {
-            file = new toResultStorageItem(AvailableGraph, this, NULL);
-        }
-        else
-        {
-            for (tablespace = firstChild(); tablespace && tablespace->text(0) != name; tablespace = tablespace->nextSibling())
-                ;
-            if (!tablespace)
-            {
-                if (Files)
-                    break;
-            }
-            file = new toResultStorageItem(AvailableGraph, tablespace, NULL);
-        }
+        toQueryAbstr::Row file;
         for (int i = 0; i < FILECOLUMNS && k != FileValues.end(); i++, k++)
-        {
-            file->setText(i, *k);
-            reinterpret_cast<toResultStorageItem*>(file)->setSortValue(i, *k);
-        }
+            file << toQValue(*k);
+        while (file.size() < FILECOLUMNS)
+            file << toQValue(QString());
+        file[FILE_TABLESPACE] = toQValue(name);
 
-        file->setText(COLUMNS, name);
-        reinterpret_cast<toResultStorageItem*>(file)->setSortValue(COLUMNS, name);
-        if (CurrentSpace == file->text(COLUMNS) &&
-                CurrentFile == file->text(0))
+        files[OnlyFiles ? -1 : spaces.value(name, -1)] << file;
+    }
+    for (QMap<int, toQueryAbstr::RowList>::const_iterator f = files.begin(); f != files.end(); f++)
+    {
+        int first = Model->size();
+        Model->appendRows(f.value(), f.key());
+        for (int id = first; selected < 0 && !CurrentFile.isEmpty() && id < Model->size(); id++)
         {
-            if (tablespace)
-                tablespace->setOpen(true);
-            setSelected(file, true);
+            if (CurrentSpace == Model->text(id, FILE_TABLESPACE) &&
+                    CurrentFile == Model->text(id, 0))
+                selected = id;
         }
     }
+
     setSortingEnabled(true);
+    if (selected >= 0)
+        setSelectedId(selected);
 }
 
 void toResultStorage::receiveTablespaceData(toEventQuery*)
@@ -820,14 +753,14 @@ void toResultStorage::slotDoneFiles(void)
 
 QString toResultStorage::currentTablespace(void)
 {
-    toTreeWidgetItem *item = selectedItem();
-    if (!item)
+    int item = selectedId();
+    if (item < 0)
         throw tr("No tablespace selected");
     QString name;
-    if (item->parent() || OnlyFiles)
-        name = item->text(COLUMNS);
+    if (Model->parentId(item) >= 0 || OnlyFiles)
+        name = Model->text(item, FILE_TABLESPACE);
     else
-        name = item->text(0);
+        name = Model->text(item, 0);
     if (name.isEmpty())
         throw tr("Weird, empty tablespace name");
     return name;
@@ -835,27 +768,15 @@ QString toResultStorage::currentTablespace(void)
 
 QString toResultStorage::currentFilename(void)
 {
-    toTreeWidgetItem *item = selectedItem();
-    if (!item || (!item->parent() && !OnlyFiles))
+    int item = selectedId();
+    if (item < 0 || (Model->parentId(item) < 0 && !OnlyFiles))
         throw tr("No file selected");
-    QString name = item->text(0);
-    return name;
+    return Model->text(item, 0);
 }
 
 void toResultStorage::setOnlyFiles(bool only)
 {
     saveSelected();
-    if (only && !OnlyFiles)
-    {
-        addColumn(tr("Tablespace"));
-        setRootIsDecorated(false);
-    }
-    else if (!only && OnlyFiles)
-    {
-        // removing columns doesn't work with qtreewidget
-//         removeColumn(columns() - 1); todo
-        setRootIsDecorated(true);
-    }
     OnlyFiles = only;
     updateList();
 }
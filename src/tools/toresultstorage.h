@@ -36,11 +36,16 @@
 #define TORESULTSTORAGE_H
 
 
-#include "toresultview.h"
+#include "core/toresult.h"
+#include "widgets/toresultitemview.h"
 
 class toEventQuery;
 
-class toResultStorage : public toResultView
+/*! \brief Tablespaces with their datafiles as children, or datafiles only.
+Rows are kept in a toResultItemModel, use itemModel() with the COL_ and
+FILE_ column numbers to read them.
+*/
+class toResultStorage : public toResultItemView, public toResult
 {
         Q_OBJECT;
 
@@ -61,6 +66,13 @@ class toResultStorage : public toResultView
         void saveSelected(void);
         void updateList(void);
     public:
+        // Columns of datafile rows beyond the displayed tablespace columns
+        enum
+        {
+            FILE_TABLESPACE = 13,
+            FILE_ID = 14
+        };
+
         toResultStorage(bool availableGraph, QWidget *parent, const char *name = NULL);
         ~toResultStorage();
 
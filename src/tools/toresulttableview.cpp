@@ -35,6 +35,7 @@
 #include "tools/toresulttableview.h"
 
 #include "widgets/toresultmodel.h"
+#include "widgets/toresultmimedata.h"
 #include "core/toeventquery.h"
 #include "core/utils.h"
 #include "core/toconfiguration.h"
@@ -721,14 +722,18 @@ void toResultTableView::setModel(toResultModel *model)
 //         throw tr("Cannot change model while query is running.");
     Model = QPointer<toResultModel>(model);
     QTableView::setModel(model);
-    // After data model is set we need to connect to it's signal dataChanged. This signal
-    // will be emitted after sorting on column and we need to resize Row's again then
-    // because height of rows do not "move" together with their rows when sorting.
+    // After data model is set we need to connect to it's signals dataChanged and
+    // layoutChanged. The latter is emitted after sorting on column and we need to
+    // resize Row's again then because height of rows do not "move" together with
+    // their rows when sorting.
     if (toConfigurationNewSingle::Instance().option(ToConfiguration::Global::MultiLineResultsBool).toBool())
+    {
         connect(model,
                 SIGNAL(dataChanged(const QModelIndex &, const QModelIndex &)),
                 this,
                 SLOT(resizeRowsToContents()));
+        connect(model, SIGNAL(layoutChanged()), this, SLOT(resizeRowsToContents()));
+    }
     emit modelChanged(model);
 }
 
@@ -824,19 +829,18 @@ bool toResultTableView::editSave(bool askfile)
 void toResultTableView::editCopy()
 {
     QClipboard *clip = qApp->clipboard();
-    QMimeData *md = new QMimeData();
     // if there's a selection, then export as text to clipboard
     QModelIndexList sel = selectedIndexes();
     if (sel.size() > 1)
     {
-        toExportSettings settings = toResultListFormat::plaintextCopySettings();
-        settings.selected = sel;
-        md->setText(exportAsText(settings));
-        md->setData("application/x-tora", QByteArray(Utils::ptr2str(this).c_str())); // store pointer to self in clipboard see tobindvar.cpp insertFromMimeData
+        // text is rendered when pasted, see toResultMimeData
+        QStringList formats;
+        formats << "text/plain";
 #ifdef Q_OS_WIN32
-        std::unique_ptr<toListViewFormatter> pFormatter(toListViewFormatterFactory::Instance().CreateObject(toListViewFormatterIdentifier::XLSX));
-        md->setData("XML Spreadsheet", pFormatter->getFormattedString(settings, model()).toUtf8());
+        formats << "XML Spreadsheet";
 #endif
+        QMimeData *md = new toResultMimeData(model(), sel, formats, toResultListFormat::plaintextCopySettings());
+        md->setData("application/x-tora", QByteArray(Utils::ptr2str(this).c_str())); // store pointer to self in clipboard see tobindvar.cpp insertFromMimeData
         clip->setMimeData(md, QClipboard::Clipboard);
     }
     else
@@ -884,14 +888,14 @@ void toResultTableView::refresh()
     toResult::refresh();
 }
 
-bool toResultTableView::queryFromCache(const QString &owner, const QString &objectType)
+bool toResultTableView::queryFromCache(const QString &objectType, const QStringList &names)
 {
     if (Model && running())
         Model->stop();
     freeModel();
     //TODO: Pass pri keys
 
-    toResultModel* model = new toResultModel(owner, objectType, this, ReadableColumns);
+    toResultModel* model = new toResultModel(objectType, names, this, ReadableColumns);
     setModel(model);
 
     this->sortByColumn(0, Qt::AscendingOrder);
@@ -903,6 +907,20 @@ bool toResultTableView::queryFromCache(const QString &owner, const QString &obje
     return true;
 }
 
+void toResultTableView::showRows(const toQColumnDescriptionList &columns, const toQueryAbstr::RowList &rows)
+{
+    if (Model && running())
+        Model->stop();
+    freeModel();
+
+    toResultModel* model = new toResultModel(columns, rows, this, ReadableColumns);
+    setModel(model);
+
+    // when a new model is created the column sizes are lost
+    slotApplyColumnRules();
+    Ready = true;
+}
+
 // ---------------------------------------- iterator
 
 #if 1 // toInvalid, toAnalyze, toSession need this
@@ -197,8 +197,14 @@ class toResultTableView : public QTableView, public toResult, public toEditWidge
 	bool handleSearching(QString const& search, QString const& replace, Search::SearchFlags flags) override;
 
         /** Fill in result from the cache rather than executing actual query on database.
+         * @param names Object names read from the cache, sorted.
          */
-        bool queryFromCache(const QString &owner, const QString &type);
+        bool queryFromCache(const QString &type, const QStringList &names);
+
+        /** Show rows read by the caller rather than executing a query.
+         * @param rows Values of each row, in the order of columns.
+         */
+        void showRows(const toQColumnDescriptionList &columns, const toQueryAbstr::RowList &rows);
 
         static QMap<QString, toResultTableView*> Registry;
 
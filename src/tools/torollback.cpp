@@ -597,7 +597,7 @@ toRollback::toRollback(QWidget *main, toConnection &connection)
     toolbar->addWidget(lab1);
     Refresh = new toRefreshCombo(toolbar);
     connect(Refresh, SIGNAL(activated(const QString &)), this, SLOT(changeRefresh(const QString &)));
-	connect(Refresh->timer(), SIGNAL(timeout(void)), this, SLOT(refresh(void)));
+	connect(Refresh, SIGNAL(timeout(void)), this, SLOT(refresh(void)));
     toolbar->addWidget(Refresh);
 
     toolbar->addWidget(new Utils::toSpacer());
@@ -620,6 +620,9 @@ toRollback::toRollback(QWidget *main, toConnection &connection)
     tab->addTab(TransactionUsers, tr("Transaction Users"));
     TransactionUsers->setSQL(SQLTransactionUsers);
 
+    Refresh->watch(Segments);
+    Refresh->watch(TransactionUsers);
+
     QSplitter *horsplit = new QSplitter(Qt::Horizontal, splitter);
     tab->addTab(horsplit, tr("Open Cursors"));
 
@@ -375,6 +375,7 @@ void toScript::execute(void)
         toExtract::ObjectList sourceObjects = createObjectList(ScriptUI->Source->objectList());
         std::list<QString> sourceDescription;
         std::list<QString> destinationDescription;
+        toExtract::FingerprintMap sourcePrints;
         QString script;
 
         toExtract source(ScriptUI->Source->connection(), this);
@@ -476,6 +477,9 @@ void toScript::execute(void)
                 }
                 break;
             case MODE_COMPARE:
+                // only fingerprints here, details are described once the differing objects are known
+                sourcePrints = source.fingerprint(sourceObjects);
+                break;
             case MODE_SEARCH:
             case MODE_REPORT:
                 sourceDescription = source.describe(sourceObjects);
@@ -490,6 +494,14 @@ void toScript::execute(void)
             switch (mode)
             {
                 case MODE_COMPARE:
+                    {
+                        toExtract::FingerprintMap destinationPrints = destination.fingerprint(destinationObjects);
+                        ObjectList sourceChanged, destinationChanged;
+                        toExtract::changedObjects(sourcePrints, destinationPrints, sourceChanged, destinationChanged);
+                        sourceDescription = source.describe(sourceChanged);
+                        destinationDescription = destination.describe(destinationChanged);
+                    }
+                    break;
                 case MODE_SEARCH:
                     destinationDescription = destination.describe(destinationObjects);
                     break;
@@ -465,6 +465,9 @@ toSession::toSession(QWidget *main, toConnection &connection)
                    connection,
                    "toSession")
     , SessionFilter(new toSessionFilter)
+    , Sampler(new toSessionSampler(this))
+    , Loading(false)
+    , PendingRefresh(false)
 {
     QToolBar *toolbar = Utils::toAllocBar(this, tr("Session manager"));
     layout()->addWidget(toolbar);
@@ -522,7 +525,7 @@ toSession::toSession(QWidget *main, toConnection &connection)
 
     Refresh = new toRefreshCombo(toolbar);
     connect(Refresh, SIGNAL(activated(const QString &)), this, SLOT(slotChangeRefresh(const QString &)));
-    connect(Refresh->timer(), &QTimer::timeout, this, [this]{ slotRefreshTabs(); });
+    connect(Refresh, &toRefreshCombo::timeout, this, [this]{ slotRefreshTabs(); });
     toolbar->addWidget(Refresh);
 
     toolbar->addSeparator();
@@ -565,7 +568,17 @@ toSession::toSession(QWidget *main, toConnection &connection)
     Sessions->view()->setSelectionMode(QAbstractItemView::ExtendedSelection);
     //Sessions->view()->setFilter(SessionFilter);
 
-    connect(Sessions, &toResultSessions::queryDone, this, [this]{ slotDone(); });
+    connect(Sessions, &toResultSessions::queryDone, this, [this]
+    {
+        Loading = false;
+        slotDone();
+        replayRefresh();
+    });
+    connect(Sampler, &toSessionSampler::sampled, this, &toSession::slotSampled);
+    connect(Sampler, &toSessionSampler::failed, this, [this](const QString &str)
+    {
+        Utils::toStatusMessage(str);
+    });
 
     ResultTab = new QTabWidget(splitter);
 
@@ -842,12 +855,67 @@ void toSession::slotRefresh(void)
             sql = sql.arg(extra);
         }
 
+        // A full load is running, refresh again once it is done so that a
+        // filter or schema changed in the meantime is not lost
+        if (Loading)
+        {
+            PendingRefresh = true;
+            return;
+        }
+
+        // Same statement as last time, fetch a new sample and merge only the
+        // rows that changed instead of resetting the whole model
+        QList<int> keys = sessionKeys();
+        if (sql == LastSQL && Sessions->columnCount() > 0 && !keys.isEmpty())
+        {
+            // the sample in progress already answers this refresh
+            if (!Sampler->isRunning())
+                Sampler->sample(connection(), sql, Sessions->rows(), keys);
+            return;
+        }
+
+        // The statement changed, a sample of the old one is of no use
+        Sampler->reset();
         Sessions->setSQL(sql);
         Sessions->refreshWithParams(toQueryParams());
+        LastSQL = sql;
+        Loading = true;
     }
     TOCATCH;
 }
 
+void toSession::replayRefresh(void)
+{
+    if (!PendingRefresh)
+        return;
+    PendingRefresh = false;
+    slotRefresh();
+}
+
+QList<int> toSession::sessionKeys(void) const
+{
+    QList<int> keys;
+    int idxSid = Sessions->headers().indexOf("SID");
+    int idxSer = Sessions->headers().indexOf("Serial#");
+    if (idxSid >= 0)
+    {
+        keys << idxSid;
+        if (idxSer >= 0)
+            keys << idxSer;
+    }
+    return keys;
+}
+
+void toSession::slotSampled(const toSessionDelta &delta)
+{
+    if (Sessions->columnCount() == 0)
+        return;
+
+    if (!delta.Changed.isEmpty() || !delta.Removed.isEmpty() || !delta.Added.isEmpty())
+        Sessions->updateRows(sessionKeys(), delta.Changed, delta.Removed, delta.Added);
+    slotDone();
+}
+
 void toSession::slotDone(void)
 {
     int system = 0;
@@ -963,6 +1031,7 @@ void toSession::slotChangeTab(int index)
         }
         else if (CurrentTab == LongOps)
         {
+            Refresh->expect(LongOps);
             LongOps->refreshWithParams(toQueryParams() << connectionId << serial);
         }
         else if (PendingLocks && CurrentTab == PendingLocks->view())
@@ -976,6 +1045,7 @@ void toSession::slotChangeTab(int index)
             if (openitem.isValid())
                 address = openitem.data().toString();
             OpenCursors->clearParams();
+            Refresh->expect(OpenCursors);
             OpenCursors->refreshWithParams(toQueryParams() << connectionId);
             if (!address.isEmpty())
             {
@@ -1011,10 +1081,12 @@ void toSession::slotChangeTab(int index)
         }
         else if (CurrentTab == AccessedObjects)
         {
+            Refresh->expect(AccessedObjects);
             AccessedObjects->refreshWithParams(toQueryParams() << connectionId);
         }
         else if (CurrentTab == LockedObjects)
         {
+            Refresh->expect(LockedObjects);
             LockedObjects->refreshWithParams(toQueryParams() << connectionId);
         }
         else if (CurrentTab == Transaction)
@@ -1103,6 +1175,8 @@ void toSession::slotChangeItem(const QModelIndex &current, const QModelIndex &pr
     slotChangeTab(ResultTab->indexOf(t));
 }
 
+// The scheduled refresh ends once the table of the current tab is read,
+// the other tabs do not tell when they are done
 void toSession::slotRefreshTabs(void)
 {
     slotChangeItem(Sessions->view()->currentIndex(), QModelIndex());
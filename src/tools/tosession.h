@@ -41,6 +41,7 @@
 #include "tools/toresultlong.h"
 
 #include "tools/toresulttableview.h"
+#include "tools/tosessionsampler.h"
 
 #include <QLabel>
 #include <QMenu>
@@ -202,6 +203,17 @@ class toSession : public toToolWidget
         QString Session;
         QString Serial;
 
+        // Refreshes with an unchanged query only merge the differences into Sessions
+        toSessionSampler  *Sampler;
+        QString            LastSQL;
+        bool               Loading;
+        // A refresh was requested while the full load was running
+        bool               PendingRefresh;
+
+        QList<int> sessionKeys(void) const;
+        /** Run the refresh postponed by slotRefresh, if any */
+        void replayRefresh(void);
+
         //void updateSchemas(void);
 
         friend class toSessionSetting;
@@ -232,6 +244,7 @@ class toSession : public toToolWidget
         void slotDisconnectSession(void);
         void slotWindowActivated(toToolWidget*) override;
         void slotDone(void);
+        void slotSampled(const toSessionDelta &delta);
         void slotSelectAll(void);
         void slotSelectNone(void);
         void slotFilterChanged(const QString &text);
@@ -0,0 +1,204 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "tools/tosessionsampler.h"
+#include "core/toeventquery.h"
+#include "core/totablemodel.h"
+#include "core/utils.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+
+toSessionSampler::toSessionSampler(QObject *parent)
+    : QObject(parent)
+    , Thread(new QThread(this))
+    , Worker(new QObject)
+    , Generation(0)
+    , Running(false)
+{
+    Thread->setObjectName("toSessionSampler Thread");
+    Worker->moveToThread(Thread);
+    Thread->start();
+}
+
+toSessionSampler::~toSessionSampler()
+{
+    reset();
+    Thread->quit();
+    Thread->wait();
+    delete Worker;
+}
+
+void toSessionSampler::sample(toConnection &conn,
+                              const QString &sql,
+                              const toQueryAbstr::RowList &previous,
+                              const QList<int> &keys)
+{
+    if (Running)
+        return;
+
+    Previous = previous;
+    Keys = keys;
+    Current.clear();
+    Running = true;
+    Generation++;
+
+    try
+    {
+        Query = new toEventQuery(this, conn, sql, toQueryParams(), toEventQuery::READ_ALL);
+        connect(Query, &toEventQuery::dataAvailable, this, &toSessionSampler::receiveData);
+        connect(Query, &toEventQuery::done, this, &toSessionSampler::queryDone);
+        connect(Query, &toEventQuery::error, this, &toSessionSampler::queryError);
+        Query->start();
+    }
+    catch (const QString &str)
+    {
+        Running = false;
+        emit failed(str);
+    }
+}
+
+void toSessionSampler::reset(void)
+{
+    Generation++;
+    Running = false;
+    Previous.clear();
+    Current.clear();
+    if (Query)
+    {
+        Query->disconnect(this);
+        Query->stop();
+        Query->deleteLater();
+        Query = NULL;
+    }
+}
+
+void toSessionSampler::receiveData(toEventQuery *query)
+{
+    if (query != Query)
+        return;
+
+    try
+    {
+        int columns = query->columnCount();
+        while (query->hasMore())
+        {
+            toQueryAbstr::Row row;
+            for (int i = 0; i < columns; i++)
+                row << query->readValue();
+            Current << row;
+        }
+    }
+    catch (const QString &str)
+    {
+        queryError(query, toConnection::exception(str));
+    }
+}
+
+void toSessionSampler::queryDone(toEventQuery *query, unsigned long)
+{
+    if (query != Query)
+        return;
+    Query->deleteLater();
+    Query = NULL;
+
+    // Comparing thousands of rows column by column is done off the GUI
+    // thread, the containers are implicitly shared so nothing is copied here.
+    unsigned generation = Generation;
+    toQueryAbstr::RowList previous = Previous;
+    toQueryAbstr::RowList current = Current;
+    QList<int> keys = Keys;
+    Previous.clear();
+    Current.clear();
+
+    QTimer::singleShot(0, Worker, [this, generation, previous, current, keys]
+    {
+        toSessionDelta delta = compare(previous, current, keys);
+        QTimer::singleShot(0, this, [this, generation, delta]
+        {
+            if (generation != Generation)
+                return;
+            Running = false;
+            emit sampled(delta);
+        });
+    });
+}
+
+void toSessionSampler::queryError(toEventQuery *query, const toConnection::exception &str)
+{
+    if (query != Query)
+        return;
+    Query->deleteLater();
+    Query = NULL;
+    Running = false;
+    Previous.clear();
+    Current.clear();
+    emit failed(str);
+}
+
+toSessionDelta toSessionSampler::compare(const toQueryAbstr::RowList &previous,
+        const toQueryAbstr::RowList &current,
+        const QList<int> &keys)
+{
+    toSessionDelta delta;
+
+    QHash<QString, int> index;
+    index.reserve(previous.size());
+    for (int i = 0; i < previous.size(); i++)
+        index.insert(toTableModelPriv::rowKey(previous.at(i), keys), i);
+
+    for (const toQueryAbstr::Row &row : current)
+    {
+        QString key = toTableModelPriv::rowKey(row, keys);
+        QHash<QString, int>::iterator old = index.find(key);
+        if (old == index.end())
+        {
+            delta.Added << row;
+            continue;
+        }
+
+        if (previous.at(old.value()) == row)
+            delta.Unchanged++;
+        else
+            delta.Changed.insert(key, row);
+        index.erase(old);
+    }
+
+    // Whatever was not matched is gone
+    for (QHash<QString, int>::const_iterator i = index.constBegin(); i != index.constEnd(); i++)
+        delta.Removed.insert(i.key());
+
+    return delta;
+}
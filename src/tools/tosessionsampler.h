@@ -0,0 +1,151 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include "core/toquery.h"
+#include "core/toconnection.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QMap>
+#include <QtCore/QSet>
+#include <QtCore/QPointer>
+
+class QThread;
+class toEventQuery;
+
+/**
+ * Difference between two consecutive samples of the session list.
+ *
+ * Rows are identified by the value of their key columns (SID and Serial#
+ * for Oracle), see @ref toTableModelPriv::rowKey. A session which was
+ * replaced by a new one with the same SID has another Serial#, so it shows
+ * up as removed and added rather than changed.
+ *
+ * Changed rows carry all their columns, the model compares them with the
+ * rows it holds to find the range of columns to repaint.
+ */
+struct toSessionDelta
+{
+    /** Rows present in both samples whose values differ, by key */
+    QMap<QString, toQueryAbstr::Row> Changed;
+    /** Keys of rows which disappeared */
+    QSet<QString> Removed;
+    /** Rows which were not present in the previous sample */
+    toQueryAbstr::RowList Added;
+    /** Number of rows left untouched */
+    int Unchanged;
+
+    toSessionDelta() : Unchanged(0) {}
+};
+
+/**
+ * Periodic sampler of the session list.
+ *
+ * Instead of reloading the whole session model on every refresh the sampler
+ * runs the session query in the background, compares the result with the
+ * rows currently shown in a worker thread and reports only what changed.
+ * The model then applies the delta with @ref toTableModelPriv::updateRows
+ * so that selection, scroll position and sorting survive the refresh.
+ *
+ * Only one sample runs at a time, @ref sample is ignored while one is in
+ * progress. The whole list is still fetched on every sample since v$session
+ * has no way to return only the rows changed since a point in time, and the
+ * per session charts and transaction tab keep their own queries.
+ */
+class toSessionSampler : public QObject
+{
+        Q_OBJECT;
+
+    public:
+        toSessionSampler(QObject *parent);
+        virtual ~toSessionSampler();
+
+        /**
+         * Start a new sample.
+         *
+         * @param conn Connection to run the query on.
+         * @param sql Session list query, must return the same columns as the model.
+         * @param previous Rows of the previous sample (implicitly shared, not copied).
+         * @param keys Indexes of the columns identifying a session.
+         */
+        void sample(toConnection &conn,
+                    const QString &sql,
+                    const toQueryAbstr::RowList &previous,
+                    const QList<int> &keys);
+
+        /** Forget any sample in progress, its result will not be reported */
+        void reset(void);
+
+        /** True while a sample is being fetched or compared */
+        bool isRunning(void) const
+        {
+            return Running;
+        }
+
+    signals:
+        /** Emitted in the main thread once a sample has been compared */
+        void sampled(const toSessionDelta &delta);
+
+        /** Emitted when the session query failed */
+        void failed(const QString &error);
+
+    private slots:
+        /** Append the rows fetched so far to Current */
+        void receiveData(toEventQuery*);
+        /** Hand the complete sample over to the worker thread for comparison */
+        void queryDone(toEventQuery*, unsigned long);
+        void queryError(toEventQuery*, const toConnection::exception &);
+
+    private:
+        /** Compare two samples, runs in the worker thread */
+        static toSessionDelta compare(const toQueryAbstr::RowList &previous,
+                                      const toQueryAbstr::RowList &current,
+                                      const QList<int> &keys);
+
+        QPointer<toEventQuery> Query;
+        // Thread running compare(), Worker lives in it
+        QThread *Thread;
+        QObject *Worker;
+
+        // Rows shown when the sample was started and rows of the new sample
+        toQueryAbstr::RowList Previous;
+        toQueryAbstr::RowList Current;
+        // Indexes of SID and Serial# in the rows
+        QList<int> Keys;
+
+        // Incremented on every sample so that late results of an abandoned one are dropped
+        unsigned Generation;
+        bool Running;
+};
@@ -155,7 +155,7 @@ toSGATrace::toSGATrace(QWidget *main, toConnection &connection)
     toolbar->addWidget(labRef);
     Refresh = new toRefreshCombo(toolbar);
     connect(Refresh, SIGNAL(activated(const QString &)), this, SLOT(changeRefresh(const QString &)));
-	connect(Refresh->timer(), SIGNAL(timeout(void)), this, SLOT(refresh(void)));
+	connect(Refresh, SIGNAL(timeout(void)), this, SLOT(refresh(void)));
     toolbar->addWidget(Refresh);
 
     toolbar->addSeparator();
@@ -209,6 +209,7 @@ toSGATrace::toSGATrace(QWidget *main, toConnection &connection)
     layout()->addWidget(splitter);
 
     Trace = new toResultTableView(true, false, splitter);
+    Refresh->watch(Trace);
 
     QList<int> list;
     list.append(75);
@@ -44,6 +44,8 @@
 #include "core/toglobalevent.h"
 #include "core/toconfiguration.h"
 
+#include <QMenu>
+#include <QSplitter>
 #include <QTableView>
 #include <QToolBar>
 #include <QFileDialog>
@@ -968,7 +970,7 @@ toStorage::toStorage(QWidget *main, toConnection &connection)
     Objects->setSelectionMode(QAbstractItemView::SingleSelection);
 
     Extents = new toStorageExtent(ExtentParent);
-    Storage->setSelectionMode(toTreeWidget::Single);
+    Storage->setSelectionMode(QAbstractItemView::SingleSelection);
 
     connect(Objects->selectionModel(),
             SIGNAL(currentRowChanged(const QModelIndex &, const QModelIndex &)),
@@ -982,6 +984,7 @@ toStorage::toStorage(QWidget *main, toConnection &connection)
         Storage->setOnlyFiles(true);
 
     connect(Storage, SIGNAL(selectionChanged(void)), this, SLOT(selectionChanged(void)));
+    connect(Extents, SIGNAL(extentsLoaded(void)), this, SLOT(extentsLoaded(void)));
 
     ToolMenu = NULL;
     // connect(toMainWidget()->workspace(), SIGNAL(subWindowActivated(QMdiSubWindow *)),
@@ -1185,19 +1188,21 @@ void toStorage::selectionChanged(void)
     ReadOnlyAct->setEnabled(false);
     ReadWriteAct->setEnabled(false);
 
-    toTreeWidgetItem *item = Storage->selectedItem();
-    if (item)
+    toResultItemModel *model = Storage->itemModel();
+    int item = Storage->selectedId();
+    if (item >= 0)
     {
-        if (item->parent() || Storage->onlyFiles())
+        if (model->parentId(item) >= 0 || Storage->onlyFiles())
         {
             if (!ExtentParent->isHidden())
-                Extents->setFile(item->text(12), item->text(13).toInt());
-            item = item->parent();
+                Extents->setFile(model->text(item, toResultStorage::FILE_TABLESPACE),
+                                 model->text(item, toResultStorage::FILE_ID).toInt());
+            item = model->parentId(item);
             MoveFileAct->setEnabled(true);
             ModFileAct->setEnabled(true);
         }
         else if (!ExtentParent->isHidden())
-            Extents->setTablespace(item->text(0));
+            Extents->setTablespace(model->text(item, 0));
 
         if (!ExtentParent->isHidden())
         {
@@ -1206,10 +1211,10 @@ void toStorage::selectionChanged(void)
             Objects->resizeRowsToContents();
         }
 
-        if (item)
+        if (item >= 0)
         {
-            toTreeWidgetItem *child = item->firstChild();
-            if (!child)
+            int child = model->firstChild(item);
+            if (child < 0)
             {
                 OnlineAct->setEnabled(true);
                 OfflineAct->setEnabled(true);
@@ -1218,23 +1223,23 @@ void toStorage::selectionChanged(void)
             }
             else
             {
-                if (child->text(1) == QString::fromLatin1("OFFLINE"))
+                if (model->text(child, 1) == QString::fromLatin1("OFFLINE"))
                     OnlineAct->setEnabled(true);
-                else if (child->text(1) == QString::fromLatin1("ONLINE"))
+                else if (model->text(child, 1) == QString::fromLatin1("ONLINE"))
                 {
                     OfflineAct->setEnabled(true);
-                    if (child->text(2) == QString::fromLatin1("READ ONLY"))
+                    if (model->text(child, 2) == QString::fromLatin1("READ ONLY"))
                         ReadWriteAct->setEnabled(true);
                     else
                         ReadOnlyAct->setEnabled(true);
                 }
             }
-            if (item->text(4) == QString::fromLatin1("LOGGING"))
+            if (model->text(item, 4) == QString::fromLatin1("LOGGING"))
                 EraseLogAct->setEnabled(true);
             else
                 LoggingAct->setEnabled(true);
 
-            if (item->text(10) != QString::fromLatin1("100%"))
+            if (model->text(item, 10) != QString::fromLatin1("100%"))
                 CoalesceAct->setEnabled(true);
         }
         NewFileAct->setEnabled(true);
@@ -1385,6 +1390,13 @@ void toStorage::moveFile(void)
     TOCATCH
 }
 
+void toStorage::extentsLoaded(void)
+{
+    ObjectsModel->setValues(Extents->objects());
+    Objects->resizeColumnsToContents();
+    Objects->resizeRowsToContents();
+}
+
 void toStorage::selectObject(const QModelIndex & current, const QModelIndex &)
 {
     QModelIndex ix = current;
@@ -62,7 +62,6 @@ class QTabWidget;
 class toConnection;
 class toFilesize;
 class toResultStorage;
-class toResultView;
 class toStorageDefinition;
 class toStorageDialog;
 class QTableView;
@@ -295,6 +294,7 @@ class toStorage : public toToolWidget
         void showExtent(bool);
         void showTablespaces(bool);
         void selectionChanged(void);
+        void extentsLoaded(void);
         void selectObject(const QModelIndex & current, const QModelIndex &);
         virtual void slotWindowActivated(toToolWidget* widget);
 };
@@ -0,0 +1,358 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "tools/totimeseries.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QIODevice>
+
+#include <cmath>
+#include <limits>
+
+// Identifies a stream written by toTimeSeries::save ("TOTS")
+#define TIMESERIES_MAGIC 0x544f5453
+#define TIMESERIES_VERSION 1
+
+// Log2 of the number of samples in a block of the lowest pyramid level
+#define TIMESERIES_BLOCK_SHIFT 4
+
+static const double NoValue = std::numeric_limits<double>::quiet_NaN();
+
+static inline void mergeRange(toTimeSeries::MinMax &ret, double val)
+{
+    if (std::isnan(val))
+        return;
+    if (!ret.Valid)
+    {
+        ret.Min = ret.Max = ret.Sum = val;
+        ret.Values = 1;
+        ret.Valid = true;
+        return;
+    }
+    if (val < ret.Min)
+        ret.Min = val;
+    else if (val > ret.Max)
+        ret.Max = val;
+    ret.Sum += val;
+    ret.Values++;
+}
+
+static inline void mergeRange(toTimeSeries::MinMax &ret, const toTimeSeries::MinMax &val)
+{
+    if (!val.Valid)
+        return;
+    if (!ret.Valid)
+        ret = val;
+    else
+    {
+        ret.Min = (std::min)(ret.Min, val.Min);
+        ret.Max = (std::max)(ret.Max, val.Max);
+        ret.Sum += val.Sum;
+        ret.Values += val.Values;
+    }
+}
+
+toTimeSeries::toTimeSeries(int capacity)
+    : Capacity(capacity > 0 ? capacity : -1)
+    , Allocated(0)
+    , Head(0)
+    , Count(0)
+    , Columns(0)
+    , Total(0)
+{
+    if (Capacity > 0)
+        reallocate(Capacity);
+}
+
+void toTimeSeries::setCapacity(int capacity)
+{
+    Capacity = capacity > 0 ? capacity : -1;
+    if (Capacity > 0)
+        reallocate(Capacity);
+}
+
+void toTimeSeries::clear(void)
+{
+    Data.clear();
+    Columns = 0;
+    Head = 0;
+    Count = 0;
+    Total = 0;
+    Levels.clear();
+    if (Capacity < 0)
+    {
+        Allocated = 0;
+        Labels.clear();
+    }
+    else
+    {
+        for (std::vector<QString>::iterator i = Labels.begin(); i != Labels.end(); i++)
+            *i = QString();
+    }
+}
+
+void toTimeSeries::reallocate(int allocated)
+{
+    int keep = (std::min)(Count, allocated);
+    int drop = Count - keep;
+
+    std::vector<double> data(size_t(Columns) * allocated, NoValue);
+    std::vector<QString> labels(allocated);
+    for (int i = 0; i < keep; i++)
+    {
+        int phys = physical(drop + i);
+        for (int c = 0; c < Columns; c++)
+            data[size_t(c) * allocated + i] = Data[size_t(c) * Allocated + phys];
+        labels[i] = Labels[phys];
+    }
+
+    Data.swap(data);
+    Labels.swap(labels);
+    Allocated = allocated;
+    Head = 0;
+    Count = keep;
+    rebuildLevels();
+}
+
+void toTimeSeries::addSeries(void)
+{
+    // Columns are laid out one after another, a new one goes at the end
+    Data.resize(Data.size() + Allocated, NoValue);
+    Columns++;
+    rebuildLevels();
+}
+
+void toTimeSeries::rebuildLevels(void)
+{
+    Levels.clear();
+    for (int shift = TIMESERIES_BLOCK_SHIFT; (1 << shift) <= Allocated; shift++)
+    {
+        Level level;
+        level.Shift = shift;
+        // Blocks partially overwritten at both ends of the ring need a slot too
+        level.Blocks = (Allocated >> shift) + 2;
+        level.Id.resize(level.Blocks, -1);
+        level.Range.resize(size_t(level.Blocks) * Columns);
+        Levels.push_back(level);
+    }
+    for (int i = 0; i < Count; i++)
+        updateLevels(Total - Count + i, physical(i));
+}
+
+void toTimeSeries::updateLevels(qint64 absolute, int slot)
+{
+    for (std::vector<Level>::iterator l = Levels.begin(); l != Levels.end(); l++)
+    {
+        qint64 block = absolute >> (*l).Shift;
+        int pos = int(block % (*l).Blocks);
+        if ((*l).Id[pos] != block)
+        {
+            // First sample of a block, forget the block that was there before
+            (*l).Id[pos] = block;
+            for (int c = 0; c < Columns; c++)
+                (*l).Range[size_t(c) * (*l).Blocks + pos].Valid = false;
+        }
+        for (int c = 0; c < Columns; c++)
+            mergeRange((*l).Range[size_t(c) * (*l).Blocks + pos], Data[size_t(c) * Allocated + slot]);
+    }
+}
+
+void toTimeSeries::append(const std::list<double> &values, const QString &label)
+{
+    if (Count == Allocated)
+    {
+        if (Capacity < 0)
+            reallocate((std::max)(16, Allocated * 2));
+        else
+        {
+            // Full, overwrite the oldest sample
+            Head = physical(1);
+            Count--;
+        }
+    }
+
+    while (Columns < int(values.size()))
+        addSeries();
+
+    int slot = physical(Count);
+    int c = 0;
+    for (std::list<double>::const_iterator i = values.begin(); i != values.end(); i++, c++)
+        Data[size_t(c) * Allocated + slot] = *i;
+    for (; c < Columns; c++)
+        Data[size_t(c) * Allocated + slot] = NoValue;
+    Labels[slot] = label;
+    updateLevels(Total, slot);
+    Count++;
+    Total++;
+}
+
+bool toTimeSeries::hasValue(int series, int index) const
+{
+    return !std::isnan(value(series, index));
+}
+
+double toTimeSeries::last(int series) const
+{
+    if (Count == 0 || series >= Columns)
+        return NoValue;
+    return value(series, Count - 1);
+}
+
+toTimeSeries::MinMax toTimeSeries::range(int series, int from, int to) const
+{
+    MinMax ret;
+    ret.Min = ret.Max = ret.Sum = 0;
+    ret.Values = 0;
+    ret.Valid = false;
+
+    from = (std::max)(from, 0);
+    to = (std::min)(to, Count);
+    if (series >= Columns || from >= to)
+        return ret;
+
+    // Take the largest aligned pyramid block starting at the current position,
+    // single samples are only read at the unaligned ends of the range.
+    const double *column = &Data[size_t(series) * Allocated];
+    qint64 base = Total - Count;
+    qint64 pos = base + from;
+    qint64 end = base + to;
+    while (pos < end)
+    {
+        bool found = false;
+        for (std::vector<Level>::const_reverse_iterator l = Levels.rbegin(); l != Levels.rend(); l++)
+        {
+            qint64 size = qint64(1) << (*l).Shift;
+            if ((pos & (size - 1)) != 0 || pos + size > end)
+                continue;
+            qint64 block = pos >> (*l).Shift;
+            int slot = int(block % (*l).Blocks);
+            if ((*l).Id[slot] != block)
+                continue;
+            mergeRange(ret, (*l).Range[size_t(series) * (*l).Blocks + slot]);
+            pos += size;
+            found = true;
+            break;
+        }
+        if (!found)
+        {
+            mergeRange(ret, column[physical(int(pos - base))]);
+            pos++;
+        }
+    }
+    return ret;
+}
+
+void toTimeSeries::decimate(int series, int from, int to, int buckets, std::vector<MinMax> &ret) const
+{
+    ret.resize((std::max)(buckets, 0));
+    if (buckets <= 0)
+        return;
+    int len = to - from;
+    for (int i = 0; i < buckets; i++)
+    {
+        int first = from + int(qint64(len) * i / buckets);
+        int last = from + int(qint64(len) * (i + 1) / buckets);
+        if (last == first)
+            last = (std::min)(first + 1, to);
+        ret[i] = range(series, first, last);
+    }
+}
+
+void toTimeSeries::save(QDataStream &stream) const
+{
+    stream << (quint32) TIMESERIES_MAGIC;
+    stream << (quint8) TIMESERIES_VERSION;
+    stream << (qint32) Columns;
+    stream << (qint32) Count;
+    for (int i = 0; i < Count; i++)
+        stream << label(i);
+    for (int c = 0; c < Columns; c++)
+        for (int i = 0; i < Count; i++)
+            stream << value(c, i);
+}
+
+bool toTimeSeries::load(QDataStream &stream)
+{
+    quint32 magic;
+    quint8 version;
+    qint32 columns, count;
+
+    stream >> magic >> version >> columns >> count;
+    if (stream.status() != QDataStream::Ok || magic != TIMESERIES_MAGIC || version != TIMESERIES_VERSION ||
+            columns < 0 || count < 0)
+        return false;
+
+    // A label takes at least its length, a value 8 bytes. Check the header against
+    // what is left in the stream before allocating anything from it.
+    quint64 needed = quint64(count) * (4 + quint64(columns) * 8);
+    QIODevice *device = stream.device();
+    bool sized = device && !device->isSequential();
+    if (sized && needed > quint64(device->size() - device->pos()))
+        return false;
+
+    // Without a known size grow as values are actually read
+    std::vector<QString> labels;
+    std::vector<double> data;
+    if (sized)
+    {
+        labels.reserve(count);
+        data.reserve(size_t(columns) * count);
+    }
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++)
+    {
+        QString label;
+        stream >> label;
+        labels.push_back(label);
+    }
+    for (qint64 i = 0; i < qint64(columns) * count && stream.status() == QDataStream::Ok; i++)
+    {
+        double val;
+        stream >> val;
+        data.push_back(val);
+    }
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    Data.swap(data);
+    Labels.swap(labels);
+    Columns = columns;
+    Allocated = Count = count;
+    Head = 0;
+    Total = count;
+    if (Capacity > 0)
+        reallocate(Capacity);
+    else
+        rebuildLevels();
+    return true;
+}
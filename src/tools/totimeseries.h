@@ -0,0 +1,223 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include <QtCore/QString>
+
+#include <limits>
+#include <list>
+#include <vector>
+
+class QDataStream;
+
+/**
+ * Fixed capacity time series store used by the charts.
+ *
+ * Samples are kept in one contiguous buffer with a column per series, each
+ * column being a ring of @ref capacity slots. Appending a sample set is O(1)
+ * per series and does not allocate once the ring is full. Series that are
+ * added later than others (or that lack a value in some sample set) hold NaN
+ * in the slots where no value was provided.
+ *
+ * Indexes passed to the accessors are logical, 0 is the oldest sample kept,
+ * size() - 1 is the most recent one.
+ *
+ * Alongside the samples a min/max pyramid is maintained incrementally, level n
+ * holding the range and sum of aligned blocks of 16 << n samples. Range queries and
+ * decimation use the largest blocks that fit so their cost depends on the
+ * number of buckets requested rather than on the number of samples.
+ */
+class toTimeSeries
+{
+    public:
+        /** Minimum, maximum and sum of a range of samples.
+         */
+        struct MinMax
+        {
+            double Min;
+            double Max;
+            double Sum;
+            /** Number of values in the range, NaN slots are not counted.
+             */
+            int Values;
+            /** False if the range contained no values at all.
+             */
+            bool Valid;
+
+            /** Average of the values in the range, NaN if there were none.
+             */
+            double average(void) const
+            {
+                return Values > 0 ? Sum / Values : std::numeric_limits<double>::quiet_NaN();
+            }
+        };
+
+        /** Create an empty store.
+         * @param capacity Number of samples to keep, -1 to keep everything.
+         */
+        toTimeSeries(int capacity = -1);
+
+        /** Change the number of samples to keep. The most recent samples are preserved.
+         * @param capacity Number of samples, -1 for unlimited.
+         */
+        void setCapacity(int capacity);
+        /** Get the number of samples kept, -1 if unlimited.
+         */
+        int capacity(void) const
+        {
+            return Capacity;
+        }
+
+        /** Number of samples currently stored.
+         */
+        int size(void) const
+        {
+            return Count;
+        }
+        /** Number of series (chart lines) stored.
+         */
+        int series(void) const
+        {
+            return Columns;
+        }
+        bool isEmpty(void) const
+        {
+            return Count == 0;
+        }
+
+        /** Remove all samples and series.
+         */
+        void clear(void);
+
+        /** Append a sample set. If the list holds more values than there are series
+         * new series are created.
+         * @param values One value for each series.
+         * @param label X-value of the sample set.
+         */
+        void append(const std::list<double> &values, const QString &label);
+
+        /** Get a value.
+         * @param series Series index.
+         * @param index Logical sample index, 0 is the oldest.
+         * @return Value or NaN if the series has no value for this sample.
+         */
+        double value(int series, int index) const
+        {
+            return Data[size_t(series) * Allocated + physical(index)];
+        }
+        /** Get the x-value of a sample.
+         */
+        const QString &label(int index) const
+        {
+            return Labels[physical(index)];
+        }
+        /** Check if a series has a value for a sample.
+         */
+        bool hasValue(int series, int index) const;
+        /** Get the most recent value of a series.
+         * @return Value or NaN if there is none.
+         */
+        double last(int series) const;
+
+        /** Get the minimum, maximum and sum of a series over a range of samples.
+         * Uses the pyramid for the aligned part of the range.
+         * @param series Series index.
+         * @param from First logical index (inclusive).
+         * @param to Last logical index (exclusive).
+         */
+        MinMax range(int series, int from, int to) const;
+
+        /** Decimate a range of samples of a series into a number of buckets by
+         * keeping the minimum, maximum and sum of every bucket. This is used when drawing
+         * so that the number of primitives depends on the width of the chart rather
+         * than on the number of samples.
+         * @param series Series index.
+         * @param from First logical index (inclusive).
+         * @param to Last logical index (exclusive).
+         * @param buckets Number of buckets to produce.
+         * @param ret Vector to fill, resized to buckets entries.
+         */
+        void decimate(int series, int from, int to, int buckets, std::vector<MinMax> &ret) const;
+
+        /** Write the content of the store to a stream.
+         */
+        void save(QDataStream &stream) const;
+        /** Read the content of the store from a stream written by @ref save. The
+         * capacity is kept unless unlimited, in which case it is set to fit the samples read.
+         * @return False if the stream did not contain a valid time series.
+         */
+        bool load(QDataStream &stream);
+
+    private:
+        /** One level of the min/max pyramid.
+         */
+        struct Level
+        {
+            /** Log2 of the number of samples in a block.
+             */
+            int Shift;
+            /** Number of block slots, enough to cover the ring.
+             */
+            int Blocks;
+            /** Absolute block number held by each slot, -1 if none.
+             */
+            std::vector<qint64> Id;
+            /** Range of each block, Blocks entries per series.
+             */
+            std::vector<MinMax> Range;
+        };
+
+        int physical(int index) const
+        {
+            int ret = Head + index;
+            return ret >= Allocated ? ret - Allocated : ret;
+        }
+        void reallocate(int allocated);
+        void addSeries(void);
+        void rebuildLevels(void);
+        void updateLevels(qint64 absolute, int slot);
+
+        int Capacity;
+        int Allocated;
+        int Head;
+        int Count;
+        int Columns;
+        /** Number of samples ever appended, used to align pyramid blocks.
+         */
+        qint64 Total;
+        std::vector<double> Data;
+        std::vector<QString> Labels;
+        std::vector<Level> Levels;
+};
@@ -716,7 +716,7 @@ toTuning::toTuning(QWidget *main, toConnection &connection)
     toolbar->addWidget(new QLabel(tr("Refresh") + " ", toolbar));
 
     Refresh = new toRefreshCombo(toolbar);
-    connect(Refresh->timer(), SIGNAL(timeout(void)), this, SLOT(refresh(void)));
+    connect(Refresh, SIGNAL(timeout(void)), this, SLOT(refresh(void)));
     toolbar->addWidget(Refresh);
 
     // used in pulldown menu
@@ -938,6 +938,8 @@ void toTuning::slotWindowActivated(toToolWidget *widget)
     }
 }
 
+// Only the table tabs tell the refresh scheduler when their query is done,
+// for the other tabs the scheduled refresh ends when this returns
 void toTuning::refresh(void)
 {
     using namespace ToConfiguration;
@@ -992,14 +994,21 @@ void toTuning::refresh(void)
 	else if (LastTab == BlockingLocks->view())
 		BlockingLocks->refreshWithParams(toQueryParams());
     else if (LastTab == LibraryCache)
+    {
+        Refresh->expect(LibraryCache);
         LibraryCache->refresh();
+    }
     else if (LastTab == ControlFiles)
     {
         QString unit = toConfigurationNewSingle::Instance().option(Global::SizeUnit).toString();
+        Refresh->expect(ControlFiles);
         ControlFiles->refreshWithParams(toQueryParams() << QString::number(Utils::toSizeDecode(unit)) << unit);
     }
     else if (LastTab == Options)
+    {
+        Refresh->expect(Options);
         Options->refresh();
+    }
     else if (LastTab == Licenses)
         Licenses->refresh();
 }
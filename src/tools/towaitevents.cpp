@@ -42,6 +42,7 @@
 #include "widgets/totoolwidget.h"
 
 #include <QtCore/QSettings>
+#include <QtCore/QDataStream>
 #include <QComboBox>
 #include <QLabel>
 #include <QSplitter>
@@ -224,12 +225,28 @@ void toWaitEvents::setup(int session)
     else
         splitter->restoreState(ba);
 
+    int samples = toConfigurationNewSingle::Instance().option(ToConfiguration::Global::ChartSamplesInt).toInt();
+    Relative.setCapacity(samples);
+    RelativeTimes.setCapacity(samples);
+
     LastTime = 0;
 
     First = true;
     ShowTimes = false;
 }
 
+void toWaitEvents::clearSamples(void)
+{
+    Labels.clear();
+    LabelIndex.clear();
+    LastCurrent.clear();
+    LastTimes.clear();
+    Current.clear();
+    CurrentTimes.clear();
+    Relative.clear();
+    RelativeTimes.clear();
+}
+
 void toWaitEvents::changeType(int item)
 {
     ShowTimes = item;
@@ -257,12 +274,7 @@ void toWaitEvents::setSession(int session)
         First = true;
         Now = QString();
         LastTime = 0;
-        Labels.clear();
-        LastCurrent.clear();
-        Current.clear();
-        CurrentTimes.clear();
-        Relative.clear();
-        RelativeTimes.clear();
+        clearSamples();
         Enabled.clear();
         delete Query;
         Query = NULL;
@@ -334,27 +346,24 @@ void toWaitEvents::changeSelection(void)
         std::list<double> absolute;
         std::list<double> relative;
         {
-            std::list<double>::iterator i = (ShowTimes ? LastTimes : LastCurrent).begin();
-            std::list<double>::iterator j = (ShowTimes ? RelativeTimes : Relative).begin();
-            std::list<bool>::iterator k = Enabled.begin();
-            while (i != (ShowTimes ? LastTimes : LastCurrent).end() && k != Enabled.end())
+            const std::vector<double> &last = ShowTimes ? LastTimes : LastCurrent;
+            const toTimeSeries &delta = ShowTimes ? RelativeTimes : Relative;
+            int ind = 0;
+            for (std::list<bool>::iterator k = Enabled.begin(); k != Enabled.end() && ind < int(last.size()); k++, ind++)
             {
+                bool hasDelta = ind < delta.series() && delta.hasValue(ind, delta.size() - 1);
                 if (*k)
                 {
-                    if (j != (ShowTimes ? RelativeTimes : Relative).end())
-                        relative.insert(relative.end(), *j);
-                    absolute.insert(absolute.end(), *i);
+                    if (hasDelta)
+                        relative.insert(relative.end(), delta.last(ind));
+                    absolute.insert(absolute.end(), last[ind]);
                 }
                 else
                 {
-                    if (j != (ShowTimes ? RelativeTimes : Relative).end())
+                    if (hasDelta)
                         relative.insert(relative.end(), 0);
                     absolute.insert(absolute.end(), 0);
                 }
-                i++;
-                if (j != (ShowTimes ? RelativeTimes : Relative).end())
-                    j++;
-                k++;
             }
         }
 
@@ -386,12 +395,7 @@ void toWaitEvents::changeSelection(void)
 
 void toWaitEvents::connectionChanged(void)
 {
-    LastCurrent.clear();
-    LastTimes.clear();
-    Labels.clear();
-
-    Relative.clear();
-    RelativeTimes.clear();
+    clearSamples();
 
     delete Query;
     Query = NULL;
@@ -411,28 +415,20 @@ void toWaitEvents::receiveData(toEventQuery*)
             Now = (QString)Query->readValue();
             if (First)
             {
+                LabelIndex[cur] = int(Labels.size());
                 Labels.insert(Labels.end(), cur);
-                Current.insert(Current.end(), Query->readValue().toDouble());
-                CurrentTimes.insert(CurrentTimes.end(), Query->readValue().toDouble());
+                Current.push_back(Query->readValue().toDouble());
+                CurrentTimes.push_back(Query->readValue().toDouble());
             }
             else
             {
                 double val = Query->readValue().toDouble();
                 double tim = Query->readValue().toDouble();
-                std::list<double>::iterator i = Current.begin();
-                std::list<double>::iterator j = CurrentTimes.begin();
-                std::list<QString>::iterator k = Labels.begin();
-                while (i != Current.end() && j != CurrentTimes.end() && k != Labels.end())
+                std::map<QString, int>::iterator i = LabelIndex.find(cur);
+                if (i != LabelIndex.end())
                 {
-                    if (*k == cur)
-                    {
-                        *i = val;
-                        *j = tim;
-                        break;
-                    }
-                    i++;
-                    j++;
-                    k++;
+                    Current[(*i).second] = val;
+                    CurrentTimes[(*i).second] = tim;
                 }
             }
             Query->readValue().toDouble();
@@ -459,7 +455,7 @@ void toWaitEvents::slotQueryDone(toEventQuery*)
     }
 
     {
-        std::list<double>::iterator j = CurrentTimes.begin();
+        std::vector<double>::iterator j = CurrentTimes.begin();
         for (std::list<QString>::iterator i = Labels.begin(); i != Labels.end(); i++, j++)
         {
             if ((*j) != 0 && types.find(*i) == types.end())
@@ -486,61 +482,42 @@ void toWaitEvents::slotQueryDone(toEventQuery*)
         toWaitEventsItem * item = dynamic_cast<toWaitEventsItem *>(ci);
         if (item)
         {
-            int col = 0;
-            std::list<double>::iterator i = Current.begin();
-            std::list<double>::iterator j = CurrentTimes.begin();
-            std::list<QString>::iterator k = Labels.begin();
-            while (i != Current.end() && j != CurrentTimes.end() && k != Labels.end())
+            std::map<QString, int>::iterator k = LabelIndex.find(item->text(1));
+            if (k != LabelIndex.end())
             {
-                if (item->text(1) == *k)
-                {
-                    item->setColor(col);
-                    item->setText(2, QString::number((*i - item->text(3).toDouble()) / (std::max)(int(now - LastTime), 1)));
-                    item->setText(3, QString::number(*i));
-                    item->setText(4, QString::number((*j - item->text(5).toDouble()) / (std::max)(int(now - LastTime), 1)));
-                    item->setText(5, QString::number(*j));
-                    break;
-                }
-                col++;
-                i++;
-                j++;
-                k++;
+                int col = (*k).second;
+                double cur = Current[col];
+                double tim = CurrentTimes[col];
+                item->setColor(col);
+                item->setText(2, QString::number((cur - item->text(3).toDouble()) / (std::max)(int(now - LastTime), 1)));
+                item->setText(3, QString::number(cur));
+                item->setText(4, QString::number((tim - item->text(5).toDouble()) / (std::max)(int(now - LastTime), 1)));
+                item->setText(5, QString::number(tim));
             }
         }
     }
 
-    Relative.clear();
-    RelativeTimes.clear();
+    std::list<double> relative;
+    for (size_t i = 0; i < Current.size() && i < LastCurrent.size(); i++)
+        relative.push_back((Current[i] - LastCurrent[i]) / (std::max)(int(now - LastTime), 1));
 
-    std::list<double>::iterator j = LastCurrent.begin();
-    std::list<double>::iterator i = Current.begin();
-    while (i != Current.end() && j != LastCurrent.end())
-    {
-        Relative.insert(Relative.end(), ((*i) - (*j)) / (std::max)(int(now - LastTime), 1));
-        i++;
-        j++;
-    }
-
-    j = LastTimes.begin();
-    i = CurrentTimes.begin();
-    while (i != CurrentTimes.end() && j != LastTimes.end())
-    {
-        RelativeTimes.insert(RelativeTimes.end(), ((*i) - (*j)) / (std::max)(int(now - LastTime), 1));
-        i++;
-        j++;
-    }
+    std::list<double> relativeTimes;
+    for (size_t i = 0; i < CurrentTimes.size() && i < LastTimes.size(); i++)
+        relativeTimes.push_back((CurrentTimes[i] - LastTimes[i]) / (std::max)(int(now - LastTime), 1));
 
     LastTime = now;
     LastTimes = CurrentTimes;
     LastCurrent = Current;
 
-#ifdef TORA_EXPERIMENTAL
-    if (Relative.begin() != Relative.end())
+    if (!relative.empty())
     {
-        Delta->addValues(Relative, Now);
-        DeltaTimes->addValues(RelativeTimes, Now);
-    }
+        Relative.append(relative, Now);
+        RelativeTimes.append(relativeTimes, Now);
+#ifdef TORA_EXPERIMENTAL
+        Delta->addValues(relative, Now);
+        DeltaTimes->addValues(relativeTimes, Now);
 #endif
+    }
 
     changeSelection();
 
@@ -657,6 +634,48 @@ void toWaitEvents::importData(std::map<QString, QString> &data, const QString &p
         HideMap[(*i).second] = true;
         id++;
     }
+
+    // Restore the sampled deltas of an exported session
+    if ((i = data.find(prefix + ":Samples")) != data.end())
+    {
+        QByteArray samples = QByteArray::fromBase64((*i).second.toLatin1());
+        QDataStream in(&samples, QIODevice::ReadOnly);
+        qint32 count;
+        in >> count;
+        std::list<QString> labels;
+        for (int j = 0; j < count && in.status() == QDataStream::Ok; j++)
+        {
+            QString label;
+            in >> label;
+            labels.push_back(label);
+        }
+        toTimeSeries relative(Relative.capacity());
+        toTimeSeries relativeTimes(RelativeTimes.capacity());
+        if (!relative.load(in) || !relativeTimes.load(in))
+            return;
+
+        // Labels are read again by the first refresh, they are only needed by the charts here
+        clearSamples();
+        First = true;
+        Relative = relative;
+        RelativeTimes = relativeTimes;
+#ifdef TORA_EXPERIMENTAL
+        Delta->clear();
+        DeltaTimes->clear();
+        Delta->setLabels(labels);
+        DeltaTimes->setLabels(labels);
+        for (int j = 0; j < Relative.size(); j++)
+        {
+            std::list<double> vals, times;
+            for (int k = 0; k < Relative.series(); k++)
+                vals.push_back(Relative.value(k, j));
+            for (int k = 0; k < RelativeTimes.series(); k++)
+                times.push_back(RelativeTimes.value(k, j));
+            Delta->addValues(vals, Relative.label(j));
+            DeltaTimes->addValues(times, RelativeTimes.label(j));
+        }
+#endif
+    }
 }
 
 void toWaitEvents::exportData(std::map<QString, QString> &data, const QString &prefix)
@@ -671,4 +690,18 @@ void toWaitEvents::exportData(std::map<QString, QString> &data, const QString &p
             id++;
         }
     }
+
+    if (!Relative.isEmpty())
+    {
+        QByteArray samples;
+        {
+            QDataStream out(&samples, QIODevice::WriteOnly);
+            out << (qint32) Labels.size();
+            for (std::list<QString>::iterator i = Labels.begin(); i != Labels.end(); i++)
+                out << *i;
+            Relative.save(out);
+            RelativeTimes.save(out);
+        }
+        data[prefix + ":Samples"] = QString::fromLatin1(samples.toBase64());
+    }
 }
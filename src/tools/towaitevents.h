@@ -35,9 +35,11 @@
 #pragma once
 
 #include "core/toconnection.h"
+#include "tools/totimeseries.h"
 
 #include <list>
 #include <map>
+#include <vector>
 #include <algorithm>
 
 #include <QWidget>
@@ -67,13 +69,18 @@ class toWaitEvents : public QWidget
         bool ShowTimes;
         QString Now;
         std::list<QString> Labels;
+        /** Position of every wait event in Labels and the value vectors.
+         */
+        std::map<QString, int> LabelIndex;
         time_t LastTime;
-        std::list<double> LastCurrent;
-        std::list<double> LastTimes;
-        std::list<double> Current;
-        std::list<double> CurrentTimes;
-        std::list<double> Relative;
-        std::list<double> RelativeTimes;
+        std::vector<double> LastCurrent;
+        std::vector<double> LastTimes;
+        std::vector<double> Current;
+        std::vector<double> CurrentTimes;
+        /** History of per second deltas, one series per wait event.
+         */
+        toTimeSeries Relative;
+        toTimeSeries RelativeTimes;
         std::list<bool> Enabled;
 
         int Session;
@@ -81,6 +88,7 @@ class toWaitEvents : public QWidget
         std::map<QString, bool> HideMap;
 
         void setup(int session);
+        void clearSamples(void);
     public:
         toWaitEvents(QWidget *parent, const char *name);
         toWaitEvents(int session, QWidget *parent, const char *name);
@@ -0,0 +1,374 @@
+#ifndef __RING_BUFFER_LOG__
+#define __RING_BUFFER_LOG__
+// Lock-free backend for basic_thread_safe_log.
+//
+// Each thread which logs owns a single producer/single consumer ring of
+// binary records (timestamp, destination, length, message chars). Writing a
+// message takes no lock and allocates nothing once the thread has its ring.
+// One background thread drains all the rings, merging them by timestamp,
+// and writes the messages to their destination streams.
+#include <string>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <assert.h>
+
+// thread_local with a destructor is needed to give the ring back
+// when a thread exits
+#if !((defined _MSC_VER) && (_MSC_VER <= 1800))
+#define TS_LOG_HAS_RING
+#endif
+
+#ifdef TS_LOG_HAS_RING
+
+////////////////////////////////////////////////////////////////////
+// binary header of a message stored in the ring
+struct ring_log_record
+{
+    // thread_manager::getTimeOfDay() when the message was written
+    long long m_time;
+    // index of the destination stream (see basic_ring_log_writer::add_sink)
+    unsigned m_sink;
+    // number of chars following the header
+    unsigned m_length;
+};
+
+////////////////////////////////////////////////////////////////////
+// single producer/single consumer ring of records,
+// m_head is only written by the logging thread, m_tail by the writer thread
+template< class char_type, std::size_t capacity = 64 * 1024>
+class spsc_log_ring
+{
+        static_assert( ( capacity & ( capacity - 1)) == 0, "capacity must be a power of two");
+        typedef spsc_log_ring< char_type, capacity> this_class;
+        // non-copyiable
+        spsc_log_ring( const this_class &);
+        this_class & operator=( this_class &);
+    public:
+        // longer messages are truncated
+        enum { max_length = capacity / 4 / sizeof( char_type) };
+
+        spsc_log_ring()
+            : m_head( 0)
+            , m_tail( 0)
+            , m_released( false)
+            , m_dropped( 0)
+        {}
+
+        // producer side, fails when there is not enough room
+        bool push( const ring_log_record & rec, const char_type * msg)
+        {
+            std::size_t bytes = sizeof( rec) + rec.m_length * sizeof( char_type);
+            std::size_t head = m_head.load( std::memory_order_relaxed);
+            std::size_t tail = m_tail.load( std::memory_order_acquire);
+            if ( capacity - ( head - tail) < bytes)
+                return false;
+            copy_in( head, &rec, sizeof( rec));
+            copy_in( head + sizeof( rec), msg, rec.m_length * sizeof( char_type));
+            m_head.store( head + bytes, std::memory_order_release);
+            return true;
+        }
+
+        // consumer side, header of the oldest record
+        bool peek( ring_log_record & rec) const
+        {
+            std::size_t tail = m_tail.load( std::memory_order_relaxed);
+            if ( m_head.load( std::memory_order_acquire) == tail)
+                return false;
+            copy_out( tail, &rec, sizeof( rec));
+            return true;
+        }
+
+        // consumer side, remove the record returned by peek()
+        void pop( const ring_log_record & rec, std::basic_string< char_type> & msg)
+        {
+            std::size_t tail = m_tail.load( std::memory_order_relaxed);
+            msg.resize( rec.m_length);
+            if ( rec.m_length)
+                copy_out( tail + sizeof( rec), &msg[0], rec.m_length * sizeof( char_type));
+            m_tail.store( tail + sizeof( rec) + rec.m_length * sizeof( char_type), std::memory_order_release);
+        }
+
+    private:
+        void copy_in( std::size_t pos, const void * src, std::size_t n)
+        {
+            std::size_t off = pos & ( capacity - 1);
+            std::size_t first = std::min( n, capacity - off);
+            memcpy( m_buf + off, src, first);
+            memcpy( m_buf, ( const char *)src + first, n - first);
+        }
+        void copy_out( std::size_t pos, void * dest, std::size_t n) const
+        {
+            std::size_t off = pos & ( capacity - 1);
+            std::size_t first = std::min( n, capacity - off);
+            memcpy( dest, m_buf + off, first);
+            memcpy( ( char *)dest + first, m_buf, n - first);
+        }
+
+        std::atomic< std::size_t> m_head;
+        // keep producer and consumer positions on separate cache lines
+        char m_pad[ 64];
+        std::atomic< std::size_t> m_tail;
+        char m_buf[ capacity];
+    public:
+        // the owning thread exited, the ring can be given to a new thread
+        std::atomic< bool> m_released;
+        // messages lost because the ring stayed full
+        std::atomic< unsigned> m_dropped;
+};
+
+////////////////////////////////////////////////////////////////////
+// owns the rings of all the threads and the thread writing them out
+template <
+class char_type,
+      class traits_type = std::char_traits< char_type>,
+      class thread_manager = DEFAULT_THREAD_MANAGER >
+class basic_ring_log_writer
+{
+        typedef basic_ring_log_writer< char_type, traits_type, thread_manager> this_class;
+        typedef std::basic_ostream< char_type, traits_type> ostream_type;
+        typedef std::basic_string< char_type, traits_type> string_type;
+        typedef spsc_log_ring< char_type> ring_type;
+        // non-copyiable
+        basic_ring_log_writer( const this_class &);
+        this_class & operator=( this_class &);
+        // thread-related definitions
+        typedef typename thread_manager::thread_obj_base thread_obj_base;
+        typedef typename thread_manager::critical_section critical_section;
+        typedef typename thread_manager::auto_lock_unlock auto_lock_unlock;
+
+        // gives the ring back when the thread exits
+        struct ring_holder
+        {
+            ring_holder() : m_ring( NULL) {}
+            ~ring_holder()
+            {
+                if ( m_ring)
+                    m_ring->m_released.store( true, std::memory_order_release);
+            }
+            ring_type * m_ring;
+        };
+
+        struct thread_info;
+        friend struct thread_info;
+        struct thread_info : public thread_obj_base
+        {
+            thread_info()
+                : m_pThis( NULL)
+                , m_bHasFinished( false)
+            {
+                thread_obj_base::set_name("logWriterRing");
+            }
+            /* virtual */ void operator()()
+            {
+                string_type msg;
+                std::vector< ring_type *> rings;
+                std::vector< ostream_type *> sinks;
+                while ( true)
+                {
+                    bool bStop;
+                    {
+                        auto_lock_unlock locker( m_pThis->m_cs);
+                        rings = m_pThis->m_rings;
+                        sinks = m_pThis->m_sinks;
+                        bStop = m_pThis->m_bShouldBeDestructed;
+                    }
+                    std::vector< bool> dirty( sinks.size(), false);
+                    unsigned nWritten = 0;
+                    // write a bounded batch, then look for new rings and sinks
+                    while ( nWritten < 4096)
+                    {
+                        // merge the rings by time so that messages of
+                        // different threads keep their order
+                        ring_type * pOldest = NULL;
+                        ring_log_record oldest, rec;
+                        for ( std::size_t idx = 0; idx < rings.size(); ++idx)
+                        {
+                            if ( rings[ idx]->peek( rec) && ( !pOldest || rec.m_time < oldest.m_time))
+                            {
+                                pOldest = rings[ idx];
+                                oldest = rec;
+                            }
+                        }
+                        if ( !pOldest || oldest.m_sink >= sinks.size())
+                            break;
+                        pOldest->pop( oldest, msg);
+                        *sinks[ oldest.m_sink] << msg;
+                        dirty[ oldest.m_sink] = true;
+                        ++nWritten;
+                    }
+                    for ( std::size_t idx = 0; idx < rings.size(); ++idx)
+                    {
+                        unsigned nDropped = rings[ idx]->m_dropped.exchange( 0);
+                        if ( nDropped)
+                            std::cerr << "ts_log: " << nDropped << " messages dropped, log ring full" << std::endl;
+                    }
+                    // we flush only when there are no more messages to write
+                    // (flushing could be time-consuming)
+                    if ( nWritten < 4096)
+                        for ( std::size_t idx = 0; idx < sinks.size(); ++idx)
+                            if ( dirty[ idx])
+                                sinks[ idx]->flush();
+                    if ( nWritten == 0)
+                    {
+                        // ... only when there are no more messages,
+                        //    will we ask if we should be destructed
+                        if ( bStop)
+                        {
+                            m_bHasFinished = true;
+                            return;
+                        }
+                        thread_manager::sleep( 10);
+                    }
+                }
+            }
+            this_class * m_pThis;
+            volatile bool m_bHasFinished;
+        };
+
+    public:
+        // the writer is never deleted (threads may log until the process ends),
+        // it is stopped from an atexit handler after writing all messages
+        static this_class & instance()
+        {
+            static this_class * s_writer = create();
+            return *s_writer;
+        }
+
+        // register a destination stream, returns its index
+        unsigned add_sink( ostream_type & log)
+        {
+            auto_lock_unlock locker( m_cs);
+            m_sinks.push_back( &log);
+            return m_sinks.size() - 1;
+        }
+
+        // called from the logging threads, lock-free once the thread has a ring
+        void write( unsigned sink, const string_type & str)
+        {
+            ring_type * ring = thread_ring();
+            ring_log_record rec;
+            rec.m_time = thread_manager::getTimeOfDay();
+            rec.m_sink = sink;
+            rec.m_length = (unsigned) std::min< std::size_t>( str.size(), ring_type::max_length);
+            // the ring is full - give the writer thread some time, then give up
+            for ( int retry = 0; !ring->push( rec, str.data()); ++retry)
+            {
+                if ( m_bStopped.load( std::memory_order_relaxed) || retry >= 100)
+                {
+                    ring->m_dropped.fetch_add( 1, std::memory_order_relaxed);
+                    return;
+                }
+                thread_manager::sleep( 1);
+            }
+        }
+
+        // write all pending messages and stop the writer thread
+        void stop()
+        {
+            {
+                auto_lock_unlock locker( m_cs);
+                if ( m_bShouldBeDestructed)
+                    return;
+                m_bShouldBeDestructed = true;
+            }
+            thread_manager::join_thread( m_info);
+            m_bStopped.store( true);
+        }
+
+    private:
+        basic_ring_log_writer()
+            : m_bShouldBeDestructed( false)
+            , m_bStopped( false)
+        {
+            m_info.m_pThis = this;
+            thread_manager::create_thread( m_info);
+        }
+
+        static this_class * create()
+        {
+            this_class * retval = new this_class;
+            atexit( &this_class::stop_instance);
+            return retval;
+        }
+
+        static void stop_instance()
+        {
+            instance().stop();
+        }
+
+        ring_type * thread_ring()
+        {
+            static thread_local ring_holder s_holder;
+            if ( !s_holder.m_ring)
+                s_holder.m_ring = acquire_ring();
+            return s_holder.m_ring;
+        }
+
+        // reuse the ring of a thread which has exited, or create a new one
+        ring_type * acquire_ring()
+        {
+            auto_lock_unlock locker( m_cs);
+            for ( std::size_t idx = 0; idx < m_rings.size(); ++idx)
+            {
+                bool bReleased = true;
+                if ( m_rings[ idx]->m_released.compare_exchange_strong( bReleased, false))
+                    return m_rings[ idx];
+            }
+            m_rings.push_back( new ring_type);
+            return m_rings.back();
+        }
+
+        // protects m_rings and m_sinks, never taken when writing a message
+        mutable critical_section m_cs;
+        thread_info m_info;
+        volatile bool m_bShouldBeDestructed;
+        std::atomic< bool> m_bStopped;
+        std::vector< ring_type *> m_rings;
+        std::vector< ostream_type *> m_sinks;
+};
+
+////////////////////////////////////////////////////////////////////
+// internal_thread_safe_log writing through the rings
+template < class char_type,
+         class traits_type = std::char_traits< char_type>,
+         class thread_manager = DEFAULT_THREAD_MANAGER >
+class basic_internal_thread_safe_log_ring
+    : public basic_internal_thread_safe_log_base< char_type, traits_type>
+{
+        typedef std::basic_ostream< char_type, traits_type> ostream_type;
+        typedef basic_ring_log_writer< char_type, traits_type, thread_manager> ring_log_writer;
+        // non-copyiable
+        typedef basic_internal_thread_safe_log_ring< char_type, traits_type, thread_manager> this_class;
+        basic_internal_thread_safe_log_ring( const this_class &);
+        this_class & operator=( this_class &);
+    public:
+        basic_internal_thread_safe_log_ring( ostream_type & underlyingLog)
+            : m_writer( ring_log_writer::instance())
+            , m_sink( m_writer.add_sink( underlyingLog))
+        {}
+        ~basic_internal_thread_safe_log_ring()
+        {}
+        void write_message( const std::basic_string< char_type, traits_type> & str)
+        {
+            m_writer.write( m_sink, str);
+        }
+        // the underlying stream is only used by the writer thread,
+        // its formatting state is not shared with the loggers
+        void copy_state_to( ostream_type & dest) const
+        {}
+        void copy_state_from( const ostream_type & src)
+        {}
+    private:
+        ring_log_writer & m_writer;
+        unsigned m_sink;
+}; // template class basic_internal_thread_safe_log_ring
+typedef basic_internal_thread_safe_log_ring< char> internal_thread_safe_log_ring;
+typedef basic_internal_thread_safe_log_ring< wchar_t> winternal_thread_safe_log_ring;
+
+#endif // TS_LOG_HAS_RING
+
+#endif
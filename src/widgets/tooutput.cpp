@@ -91,7 +91,8 @@ toOutputWidget::toOutputWidget(QWidget *parent)
 
     Refresh = new toRefreshCombo(Toolbar, toConfigurationNewSingle::Instance().option(Global::OutputPollingInterval).toString());
     Toolbar->addWidget(Refresh);
-    connect(Refresh->timer(), SIGNAL(timeout(void)), this, SLOT(refresh(void)));
+    // poll() reads the output synchronously, nothing to watch
+    connect(Refresh, SIGNAL(timeout(void)), this, SLOT(refresh(void)));
 
     Toolbar->addWidget(new Utils::toSpacer());
 
@@ -218,7 +219,7 @@ void toOutputWidget::setEnabled(bool enabled)
             LockedConnection.data()->execute(SQLEnable);
             LockedConnection.data()->setInit("OUTPUT", "");
         }
-        Refresh->timer()->blockSignals(false);
+        Refresh->setPaused(false);
     } else {
         if (LockedConnection.data())
         {
@@ -226,7 +227,7 @@ void toOutputWidget::setEnabled(bool enabled)
             LockedConnection.data()->delInit("OUTPUT");
         }
         LockedConnection.clear();
-        Refresh->timer()->blockSignals(true);
+        Refresh->setPaused(true);
     }
 }
 
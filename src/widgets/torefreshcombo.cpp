@@ -1,12 +1,19 @@
 #include "widgets/torefreshcombo.h"
 #include "core/toconfiguration.h"
 #include "core/toglobalconfiguration.h"
-
-#include <QtCore/QTimer>
+#include "widgets/torefreshscheduler.h"
 
 toRefreshCombo::toRefreshCombo(QWidget *parent, const QString& def)
 	: QComboBox(parent)
-	, m_timer(new QTimer(this))
+	, m_interval(0)
+	, m_paused(false)
+	, m_due(0)
+	, m_dispatching(false)
+	, m_started(0)
+	, m_last(0)
+	, m_total(0)
+	, m_count(0)
+	, m_skipped(0)
 {
 	this->setObjectName("toRefreshCombo");
 	this->setEditable(false);
@@ -42,6 +49,7 @@ toRefreshCombo::toRefreshCombo(QWidget *parent, const QString& def)
 		setCurrentIndex(0);
 
 	slotRefreshUpdate();
+	toRefreshSchedulerSing::Instance().add(this);
 
 	connect(this,
 	        SIGNAL(activated(const QString &)),
@@ -55,10 +63,82 @@ void toRefreshCombo::setRefreshInterval(QString const& interval)
 	slotRefreshUpdate();
 }
 
+toRefreshCombo::~toRefreshCombo()
+{
+	toRefreshSchedulerSing::Instance().remove(this);
+}
+
+int toRefreshCombo::refreshTime() const
+{
+	return m_interval;
+}
+
+void toRefreshCombo::watch(QObject *result)
+{
+	connect(result, SIGNAL(done()), this, SLOT(slotDone()), Qt::UniqueConnection);
+	connect(result, SIGNAL(destroyed(QObject*)), this, SLOT(slotDestroyed(QObject*)), Qt::UniqueConnection);
+	if (!m_watched.contains(result))
+		m_watched << result;
+}
+
+void toRefreshCombo::expect(QObject *result)
+{
+	if (!m_dispatching || !result || result->metaObject()->indexOfSignal("done()") < 0)
+		return;
+	connect(result, SIGNAL(done()), this, SLOT(slotDone()), Qt::UniqueConnection);
+	connect(result, SIGNAL(destroyed(QObject*)), this, SLOT(slotDestroyed(QObject*)), Qt::UniqueConnection);
+	m_pending.insert(result);
+}
+
+void toRefreshCombo::setPaused(bool paused)
+{
+	m_paused = paused;
+}
+
+void toRefreshCombo::dispatch()
+{
+	toRefreshScheduler &scheduler = toRefreshSchedulerSing::Instance();
+	m_started = scheduler.now();
+	m_pending = m_watched.toSet();
+	m_dispatching = true;
+	emit timeout();
+	m_dispatching = false;
+	if (m_pending.isEmpty())
+		finish();
+}
+
+void toRefreshCombo::slotDone()
+{
+	// done() of a refresh the user started by hand is ignored
+	if (m_pending.remove(sender()) && m_pending.isEmpty() && !m_dispatching)
+		finish();
+}
+
+void toRefreshCombo::slotDestroyed(QObject *result)
+{
+	m_watched.removeAll(result);
+	if (m_pending.remove(result) && m_pending.isEmpty() && !m_dispatching)
+		finish();
+}
 
-QTimer* toRefreshCombo::timer()
+void toRefreshCombo::finish()
 {
-	return m_timer;
+	m_last = toRefreshSchedulerSing::Instance().now() - m_started;
+	m_total += m_last;
+	m_count++;
+	updateToolTip();
+}
+
+void toRefreshCombo::updateToolTip()
+{
+	if (m_count == 0)
+		setToolTip(tr("Skipped %1 times, refresh still running").arg(m_skipped));
+	else
+		setToolTip(tr("Last refresh %1 ms, average %2 ms over %3 refreshes, skipped %4 times")
+		           .arg(m_last)
+		           .arg(m_total / m_count)
+		           .arg(m_count)
+		           .arg(m_skipped));
 }
 
 void toRefreshCombo::slotRefreshUpdate()
@@ -69,23 +149,26 @@ void toRefreshCombo::slotRefreshUpdate()
         t = toConfigurationNewSingle::Instance().option(ToConfiguration::Global::RefreshInterval).toString();
     }
 
+    int interval;
     if (t == tr("toRefreshCreate", "None") || t == "None")
-        m_timer->stop();
+        interval = 0;
     else if (t == tr("toRefreshCreate", "2 seconds") || t == "2 seconds")
-        m_timer->start(2 * 1000);
+        interval = 2 * 1000;
     else if (t == tr("toRefreshCreate", "5 seconds") || t == "5 seconds")
-        m_timer->start(5 * 1000);
+        interval = 5 * 1000;
     else if (t == tr("toRefreshCreate", "10 seconds") || t == "10 seconds")
-        m_timer->start(10 * 1000);
+        interval = 10 * 1000;
     else if (t == tr("toRefreshCreate", "30 seconds") || t == "30 seconds")
-        m_timer->start(30 * 1000);
+        interval = 30 * 1000;
     else if (t == tr("toRefreshCreate", "1 min") || t == "1 min")
-        m_timer->start(60 * 1000);
+        interval = 60 * 1000;
     else if (t == tr("toRefreshCreate", "5 min") || t == "5 min")
-        m_timer->start(300 * 1000);
+        interval = 300 * 1000;
     else if (t == tr("toRefreshCreate", "10 min") || t == "10 min")
-        m_timer->start(600 * 1000);
+        interval = 600 * 1000;
     else
         throw qApp->translate("toRefreshParse", "Unknown timer value");
+    m_interval = interval;
+    toRefreshSchedulerSing::Instance().reschedule(this);
     return;
 }
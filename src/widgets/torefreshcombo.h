@@ -1,21 +1,61 @@
 #pragma once
 
 #include <QComboBox>
+#include <QtCore/QList>
+#include <QtCore/QSet>
 
+/** Refresh interval selector of a tool.
+ * The timeout() signal is sent by @ref toRefreshScheduler, which pauses
+ * hidden tools and skips a tick while the previous refresh still runs.
+ */
 class toRefreshCombo : public QComboBox
 {
        Q_OBJECT
+       friend class toRefreshScheduler;
 public:
 	explicit toRefreshCombo(QWidget *parent, const QString& def = QString());
+	~toRefreshCombo();
 
 	void setRefreshInterval(QString const&);
-	
-	QTimer* timer();
 
+	/** Refresh interval in ms, 0 when disabled */
 	int refreshTime() const;
 
+	/** A refresh is complete once every watched object emitted done(),
+	 * without any the refresh ends when the timeout() slots return.
+	 */
+	void watch(QObject *result);
+
+	/** Wait for done() of result in the refresh being dispatched, for tools
+	 * which refresh only some of their results (e.g. the current tab).
+	 * Call it from a timeout() slot before the result starts its query.
+	 * Ignored outside of timeout() and for objects without a done() signal.
+	 */
+	void expect(QObject *result);
+
+	/** Stop sending timeout() without changing the interval */
+	void setPaused(bool paused);
+
+signals:
+	void timeout();
+
 private slots:
         void slotRefreshUpdate();
+        void slotDone();
+        void slotDestroyed(QObject *result);
 private:
-	QTimer *m_timer;
+	void dispatch();
+	void finish();
+	void updateToolTip();
+
+	int m_interval;
+	bool m_paused;
+	qint64 m_due;
+	bool m_dispatching;
+	// watched objects, and the ones which did not emit done() yet for the running refresh
+	QList<QObject*> m_watched;
+	QSet<QObject*> m_pending;
+	// refresh cost statistics
+	qint64 m_started, m_last, m_total;
+	unsigned m_count, m_skipped;
 };
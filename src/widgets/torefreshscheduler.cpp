@@ -0,0 +1,124 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+#include "widgets/torefreshscheduler.h"
+#include "widgets/torefreshcombo.h"
+#include "core/toconnection.h"
+
+#include <QtCore/QSet>
+
+toRefreshScheduler::toRefreshScheduler()
+    : QObject(NULL)
+    , Next(0)
+{
+    Clock.start();
+    Timer.setInterval(TickMs);
+    connect(&Timer, SIGNAL(timeout()), this, SLOT(tick()));
+}
+
+void toRefreshScheduler::add(toRefreshCombo *combo)
+{
+    if (!Clients.contains(combo))
+        Clients.append(combo);
+    reschedule(combo);
+    if (!Timer.isActive())
+        Timer.start();
+}
+
+void toRefreshScheduler::remove(toRefreshCombo *combo)
+{
+    Clients.removeAll(combo);
+    if (Clients.isEmpty())
+        Timer.stop();
+}
+
+void toRefreshScheduler::reschedule(toRefreshCombo *combo)
+{
+    combo->m_due = now() + combo->m_interval;
+}
+
+void toRefreshScheduler::tick(void)
+{
+    qint64 t = now();
+    // connections which were already served during this tick
+    QSet<toConnection*> served;
+
+    int count = Clients.size();
+    int first = Next < count ? Next : 0;
+    for (int n = 0; n < count; n++)
+    {
+        // the client list may change while a tool refreshes
+        if (n >= Clients.size())
+            break;
+        toRefreshCombo *combo = Clients.at((first + n) % Clients.size());
+
+        if (combo->m_interval <= 0 || combo->m_paused || t < combo->m_due)
+            continue;
+
+        // hidden tools wait until they are shown again
+        if (!combo->isVisible())
+            continue;
+
+        if (!combo->m_pending.isEmpty())
+        {
+            if (t - combo->m_started < qMax<qint64>(StaleMs, 4 * combo->m_interval))
+            {
+                combo->m_skipped++;
+                combo->m_due = t + combo->m_interval;
+                combo->updateToolTip();
+                continue;
+            }
+            combo->m_pending.clear();
+        }
+
+        toConnection *conn = NULL;
+        try
+        {
+            conn = &toConnection::currentConnection(combo);
+        }
+        catch (...)
+        {
+        }
+        if (conn)
+        {
+            // spread the refreshes of one connection over several ticks
+            if (served.contains(conn))
+                continue;
+            served.insert(conn);
+        }
+
+        combo->m_due = t + combo->m_interval;
+        combo->dispatch();
+        Next = (first + n + 1) % qMax(1, Clients.size());
+    }
+}
@@ -0,0 +1,92 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+#pragma once
+
+#include "loki/Singleton.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QList>
+
+class toRefreshCombo;
+
+/**
+ * Drives all the @ref toRefreshCombo instances from a single timer.
+ *
+ * Instead of each tool firing its own QTimer, the scheduler checks the
+ * registered combos every TickMs and emits their timeout() when due.
+ * Tools which are not visible are paused, a tool whose previous refresh
+ * is still running skips its turn, and at most one tool per database
+ * connection is refreshed per tick so that tools sharing a connection
+ * do not all query it at the same moment.
+ */
+class toRefreshScheduler : public QObject
+{
+        Q_OBJECT;
+
+    public:
+        enum
+        {
+            TickMs = 250,
+            /** A refresh running longer than this (and 4 intervals) is considered lost */
+            StaleMs = 60 * 1000
+        };
+
+        toRefreshScheduler();
+
+        void add(toRefreshCombo *combo);
+        void remove(toRefreshCombo *combo);
+
+        /** Restart the countdown of a combo, called when its interval changes */
+        void reschedule(toRefreshCombo *combo);
+
+        /** Time since the scheduler was created, in ms */
+        qint64 now() const
+        {
+            return Clock.elapsed();
+        }
+
+    private slots:
+        void tick(void);
+
+    private:
+        QList<toRefreshCombo*> Clients;
+        QElapsedTimer Clock;
+        QTimer Timer;
+        // first client checked on the next tick, rotates to be fair
+        int Next;
+};
+
+typedef Loki::SingletonHolder<toRefreshScheduler> toRefreshSchedulerSing;
@@ -0,0 +1,340 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "widgets/toresultitemmodel.h"
+
+#include <algorithm>
+
+toResultItemModel::toResultItemModel(QObject *parent, Options options)
+    : QAbstractItemModel(parent)
+    , ItemOptions(options)
+{
+}
+
+void toResultItemModel::setHeaders(const QStringList &headers)
+{
+    beginResetModel();
+    Headers = headers;
+    Alignment.resize(Headers.size());
+    endResetModel();
+}
+
+void toResultItemModel::setColumnAlignment(int column, Qt::Alignment align)
+{
+    if (column >= Alignment.size())
+        Alignment.resize(column + 1);
+    Alignment[column] = align;
+}
+
+int toResultItemModel::appendRow(const toQueryAbstr::Row &values, int parent)
+{
+    int row = children(parent).size();
+    beginInsertRows(indexOf(parent), row, row);
+
+    Node node;
+    node.Values = values;
+    node.Parent = parent;
+    node.Position = row;
+    node.Check = Qt::Unchecked;
+    Nodes.append(node);
+    if (parent < 0)
+        Top.append(Nodes.size() - 1);
+    else
+        Nodes[parent].Children.append(Nodes.size() - 1);
+
+    endInsertRows();
+    return Nodes.size() - 1;
+}
+
+void toResultItemModel::appendRows(const toQueryAbstr::RowList &rows, int parent)
+{
+    if (rows.isEmpty())
+        return;
+
+    int first = children(parent).size();
+    beginInsertRows(indexOf(parent), first, first + rows.size() - 1);
+
+    Nodes.reserve(Nodes.size() + rows.size());
+    int position = first;
+    for (toQueryAbstr::RowList::const_iterator i = rows.begin(); i != rows.end(); i++)
+    {
+        Node node;
+        node.Values = *i;
+        node.Parent = parent;
+        node.Position = position++;
+        node.Check = Qt::Unchecked;
+        Nodes.append(node);
+        (parent < 0 ? Top : Nodes[parent].Children).append(Nodes.size() - 1);
+    }
+
+    endInsertRows();
+}
+
+void toResultItemModel::clear(void)
+{
+    beginResetModel();
+    Nodes.clear();
+    Top.clear();
+    endResetModel();
+}
+
+int toResultItemModel::id(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return -1;
+    return int(index.internalId());
+}
+
+QModelIndex toResultItemModel::indexOf(int id, int column) const
+{
+    if (id < 0 || id >= Nodes.size())
+        return QModelIndex();
+    return createIndex(Nodes[id].Position, column, quintptr(id));
+}
+
+int toResultItemModel::parentId(int id) const
+{
+    if (id < 0 || id >= Nodes.size())
+        return -1;
+    return Nodes[id].Parent;
+}
+
+int toResultItemModel::firstChild(int id) const
+{
+    if (id >= Nodes.size())
+        return -1;
+    const QVector<int> &level = children(id);
+    return level.isEmpty() ? -1 : level.first();
+}
+
+int toResultItemModel::childCount(int id) const
+{
+    if (id >= Nodes.size())
+        return 0;
+    return children(id).size();
+}
+
+const toQueryAbstr::Row &toResultItemModel::row(int id) const
+{
+    return Nodes[id].Values;
+}
+
+QString toResultItemModel::text(int id, int column) const
+{
+    if (id < 0 || id >= Nodes.size())
+        return QString();
+    const toQueryAbstr::Row &values = Nodes[id].Values;
+    if (column < 0 || column >= values.size())
+        return QString();
+    return (QString)values.at(column);
+}
+
+Qt::CheckState toResultItemModel::checkState(int id) const
+{
+    if (id < 0 || id >= Nodes.size())
+        return Qt::Unchecked;
+    return Nodes[id].Check;
+}
+
+void toResultItemModel::setCheckState(int id, Qt::CheckState state)
+{
+    if (id < 0 || id >= Nodes.size() || Nodes[id].Check == state)
+        return;
+    Nodes[id].Check = state;
+    QModelIndex index = indexOf(id);
+    emit dataChanged(index, index);
+    emit checkStateChanged(id, state);
+}
+
+QModelIndex toResultItemModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (column < 0 || column >= columnCount() || (parent.isValid() && parent.column() != 0))
+        return QModelIndex();
+    const QVector<int> &level = children(id(parent));
+    if (row < 0 || row >= level.size())
+        return QModelIndex();
+    return createIndex(row, column, quintptr(level.at(row)));
+}
+
+QModelIndex toResultItemModel::parent(const QModelIndex &index) const
+{
+    return indexOf(parentId(id(index)));
+}
+
+int toResultItemModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() && parent.column() != 0)
+        return 0;
+    return children(id(parent)).size();
+}
+
+int toResultItemModel::columnCount(const QModelIndex &) const
+{
+    return Headers.size();
+}
+
+QVariant toResultItemModel::data(const QModelIndex &index, int role) const
+{
+    int node = id(index);
+    if (node < 0 || node >= Nodes.size())
+        return QVariant();
+
+    switch (role)
+    {
+        case Qt::DisplayRole:
+        {
+            QString str = text(node, index.column());
+            if (!(ItemOptions & MultiLine))
+            {
+                int pos = str.indexOf(QChar('\n'));
+                if (pos != -1)
+                    return str.left(pos) + QString::fromLatin1("...");
+            }
+            return str;
+        }
+        case Qt::EditRole:
+            return text(node, index.column());
+        case Qt::ToolTipRole:
+        {
+            QString str = text(node, index.column());
+            return str.isEmpty() ? QVariant() : QVariant(str);
+        }
+        case Qt::TextAlignmentRole:
+            if (index.column() < Alignment.size() && Alignment.at(index.column()) != 0)
+                return QVariant(int(Alignment.at(index.column())));
+            return QVariant();
+        case Qt::CheckStateRole:
+            if ((ItemOptions & Checkable) && index.column() == 0)
+                return int(Nodes[node].Check);
+            return QVariant();
+    }
+    return QVariant();
+}
+
+bool toResultItemModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (role != Qt::CheckStateRole || !(ItemOptions & Checkable) || index.column() != 0)
+        return false;
+    setCheckState(id(index), Qt::CheckState(value.toInt()));
+    return true;
+}
+
+Qt::ItemFlags toResultItemModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return Qt::NoItemFlags;
+    Qt::ItemFlags fl = Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsDragEnabled;
+    if ((ItemOptions & Checkable) && index.column() == 0)
+        fl |= Qt::ItemIsUserCheckable;
+    return fl;
+}
+
+QVariant toResultItemModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < Headers.size())
+        return Headers.at(section);
+    return QAbstractItemModel::headerData(section, orientation, role);
+}
+
+void toResultItemModel::sortLevel(QVector<int> &level, int column, Qt::SortOrder order)
+{
+    if (level.size() < 2)
+        return;
+
+    // Keys are computed once per row, texts holding numbers sort as numbers
+    struct sortKey
+    {
+        int Id;
+        bool Numeric;
+        double Number;
+        QString Text;
+    };
+    std::vector<sortKey> keys;
+    keys.reserve(level.size());
+    for (QVector<int>::const_iterator i = level.begin(); i != level.end(); i++)
+    {
+        sortKey key;
+        key.Id = *i;
+        const toQueryAbstr::Row &values = Nodes[*i].Values;
+        if (column < values.size() && values.at(column).isNumber())
+        {
+            key.Numeric = true;
+            key.Number = values.at(column).toDouble();
+        }
+        else
+        {
+            key.Text = text(*i, column);
+            key.Number = key.Text.trimmed().toDouble(&key.Numeric);
+        }
+        keys.push_back(key);
+    }
+
+    // Numbers come before texts
+    std::stable_sort(keys.begin(), keys.end(), [order](const sortKey & a, const sortKey & b)
+    {
+        const sortKey &l = order == Qt::AscendingOrder ? a : b;
+        const sortKey &r = order == Qt::AscendingOrder ? b : a;
+        if (l.Numeric != r.Numeric)
+            return l.Numeric;
+        if (l.Numeric)
+            return l.Number < r.Number;
+        return l.Text < r.Text;
+    });
+
+    for (int i = 0; i < level.size(); i++)
+    {
+        level[i] = keys[i].Id;
+        Nodes[level[i]].Position = i;
+    }
+}
+
+void toResultItemModel::sort(int column, Qt::SortOrder order)
+{
+    if (column < 0 || column >= columnCount())
+        return;
+
+    emit layoutAboutToBeChanged();
+    QModelIndexList before = persistentIndexList();
+
+    sortLevel(Top, column, order);
+    for (int i = 0; i < Nodes.size(); i++)
+        sortLevel(Nodes[i].Children, column, order);
+
+    // Ids do not change, only positions
+    QModelIndexList after;
+    Q_FOREACH(QModelIndex const & index, before)
+        after << indexOf(id(index), index.column());
+    changePersistentIndexList(before, after);
+    emit layoutChanged();
+}
@@ -0,0 +1,148 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include "core/toquery.h"
+
+#include <QtCore/QAbstractItemModel>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+/*! \brief List or two level tree model keeping rows as toQueryAbstr::Row.
+
+This is the model/view replacement of the toResultViewItem based lists. Rows
+are stored in one vector like in toResultModel, parents and children are
+indexes into it, so no object is allocated per row. A row is identified by
+its id, the position in that vector, which does not change when sorting.
+
+The item behaviours of toResultViewItem, toResultViewMLine and
+toResultViewCheck are model options:
+- default, only the first line of a text is displayed followed by "...",
+  the whole text is the tooltip,
+- MultiLine, the whole text is displayed,
+- Checkable, the first column has a check box.
+*/
+class toResultItemModel : public QAbstractItemModel
+{
+        Q_OBJECT;
+    public:
+        enum Option
+        {
+            NoOptions = 0,
+            MultiLine = 1,
+            Checkable = 2
+        };
+        Q_DECLARE_FLAGS(Options, Option);
+
+        toResultItemModel(QObject *parent = 0, Options options = NoOptions);
+
+        Options options(void) const
+        {
+            return ItemOptions;
+        }
+
+        void setHeaders(const QStringList &headers);
+        void setColumnAlignment(int column, Qt::Alignment align);
+
+        /** Append a row.
+         * @param parent Id of the parent row, -1 for a top level row.
+         * @return Id of the new row.
+         */
+        int appendRow(const toQueryAbstr::Row &values, int parent = -1);
+
+        /** Append rows below one parent, the view is notified once */
+        void appendRows(const toQueryAbstr::RowList &rows, int parent = -1);
+
+        void clear(void);
+
+        /** Number of rows at all levels */
+        int size(void) const
+        {
+            return Nodes.size();
+        }
+
+        int id(const QModelIndex &index) const;
+        QModelIndex indexOf(int id, int column = 0) const;
+        int parentId(int id) const;
+        /** Id of the first child in the current sort order, -1 if none */
+        int firstChild(int id) const;
+        int childCount(int id) const;
+
+        const toQueryAbstr::Row &row(int id) const;
+        /** Whole text of a cell, empty if the column is out of range */
+        QString text(int id, int column) const;
+
+        Qt::CheckState checkState(int id) const;
+        void setCheckState(int id, Qt::CheckState state);
+
+        QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+        QModelIndex parent(const QModelIndex &index) const override;
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+        int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+        QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+        bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+        Qt::ItemFlags flags(const QModelIndex &index) const override;
+        QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+        /** Sort every level, numbers (also numbers held as text) are compared as numbers */
+        void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    signals:
+        void checkStateChanged(int id, Qt::CheckState state);
+
+    private:
+        struct Node
+        {
+            toQueryAbstr::Row Values;
+            int Parent;
+            int Position;         // row within the parent
+            QVector<int> Children;
+            Qt::CheckState Check;
+        };
+
+        const QVector<int> &children(int parent) const
+        {
+            return parent < 0 ? Top : Nodes[parent].Children;
+        }
+        void sortLevel(QVector<int> &level, int column, Qt::SortOrder order);
+
+        Options ItemOptions;
+        QStringList Headers;
+        QVector<Qt::Alignment> Alignment;
+        QVector<Node> Nodes;
+        QVector<int> Top;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(toResultItemModel::Options);
@@ -0,0 +1,204 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "widgets/toresultitemview.h"
+#include "widgets/toresultlistformat.h"
+#include "core/tolistviewformatterfactory.h"
+#include "core/utils.h"
+
+#include <QApplication>
+#include <QtGui/QClipboard>
+#include <QMenu>
+
+#include <memory>
+
+toResultItemView::toResultItemView(toResultItemModel::Options options, QWidget *parent, const char *name)
+    : QTreeView(parent)
+    , toEditWidget()
+    , Model(new toResultItemModel(this, options))
+    , Menu(NULL)
+    , copyAct(NULL)
+    , leftAct(NULL)
+    , centerAct(NULL)
+    , rightAct(NULL)
+    , selectAllAct(NULL)
+    , exportAct(NULL)
+{
+    toEditWidget::FlagSet.Save = true;
+    toEditWidget::FlagSet.Copy = true;
+    toEditWidget::FlagSet.SelectAll = true;
+
+    if (name)
+        setObjectName(name);
+    setModel(Model);
+    setAllColumnsShowFocus(true);
+    setSelectionBehavior(QAbstractItemView::SelectRows);
+    setUniformRowHeights(!(options & toResultItemModel::MultiLine));
+
+    setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(this, SIGNAL(customContextMenuRequested(const QPoint &)),
+            this, SLOT(slotDisplayMenu(const QPoint &)));
+}
+
+int toResultItemView::selectedId(void) const
+{
+    QModelIndexList rows = selectionModel()->selectedRows();
+    if (rows.isEmpty())
+        return -1;
+    return Model->id(rows.first());
+}
+
+void toResultItemView::setSelectedId(int id)
+{
+    QModelIndex index = Model->indexOf(id);
+    if (!index.isValid())
+        return;
+    if (index.parent().isValid())
+        expand(index.parent());
+    selectionModel()->setCurrentIndex(index, QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
+    scrollTo(index);
+}
+
+void toResultItemView::selectionChanged(const QItemSelection &selected, const QItemSelection &deselected)
+{
+    QTreeView::selectionChanged(selected, deselected);
+    emit selectionChanged();
+}
+
+QString toResultItemView::exportAsText(toExportSettings settings)
+{
+    if (settings.requireSelection())
+        settings.selected = selectedIndexes();
+    // Formatters skip column 0 as the row number unless asked for it
+    settings.rowsHeader = true;
+
+    std::unique_ptr<toListViewFormatter> pFormatter(toListViewFormatterFactory::Instance().CreateObject(settings.type));
+    return pFormatter->getFormattedString(settings, Model);
+}
+
+bool toResultItemView::editSave(bool)
+{
+    try
+    {
+        toResultListFormat exp(this, toResultListFormat::TypeExport);
+        if (!exp.exec())
+            return false;
+
+        toExportSettings settings = exp.exportSettings();
+
+        QString filename = Utils::toSaveFilename(QString(), settings.extension, this);
+        if (filename.isEmpty())
+            return false;
+
+        return Utils::toWriteFile(filename, exportAsText(settings));
+    }
+    TOCATCH;
+
+    return false;
+}
+
+void toResultItemView::editCopy(void)
+{
+    QModelIndexList sel = selectedIndexes();
+    if (sel.size() > 1)
+    {
+        toExportSettings settings = toResultListFormat::plaintextCopySettings();
+        settings.selected = sel;
+        qApp->clipboard()->setText(exportAsText(settings));
+    }
+    else if (currentIndex().isValid())
+    {
+        qApp->clipboard()->setText(Model->data(currentIndex(), Qt::EditRole).toString());
+    }
+}
+
+void toResultItemView::slotDisplayMenu(const QPoint &pos)
+{
+    MenuIndex = indexAt(pos);
+    if (!MenuIndex.isValid())
+        return;
+
+    if (!Menu)
+    {
+        Menu = new QMenu(this);
+        copyAct = Menu->addAction(tr("&Copy field"));
+
+        QMenu *just = Menu->addMenu(tr("Alignment"));
+        leftAct   = just->addAction(tr("Left"));
+        centerAct = just->addAction(tr("Center"));
+        rightAct  = just->addAction(tr("Right"));
+
+        Menu->addSeparator();
+        selectAllAct = Menu->addAction(tr("Select all"));
+
+        Menu->addSeparator();
+        exportAct = Menu->addAction(tr("Export to file..."));
+
+        // actions of the submenu are reported by the menu too
+        connect(Menu, SIGNAL(triggered(QAction *)), this, SLOT(slotMenuCallback(QAction *)));
+        emit displayMenu(Menu);
+    }
+    Menu->exec(viewport()->mapToGlobal(pos));
+}
+
+void toResultItemView::slotMenuCallback(QAction *action)
+{
+    if (action == copyAct)
+        qApp->clipboard()->setText(Model->data(MenuIndex, Qt::EditRole).toString());
+    else if (action == leftAct)
+        Model->setColumnAlignment(MenuIndex.column(), Qt::AlignLeft);
+    else if (action == centerAct)
+        Model->setColumnAlignment(MenuIndex.column(), Qt::AlignCenter);
+    else if (action == rightAct)
+        Model->setColumnAlignment(MenuIndex.column(), Qt::AlignRight);
+    else if (action == selectAllAct)
+        selectAll();
+    else if (action == exportAct)
+        editSave(false);
+    else
+        return;
+    viewport()->update();
+}
+
+void toResultItemView::focusInEvent(QFocusEvent *e)
+{
+    QTreeView::focusInEvent(e);
+    toEditWidget::gotFocus();
+}
+
+void toResultItemView::focusOutEvent(QFocusEvent *e)
+{
+    QTreeView::focusOutEvent(e);
+    toEditWidget::lostFocus();
+}
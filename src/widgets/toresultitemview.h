@@ -0,0 +1,118 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include "widgets/toresultitemmodel.h"
+#include "core/toeditwidget.h"
+#include "core/tolistviewformatter.h"
+
+#include <QTreeView>
+
+class QMenu;
+class QAction;
+
+/*! \brief Tree view over a toResultItemModel.
+
+Model/view counterpart of toResultView for tools filling their lists
+themselves. Rows have uniform heights unless the model is MultiLine, so
+the view does not measure rows it does not paint.
+
+Like toListView it takes part in the edit menu (save, copy, select all)
+and has a context menu with copy, alignment and export, texts are
+exported through the toListViewFormatter chosen by the user.
+*/
+class toResultItemView : public QTreeView, public toEditWidget
+{
+        Q_OBJECT;
+    public:
+        toResultItemView(toResultItemModel::Options options, QWidget *parent, const char *name = NULL);
+
+        toResultItemModel *itemModel(void) const
+        {
+            return Model;
+        }
+
+        /** Id of the selected row, -1 if none */
+        int selectedId(void) const;
+
+        /** Select a row and make it visible, its parent is expanded */
+        void setSelectedId(int id);
+
+        /** Export the list as a string, the first column is data, not a row header */
+        QString exportAsText(toExportSettings settings);
+
+        // ----- overrides toEditWidget
+        bool editSave(bool askfile) override;
+        void editCopy(void) override;
+        void editSelectAll(void) override
+        {
+            selectAll();
+        }
+
+        // These methods do not make any sense for a readonly list
+        bool editOpen(const QString&) override { return false; }
+        void editUndo() override {}
+        void editRedo() override {}
+        void editCut() override {}
+        void editPaste() override {}
+        void editReadAll() override {}
+        QString editText() override { return ""; }
+        bool handleSearching(QString const&, QString const&, Search::SearchFlags) override { return false; }
+
+    signals:
+        void selectionChanged(void);
+
+        /** Emitted before the context menu is shown for the first time, to add entries to it */
+        void displayMenu(QMenu *menu);
+
+    protected slots:
+        // override parent
+        void selectionChanged(const QItemSelection &selected, const QItemSelection &deselected) override;
+
+    private slots:
+        void slotDisplayMenu(const QPoint &pos);
+        void slotMenuCallback(QAction *action);
+
+    protected:
+        void focusInEvent(QFocusEvent *e) override;
+        void focusOutEvent(QFocusEvent *e) override;
+
+        toResultItemModel *Model;
+
+    private:
+        QMenu *Menu;
+        QModelIndex MenuIndex;
+        QAction *copyAct, *leftAct, *centerAct, *rightAct, *selectAllAct, *exportAct;
+};
@@ -0,0 +1,342 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "widgets/toresultmimedata.h"
+#include "widgets/toresultmodel.h"
+#include "core/tolistviewformatterfactory.h"
+#include "core/tolistviewformatteridentifier.h"
+
+#include <QtCore/QDataStream>
+#include <QApplication>
+#include <QProgressDialog>
+
+#include <algorithm>
+#include <memory>
+
+namespace
+{
+    // sorted, without duplicates
+    void addUnique(QVector<int> &list)
+    {
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+    }
+
+    void endLine(QByteArray &output)
+    {
+#ifdef Q_OS_WIN32
+        output += "\r\n";
+#else
+        output += "\n";
+#endif
+    }
+}
+
+toResultMimeData::toResultMimeData(QAbstractItemModel *model,
+                                   const QModelIndexList &indexes,
+                                   const QStringList &formats,
+                                   const toExportSettings &settings)
+    : QMimeData()
+    , Model(model)
+    , Formats(formats)
+    , Settings(settings)
+{
+    Settings.selected.clear();
+
+    Rows.reserve(indexes.size());
+    Columns.reserve(indexes.size());
+    foreach (QModelIndex const& index, indexes)
+    {
+        if (!index.isValid())
+            continue;
+        Rows.append(index.row());
+        Columns.append(index.column());
+    }
+    addUnique(Rows);
+    addUnique(Columns);
+
+    connect(model, &QAbstractItemModel::modelAboutToBeReset, this, &toResultMimeData::detach);
+    connect(model, &QAbstractItemModel::layoutAboutToBeChanged, this, &toResultMimeData::detach);
+    connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &toResultMimeData::detach);
+    connect(model, &QAbstractItemModel::columnsAboutToBeRemoved, this, &toResultMimeData::detach);
+
+    // destroyed() and dataChanged() are emitted too late to read the data
+    toResultModel *resultModel = qobject_cast<toResultModel*>(model);
+    if (resultModel)
+    {
+        connect(resultModel, &toResultModel::aboutToBeDeleted, this, &toResultMimeData::detach);
+        connect(resultModel, &toResultModel::dataAboutToBeChanged, this, &toResultMimeData::detach);
+    }
+}
+
+QStringList toResultMimeData::formats() const
+{
+    QStringList ret = QMimeData::formats();
+    foreach (QString const& format, Formats)
+    {
+        if (Model || Rendered.contains(format))
+            ret << format;
+    }
+    return ret;
+}
+
+bool toResultMimeData::hasFormat(const QString &mimetype) const
+{
+    return formats().contains(mimetype);
+}
+
+QVariant toResultMimeData::retrieveData(const QString &mimetype, QVariant::Type type) const
+{
+    if (!Formats.contains(mimetype))
+        return QMimeData::retrieveData(mimetype, type);
+
+    if (!render(mimetype))
+        return QVariant();
+
+    if (type == QVariant::String)
+        return QString::fromUtf8(Rendered[mimetype]);
+    return Rendered[mimetype];
+}
+
+void toResultMimeData::detach()
+{
+    if (!Model)
+        return;
+
+    foreach (QString const& format, Formats)
+        render(format);
+
+    disconnect(Model, 0, this, 0);
+    Model = NULL;
+}
+
+bool toResultMimeData::render(const QString &mimetype) const
+{
+    if (Rendered.contains(mimetype))
+        return true;
+    if (!Model)
+        return false;
+
+    // the spreadsheet and the text layouts without a row by row renderer
+    // go through the export formatter in one piece
+    if (mimetype == "XML Spreadsheet")
+    {
+        Rendered[mimetype] = renderFormatted(toListViewFormatterIdentifier::XLSX);
+        return true;
+    }
+    if (mimetype != "application/vnd.tomodel.list"
+            && Settings.type != toListViewFormatterIdentifier::TEXT
+            && Settings.type != toListViewFormatterIdentifier::TAB_DELIMITED)
+    {
+        Rendered[mimetype] = renderFormatted(Settings.type);
+        return true;
+    }
+
+    std::unique_ptr<QProgressDialog> progress;
+    if (cells() > LargeSelection)
+    {
+        progress.reset(new QProgressDialog(tr("Copying %1 cells...").arg(cells()),
+                                           tr("Cancel"),
+                                           0,
+                                           Rows.size(),
+                                           QApplication::activeWindow()));
+        progress->setWindowModality(Qt::WindowModal);
+        progress->setMinimumDuration(500);
+    }
+
+    QByteArray output;
+    if (mimetype == "application/vnd.tomodel.list")
+        output = renderList(progress.get());
+    else
+        output = renderText(progress.get());
+
+    if (progress && progress->wasCanceled())
+        return false;
+
+    Rendered[mimetype] = output;
+    return true;
+}
+
+QByteArray toResultMimeData::renderText(QProgressDialog *progress) const
+{
+    QByteArray output;
+
+    // same layouts as toListViewFormatterText (fixed width columns, two passes
+    // to get the widths) and toListViewFormatterTabDel
+    bool fixed = Settings.type == toListViewFormatterIdentifier::TEXT;
+    QVector<int> columns;
+    foreach (int column, Columns)
+    {
+        if (!Settings.rowsHeader && column == 0)
+            continue;
+        columns.append(column);
+    }
+
+    QStringList headers;
+    foreach (int column, columns)
+        headers << Model->headerData(column, Qt::Horizontal, Qt::DisplayRole).toString();
+
+    QVector<int> widths(columns.size(), 0);
+    if (progress)
+        progress->setMaximum(fixed ? Rows.size() * 2 : Rows.size());
+    if (fixed)
+    {
+        if (Settings.columnsHeader)
+        {
+            for (int i = 0; i < columns.size(); i++)
+                widths[i] = headers.at(i).length();
+        }
+        for (int r = 0; r < Rows.size(); r++)
+        {
+            if (progress)
+            {
+                if (progress->wasCanceled())
+                    return QByteArray();
+                if (r % 1000 == 0)
+                    progress->setValue(r);
+            }
+            for (int i = 0; i < columns.size(); i++)
+                widths[i] = (std::max)(widths[i], cellText(Rows[r], columns[i], fixed).length());
+        }
+    }
+
+    if (Settings.columnsHeader)
+    {
+        if (fixed)
+        {
+            QString line, border;
+            for (int i = 0; i < columns.size(); i++)
+            {
+                line += headers.at(i).leftJustified(widths[i], ' ');
+                line += ' '; // gap between columns
+                border += QString::fromLatin1("=").leftJustified(widths[i], '=');
+                border += ' ';
+            }
+            output += line.toUtf8();
+            endLine(output);
+            output += border.toUtf8();
+        }
+        else
+        {
+            output += headers.join("\t").toUtf8();
+        }
+        endLine(output);
+    }
+
+    int offset = fixed ? Rows.size() : 0;
+    for (int r = 0; r < Rows.size(); r++)
+    {
+        if (progress)
+        {
+            if (progress->wasCanceled())
+                return QByteArray();
+            if (r % 1000 == 0)
+                progress->setValue(offset + r);
+        }
+
+        QString line;
+        for (int i = 0; i < columns.size(); i++)
+        {
+            QString value = cellText(Rows[r], columns[i], fixed);
+            if (fixed)
+            {
+                line += value.leftJustified(widths[i], ' ');
+                line += ' ';
+            }
+            else
+            {
+                if (i > 0)
+                    line += '\t';
+                line += value;
+            }
+        }
+        output += line.toUtf8();
+        endLine(output);
+    }
+
+    if (progress)
+        progress->setValue(progress->maximum());
+    return output;
+}
+
+QString toResultMimeData::cellText(int row, int column, bool markNull) const
+{
+    QVariant data = Model->data(Model->index(row, column), Qt::EditRole);
+    if (markNull && data.isNull())
+        return QString::fromLatin1("{null}");
+    return data.toString();
+}
+
+QByteArray toResultMimeData::renderList(QProgressDialog *progress) const
+{
+    QByteArray output;
+    QDataStream stream(&output, QIODevice::WriteOnly);
+
+    // selection shape, then the cells column by column as toResultModelEdit::dropMimeData reads them
+    stream << Rows.size();
+    stream << Columns.size();
+
+    int done = 0;
+    foreach (int column, Columns)
+    {
+        foreach (int row, Rows)
+        {
+            if (progress)
+            {
+                if (progress->wasCanceled())
+                    return QByteArray();
+                if (++done % 1000 == 0)
+                    progress->setValue(done / Columns.size());
+            }
+            stream << Model->data(Model->index(row, column), Qt::DisplayRole).toString();
+        }
+    }
+
+    if (progress)
+        progress->setValue(Rows.size());
+    return output;
+}
+
+QByteArray toResultMimeData::renderFormatted(int type) const
+{
+    toExportSettings settings(Settings);
+    foreach (int row, Rows)
+    {
+        foreach (int column, Columns)
+            settings.selected.append(Model->index(row, column));
+    }
+
+    std::unique_ptr<toListViewFormatter> pFormatter(toListViewFormatterFactory::Instance().CreateObject(type));
+    return pFormatter->getFormattedString(settings, Model).toUtf8();
+}
@@ -0,0 +1,111 @@
+
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ *
+ * TOra - An Oracle Toolkit for DBA's and developers
+ *
+ * Shared/mixed copyright is held throughout files in this product
+ *
+ * Portions Copyright (C) 2000-2001 Underscore AB
+ * Portions Copyright (C) 2003-2005 Quest Software, Inc.
+ * Portions Copyright (C) 2004-2013 Numerous Other Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation;  only version 2 of
+ * the License is valid for this program.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program as the file COPYING.txt; if not, please see
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *      As a special exception, you have permission to link this program
+ *      with the Oracle Client libraries and distribute executables, as long
+ *      as you follow the requirements of the GNU GPL in regard to all of the
+ *      software in the executable aside from Oracle client libraries.
+ *
+ * All trademarks belong to their respective owners.
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include "core/tolistviewformatter.h"
+
+#include <QtCore/QMimeData>
+#include <QtCore/QPointer>
+#include <QtCore/QVector>
+#include <QtCore/QHash>
+
+class QAbstractItemModel;
+class QProgressDialog;
+
+/*! \brief Clipboard and drag payload of a result model selection.
+
+Only the selection shape is taken when the copy or drag starts; text and
+the other formats are rendered from the model when a target asks for
+them, row by row, and kept for the following requests. Selections above
+LargeSelection cells show a cancellable progress dialog while rendering.
+
+If the model is reset, changes layout (sort), is edited or is deleted
+before anybody asked, the pending formats are rendered right away from
+the pre-change signals so a paste still returns what was copied.
+*/
+class toResultMimeData : public QMimeData
+{
+        Q_OBJECT;
+    public:
+        /** Number of cells above which rendering shows a progress dialog */
+        static const int LargeSelection = 100000;
+
+        /**
+         * @param model   Model the selection belongs to.
+         * @param indexes Selected cells, rendered as the rows x columns they span.
+         * @param formats Formats offered, rendered on demand.
+         * @param settings Settings used for text/plain, see toResultListFormat::plaintextCopySettings.
+         */
+        toResultMimeData(QAbstractItemModel *model,
+                         const QModelIndexList &indexes,
+                         const QStringList &formats,
+                         const toExportSettings &settings);
+
+        QStringList formats() const override;
+        bool hasFormat(const QString &mimetype) const override;
+
+        /** Number of cells spanned by the selection */
+        int cells(void) const
+        {
+            return Rows.size() * Columns.size();
+        }
+
+    protected:
+        QVariant retrieveData(const QString &mimetype, QVariant::Type type) const override;
+
+    private slots:
+        /** Render whatever was not asked for yet and let go of the model */
+        void detach(void);
+
+    private:
+        // false if cancelled or the model is gone
+        bool render(const QString &mimetype) const;
+
+        /** text/plain in the layout of Settings.type, TEXT (fixed width) or TAB_DELIMITED */
+        QByteArray renderText(QProgressDialog *progress) const;
+        QByteArray renderList(QProgressDialog *progress) const;
+        /** Whole selection through the export formatter type (toListViewFormatterIdentifier) */
+        QByteArray renderFormatted(int type) const;
+        /** Cell value as copied, {null} for NULL in the fixed width layout */
+        QString cellText(int row, int column, bool markNull) const;
+
+        QPointer<QAbstractItemModel> Model;
+        QVector<int> Rows;
+        QVector<int> Columns;
+        QStringList Formats;
+        toExportSettings Settings;
+
+        mutable QHash<QString, QByteArray> Rendered;
+};
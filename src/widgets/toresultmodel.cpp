@@ -33,6 +33,8 @@
  * END_COMMON_COPYRIGHT_HEADER */
 
 #include "widgets/toresultmodel.h"
+#include "widgets/toresultmimedata.h"
+#include "widgets/toresultlistformat.h"
 #include "core/utils.h"
 #include "core/tologger.h"
 #include "core/toconfiguration.h"
@@ -42,8 +44,11 @@
 #include "core/todatabaseconfig.h"
 
 #include <QtCore/QDebug>
+#include <QtCore/QHash>
 #include <QtCore/QMimeData>
 
+#include <algorithm>
+
 toResultModel::toResultModel(toEventQuery *query,
                              QObject *parent,
                              bool read)
@@ -56,8 +61,10 @@ toResultModel::toResultModel(toEventQuery *query,
     , First(true)
     , HeadersRead(false)
     , ReadAll(false)
+    , DisplayCache(DisplayBlocks)
 {
     MaxRowsToAdd = MaxRows = toConfigurationNewSingle::Instance().option(ToConfiguration::Database::InitialFetchInt).toInt();
+    setupDisplay();
 
     Query = query;
     Query->setParent(this); // this will satisfy QObject's disposal
@@ -74,21 +81,24 @@ toResultModel::toResultModel(toEventQuery *query,
 #endif
 }
 
-toResultModel::toResultModel(const QString &owner,
-                             const QString &type,
+toResultModel::toResultModel(const QString &type,
+                             const QStringList &names,
                              QObject *parent,
                              bool read)
     : QAbstractTableModel(parent)
     , Query(NULL)
-    , SortedOnColumn(-1)
+    , CachedNames(names)
+    , SortedOnColumn(0)
     , SortedOrder(Qt::AscendingOrder)
     , CurrRowKey(1)
     , ReadableColumns(read)
-    , First(true)
+    , First(false)
     , HeadersRead(false)
     , ReadAll(false)
+    , DisplayCache(DisplayBlocks)
 {
     MaxRowsToAdd = MaxRows = toConfigurationNewSingle::Instance().option(ToConfiguration::Database::InitialFetchInt).toInt();
+    setupDisplay();
 #if QT_VERSION < 0x050000
     setSupportedDragActions(Qt::CopyAction);
 #endif
@@ -109,35 +119,71 @@ toResultModel::toResultModel(const QString &owner,
     Headers.append(d);
     HeadersRead = true;
 
-    // Fetch list of objects from the cache
-    QList<toCache::CacheEntry const*> tmp = toConnection::currentConnection(this).getCache().getEntriesInSchema(owner, type);
+    // Names come sorted, the rest is appended when the view scrolls
+    appendCached();
+}
+
+void toResultModel::appendCached(void)
+{
+    int current = Rows.size();
+    int last = CachedNames.size();
+    if (!ReadAll && MaxRows >= 0 && MaxRows < last)
+        last = MaxRows;
+    if (last <= current)
+        return;
 
-    beginInsertRows(QModelIndex(), 0, tmp.count());
-    // Convert list of objects to appropriate type
-    toQueryAbstr::Row row;
-    int counter = 1;
-    for (QList<toCache::CacheEntry const*>::iterator i = tmp.begin(); i != tmp.end(); i++)
+    beginInsertRows(QModelIndex(), current, last - 1);
+    for (int i = current; i < last; i++)
     {
         // For each row a mandatory rownumber integer should be added
+        toQueryAbstr::Row row;
         toRowDesc rowDesc;
-        rowDesc.key = counter++;
+        rowDesc.key = CurrRowKey++;
         rowDesc.status = EXISTED;
         row.append(toQValue(rowDesc));
-        //row.append(toQValue(counter++));
-        // Copy all values of a record
-        ////for (toCache::Row::iterator ii = (*i).begin(); ii != (*i).end(); ii++)
-        ///{
-        ///    row.append((*ii).toString());
-        ///}
-        row.append((*i)->name.second);
+        row.append(toQValue(CachedNames.at(i)));
         Rows.append(row);
-        row.clear();
     }
     endInsertRows();
 }
 
+toResultModel::toResultModel(const toQColumnDescriptionList &columns,
+                             const toQueryAbstr::RowList &rows,
+                             QObject *parent,
+                             bool read)
+    : QAbstractTableModel(parent)
+    , Query(NULL)
+    , SortedOnColumn(-1)
+    , SortedOrder(Qt::AscendingOrder)
+    , CurrRowKey(1)
+    , ReadableColumns(read)
+    , First(false)
+    , HeadersRead(false)
+    , ReadAll(true)
+    , DisplayCache(DisplayBlocks)
+{
+    MaxRowsToAdd = MaxRows = toConfigurationNewSingle::Instance().option(ToConfiguration::Database::InitialFetchInt).toInt();
+    setupDisplay();
+#if QT_VERSION < 0x050000
+    setSupportedDragActions(Qt::CopyAction);
+#endif
+    setHeaders(columns);
+
+    Q_FOREACH(toQueryAbstr::Row const& r, rows)
+    {
+        toQueryAbstr::Row row;
+        toRowDesc rowDesc;
+        rowDesc.key = CurrRowKey++;
+        rowDesc.status = EXISTED;
+        row.append(toQValue(rowDesc));
+        row.append(r);
+        Rows.append(row);
+    }
+}
+
 toResultModel::~toResultModel()
 {
+    emit aboutToBeDeleted();
     cleanup();
 }
 
@@ -173,6 +219,8 @@ void toResultModel::readAll()
     ReadAll = true;
     if (Query)
         Query->setFetchMode(toEventQuery::READ_ALL);
+    else
+        appendCached();
 }
 
 void toResultModel::slotReadAll()
@@ -180,6 +228,8 @@ void toResultModel::slotReadAll()
     ReadAll = true;
     if (Query)
         Query->setFetchMode(toEventQuery::READ_ALL);
+    else
+        appendCached();
 }
 
 
@@ -300,71 +350,41 @@ QStringList toResultModel::mimeTypes() const
 
 QMimeData* toResultModel::mimeData(const QModelIndexList &indexes) const
 {
-    QMimeData   *mimeData = new QMimeData();
-    QByteArray   encodedData;
-    QDataStream  stream(&encodedData, QIODevice::WriteOnly);
-    QByteArray   stringData;
-    QDataStream  ss(&stringData, QIODevice::WriteOnly);
-
     int         valid = 0;
     QModelIndex validIndex;
-    QString     text;
-
-    // qt sends list by column (all indexes from column 1, then column
-    // column2). Need to figure out the number of columns and
-    // rows. It'd be awesome if we could get the selection but there's
-    // no good way to do that from the model.
-    int rows       = 0;
-    int columns    = 0;
-    int currentRow = -1;
-    int currentCol = -1;
 
     foreach (QModelIndex index, indexes)
     {
         if (index.isValid())
         {
-            if (index.row() > currentRow)
-            {
-                currentRow = index.row();
-                rows++;
-            }
-
-            if (currentCol != index.column())
-            {
-                currentCol = index.column();
-                columns++;
-            }
-
             valid++;
             validIndex = index;
-            text = data(index, Qt::DisplayRole).toString();
-            ss << text;
         }
     }
 
     if (valid < 1)
         return 0;
 
-    if (valid == 1)
+    if (valid > 1)
     {
-        mimeData->setText(text);
+        // cells are only read when the drop target asks for them
+        return new toResultMimeData(const_cast<toResultModel*>(this),
+                                    indexes,
+                                    QStringList() << "application/vnd.tomodel.list" << "text/plain",
+                                    toResultListFormat::plaintextCopySettings());
+    }
 
-        // set row and column in data so we can try to preserve the
-        // columns, if needed
+    QMimeData *mimeData = new QMimeData();
+    mimeData->setText(data(validIndex, Qt::DisplayRole).toString());
 
-        QByteArray sourceData;
-        QDataStream sourceStream(&sourceData, QIODevice::WriteOnly);
-        sourceStream << validIndex.row();
-        sourceStream << validIndex.column();
-        mimeData->setData("application/vnd.int.list", sourceData);
-    }
-    else
-    {
-        // serialize selection shape
-        stream << rows;
-        stream << columns;
-        mimeData->setData("application/vnd.tomodel.list", encodedData + stringData);
-    }
+    // set row and column in data so we can try to preserve the
+    // columns, if needed
+
+    QByteArray sourceData;
+    QDataStream sourceStream(&sourceData, QIODevice::WriteOnly);
+    sourceStream << validIndex.row();
+    sourceStream << validIndex.column();
+    mimeData->setData("application/vnd.int.list", sourceData);
 
     return mimeData;
 }
@@ -527,17 +547,12 @@ QVariant toResultModel::data(const QModelIndex &index, int role) const
 			}
 			return QVariant(data.editData());
 		case Qt::DisplayRole:
-			if (data.isComplexType())
-			{
-				toQValue::complexType *i = data.toQVariant().value<toQValue::complexType*>();
-				return QVariant(i->displayData());
-			}
-			if (index.column() == 0)
+			if (index.column() == 0 && !data.isComplexType())
 				return QVariant(rowDesc.key);
-			return QVariant(data.displayData());
+			return QVariant(displayText(index.row(), index.column()));
 		case Qt::BackgroundRole:
-			if (data.isNull() && toConfigurationNewSingle::Instance().option(ToConfiguration::Database::IndicateEmptyBool).toBool())
-				return QVariant(QColor(toConfigurationNewSingle::Instance().option(ToConfiguration::Database::IndicateEmptyColor).toString()));
+			if (data.isNull() && IndicateEmpty)
+				return QVariant(EmptyColor);
 			if (index.column() == 0)
 			{
 				return QPalette().color(QPalette::Window);
@@ -564,6 +579,96 @@ QVariant toResultModel::data(const QModelIndex &index, int role) const
     return QVariant();
 }
 
+QString const& toResultModel::displayText(int row, int column) const
+{
+    int block = row / DisplayBlockRows;
+    int columns = Headers.size();
+    QVector<QString> *texts = DisplayCache.object(block);
+    if (!texts)
+    {
+        // Format the whole block while it is being scrolled into view
+        int first = block * DisplayBlockRows;
+        int last = (std::min)(first + DisplayBlockRows, Rows.size());
+        texts = new QVector<QString>((last - first) * columns);
+        bool indicateEmpty = IndicateEmpty;
+        for (int r = first; r < last; r++)
+        {
+            toQueryAbstr::Row const& cells = Rows.at(r);
+            QString *out = texts->data() + (r - first) * columns;
+            for (int c = 0; c < columns && c < cells.size(); c++)
+            {
+                toQValue const &cell = cells.at(c);
+                if (cell.isComplexType())
+                {
+                    toQValue::complexType *i = cell.toQVariant().value<toQValue::complexType*>();
+                    out[c] = i->displayData();
+                }
+                else if (cell.isNull())
+                {
+                    if (indicateEmpty)
+                        out[c] = QString::fromLatin1("{null}");
+                }
+                else if (c > 0)
+                    out[c] = cell.displayData();
+            }
+        }
+        DisplayCache.insert(block, texts);
+    }
+    return texts->at((row - block * DisplayBlockRows) * columns + column);
+}
+
+void toResultModel::setupDisplay(void)
+{
+    EmptyColor = QColor((QString) IndicateEmptyColor);
+    connect(&IndicateEmpty, SIGNAL(valueChanged(QVariant const&)), this, SLOT(invalidateDisplay()));
+    connect(&IndicateEmptyColor, SIGNAL(valueChanged(QVariant const&)), this, SLOT(emptyColorChanged()));
+
+    // Every change of Rows is announced through one of these, including edits and sort
+    connect(this, SIGNAL(modelReset()), this, SLOT(invalidateDisplay()));
+    connect(this, SIGNAL(layoutChanged()), this, SLOT(invalidateDisplay()));
+    connect(this, SIGNAL(headerDataChanged(Qt::Orientation, int, int)), this, SLOT(invalidateDisplay()));
+    connect(this, SIGNAL(dataChanged(const QModelIndex &, const QModelIndex &)),
+            this, SLOT(invalidateDisplay(const QModelIndex &, const QModelIndex &)));
+    connect(this, SIGNAL(rowsInserted(const QModelIndex &, int, int)),
+            this, SLOT(invalidateDisplayFrom(const QModelIndex &, int)));
+    connect(this, SIGNAL(rowsRemoved(const QModelIndex &, int, int)),
+            this, SLOT(invalidateDisplayFrom(const QModelIndex &, int)));
+    connect(this, SIGNAL(columnsInserted(const QModelIndex &, int, int)), this, SLOT(invalidateDisplay()));
+}
+
+void toResultModel::invalidateDisplay(void)
+{
+    DisplayCache.clear();
+}
+
+void toResultModel::invalidateDisplay(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    int first = (std::max)(topLeft.row(), 0) / DisplayBlockRows;
+    int last = (std::max)(bottomRight.row(), 0) / DisplayBlockRows;
+    if (last - first >= DisplayBlocks)
+    {
+        DisplayCache.clear();
+        return;
+    }
+    for (int block = first; block <= last; block++)
+        DisplayCache.remove(block);
+}
+
+void toResultModel::invalidateDisplayFrom(const QModelIndex &, int first)
+{
+    // rows at and after first moved, blocks before it are still valid
+    foreach(int block, DisplayCache.keys())
+    {
+        if ((block + 1) * DisplayBlockRows > first)
+            DisplayCache.remove(block);
+    }
+}
+
+void toResultModel::emptyColorChanged(void)
+{
+    EmptyColor = QColor((QString) IndicateEmptyColor);
+}
+
 QVariant toResultModel::data(int row, int column, int role) const
 {
     QModelIndex ind = index(row, column);
@@ -659,6 +764,11 @@ void toResultModel::receiveHeaders(toEventQuery*)
     if (!Query)
         return;
 
+    setHeaders(Query->describe());
+}
+
+void toResultModel::setHeaders(const toQColumnDescriptionList &desc)
+{
     // always add the number column. this makes adjusting for it in
     // the row data easier. it is not always displayed.
     struct HeaderDesc d;
@@ -668,8 +778,7 @@ void toResultModel::receiveHeaders(toEventQuery*)
     d.datatype = "INT";
     Headers.append(d);
 
-    toQColumnDescriptionList desc = Query->describe();
-    for (toQColumnDescriptionList::iterator i = desc.begin(); i != desc.end(); i++)
+    for (toQColumnDescriptionList::const_iterator i = desc.begin(); i != desc.end(); i++)
     {
         struct HeaderDesc d;
 
@@ -722,7 +831,7 @@ bool toResultModel::canFetchMore(const QModelIndex &parent) const
         return true;
     if (Query)
         return !Query->eof();
-    return false;
+    return Rows.size() < CachedNames.size();
 }
 
 
@@ -759,6 +868,12 @@ void toResultModel::fetchMore(const QModelIndex &parent)
     if (MaxRows < 0 || MaxRows <= Rows.size())
         MaxRows += MaxRowsToAdd;
 
+    if (!Query && !CachedNames.isEmpty())
+    {
+        appendCached();
+        return;
+    }
+
     if (Query)
         Query->requestMore();
     slotReadData();
@@ -814,11 +929,38 @@ void toResultModel::sort(int column, Qt::SortOrder order)
             SortedOrder == order)
         return;
 
+    // Cached names appended after the sort would not be in order
+    if (!Query && Rows.size() < CachedNames.size())
+    {
+        ReadAll = true;
+        appendCached();
+    }
+
+    emit layoutAboutToBeChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+
+    // Persistent indexes (selection, current cell) follow their rows, found by row key
+    QModelIndexList persistent = persistentIndexList();
+    QVector<int> keys;
+    keys.reserve(persistent.size());
+    Q_FOREACH(QModelIndex const& i, persistent)
+        keys << (i.row() < Rows.size() ? Rows.at(i.row()).at(0).getRowDesc().key : -1);
+
     Rows = mergesort(Rows, column, order);
     SortedOnColumn = column;
     SortedOrder = order;
-    emit dataChanged(createIndex(0, 0),
-                     createIndex(rowCount(), columnCount()));
+
+    QHash<int, int> rowOfKey;
+    for (int r = 0; r < Rows.size(); r++)
+        rowOfKey.insert(Rows.at(r).at(0).getRowDesc().key, r);
+    QModelIndexList moved;
+    for (int i = 0; i < persistent.size(); i++)
+    {
+        QHash<int, int>::const_iterator r = rowOfKey.constFind(keys.at(i));
+        moved << (r == rowOfKey.constEnd() ? QModelIndex() : index(r.value(), persistent.at(i).column()));
+    }
+    changePersistentIndexList(persistent, moved);
+
+    emit layoutChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
 }
 
 
@@ -872,6 +1014,15 @@ toQueryAbstr::RowList& toResultModel::getRawData(void)
     return Rows;
 }
 
+void toResultModel::setValue(int row, int column, const toQValue &value)
+{
+    if (row < 0 || row >= Rows.size() || column < 1 || column >= Rows.at(row).size())
+        return;
+    emit dataAboutToBeChanged(index(row, column), index(row, column));
+    Rows[row][column] = value;
+    emit dataChanged(index(row, column), index(row, column));
+}
+
 void toResultModel::setInitialRows(int r)
 {
     MaxRows = r;
@@ -39,12 +39,17 @@
 #include "core/toresult.h"
 #include "core/toconnection.h"
 #include "core/toqvalue.h"
+#include "core/toconfiguration.h"
+#include "core/todatabaseconfig.h"
 
 #include <QtCore/QObject>
 #include <QtCore/QAbstractTableModel>
 #include <QtCore/QModelIndex>
 #include <QtCore/QList>
 #include <QtCore/QMap>
+#include <QtCore/QCache>
+#include <QtCore/QVector>
+#include <QColor>
 
 
 class toEventQuery;
@@ -72,8 +77,17 @@ class toResultModel : public QAbstractTableModel
         /** This constructor is used when model has to be filled in
          * from the cache rather than from the database.
          */
-        toResultModel(const QString &owner,
-                      const QString &type,
+        toResultModel(const QString &type,
+                      const QStringList &names,
+                      QObject *parent = 0,
+                      bool read = false);
+
+        /** This constructor is used for rows read by the caller (e.g. before they
+         * were removed from the database).
+         * @param rows Values of each row, without the row number column.
+         */
+        toResultModel(const toQColumnDescriptionList &columns,
+                      const toQueryAbstr::RowList &rows,
                       QObject *parent = 0,
                       bool read = false);
 
@@ -236,6 +250,12 @@ class toResultModel : public QAbstractTableModel
         toQueryAbstr::RowList &getRawData(void);
 
         void setInitialRows(int);
+
+        /**
+         * Replace the value of one cell without changing the row status.
+         * Meant for tools annotating the rows they show, not for edits.
+         */
+        void setValue(int row, int column, const toQValue &value);
     signals:
 
         /**
@@ -259,6 +279,17 @@ class toResultModel : public QAbstractTableModel
          */
         void lastResult(const QString &message, bool error);
 
+        /**
+         * Emitted from the destructor while the data can still be read.
+         */
+        void aboutToBeDeleted(void);
+
+        /**
+         * Emitted before values in the range are replaced (edits, @ref setValue),
+         * while the old values can still be read. dataChanged() follows.
+         */
+        void dataAboutToBeChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
     protected slots:
         /**
          * reads and sets up Headers
@@ -287,8 +318,24 @@ class toResultModel : public QAbstractTableModel
          */
         void slotReadAll(void);
 
+        /**
+         * Drop formatted display strings after the rows were changed.
+         */
+        void invalidateDisplay(void);
+        void invalidateDisplay(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+        void invalidateDisplayFrom(const QModelIndex &parent, int first);
+        void emptyColorChanged(void);
+
     protected:
         void cleanup(void);
+        void setupDisplay(void);
+        /** Add the row number column and the described ones to Headers */
+        void setHeaders(const toQColumnDescriptionList &desc);
+
+        /** Formatted DisplayRole text of a cell, the whole block of rows
+         *  containing it is formatted at once on first access.
+         */
+        QString const& displayText(int row, int column) const;
 
         // helpers for sort implementation
         toQueryAbstr::RowList mergesort(toQueryAbstr::RowList&, int, Qt::SortOrder);
@@ -296,6 +343,11 @@ class toResultModel : public QAbstractTableModel
 
         toEventQuery *Query;
 
+        // Object names when the model is filled from the cache, rows are
+        // appended from it in blocks of MaxRowsToAdd like query results
+        QStringList CachedNames;
+        void appendCached(void);
+
         toQueryAbstr::RowList Rows;
         HeaderList Headers;
 
@@ -326,6 +378,17 @@ class toResultModel : public QAbstractTableModel
 
         // should read all data
         bool ReadAll;
+
+        // Display strings of blocks of DisplayBlockRows rows (row major), keyed by block
+        // number. QCache drops the least recently used blocks once DisplayBlocks are held.
+        static const int DisplayBlockRows = 128;
+        static const int DisplayBlocks = 64;
+        mutable QCache<int, QVector<QString> > DisplayCache;
+
+        // Snapshots of the options used while painting, updated when the options change
+        OptionObserver<ToConfiguration::Database::IndicateEmptyBool> IndicateEmpty;
+        OptionObserver<ToConfiguration::Database::IndicateEmptyColor> IndicateEmptyColor;
+        QColor EmptyColor;
 };
 
 
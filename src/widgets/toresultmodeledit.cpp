@@ -273,6 +273,8 @@ bool toResultModelEdit::setData(const QModelIndex &index,
     if (index.row() >= Rows.size() || index.column() >= Headers.size())
         return false;
 
+    emit dataAboutToBeChanged(index, index);
+
     toQueryAbstr::Row &row = Rows[index.row()];
     toQValue newValue = toQValue::fromVariant(_value);
     toRowDesc rowDesc = Rows.at(index.row())[0].getRowDesc();
@@ -423,3 +425,38 @@ void toResultModelEdit::recordDelete(const toQueryAbstr::Row &row)
     }
     emit changed(changed());
 }
+
+QList<toResultModelEdit::ChangeBatch> toResultModelEdit::batchChanges(QList<ChangeSet> const& changes,
+        int maxAdd,
+        int maxDelete)
+{
+    QList<ChangeBatch> retval;
+
+    for (int i = 0; i < changes.size(); i++)
+    {
+        ChangeSet const& change = changes.at(i);
+
+        // Only edits of a row following each other are coalesced, any change
+        // in between (e.g. swapping key values of two rows) must run before
+        // the next edit of the row
+        if (change.kind == Update)
+        {
+            if (!retval.isEmpty()
+                    && retval.last().first()->kind == Update
+                    && retval.last().first()->row[0].getRowDesc().key == change.row[0].getRowDesc().key)
+                retval.last() << &change;
+            else
+                retval << (ChangeBatch() << &change);
+            continue;
+        }
+
+        int max = change.kind == Add ? maxAdd : maxDelete;
+        if (!retval.isEmpty()
+                && retval.last().first()->kind == change.kind
+                && retval.last().size() < max)
+            retval.last() << &change;
+        else
+            retval << (ChangeBatch() << &change);
+    }
+    return retval;
+}
@@ -70,6 +70,17 @@ class toResultModelEdit : public toResultModel
             toQueryAbstr::Row       row;          /* data before the change */
         };
 
+        /** Changes sent to the database in one statement: rows to add or to delete,
+         * or the edits of a single row. Points into the list of changes.
+         */
+        typedef QList<ChangeSet const*> ChangeBatch;
+
+        /** Coalesce consecutive edits of a row and group consecutive adds/deletes, order is preserved
+         * @param maxAdd Maximum number of rows added by one batch
+         * @param maxDelete Maximum number of rows deleted by one batch
+         */
+        static QList<ChangeBatch> batchChanges(QList<ChangeSet> const& changes, int maxAdd, int maxDelete);
+
         toResultModelEdit(toEventQuery *query,
                           QList<QString> priKeys,
                           QObject *parent = 0,